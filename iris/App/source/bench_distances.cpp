@@ -0,0 +1,171 @@
+#include "lib_iris.hpp"
+#include <iostream>
+#include <ctime>
+using namespace std;
+
+/**@fn
+ * @brief
+ * Temps écoulé (horloge monotone) en secondes.
+ **/
+static double get_time( void )
+{
+	struct timespec t;
+	clock_gettime( CLOCK_MONOTONIC, &t );
+	return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/**@fn
+ * @brief
+ * Comptage bit à bit ( ancienne implémentation, référence ).
+ **/
+static void count_bits_ref(	distance::bit_counts & counts,
+							const unsigned long long * x_1,
+							const unsigned long long * x_2,
+							const unsigned long long * v_1,
+							const unsigned long long * v_2,
+							const unsigned long long * s_1,
+							const unsigned long long * s_2,
+							size_t size )
+{
+	counts.valid = 0;
+	counts.diff = 0;
+	counts.both = 0;
+	for ( size_t i = 0; i < size; ++ i )
+	{
+		unsigned long long 	n1 = v_1[i] & v_2[i],
+							c1 = ( x_1[i] ^ x_2[i] ) & n1,
+							c2 = s_1[i] & s_2[i] & n1;
+		for ( unsigned int k = 0; k < 64; ++ k )
+		{
+			counts.valid += ( n1 >> k ) & 1;
+			counts.diff += ( c1 >> k ) & 1;
+			counts.both += ( c2 >> k ) & 1;
+		}
+	}
+}
+
+static void random_template( 	unsigned long long * code,
+								unsigned long long * mask,
+								unsigned long long * fb,
+								size_t size )
+{
+	for ( size_t i = 0; i < size; ++ i )
+	{
+		code[i] = ( ( (unsigned long long) rand() ) << 32 ) ^ rand();
+		mask[i] = ~( ( ( (unsigned long long) rand() ) << 32 ) & rand() );
+		fb[i] = mask[i] & ( ( ( (unsigned long long) rand() ) << 32 ) | rand() );
+	}
+}
+
+/**
+ * argv[1] : nombre de répétitions ( optionnel, 20000 par défaut )
+ * Pour chaque taille d'iris code ( nb_directions x 2 * nb_samples ), compare
+ * le comptage bit à bit avec chaque noyau de comptage disponible et vérifie
+ * que les distances de Hamming, FBD et Hamming_FBD sont identiques.
+ **/
+int main ( int argc, char ** argv )
+{
+	unsigned int nb_iterations = 20000;
+	if ( argc > 1 )
+		nb_iterations = atoi( argv[1] );
+
+	const unsigned int 	widths[] = { 128, 256, 512, 1024 },
+						heights[] = { 16, 32, 64 };
+	const distance::popcount_kernel kernels[] = { 	distance::POPCOUNT_SCALAR,
+													distance::POPCOUNT_AVX2,
+													distance::POPCOUNT_AVX512 };
+	distance::popcount_kernel auto_kernel = distance::get_popcount_kernel();
+	int q = 0;
+	cout << "Auto kernel : " << distance::popcount_kernel_name( auto_kernel ) << endl;
+	cout << "width\theight\tkernel\tns/compare\tspeed-up\tdistances" << endl;
+
+	for ( unsigned int w = 0; w < sizeof(widths) / sizeof(unsigned int); ++ w )
+	{
+		for ( unsigned int h = 0; h < sizeof(heights) / sizeof(unsigned int); ++ h )
+		{
+			unsigned int 	width = widths[w],
+							height = heights[h],
+							width_step = ( width + 63 ) / 64;
+			size_t size = width_step * height;
+			unsigned long long 	* buffer = new unsigned long long[ 9 * size ],
+								* code_1 = buffer,
+								* mask_1 = buffer + size,
+								* fb_1 = buffer + 2 * size,
+								* code_2 = buffer + 3 * size,
+								* mask_2 = buffer + 4 * size,
+								* fb_2 = buffer + 5 * size,
+								* _code_2 = buffer + 6 * size,
+								* _mask_2 = buffer + 7 * size,
+								* _fb_2 = buffer + 8 * size;
+			random_template( code_1, mask_1, fb_1, size );
+			random_template( code_2, mask_2, fb_2, size );
+
+			//Référence
+			distance::bit_counts ref, counts;
+			unsigned long long sum = 0;
+			double t_ref = get_time();
+			for ( unsigned int i = 0; i < nb_iterations; ++ i )
+			{
+				count_bits_ref( ref, code_1, code_2, mask_1, mask_2, fb_1, fb_2, size );
+				sum += ref.diff;
+			}
+			t_ref = ( get_time() - t_ref ) / nb_iterations;
+			cout << width << "\t" << height << "\tbitwise\t" << t_ref * 1e9 << "\t1\t-" << endl;
+
+			for ( unsigned int k = 0; k < sizeof(kernels) / sizeof(distance::popcount_kernel); ++ k )
+			{
+				if ( distance::set_popcount_kernel( kernels[k] ) )
+					continue;
+
+				double t = get_time();
+				for ( unsigned int i = 0; i < nb_iterations; ++ i )
+				{
+					distance::count_bits( counts, code_1, code_2, mask_1, mask_2, fb_1, fb_2, size );
+					sum += counts.diff;
+				}
+				t = ( get_time() - t ) / nb_iterations;
+
+				//Vérification des distances ( bit à bit identiques )
+				const char * check = "OK";
+				if ( 	counts.valid != ref.valid 	||
+						counts.diff != ref.diff 	||
+						counts.both != ref.both 	)
+					check = "FAILED";
+				double alpha = 0.5;
+				for ( int theta = - (int) width / 8; theta <= (int) width / 8; ++ theta )
+				{
+					double d_1, d_2, d_3;
+					distance::Hamming_opt( 	d_1, code_1, mask_1, fb_1, code_2, mask_2, fb_2,
+											width, height, width_step, theta, &alpha,
+											_code_2, _mask_2, _fb_2 );
+					distance::fragile_bit_distance_opt( 	d_2, code_1, mask_1, fb_1, code_2, mask_2, fb_2,
+															width, height, width_step, theta, &alpha,
+															_code_2, _mask_2, _fb_2 );
+					distance::Hamming_FBD_opt( 	d_3, code_1, mask_1, fb_1, code_2, mask_2, fb_2,
+												width, height, width_step, theta, &alpha,
+												_code_2, _mask_2, _fb_2 );
+					distance::bit_counts h, f;
+					count_bits_ref( h, code_1, _code_2, fb_1, _fb_2, fb_1, _fb_2, size );
+					count_bits_ref( f, code_1, _code_2, mask_1, _mask_2, fb_1, _fb_2, size );
+					if ( 	( h.valid && d_1 != ( (double) h.diff ) / h.valid ) ||
+							( f.valid && d_2 != 1 - ( (double) f.both ) / f.valid ) ||
+							( f.valid && d_3 != alpha * ( 1 - ( (double) f.both ) / f.valid ) + ( 1 - alpha ) * ( ( (double) f.diff ) / f.valid ) ) )
+						check = "FAILED";
+				}
+				if ( check[0] == 'F' )
+					q = 1;
+
+				cout << 	width << "\t" << height << "\t"
+						<< distance::popcount_kernel_name( kernels[k] ) << "\t"
+						<< t * 1e9 << "\t"
+						<< t_ref / t << "\t"
+						<< check << endl;
+			}
+			delete[] buffer;
+			if ( sum == 42 )
+				cout << endl;
+		}
+	}
+	distance::set_popcount_kernel( auto_kernel );
+	return q;
+}
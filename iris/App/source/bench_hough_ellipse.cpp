@@ -0,0 +1,137 @@
+#include "lib_iris.hpp"
+#include <iostream>
+#include <ctime>
+#include <cstdlib>
+#include <vector>
+using namespace std;
+
+//Taille max. de l'accumulateur dense ( 1 Go )
+#define BENCH_HOUGH_MAX_DENSE_BYTES ( 1ULL << 30 )
+
+/**@fn
+ * @brief
+ * Temps écoulé (horloge monotone) en secondes.
+ **/
+static double get_time( void )
+{
+	struct timespec t;
+	clock_gettime( CLOCK_MONOTONIC, &t );
+	return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/**
+ * argv[1] : nombre d'orientations
+ * argv[2] : demi-axe min. ( pixels de l'image réduite )
+ * argv[3] : demi-axe max. ( exclu )
+ * argv[4] : facteur de réduction des masques ( 1 : aucune )
+ * argv[5...] : masques de contour ( pixel non nul : contour )
+ * Compare le mode HOUGH_ELLIPSE_PYRAMID de c_hough_ellipse au mode HOUGH_ELLIPSE_DENSE.
+ * Un pixel de l'image réduite est un contour si un pixel de son bloc l'est ( l'accumulateur
+ * dense fait largeur * hauteur * ( r_max - r_min )² * nb_thetas entiers ).
+ * Pour chaque masque, affiche les deux ellipses ( x, y, a, b, theta ) et leurs votes, puis
+ * le taux d'accord exact, le taux d'accord à une cellule près et les temps moyens.
+ **/
+int main ( int argc, char ** argv )
+{
+	if ( argc < 6 )
+	{
+		cout << "Error : missing argument(s)" << endl;
+		cout << "Usage : " << argv[0] << " nb_thetas r_min r_max reduction mask_1 [mask_2 ...]" << endl;
+		return 1;
+	}
+	unsigned int 	nb_thetas = atoi( argv[1] ),
+					r_min = atoi( argv[2] ),
+					r_max = atoi( argv[3] ),
+					reduction = atoi( argv[4] );
+	if ( ! nb_thetas || r_min >= r_max || ! reduction )
+	{
+		cout << "Error : invalid argument(s)" << endl;
+		return 1;
+	}
+
+	unsigned int 	nb_masks = 0,
+					nb_exact = 0,
+					nb_close = 0;
+	double 	t_dense = 0,
+			t_pyramid = 0;
+	cout << "mask\tdense (x y a b theta : votes)\tpyramid (x y a b theta : votes)\tdense (s)\tpyramid (s)" << endl;
+	for ( int n = 5; n < argc; ++ n )
+	{
+		IplImage * image = cvLoadImage( argv[n], CV_LOAD_IMAGE_GRAYSCALE );
+		if ( ! image )
+		{
+			cout << "Error : can't open " << argv[n] << endl;
+			continue;
+		}
+		//Réduction ( OU logique sur les blocs )
+		unsigned int 	width = image->width / reduction,
+						height = image->height / reduction;
+		vector<unsigned char> mask( width * height, 0 );
+		for ( unsigned int i = 0; i < height * reduction; ++ i )
+		{
+			const unsigned char * row = (const unsigned char *) image->imageData + i * image->widthStep;
+			for ( unsigned int j = 0; j < width * reduction; ++ j )
+			{
+				if ( row[j] )
+					mask[ ( i / reduction ) * width + j / reduction ] = 1;
+			}
+		}
+		cvReleaseImage( &image );
+		double nb_bytes = 	(double) sizeof(unsigned int) * width * height *
+							( r_max - r_min ) * ( r_max - r_min ) * nb_thetas;
+		if ( ! width || ! height || nb_bytes > BENCH_HOUGH_MAX_DENSE_BYTES )
+		{
+			cout << "Error : " << argv[n] << " : dense accumulator too large ( " << nb_bytes / ( 1 << 20 ) << " MB ), increase the reduction" << endl;
+			continue;
+		}
+
+		int 	x_d, y_d,
+				x_p, y_p;
+		unsigned int 	a_d, b_d, v_d,
+						a_p, b_p, v_p;
+		double 	theta_d,
+				theta_p;
+
+		double t = get_time();
+		c_hough_ellipse dense;
+		if ( dense.setup( width, height, nb_thetas, r_min, r_max ) )
+			return 1;
+		dense.compute_hough_transform( &mask[0], width, height, width, 0, width, 0, height, r_min, r_max );
+		v_d = dense.search_best_ellipse( x_d, y_d, a_d, b_d, theta_d, 0, width, 0, height, r_min, r_max );
+		double t_d = get_time() - t;
+
+		t = get_time();
+		c_hough_ellipse pyramid;
+		if ( pyramid.setup_pyramid( nb_thetas, r_min, r_max ) )
+			return 1;
+		pyramid.compute_hough_transform( &mask[0], width, height, width, 0, width, 0, height, r_min, r_max );
+		v_p = pyramid.search_best_ellipse( x_p, y_p, a_p, b_p, theta_p, 0, width, 0, height, r_min, r_max );
+		double t_p = get_time() - t;
+
+		//Orientations en indices ( theta = k * PI / ( 2 nb_thetas ) )
+		int 	k_d = (int) floor( theta_d * 2 * nb_thetas / M_PI + 0.5 ),
+				k_p = (int) floor( theta_p * 2 * nb_thetas / M_PI + 0.5 );
+		if ( 	x_d == x_p && y_d == y_p && a_d == a_p && b_d == b_p && k_d == k_p )
+			++ nb_exact;
+		if ( 	abs( x_d - x_p ) <= 1 &&
+				abs( y_d - y_p ) <= 1 &&
+				abs( (int) a_d - (int) a_p ) <= 1 &&
+				abs( (int) b_d - (int) b_p ) <= 1 &&
+				abs( k_d - k_p ) <= 1 )
+			++ nb_close;
+		t_dense += t_d;
+		t_pyramid += t_p;
+		++ nb_masks;
+		cout << 	argv[n] << "\t" <<
+					x_d << " " << y_d << " " << a_d << " " << b_d << " " << theta_d << " : " << v_d << "\t" <<
+					x_p << " " << y_p << " " << a_p << " " << b_p << " " << theta_p << " : " << v_p << "\t" <<
+					t_d << "\t" << t_p << endl;
+	}
+	if ( ! nb_masks )
+		return 1;
+	cout << "Masks : " << nb_masks << endl;
+	cout << "Exact agreement : " << 100.0 * nb_exact / nb_masks << " %" << endl;
+	cout << "Agreement within 1 cell : " << 100.0 * nb_close / nb_masks << " %" << endl;
+	cout << "Mean time dense : " << t_dense / nb_masks << " s, pyramid : " << t_pyramid / nb_masks << " s ( speed-up " << t_dense / t_pyramid << " )" << endl;
+	return 0;
+}
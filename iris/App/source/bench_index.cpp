@@ -0,0 +1,177 @@
+#include "lib_iris.hpp"
+#include <iostream>
+#include <ctime>
+using namespace std;
+
+/**@fn
+ * @brief
+ * Temps écoulé (horloge monotone) en secondes.
+ **/
+static double get_time( void )
+{
+	struct timespec t;
+	clock_gettime( CLOCK_MONOTONIC, &t );
+	return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/**
+ * argv[1] : répertoire de la base de données ( ou fichier de galerie )
+ * argv[2] : fichier de paramètres ( matching.cfg )
+ * argv[3] : nombre de candidats vérifiés ( optionnel, 10 par défaut )
+ * argv[4] : pas des décalages de la requête ( optionnel, 2 par défaut )
+ * Compare l'index LSH ( c_lsh_index ) à la recherche exhaustive ( matching_opt ).
+ * Chaque iris code de la base est cherché dans le reste de la base ( leave-one-out ).
+ * Pour chaque configuration ( nb_tables x nb_bits ), affiche le rappel@1 ( même
+ * meilleure distance que la recherche exhaustive ) et le nombre de requêtes par seconde.
+ **/
+int main ( int argc, char ** argv )
+{
+	if ( argc < 3 )
+	{
+		cout << "Error : missing argument(s)" << endl;
+		cout << "Usage : " << argv[0] << " database_dir params.cfg [nb_candidates] [theta_step]" << endl;
+		return 1;
+	}
+	unsigned int 	nb_candidates = 10,
+					theta_step = 2;
+	if ( argc > 3 )
+		nb_candidates = atoi( argv[3] );
+	if ( argc > 4 )
+		theta_step = atoi( argv[4] );
+
+	api_parameters params;
+	params.load( argv[2] );
+	string 	iris_code_fn,
+			fragility_map_fn;
+	unsigned int nb_fused_images;
+	double 	fbr,
+			d_theta;
+	if ( 	api_get_string( params, "matching::iris_code_filename", &iris_code_fn, &cout ) 			||
+			api_get_string( params, "matching::fragility_map_filename", &fragility_map_fn, &cout ) 	||
+			api_get_double( params, "matching::d_theta", &d_theta, &cout ) 							)
+		return 1;
+	if ( api_get_positive_integer( params, "matching::nb_fused_images", &nb_fused_images ) )
+		nb_fused_images = 0;
+	if ( api_get_double( params, "matching::FBR_min", &fbr ) )
+		fbr = 0;
+
+	//Noms des fichiers ( cf. c_recognition )
+	stringstream oss, oss2;
+	if ( nb_fused_images != 0 )
+	{
+		oss << iris_code_fn << "_" << nb_fused_images << ".png";
+		oss2 << fragility_map_fn << "_" << nb_fused_images << ".png";
+	}
+	else
+	{
+		oss << iris_code_fn << ".png";
+		oss2 << fragility_map_fn << ".png";
+	}
+
+	c_matching matching;
+	if ( matching.setup(	argv[1],
+							oss.str().c_str(),
+							oss2.str().c_str(),
+							params,
+							&cout ) )
+		return 1;
+	matching.compute_fragile_bit_threshold( fbr );
+
+	unsigned int 	nb_classes = matching.nb_classes(),
+					truth;
+	double 	* distances = new double[ nb_classes ],
+			* best_distances = new double[ nb_classes ];
+	unsigned int 	* orders = new unsigned int[ nb_classes ],
+					* candidates = new unsigned int[ nb_candidates + 1 ];
+
+	//Recherche exhaustive
+	unsigned int nb_queries = 0;
+	double t_linear = get_time();
+	for ( unsigned int i = 0; i < nb_classes; ++ i )
+	{
+		best_distances[i] = 2;
+		if ( ! matching.iris_code_bis( i ) )
+			continue;
+		matching.matching_opt(	distances,
+								orders,
+								truth,
+								matching.iris_code_bis( i ),
+								matching.mask( i ),
+								matching.fragile_bits( i ),
+								matching.class_name( i ) );
+		for ( unsigned int j = 0; j < nb_classes; ++ j )
+		{
+			if ( orders[j] != i && matching.iris_code_bis( orders[j] ) )
+			{
+				best_distances[i] = distances[ orders[j] ];
+				break;
+			}
+		}
+		++ nb_queries;
+	}
+	t_linear = get_time() - t_linear;
+	cout << "Linear scan : " << nb_queries << " queries, " << nb_queries / t_linear << " queries/s" << endl;
+	cout << "nb_tables\tnb_bits\tentries\tbuild (s)\trecall@1\tqueries/s\tspeed-up" << endl;
+
+	const unsigned int 	tables[] = { 8, 16, 32, 64, 128 },
+						bits[] = { 8, 12, 16 };
+	for ( unsigned int b = 0; b < sizeof(bits) / sizeof(unsigned int); ++ b )
+	{
+		for ( unsigned int t = 0; t < sizeof(tables) / sizeof(unsigned int); ++ t )
+		{
+			double t_build = get_time();
+			c_lsh_index index;
+			if ( index.setup( 	matching,
+								tables[t],
+								bits[b],
+								d_theta,
+								theta_step,
+								0,
+								&cout ) )
+				return 1;
+			t_build = get_time() - t_build;
+
+			unsigned int nb_found = 0;
+			double t_index = get_time();
+			for ( unsigned int i = 0; i < nb_classes; ++ i )
+			{
+				if ( ! matching.iris_code_bis( i ) )
+					continue;
+				unsigned int n = index.query(	candidates,
+												nb_candidates + 1,
+												matching.iris_code_bis( i ),
+												matching.fragile_bits( i ) );
+				//Sans l'iris code cherché
+				unsigned int m = 0;
+				for ( unsigned int j = 0; j < n && m < nb_candidates; ++ j )
+				{
+					if ( candidates[j] != i )
+						candidates[ m ++ ] = candidates[j];
+				}
+				n = matching.matching_candidates(	distances,
+													orders,
+													candidates,
+													m,
+													matching.iris_code_bis( i ),
+													matching.mask( i ),
+													matching.fragile_bits( i ) );
+				if ( n && distances[0] == best_distances[i] )
+					++ nb_found;
+			}
+			t_index = get_time() - t_index;
+
+			cout << 	tables[t] << "\t" << bits[b] << "\t"
+					<< index.nb_entries() << "\t"
+					<< t_build << "\t"
+					<< ( (double) nb_found ) / nb_queries << "\t"
+					<< nb_queries / t_index << "\t"
+					<< t_linear / t_index << endl;
+		}
+	}
+
+	delete[] distances;
+	delete[] best_distances;
+	delete[] orders;
+	delete[] candidates;
+	return 0;
+}
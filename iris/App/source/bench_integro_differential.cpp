@@ -0,0 +1,151 @@
+#include "lib_iris.hpp"
+#include <iostream>
+#include <ctime>
+#include <cstdlib>
+#include <cmath>
+using namespace std;
+
+//Transformée polaire et noyau de l'opérateur
+#define BENCH_INTEGRO_NB_DIRECTIONS 128
+#define BENCH_INTEGRO_NB_SAMPLES 64
+#define BENCH_INTEGRO_KERNEL_SIZE 3
+//Modes comparés
+#define BENCH_INTEGRO_NB_MODES 4
+
+/**@fn
+ * @brief
+ * Temps écoulé (horloge monotone) en secondes.
+ **/
+static double get_time( void )
+{
+	struct timespec t;
+	clock_gettime( CLOCK_MONOTONIC, &t );
+	return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/**@fn
+ * @brief
+ * Mode de recherche n ( 0 : exhaustive, 1 : grossière pleine résolution,
+ * 2 : grossière sur l'image réduite, 3 : 2 + optimisation continue ).
+ **/
+static void set_mode( c_integro_differential_operator & op, unsigned int n )
+{
+	if ( n == 0 )
+		op.set_search_mode( C_INTEGRODIFF_EXHAUSTIVE );
+	else
+		op.set_search_mode( 	C_INTEGRODIFF_COARSE_TO_FINE,
+								C_INTEGRODIFF_COARSE_STEP,
+								C_INTEGRODIFF_NB_CANDIDATES,
+								n == 3,
+								n >= 2 );
+}
+
+/**
+ * argv[1] : rayon min.
+ * argv[2] : rayon max.
+ * argv[3] : nombre de centres par axe ( grille n x n sur la moitié centrale de l'image )
+ * argv[4] : nombre de threads
+ * argv[5...] : images d'oeil ( niveaux de gris )
+ * Compare la recherche C_INTEGRODIFF_COARSE_TO_FINE de c_integro_differential_operator
+ * à la recherche exhaustive. Pour chaque mode, affiche le taux d'accord ( même cercle
+ * que la recherche exhaustive ; à un pas de grille près pour l'optimisation continue ),
+ * l'écart moyen du centre, le nombre moyen de transformées polaires ( nb_evaluations,
+ * dont nb_coarse_evaluations sur l'image réduite ) et le temps moyen.
+ **/
+int main ( int argc, char ** argv )
+{
+	if ( argc < 6 )
+	{
+		cout << "Error : missing argument(s)" << endl;
+		cout << "Usage : " << argv[0] << " r_min r_max n nb_threads image_1 [image_2 ...]" << endl;
+		return 1;
+	}
+	double 	r_min = atof( argv[1] ),
+			r_max = atof( argv[2] );
+	unsigned int 	n = atoi( argv[3] ),
+					nb_threads = atoi( argv[4] );
+	if ( r_min >= r_max || n < 2 )
+	{
+		cout << "Error : invalid argument(s)" << endl;
+		return 1;
+	}
+	const char * names[BENCH_INTEGRO_NB_MODES] = { 	"exhaustive",
+													"coarse-to-fine",
+													"coarse-to-fine, downsampled",
+													"coarse-to-fine, downsampled + continuous" };
+	unsigned int 	nb_images = 0,
+					nb_agree[BENCH_INTEGRO_NB_MODES] = { 0 };
+	double 	nb_evaluations[BENCH_INTEGRO_NB_MODES] = { 0 },
+			nb_coarse_evaluations[BENCH_INTEGRO_NB_MODES] = { 0 },
+			times[BENCH_INTEGRO_NB_MODES] = { 0 },
+			distances[BENCH_INTEGRO_NB_MODES] = { 0 };
+
+	for ( int k = 5; k < argc; ++ k )
+	{
+		IplImage * image = cvLoadImage( argv[k], CV_LOAD_IMAGE_GRAYSCALE );
+		if ( ! image )
+		{
+			cout << "Error : can't open " << argv[k] << endl;
+			continue;
+		}
+		IplImage * mask = cvCreateImage( cvGetSize( image ), IPL_DEPTH_8U, 1 );
+		memset( mask->imageData, 255, mask->widthStep * mask->height );
+
+		c_integro_differential_operator op( 	image->width,
+												image->height,
+												BENCH_INTEGRO_NB_DIRECTIONS,
+												BENCH_INTEGRO_NB_SAMPLES,
+												BENCH_INTEGRO_KERNEL_SIZE );
+		if ( op.set_nb_threads( nb_threads ) )
+			cout << "Warning : " << op.nb_threads() << " thread(s)" << endl;
+
+		//Moitié centrale de l'image
+		double 	x_min = image->width / 4.0,
+				x_max = 3 * image->width / 4.0,
+				y_min = image->height / 4.0,
+				y_max = 3 * image->height / 4.0,
+				step = max( ( x_max - x_min ), ( y_max - y_min ) ) / ( n - 1 ),
+				x_0 = 0,
+				y_0 = 0,
+				r_0 = 0;
+		cout << argv[k];
+		for ( unsigned int m = 0; m < BENCH_INTEGRO_NB_MODES; ++ m )
+		{
+			set_mode( op, m );
+			double t = get_time();
+			op.search_best_circle_params( image, mask, x_min, x_max, n, y_min, y_max, n, r_min, r_max );
+			times[m] += get_time() - t;
+			nb_evaluations[m] += op.nb_evaluations();
+			nb_coarse_evaluations[m] += op.nb_coarse_evaluations();
+			if ( m == 0 )
+			{
+				x_0 = op.x();
+				y_0 = op.y();
+				r_0 = op.r();
+			}
+			double d = sqrt( ( op.x() - x_0 ) * ( op.x() - x_0 ) + ( op.y() - y_0 ) * ( op.y() - y_0 ) );
+			distances[m] += d;
+			if ( ( m < 3 && op.x() == x_0 && op.y() == y_0 && op.r() == r_0 ) ||
+				 ( m == 3 && d <= step && fabs( op.r() - r_0 ) <= ( r_max - r_min ) / ( BENCH_INTEGRO_NB_SAMPLES - 1 ) ) )
+				++ nb_agree[m];
+			cout << "\t" << op.x() << " " << op.y() << " " << op.r();
+		}
+		cout << endl;
+		++ nb_images;
+		cvReleaseImage( &mask );
+		cvReleaseImage( &image );
+	}
+	if ( ! nb_images )
+		return 1;
+
+	cout << "Images : " << nb_images << endl;
+	cout << "mode\tagreement (%)\tmean center offset (px)\tnb_evaluations\tnb_coarse_evaluations\ttime (s)" << endl;
+	for ( unsigned int m = 0; m < BENCH_INTEGRO_NB_MODES; ++ m )
+		cout << 	names[m] << "\t" <<
+					100.0 * nb_agree[m] / nb_images << "\t" <<
+					distances[m] / nb_images << "\t" <<
+					nb_evaluations[m] / nb_images << "\t" <<
+					nb_coarse_evaluations[m] / nb_images << "\t" <<
+					times[m] / nb_images << endl;
+	return 0;
+}
@@ -0,0 +1,115 @@
+#include "lib_iris.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+using namespace std;
+
+/**
+ * argv[1] : rayon min.
+ * argv[2] : rayon max.
+ * argv[3] : nombre de rayons
+ * argv[4] : nombre de directions
+ * argv[5] : nombre de centres par image
+ * argv[6...] : images ( niveaux de gris )
+ * Compare c_polar_table::compute à c_polar::compute ( image_2_polar ), et à
+ * c_polar::compute + c_polar::resize ( ancienne transformée de c_integro_differential_operator ).
+ * Les centres sont tirés au hasard ( parties fractionnaires quelconques ), y compris
+ * hors de l'image. Masque : pixels non saturés ( < 255 ).
+ * Affiche le nombre d'échantillons différents ( valeur ou masque ) et l'écart max.
+ **/
+int main ( int argc, char ** argv )
+{
+	if ( argc < 7 )
+	{
+		cout << "Error : missing argument(s)" << endl;
+		cout << "Usage : " << argv[0] << " r_min r_max nb_radii nb_directions nb_centers image_1 [image_2 ...]" << endl;
+		return 1;
+	}
+	unsigned int 	r_min = atoi( argv[1] ),
+					r_max = atoi( argv[2] ),
+					nb_radii = atoi( argv[3] ),
+					nb_dir = atoi( argv[4] ),
+					nb_centers = atoi( argv[5] );
+	if ( r_min >= r_max || ! nb_radii || ! nb_dir || ! nb_centers )
+	{
+		cout << "Error : invalid argument(s)" << endl;
+		return 1;
+	}
+
+	c_polar polar( nb_radii, nb_dir );
+	c_polar_table table;
+	table.setup( nb_radii, nb_dir, r_min, r_max );
+	double * table_data = new double[ nb_radii * nb_dir ],
+		   * resized_data = new double[ nb_radii * nb_dir ];
+	unsigned char 	* table_mask = new unsigned char[ nb_radii * nb_dir ],
+					* resized_mask = new unsigned char[ nb_radii * nb_dir ];
+
+	unsigned long long 	nb_samples = 0,
+						nb_diff = 0,
+						nb_diff_resize = 0;
+	double 	max_diff = 0,
+			max_diff_resize = 0;
+	srand( 0 );
+	for ( int k = 6; k < argc; ++ k )
+	{
+		IplImage * image = cvLoadImage( argv[k], CV_LOAD_IMAGE_GRAYSCALE );
+		if ( ! image )
+		{
+			cout << "Error : can't open " << argv[k] << endl;
+			continue;
+		}
+		unsigned int 	width = image->width,
+						height = image->height,
+						width_step = image->widthStep;
+		const unsigned char * data = (const unsigned char *) image->imageData;
+		unsigned char * mask = new unsigned char[ width * height ];
+		for ( unsigned int i = 0; i < height; ++ i )
+			for ( unsigned int j = 0; j < width; ++ j )
+				mask[ i * width + j ] = ( data[ i * width_step + j ] < 255 ) ? 255 : 0;
+
+		for ( unsigned int c = 0; c < nb_centers; ++ c )
+		{
+			//Centre dans l'image agrandie de r_max de chaque côté
+			double 	x = ( (double) rand() / RAND_MAX ) * ( width + 2.0 * r_max ) - r_max,
+					y = ( (double) rand() / RAND_MAX ) * ( height + 2.0 * r_max ) - r_max;
+			polar.compute( x, y, nb_radii, nb_dir, r_min, r_max, data, mask, width, height, width_step, width );
+			polar.resize( resized_data, resized_mask, nb_radii, nb_dir, nb_dir, nb_dir );
+			table.compute( table_data, table_mask, nb_dir, nb_dir, x, y, data, mask, width, height, width_step, width );
+
+			const double * polar_data = polar.image_data();
+			const unsigned char * polar_mask = polar.image_mask();
+			for ( unsigned int i = 0; i < nb_radii; ++ i )
+			{
+				for ( unsigned int j = 0; j < nb_dir; ++ j )
+				{
+					double 	v = table_data[ i * nb_dir + j ],
+							v_polar = polar_data[ i * polar.image_width_step() + j ],
+							v_resized = resized_data[ i * nb_dir + j ];
+					unsigned char 	m = table_mask[ i * nb_dir + j ],
+									m_polar = polar_mask[ i * polar.mask_width_step() + j ],
+									m_resized = resized_mask[ i * nb_dir + j ];
+					if ( v != v_polar || m != m_polar )
+						++ nb_diff;
+					if ( v != v_resized || m != m_resized )
+						++ nb_diff_resize;
+					max_diff = max( max_diff, fabs( v - v_polar ) );
+					max_diff_resize = max( max_diff_resize, fabs( v - v_resized ) );
+					++ nb_samples;
+				}
+			}
+		}
+		delete[] mask;
+		cvReleaseImage( &image );
+	}
+	delete[] table_data;
+	delete[] resized_data;
+	delete[] table_mask;
+	delete[] resized_mask;
+	if ( ! nb_samples )
+		return 1;
+
+	cout << "Samples : " << nb_samples << endl;
+	cout << "c_polar::compute : " << nb_diff << " different samples, max. difference " << max_diff << endl;
+	cout << "c_polar::compute + resize : " << nb_diff_resize << " different samples, max. difference " << max_diff_resize << endl;
+	return ( nb_diff || nb_diff_resize ) ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+#include "lib_iris.hpp"
+#include <iostream>
+#include <ctime>
+#include <cstdlib>
+#include <cmath>
+using namespace std;
+
+//Moteurs comparés à RADON_SCATTER ( RADON_GATHER avec chaque noyau, RADON_FFT )
+#define CHECK_RADON_NB_MODES 4
+
+/**@fn
+ * @brief
+ * Temps écoulé (horloge monotone) en secondes.
+ **/
+static double get_time( void )
+{
+	struct timespec t;
+	clock_gettime( CLOCK_MONOTONIC, &t );
+	return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/**
+ * argv[1] : nombre d'angles
+ * argv[2] : nombre de threads ( RADON_GATHER et RADON_FFT )
+ * argv[3...] : images ( niveaux de gris )
+ * Compare les moteurs RADON_GATHER ( noyaux scalaire, SSE2 et AVX2 ) et RADON_FFT de
+ * c_radon au moteur RADON_SCATTER ( noyaux non supportés par le processeur : ignorés ).
+ * Pour chaque image et chaque moteur, affiche l'erreur max. ( absolue et relative au
+ * maximum de RADON_SCATTER ), l'erreur L2 relative, l'accord du maximum ( search_max )
+ * et le temps, puis les erreurs max. et les moyennes sur toutes les images.
+ **/
+int main ( int argc, char ** argv )
+{
+	if ( argc < 4 )
+	{
+		cout << "Error : missing argument(s)" << endl;
+		cout << "Usage : " << argv[0] << " nb_thetas nb_threads image_1 [image_2 ...]" << endl;
+		return 1;
+	}
+	unsigned int 	nb_thetas = atoi( argv[1] ),
+					nb_threads = atoi( argv[2] );
+	if ( ! nb_thetas )
+	{
+		cout << "Error : invalid argument(s)" << endl;
+		return 1;
+	}
+	const char * names[CHECK_RADON_NB_MODES] = { "RADON_GATHER (scalar)", "RADON_GATHER (SSE2)", "RADON_GATHER (AVX2)", "RADON_FFT" };
+	int modes[CHECK_RADON_NB_MODES] = { RADON_GATHER, RADON_GATHER, RADON_GATHER, RADON_FFT },
+		kernels[CHECK_RADON_NB_MODES] = { RADON_KERNEL_SCALAR, RADON_KERNEL_SSE2, RADON_KERNEL_AVX2, RADON_KERNEL_AUTO };
+	unsigned int 	nb_images = 0,
+					nb_runs[CHECK_RADON_NB_MODES] = { 0 },
+					nb_agree[CHECK_RADON_NB_MODES] = { 0 };
+	double 	max_errors[CHECK_RADON_NB_MODES] = { 0 },
+			max_rel_errors[CHECK_RADON_NB_MODES] = { 0 },
+			max_l2_errors[CHECK_RADON_NB_MODES] = { 0 },
+			l2_errors[CHECK_RADON_NB_MODES] = { 0 },
+			times[CHECK_RADON_NB_MODES] = { 0 },
+			time_scatter = 0;
+
+	cout << "image\tengine\tmax. error\tmax. error / max.\trelative L2 error\tsame max.\ttime (s)" << endl;
+	for ( int k = 3; k < argc; ++ k )
+	{
+		IplImage * image = cvLoadImage( argv[k], CV_LOAD_IMAGE_GRAYSCALE );
+		if ( ! image )
+		{
+			cout << "Error : can't open " << argv[k] << endl;
+			continue;
+		}
+		unsigned int r_size = (unsigned int) sqrt( (double) image->width * image->width + image->height * image->height ) + 1;
+		c_radon scatter( r_size, nb_thetas );
+		double t = get_time();
+		if ( scatter.compute_transform( image, nb_thetas ) )
+		{
+			cvReleaseImage( &image );
+			continue;
+		}
+		time_scatter += get_time() - t;
+		double r_0, theta_0;
+		scatter.search_max( r_0, theta_0 );
+		const double * ref = scatter.radon_transform();
+		unsigned int ref_step = scatter.width_step();
+		double ref_max = 0;
+		for ( unsigned int r = 0; r <= 2 * scatter.r_size(); ++ r )
+			for ( unsigned int i = 0; i < nb_thetas; ++ i )
+				ref_max = max( ref_max, fabs( ref[ r * ref_step + i ] ) );
+
+		for ( unsigned int m = 0; m < CHECK_RADON_NB_MODES; ++ m )
+		{
+			if ( ! c_radon::gather_kernel_supported( kernels[m] ) )
+				continue;
+			c_radon radon( r_size, nb_thetas );
+			radon.set_mode( modes[m] );
+			radon.set_gather_kernel( kernels[m] );
+			if ( radon.set_nb_threads( nb_threads ) )
+				cout << "Warning : " << radon.nb_threads() << " thread(s)" << endl;
+			t = get_time();
+			if ( radon.compute_transform( image, nb_thetas ) )
+				continue;
+			double dt = get_time() - t;
+			const double * data = radon.radon_transform();
+			unsigned int step = radon.width_step();
+			double 	max_error = 0,
+					num = 0,
+					den = 0;
+			for ( unsigned int r = 0; r <= 2 * scatter.r_size(); ++ r )
+			{
+				for ( unsigned int i = 0; i < nb_thetas; ++ i )
+				{
+					double 	v_ref = ref[ r * ref_step + i ],
+							d = data[ r * step + i ] - v_ref;
+					max_error = max( max_error, fabs( d ) );
+					num += d * d;
+					den += v_ref * v_ref;
+				}
+			}
+			double 	rel_error = ( ref_max > 0 ) ? max_error / ref_max : 0,
+					l2_error = ( den > 0 ) ? sqrt( num / den ) : sqrt( num ),
+					r_1,
+					theta_1;
+			radon.search_max( r_1, theta_1 );
+			bool agree = ( r_1 == r_0 && theta_1 == theta_0 );
+			max_errors[m] = max( max_errors[m], max_error );
+			max_rel_errors[m] = max( max_rel_errors[m], rel_error );
+			max_l2_errors[m] = max( max_l2_errors[m], l2_error );
+			l2_errors[m] += l2_error;
+			times[m] += dt;
+			++ nb_runs[m];
+			if ( agree )
+				++ nb_agree[m];
+			cout << 	argv[k] << "\t" << names[m] << "\t" <<
+						max_error << "\t" <<
+						rel_error << "\t" <<
+						l2_error << "\t" <<
+						( agree ? "yes" : "no" ) << "\t" <<
+						dt << endl;
+		}
+		++ nb_images;
+		cvReleaseImage( &image );
+	}
+	if ( ! nb_images )
+		return 1;
+
+	cout << "Images : " << nb_images << ", mean time RADON_SCATTER : " << time_scatter / nb_images << " s" << endl;
+	cout << "engine\tmax. error\tmax. error / max.\tmax. relative L2 error\tmean relative L2 error\tsame max. (%)\tmean time (s)" << endl;
+	for ( unsigned int m = 0; m < CHECK_RADON_NB_MODES; ++ m )
+	{
+		if ( ! nb_runs[m] )
+		{
+			cout << names[m] << "\tnot supported" << endl;
+			continue;
+		}
+		cout << 	names[m] << "\t" <<
+					max_errors[m] << "\t" <<
+					max_rel_errors[m] << "\t" <<
+					max_l2_errors[m] << "\t" <<
+					l2_errors[m] / nb_runs[m] << "\t" <<
+					100.0 * nb_agree[m] / nb_runs[m] << "\t" <<
+					times[m] / nb_runs[m] << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,177 @@
+#include "lib_iris.hpp"
+#include <iostream>
+#include <ctime>
+#include <cstdlib>
+using namespace std;
+
+//Distances disponibles pour matching_top_k ( pas E(Hamming) )
+#define CHECK_TOP_K_NB_DISTANCES 3
+
+/**@fn
+ * @brief
+ * Temps écoulé (horloge monotone) en secondes.
+ **/
+static double get_time( void )
+{
+	struct timespec t;
+	clock_gettime( CLOCK_MONOTONIC, &t );
+	return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/**
+ * argv[1] : répertoire de la base de données ( ou fichier de galerie )
+ * argv[2] : fichier de paramètres ( matching.cfg )
+ * argv[3] : nombre de résultats k ( optionnel, 10 par défaut )
+ * argv[4] : nombre de rotations de la banque ( optionnel, 8 par défaut )
+ * Compare matching_top_k( k ) aux k premières distances triées de matching_opt pour
+ * Hamming, FBD et Hamming_FBD ( matching::alpha, 0.5 par défaut ), sans puis avec la
+ * banque de rotations. Chaque iris code de la base est cherché dans toute la base.
+ * Affiche le nombre de requêtes dont les distances diffèrent, le nombre de rotations
+ * comparées et abandonnées avant la dernière ligne, et le temps de chaque recherche.
+ **/
+int main ( int argc, char ** argv )
+{
+	if ( argc < 3 )
+	{
+		cout << "Error : missing argument(s)" << endl;
+		cout << "Usage : " << argv[0] << " database_dir params.cfg [k] [nb_rotations]" << endl;
+		return 1;
+	}
+	unsigned int 	k = 10,
+					nb_rotations = 8;
+	if ( argc > 3 )
+		k = atoi( argv[3] );
+	if ( argc > 4 )
+		nb_rotations = atoi( argv[4] );
+	if ( k == 0 )
+	{
+		cout << "Error : invalid argument(s)" << endl;
+		return 1;
+	}
+
+	api_parameters params;
+	params.load( argv[2] );
+	string 	iris_code_fn,
+			fragility_map_fn;
+	unsigned int nb_fused_images;
+	double 	fbr,
+			d_theta,
+			alpha;
+	if ( 	api_get_string( params, "matching::iris_code_filename", &iris_code_fn, &cout ) 			||
+			api_get_string( params, "matching::fragility_map_filename", &fragility_map_fn, &cout ) 	||
+			api_get_double( params, "matching::d_theta", &d_theta, &cout ) 							)
+		return 1;
+	if ( api_get_positive_integer( params, "matching::nb_fused_images", &nb_fused_images ) )
+		nb_fused_images = 0;
+	if ( api_get_double( params, "matching::FBR_min", &fbr ) )
+		fbr = 0;
+	if ( api_get_double( params, "matching::alpha", &alpha ) )
+		alpha = 0.5;
+
+	//Noms des fichiers ( cf. c_recognition )
+	stringstream oss, oss2;
+	if ( nb_fused_images != 0 )
+	{
+		oss << iris_code_fn << "_" << nb_fused_images << ".png";
+		oss2 << fragility_map_fn << "_" << nb_fused_images << ".png";
+	}
+	else
+	{
+		oss << iris_code_fn << ".png";
+		oss2 << fragility_map_fn << ".png";
+	}
+
+	const char * names[CHECK_TOP_K_NB_DISTANCES] = { "Hamming", "FBD", "Hamming_FBD" };
+	distance::function_prototype_bis dists[CHECK_TOP_K_NB_DISTANCES] = {
+		(distance::function_prototype_bis) distance::Hamming,
+		(distance::function_prototype_bis) distance::fragile_bit_distance,
+		(distance::function_prototype_bis) distance::Hamming_FBD };
+	int q = 0;
+	cout << "distance\tbank\tqueries\tmismatches\tcomparisons\taborted\taborted (%)\tmatching_opt (s)\tmatching_top_k (s)" << endl;
+	for ( unsigned int m = 0; m < CHECK_TOP_K_NB_DISTANCES; ++ m )
+	{
+		c_matching matching;
+		if ( matching.setup(	argv[1],
+								oss.str().c_str(),
+								oss2.str().c_str(),
+								dists[m],
+								d_theta,
+								&cout ) )
+			return 1;
+		matching.set_alpha( alpha );
+		matching.compute_fragile_bit_threshold( fbr );
+
+		unsigned int 	nb_classes = matching.nb_classes(),
+						truth;
+		double 	* distances = new double[ nb_classes ],
+				* top_distances = new double[ k ];
+		unsigned int 	* orders = new unsigned int[ nb_classes ],
+						* ids = new unsigned int[ k ];
+		for ( unsigned int b = 0; b < 2; ++ b )
+		{
+			if ( matching.set_rotation_bank( b ? nb_rotations : 0 ) )
+			{
+				cout << "Error : can't set the rotation bank" << endl;
+				q = 1;
+				continue;
+			}
+			unsigned int 	nb_queries = 0,
+							nb_mismatches = 0;
+			unsigned long long 	nb_comparisons = 0,
+								nb_aborted = 0;
+			double 	t_opt = 0,
+					t_top_k = 0;
+			for ( unsigned int i = 0; i < nb_classes; ++ i )
+			{
+				if ( ! matching.iris_code_bis( i ) )
+					continue;
+				double t = get_time();
+				matching.matching_opt(	distances,
+										orders,
+										truth,
+										matching.iris_code_bis( i ),
+										matching.mask( i ),
+										matching.fragile_bits( i ),
+										matching.class_name( i ) );
+				t_opt += get_time() - t;
+				t = get_time();
+				unsigned int n = matching.matching_top_k(	top_distances,
+															ids,
+															k,
+															matching.iris_code_bis( i ),
+															matching.mask( i ),
+															matching.fragile_bits( i ) );
+				t_top_k += get_time() - t;
+				nb_comparisons += matching.nb_top_k_comparisons();
+				nb_aborted += matching.nb_top_k_aborted();
+
+				//k premières distances de matching_opt ( sans les classes non comparées )
+				unsigned int n_opt = 0;
+				while ( n_opt < k && n_opt < nb_classes && distances[ orders[n_opt] ] < 2 )
+					++ n_opt;
+				bool same = ( n == n_opt );
+				for ( unsigned int j = 0; same && j < n; ++ j )
+					same = ( top_distances[j] == distances[ orders[j] ] );
+				if ( ! same )
+					++ nb_mismatches;
+				++ nb_queries;
+			}
+			if ( nb_mismatches )
+				q = 1;
+			cout << 	names[m] << "\t" <<
+						( b ? nb_rotations : 0 ) << "\t" <<
+						nb_queries << "\t" <<
+						nb_mismatches << "\t" <<
+						nb_comparisons << "\t" <<
+						nb_aborted << "\t" <<
+						( nb_comparisons ? 100.0 * nb_aborted / nb_comparisons : 0 ) << "\t" <<
+						t_opt << "\t" <<
+						t_top_k << endl;
+		}
+		delete[] distances;
+		delete[] top_distances;
+		delete[] orders;
+		delete[] ids;
+	}
+	return q;
+}
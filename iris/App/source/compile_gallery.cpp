@@ -0,0 +1,67 @@
+#include "lib_iris.hpp"
+
+/**
+ * argv[1] : répertoire de la base de données
+ * argv[2] : fichier de galerie créé
+ * argv[3...] : fichiers de paramètres ( matching.cfg )
+ * Compile la base dans un fichier de galerie projetable en mémoire
+ * ( cf. gallery_file.hpp ). Le fichier remplace ensuite le répertoire
+ * de la base dans les arguments de matching.run.
+ * Les iris codes binaires sont stockés pour le taux de bits fragiles
+ * matching::FBR_min ( 0 par défaut ) ; les autres taux sont recalculés
+ * au chargement à partir des images stockées.
+ **/
+int main ( int argc, char ** argv )
+{
+	if ( argc < 4 )
+	{
+		cout << "Error : missing argument(s)" << endl;
+		cout << "Usage : " << argv[0] << " database_dir gallery_file params.cfg ..." << endl;
+		return 1;
+	}
+
+	api_parameters params;
+	for ( int i = 3; i < argc; ++ i )
+		params.load( argv[i] );
+
+	string 	iris_code_fn,
+			fragility_map_fn;
+	unsigned int nb_fused_images;
+	double fbr;
+	if ( 	api_get_string( params, "matching::iris_code_filename", &iris_code_fn, &cout ) 			||
+			api_get_string( params, "matching::fragility_map_filename", &fragility_map_fn, &cout ) 	)
+		return 1;
+	if ( api_get_positive_integer( params, "matching::nb_fused_images", &nb_fused_images ) )
+		nb_fused_images = 0;
+	if ( api_get_double( params, "matching::FBR_min", &fbr ) )
+		fbr = 0;
+
+	//Noms des fichiers ( cf. c_recognition )
+	stringstream oss, oss2;
+	if ( nb_fused_images != 0 )
+	{
+		oss << iris_code_fn << "_" << nb_fused_images << ".png";
+		oss2 << fragility_map_fn << "_" << nb_fused_images << ".png";
+	}
+	else
+	{
+		oss << iris_code_fn << ".png";
+		oss2 << fragility_map_fn << ".png";
+	}
+
+	c_database database;
+	if ( database.setup( 	argv[1],
+							oss.str().c_str(),
+							oss2.str().c_str(),
+							&cout ) )
+		return 1;
+
+	if ( database.save(	argv[2],
+						fbr,
+						oss.str().c_str(),
+						oss2.str().c_str() ) )
+		return 1;
+
+	cout << database.nb_classes() << " iris codes saved in " << argv[2] << endl;
+	return 0;
+}
@@ -3,7 +3,7 @@
 #include <ctime>
 int main( int argc, char ** argv )
 {
-	c_get_iris_template_pthread obj;
+	c_video_scheduler scheduler;
 	int end = 0;
 	if ( argc == 1 )
 	{
@@ -19,6 +19,7 @@ int main( int argc, char ** argv )
 		cout << "argv[2] : Save directory " << endl;
 		cout << "Author: Valérian Némesin." << endl;
 		unsigned int id = 3;
+		c_get_iris_template_pthread obj;
 		id = obj.help( cout, id );
 		return 0; 
 	}	
@@ -31,13 +32,13 @@ int main( int argc, char ** argv )
 	
 
 	
-	if ( obj.setup( argc - 3, argv + 3, argv[2], &cout, true ) )
-		return 1;
-		
-
 	//Création du rép. de sauvegarde
 	mkdir ( argv[2],
 			014777 );
+
+	//Vidéos traitées simultanément ( buffer::nb_videos )
+	if ( scheduler.setup( argc - 3, argv + 3, argv[2], &cout ) )
+		return 1;
 	
 	//Chargement des paramères
 	api_parameters params;
@@ -56,16 +57,6 @@ int main( int argc, char ** argv )
 		return 1;
 	}
 	
-	unsigned int nb_videos = 0, n_video = 0;
-	while ( ( ent = readdir( dir ) ) != NULL )
-	{
-		stringstream oss;
-		oss << argv[1] << "/" << ent->d_name;
-		if ( strcmp( ent->d_name, ".." ) && strcmp( ent->d_name, "." ) )
-			nb_videos ++;
-	}
-	closedir(dir);
-	dir = opendir( argv[1] );
 	while ( ( ent = readdir( dir ) ) != NULL )
 	{
 
@@ -74,10 +65,6 @@ int main( int argc, char ** argv )
 		oss << argv[1] << "/" << ent->d_name;
 		if ( strcmp( ent->d_name, ".." ) && strcmp( ent->d_name, "." ) )
 		{
-			n_video ++;
-			system("clear");
-			cout << "( " << n_video << " / " << nb_videos << " )" << endl; 
-			
 			api_parameters params;
 			if ( ! params.load( oss.str().c_str() ))
 			{
@@ -86,7 +73,6 @@ int main( int argc, char ** argv )
 				if (	! api_get_string( params, "type", &type, &cout ) &&
 						! api_get_string( params, "path", &path, &cout )	)
 				{
-					obj.test();
 					//Récupération du dossier
 					char * buffer = NULL;
 					//Détection du dernier / dans path
@@ -114,21 +100,15 @@ int main( int argc, char ** argv )
 						mkdir ( oss2.str().c_str(),
 									014777 );
 						oss2.str("");		
-						oss2 << argv[2] << "/" << type << '_' << buffer << "/log.txt";			
-						ofstream log_file(oss2.str().c_str());
-						obj.set_error_stream(log_file);		
-						oss2.str("");
-						
+						string save_dir = oss2.str();
+						oss2 << "/log.txt";
 						
-						
-						
-						//Segmentation
-						while ( obj.run( path.c_str(), end ) );
-						oss2 << argv[2] << "/" << type << '_' << buffer;
-						obj.save( oss2.str().c_str() );
+						//Segmentation ( cf. scheduler.run )
+						scheduler.add_job( 	path.c_str(),
+											save_dir.c_str(),
+											oss2.str().c_str() );
 						oss2.str("");	
 						delete[] buffer;
-						log_file.close();
 					}
 					
 					
@@ -139,5 +119,10 @@ int main( int argc, char ** argv )
 		}
 	}
 	closedir(dir);
+	
+	//Traitement des vidéos
+	cout << scheduler.nb_jobs() << " videos, " << scheduler.nb_videos() << " at a time" << endl;
+	if ( scheduler.run( end ) )
+		cout << "Error: some videos failed (see log.txt)" << endl;
 	return 0;
 }
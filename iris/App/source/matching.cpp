@@ -23,6 +23,7 @@ struct matching_parameters
 		fbr_max = 0;
 		nb_process = 1;
 		nb_fbr = 0;
+		sweep_memory = 1024;
 	} 
 	
 	
@@ -89,6 +90,15 @@ struct matching_parameters
 			nb_process = 1;
 		}
 		oss.str("");
+		
+		//Mémoire de la grille ( Mo )
+		oss << name_space << "::sweep_memory";
+		if ( api_get_positive_integer (	params, 
+										oss.str().c_str(), 
+										&sweep_memory,
+										NULL ) )
+			sweep_memory = 1024;
+		oss.str("");
 	
 		
 		
@@ -184,6 +194,30 @@ struct matching_parameters
 	unsigned int nb_fbr;
 	
 	unsigned int nb_process;
+	
+	unsigned int sweep_memory;
+	
+	/**@fn
+	 * @brief
+	 * Taux de bits fragiles n°k de la grille.
+	 **/
+	double get_fbr( unsigned int k ) const
+	{
+		if ( nb_fbr > 1 )
+			return k * ( ( fbr_max - fbr_min ) / ( nb_fbr - 1.0 ) ) + fbr_min;
+		return fbr_min;
+	}
+	
+	/**@fn
+	 * @brief
+	 * Alpha n°a de la grille.
+	 **/
+	double get_alpha( unsigned int a ) const
+	{
+		if ( nb_alpha > 1 )
+			return a * ( ( alpha_max - alpha_min ) / ( nb_alpha - 1.0 ) ) + alpha_min;
+		return alpha_min;
+	}
 };
 
 struct matching_process
@@ -236,18 +270,8 @@ struct matching_process
 		if ( i == params->nb_fbr * params->nb_alpha )
 			return 1;
 		(*r_id) ++;
-		double fbr,
-			   alpha;
-			   
-		if ( params->nb_fbr > 1 )
-			fbr = ( i % params->nb_fbr ) * ( ( params->fbr_max - params->fbr_min ) / ( params->nb_fbr - 1.0 ) ) + params->fbr_min;
-		else
-			fbr = params->fbr_min;
-		
-		if ( params->nb_alpha > 1 )
-			alpha = ( i / params->nb_fbr ) * ( ( params->alpha_max - params->alpha_min ) / ( params->nb_alpha - 1.0 ) ) + params->alpha_min;
-		else
-			alpha = params->alpha_min;	
+		double 	fbr = params->get_fbr( i % params->nb_fbr ),
+				alpha = params->get_alpha( i / params->nb_fbr );
 		
 		cout << "Job lauched for " << endl;
 		cout << "Distance = " << params->distance << endl;
@@ -259,13 +283,70 @@ struct matching_process
 		if ( obj->match( fbr, alpha ) )
 			return 1;
 		
+		save( fbr, alpha );
+		return 0;
+		
+	}
+	
+	/**@fn
+	 * @brief
+	 * Traitement de toute la grille ( FBR, alpha ) par c_recognition::match_sweep :
+	 * les taux sont traités par groupes tenant dans matching::sweep_memory Mo.
+	 * 
+	 */
+	int sweep( )
+	{
+		double 	* fbr = new double[ params->nb_fbr ],
+				* alpha = new double[ params->nb_alpha ];
+		for ( unsigned int k = 0; k < params->nb_fbr; ++ k )
+			fbr[k] = params->get_fbr( k );
+		for ( unsigned int a = 0; a < params->nb_alpha; ++ a )
+			alpha[a] = params->get_alpha( a );
+		
+		unsigned int nb_group = ( ( (size_t) params->sweep_memory ) << 20 ) / obj->sweep_memory( 1, params->nb_alpha );
+		if ( nb_group == 0 )
+			nb_group = 1;
+		
+		int q = 0;
+		for ( unsigned int k0 = 0; k0 < params->nb_fbr && ! q; k0 += nb_group )
+		{
+			unsigned int nb = ( nb_group < params->nb_fbr - k0 ) ? nb_group : params->nb_fbr - k0;
+			cout << "Sweep lauched for " << endl;
+			cout << "Distance = " << params->distance << endl;
+			cout << "FBR = " << fbr[k0] << " ... " << fbr[k0 + nb - 1] << endl;
+			cout << "Alpha = " << alpha[0] << " ... " << alpha[params->nb_alpha - 1] << endl;
+			if ( obj->match_sweep( fbr + k0, nb, alpha, params->nb_alpha ) )
+			{
+				q = 1;
+				break;
+			}
+			for ( unsigned int k = 0; k < nb; ++ k )
+			{
+				for ( unsigned int a = 0; a < params->nb_alpha; ++ a )
+				{
+					obj->select_sweep( k, a );
+					save( fbr[k0 + k], alpha[a] );
+				}
+			}
+		}
+		delete[] fbr;
+		delete[] alpha;
+		return q;
+	}
+	
+	/**@fn
+	 * @brief
+	 * Sauvegarde des résultats d'un point de la grille.
+	 * 
+	 */
+	void save( 	double fbr,
+				double alpha )
+	{
 		stringstream oss;
 		oss << rep << "/" << "Distance=" << params->distance << "&Alpha=" << alpha << "&FBR=" << fbr;
 		mkdir( oss.str().c_str(), 014777 );
 		obj->save(oss.str().c_str());
 		oss.str("");
-		return 0;
-		
 	}
 	
 	~matching_process()
@@ -322,7 +403,21 @@ int main( int argc, char ** argv )
 	//Construction des différents process
 	unsigned int id = 0;
 	matching_process * m_process = new matching_process[m_params.nb_process];
-	for ( unsigned int i = 0; i < m_params.nb_process; ++ i )
+	if ( m_process[0].setup( &m_params, id, argc, argv ) )
+	{
+		delete[] m_process;
+		return 1;
+	}
+	
+	//Distances binaires : toute la grille en un seul passage
+	if ( m_process[0].obj->use_fbr() )
+	{
+		int q = m_process[0].sweep();
+		delete[] m_process;
+		return q;
+	}
+	
+	for ( unsigned int i = 1; i < m_params.nb_process; ++ i )
 	{
 		if ( m_process[i].setup( &m_params, id, argc, argv ) )
 		{
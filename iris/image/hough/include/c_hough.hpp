@@ -4,12 +4,41 @@
 #ifndef _C_HOUGH_HPP_
 	#define _C_HOUGH_HPP_
 	#include <opencv/cv.h>
+	#include "../../utilities/lib_utilities.hpp"
+	#include <vector>
 	using namespace std;
 	
+	//Modes de vote
+	#define HOUGH_DENSE 0 // Cercle complet pour chaque pixel de contour ( setup )
+	#define HOUGH_GRADIENT 1 // Vote le long du gradient ( setup_gradient )
+	
+	//Sens du vote le long du gradient
+	#define HOUGH_VOTE_BOTH 0 // Des deux côtés du contour
+	#define HOUGH_VOTE_DARK_CENTER 1 // Disque plus sombre que le fond ( pupille )
+	#define HOUGH_VOTE_BRIGHT_CENTER 2 // Disque plus clair que le fond
+	
+	//Tâches des threads
+	#define HOUGH_TASK_VOTE 0
+	#define HOUGH_TASK_BEST 1
+	
 	/**@class
 	 * @brief
 	 * Cette classe permet de gérer la transformée de Hough pour un cercle.
 	 * 
+	 * Mode HOUGH_DENSE : accumulateur ( width + 2 r_max ) x ( height + 2 r_max ) x r_max
+	 * ( unsigned int ), chaque pixel de contour ajoute un cercle entier par rayon.
+	 * Mode HOUGH_GRADIENT : chaque pixel de contour vote seulement le long de la normale
+	 * au contour ( direction du gradient ), un vote par rayon et par sens ; l'accumulateur
+	 * ( unsigned short, saturé ) est limité aux centres dans l'image et aux rayons
+	 * [r_min, r_max]. get_best_circle y somme les votes sur 3 x 3 centres.
+	 * c_hough n'est pas utilisée par la segmentation ( iris/ ) : setup_gradient
+	 * n'est accessible que par l'API, aucun paramètre .cfg ne choisit le mode.
+	 * 
+	 * Avec set_nb_threads, les votes ( mode HOUGH_DENSE ) et la recherche du maximum
+	 * sont répartis par tranches de rayons sur des threads créés une fois pour toutes :
+	 * chaque thread n'écrit que dans ses plans de l'accumulateur. Comme setup_gradient,
+	 * set_nb_threads n'est accessible que par l'API ( 1 thread par défaut ).
+	 * 
 	 **/
 	class c_hough
 	{
@@ -50,6 +79,20 @@
 							unsigned int r_max,
 							unsigned int thickness = 1 ); // hough_space, width, height, r_step, _width_step
 				
+			/**@fn
+			 * @param width : largeur de l'image
+			 * @param height : hauteur de l'image
+			 * @param r_min : rayon min. ( >= 1 )
+			 * @param r_max : rayon max.
+			 * @brief
+			 * Setup du mode HOUGH_GRADIENT.
+			 * 
+			 **/
+			int  setup_gradient (	unsigned int width,
+									unsigned int height,
+									unsigned int r_min,
+									unsigned int r_max );
+				
 			/**@fn 
 			 * @param img_data : image pixels
 			 * @param width : image width ( <= _width)
@@ -84,6 +127,28 @@
 											unsigned int r_min = 1,
 											unsigned int r_max = 0 );
 											
+			/**@fn
+			 * @param img_data : image ( niveaux de gris ) pour le gradient
+			 * @param edge_data : contours ( pixels != 0 ), même widthStep que img_data
+			 * @param width : image width ( <= _width)
+			 * @param height : image height ( <= _height )
+			 * @param width_step : image widthStep
+			 * @param r_min : min radius ( >= _r_min ) 
+			 * @param r_max : max radius ( <= _r_max )
+			 * @param direction : HOUGH_VOTE_BOTH, HOUGH_VOTE_DARK_CENTER ou HOUGH_VOTE_BRIGHT_CENTER
+			 * @brief
+			 * Compute the hough transform ( mode HOUGH_GRADIENT ) : gradient de Sobel en
+			 * chaque pixel de contour, puis un vote par rayon le long de la normale.
+			 */
+			int compute_gradient_hough_transform( 	const unsigned char * img_data,
+													const unsigned char * edge_data,
+													unsigned int width,
+													unsigned int height,
+													unsigned int width_step = 0,
+													unsigned int r_min = 0,
+													unsigned int r_max = 0,
+													int direction = HOUGH_VOTE_BOTH );
+											
 			/**@fn
 			 * @param x, y, r : circle parameters
 			 * @param r_min, r_max, width, height : aera of searching.
@@ -100,6 +165,34 @@
 											unsigned int height );
 			
 			
+			/**@fn
+			 * @param nb_threads : nombre de threads ( 0 : nombre de processeurs )
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon
+			 * @brief
+			 * Nombre de threads des votes et de get_best_circle ( 1 par défaut ).
+			 */
+			int set_nb_threads ( unsigned int nb_threads );
+			
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre de threads.
+			 */
+			inline unsigned int nb_threads() const
+			{
+				return _nb_threads;
+			}
+			
+			/**@fn
+			 * @brief
+			 * Renvoie le mode de vote ( HOUGH_DENSE ou HOUGH_GRADIENT ).
+			 */
+			inline int mode() const
+			{
+				return _mode;
+			}
+			
 			/**@fn 
 			 * @brief
 			 * Destructor
@@ -143,6 +236,98 @@
 			 * 
 			 **/
 			void generate_templates ( ); 
+			
+			/**@fn
+			 * @param points : pixels de contour ( x, y )
+			 * @param nb_points : nombre de pixels
+			 * @param r_min, r_max : rayons
+			 * @brief
+			 * Remise à 0 et votes du mode HOUGH_DENSE, par tranches de rayons.
+			 **/
+			void vote ( const unsigned int * points,
+						unsigned int nb_points,
+						unsigned int r_min,
+						unsigned int r_max );
+			
+			/**@fn
+			 * @param id : numéro de la tranche
+			 * @brief
+			 * Votes d'une tranche de rayons.
+			 **/
+			void vote_slab ( unsigned int id );
+			
+			/**@fn
+			 * @param id : numéro de la tranche
+			 * @brief
+			 * Maximum d'une tranche de rayons ( premier dans l'ordre r, y, x ).
+			 **/
+			void best_circle_slab ( unsigned int id );
+			
+			/**@fn
+			 * @param r_min, r_max : rayons
+			 * @param task : HOUGH_TASK_VOTE ou HOUGH_TASK_BEST
+			 * @brief
+			 * Découpe [r_min, r_max] en nb_threads tranches de même coût.
+			 **/
+			void split_radii ( 	unsigned int r_min,
+								unsigned int r_max,
+								int task );
+			
+			/**@fn
+			 * @brief
+			 * Coût d'un rayon pour une tâche.
+			 **/
+			double radius_cost ( 	unsigned int r,
+									int task ) const;
+			
+			/**@fn
+			 * @param task : HOUGH_TASK_VOTE ou HOUGH_TASK_BEST
+			 * @brief
+			 * Lance une tâche sur toutes les tranches et attend la fin.
+			 **/
+			void dispatch ( int task );
+			
+			/**@fn
+			 * @param id : numéro de la tranche
+			 * @brief
+			 * Traitement d'une tranche par la tâche courante.
+			 **/
+			void run_task ( unsigned int id );
+			
+			/**@fn
+			 * @param obj : c_hough
+			 * @param id : numéro de la tranche
+			 * @brief
+			 * Tâche du pool ( run_task ).
+			 **/
+			static void pool_task ( 	void * obj,
+										unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * Ini. des threads ( un seul, le thread appelant ).
+			 **/
+			void initialize_threads ( );
+			
+			/**@fn
+			 * @brief
+			 * Arrêt des threads.
+			 **/
+			void stop_threads ( );
+			
+			/**@fn
+			 * @param y, x : pixel de contour
+			 * @param dx, dy : direction unitaire du vote
+			 * @param r_min, r_max : rayons
+			 * @brief
+			 * Votes du mode HOUGH_GRADIENT le long d'une demi-droite.
+			 **/
+			void add_ray ( 	unsigned int y, 
+							unsigned int x,
+							float dx,
+							float dy,
+							unsigned int r_min, 
+							unsigned int r_max );
 
 			ostream * err_stream;
 			
@@ -156,6 +341,29 @@
 			unsigned int _thickness;
 			int ** _circles_points;
 			unsigned int * _nb_circles_points;
+			
+			//Mode HOUGH_GRADIENT ( r_step = width * height )
+			int _mode;
+			unsigned int _r_min;
+			unsigned short * _gradient_space;
+			unsigned int * _plane; // Scores d'un rayon par thread ( get_best_circle )
+			
+			//Threads ( le thread appelant traite la tranche 0 )
+			c_thread_pool _pool;
+			unsigned int _nb_threads; // _pool.nb_threads()
+			
+			//Tâche courante
+			int _task;
+			const unsigned int * _task_points;
+			unsigned int 	_task_nb_points,
+							_task_width,
+							_task_height;
+			unsigned int * _slabs; // Bornes des tranches de rayons ( nb_threads + 1 )
+			int 	* _best_x,
+					* _best_y;
+			unsigned int * _best_r;
+			long long * _best_v;
+			vector<unsigned int> _points; // Pixels de contour de l'image ( x, y )
 	};
 	
 	
@@ -10,8 +10,42 @@
 	#include <stdexcept>
 	#include <cstring>
 	#include <cmath>
+	#include <vector>
+	#include <map>
 	using namespace std;
 	
+	//Moteurs
+	#define HOUGH_ELLIPSE_DENSE 0 // Accumulateur 5D complet ( setup )
+	#define HOUGH_ELLIPSE_PYRAMID 1 // Recherche grossière puis fine ( setup_pyramid )
+	
+	//Mode HOUGH_ELLIPSE_PYRAMID : taille max. de l'accumulateur du niveau grossier ( 4 Mo )
+	#define HOUGH_ELLIPSE_MAX_CELLS ( 1 << 20 )
+	//Nombre de maxima du niveau grossier affinés
+	#define HOUGH_ELLIPSE_NB_CANDIDATES 8
+	//Demi-largeur ( cellules ) de la vérification dense finale autour du meilleur maximum
+	#define HOUGH_ELLIPSE_CHECK_RADIUS 2
+	
+	/**@class
+	 * @brief
+	 * Transformée de Hough pour une ellipse ( x, y, a, b, theta ).
+	 * 
+	 * Mode HOUGH_ELLIPSE_DENSE : accumulateur nb_x * nb_y * nb_r² * nb_thetas et un
+	 * gabarit par ( a, b, theta ) ajouté pour chaque pixel de contour.
+	 * Mode HOUGH_ELLIPSE_PYRAMID : compute_hough_transform garde les pixels de contour ;
+	 * search_best_ellipse vote d'abord au niveau 2^L ( centres et axes regroupés par
+	 * blocs de 2^L, L le plus petit niveau dont l'accumulateur tient dans max_cells ),
+	 * puis affine les meilleurs maxima niveau par niveau dans une fenêtre de
+	 * 4 x 4 x 4 x 4 x 3 cellules autour du maximum précédent, puis revote au niveau 0
+	 * autour du meilleur ( +/- HOUGH_ELLIPSE_CHECK_RADIUS ) tant qu'il change.
+	 * Au niveau 0, les gabarits sont ceux du mode dense ( cvEllipse, même épaisseur ) :
+	 * les votes sont exacts et les égalités sont départagées dans l'ordre du mode dense.
+	 * Seuls HOUGH_ELLIPSE_NB_CANDIDATES maxima du niveau grossier sont affinés ( gabarits
+	 * échantillonnés sur l'ellipse aux niveaux > 0 ) : l'ellipse du mode dense peut encore
+	 * être manquée si son pic n'est pas parmi eux ( contours très bruités, pics voisins
+	 * de votes presque égaux ). Comparaison avec le mode dense : App bench_hough_ellipse.
+	 * Bibliothèque seulement : la segmentation ( iris/ ) n'utilise pas c_hough_ellipse,
+	 * aucune clé .cfg ne sélectionne setup_pyramid.
+	 **/
 	class c_hough_ellipse
 	{
 		public:
@@ -51,6 +85,21 @@
 						unsigned int r_max,
 						unsigned int thickness = 1);
 	
+			/**@fn
+			 * @param nb_thetas : nombre d'orientations ( theta = k * PI / ( 2 nb_thetas ) )
+			 * @param r_min : demi-axe min.
+			 * @param r_max : demi-axe max. ( exclu )
+			 * @param thickness : épaisseur des gabarits du niveau 0 ( cf. setup )
+			 * @param max_cells : taille max. de l'accumulateur
+			 * @brief
+			 * Setup du mode HOUGH_ELLIPSE_PYRAMID ( gabarits du niveau 0 dessinés à la demande ).
+			 **/
+			int setup_pyramid (	unsigned int nb_thetas,
+								unsigned int r_min,
+								unsigned int r_max,
+								unsigned int thickness = 1,
+								unsigned int max_cells = HOUGH_ELLIPSE_MAX_CELLS );
+	
 			/**@fn 
 			 * @param img_data : image pixels
 			 * @param width : image width ( <= _width)
@@ -119,6 +168,15 @@
 		
 		
 		
+			/**@fn
+			 * @brief
+			 * Renvoie le moteur ( HOUGH_ELLIPSE_DENSE ou HOUGH_ELLIPSE_PYRAMID ).
+			 */
+			inline int mode() const
+			{
+				return _mode;
+			}
+		
 			/**@fn
 			 * @brief
 			 * Destructeur.
@@ -171,6 +229,109 @@
 			int ** _template_ellipses; //  4 PI ( r_max )³ x nb_thetas
 			unsigned int * _nb_ellipses_points; //(r_max )² x nb_thetas
 			
+			/**@struct
+			 * @brief
+			 * Fenêtre de recherche d'un niveau ( unités du niveau, bornes max exclues ).
+			 */
+			struct pyramid_window
+			{
+				int x_0, x_1,
+					y_0, y_1,
+					a_0, a_1,
+					b_0, b_1,
+					t_0, t_1;
+			};
+			
+			/**@struct
+			 * @brief
+			 * Cellule d'un niveau ( unités du niveau, indices des axes et de l'orientation ).
+			 */
+			struct pyramid_cell
+			{
+				int x, y, a, b, t;
+			};
+			
+			/**@fn
+			 * @param level : niveau ( blocs de 2^level pixels )
+			 * @param w : fenêtre
+			 * @param r_min, r_max : demi-axes ( pixels )
+			 * @param best : maxima ( sortie, nb_best cellules )
+			 * @param votes : votes des maxima ( sortie )
+			 * @param nb_best : nombre de maxima ( séparés d'au moins 2 cellules )
+			 * @return
+			 * Nombre de maxima trouvés
+			 * @brief
+			 * Votes des pixels de contour du niveau ( _level_points ) dans la fenêtre.
+			 **/
+			unsigned int vote_level ( 	unsigned int level,
+										const pyramid_window & w,
+										unsigned int r_min,
+										unsigned int r_max,
+										pyramid_cell * best,
+										unsigned int * votes,
+										unsigned int nb_best );
+			
+			/**@fn
+			 * @param level : niveau
+			 * @brief
+			 * Blocs de contour du niveau, sans doublons, avec leur nombre de pixels
+			 * ( 1 au niveau 0 : un vote par pixel de contour, comme le mode dense ).
+			 **/
+			void pyramid_points ( unsigned int level );
+			
+			/**@fn
+			 * @param level : niveau
+			 * @param a, b : demi-axes ( pixels )
+			 * @param k : orientation
+			 * @brief
+			 * Gabarit d'une ellipse centrée en 0, en unités du niveau, sans doublons.
+			 **/
+			void pyramid_template ( unsigned int level,
+									double a,
+									double b,
+									unsigned int k );
+			
+			/**@fn
+			 * @param a, b : demi-axes ( pixels )
+			 * @param k : orientation
+			 * @return
+			 * Gabarit du mode dense ( draw_template ), dessiné au premier appel.
+			 **/
+			const vector<int> & level_0_template ( 	unsigned int a,
+													unsigned int b,
+													unsigned int k );
+			
+			/**@fn
+			 * @return
+			 * true si c_1 est avant c_2 dans l'ordre de parcours du mode dense.
+			 **/
+			static bool dense_order ( 	const pyramid_cell & c_1,
+										const pyramid_cell & c_2 );
+			
+			/**@fn
+			 * @param temp : image de dessin ( 2 r_max + 1 )²
+			 * @param a, b : demi-axes
+			 * @param k : orientation
+			 * @param pts : points du gabarit ( x, y ) relatifs au centre ( sortie )
+			 * @brief
+			 * Dessin d'un gabarit avec cvEllipse ( generate_templates ).
+			 **/
+			void draw_template ( 	IplImage * temp,
+									unsigned int a,
+									unsigned int b,
+									unsigned int k,
+									vector<int> & pts );
+			
+			//Mode HOUGH_ELLIPSE_PYRAMID
+			int _mode;
+			unsigned int _max_cells;
+			vector<int> _points; // Pixels de contour ( x, y )
+			vector<int> _level_points; // Blocs de contour du niveau ( x, y, nombre de pixels )
+			vector<int> _template; // Gabarit courant
+			vector<unsigned int> _accumulator;
+			IplImage * _canvas; // Dessin des gabarits du niveau 0
+			map< unsigned long long, vector<int> > _level_0_templates;
+			
 	};
 	
 
@@ -13,7 +13,7 @@ AUTHOR="Valérian Némesin"
 
 #Dépendances
 #Lib. statiques
-S_LIBS=
+S_LIBS=../utilities
 #Lib. dynamiques
 D_LIBS=opencv
 
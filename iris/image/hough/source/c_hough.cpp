@@ -6,9 +6,11 @@
 #include <stdexcept>
 #include <cstring>
 #include <cmath>
+
 c_hough :: c_hough()
 {
 	initialize();
+	initialize_threads();
 }
 
 c_hough :: c_hough(	unsigned int width,
@@ -17,6 +19,7 @@ c_hough :: c_hough(	unsigned int width,
 						unsigned int thickness ) // hough_space, width, height
 {
 	initialize();
+	initialize_threads();
 	if ( setup ( 	width, 
 					height, 
 					r_max, 
@@ -63,6 +66,43 @@ int c_hough :: setup (	unsigned int width,
 	return 0;
 }
 
+/**@fn
+ * @param width : largeur de l'image
+ * @param height : hauteur de l'image
+ * @param r_min : rayon min. ( >= 1 )
+ * @param r_max : rayon max.
+ * @brief
+ * Setup du mode HOUGH_GRADIENT : centres dans l'image, rayons [r_min, r_max].
+ * 
+ **/
+int c_hough :: setup_gradient (	unsigned int width,
+								unsigned int height,
+								unsigned int r_min,
+								unsigned int r_max )
+{
+	free();
+	initialize();
+	
+	if ( ! width || ! height || ! r_min || r_max < r_min ) 
+	{
+		*err_stream << "Error : bad arguments in int c_hough :: setup_gradient ( unsigned int width, unsigned int height, unsigned int r_min, unsigned int r_max ); " << endl;
+		return 1;
+	}
+	
+	_mode = HOUGH_GRADIENT;
+	_width = width;
+	_height = height;
+	_r_min = r_min;
+	_r_max = r_max;
+	_width_step = _width;
+	_r_step = _width * _height;
+	_gradient_space = new unsigned short[ _r_step * ( _r_max - _r_min + 1 ) ];
+	//Un plan de scores par thread
+	_plane = new unsigned int[ _r_step * _nb_threads ];
+	
+	return 0;
+}
+
 /**@fn
  * @brief
  * Generate the circle images ( for r = 0 to r_max )
@@ -168,6 +208,12 @@ int c_hough :: compute_hough_transform( 	const unsigned char * img_data,
 		return -3;
 	}
 	
+	if ( ! _hough_space )
+	{
+		*err_stream << "Error : c_hough :: compute_hough_transform needs HOUGH_DENSE mode ( setup )" << endl;
+		return -2;
+	}
+	
 	if ( width_step == 0 )
 		width_step = width;
 	
@@ -180,20 +226,25 @@ int c_hough :: compute_hough_transform( 	const unsigned char * img_data,
 		return -1;
 	}
 	
-	// 0
-	memset ( _hough_space, 0, sizeof(int) * _r_step * _r_max );
-	
-	//Computation
+	//Pixels de contour ( x, y )
+	_points.clear();
 	for ( unsigned int i = 0; i < height; ++ i )
 	{
 		for ( unsigned int j = 0; j < width; ++ j )
 		{
 			if ( img_data[ i * width_step + j ] )
 			{
-				add_circles ( i, j, r_min, r_max );
+				_points.push_back( j );
+				_points.push_back( i );
 			}
 		}
 	}
+	
+	//Computation
+	vote( 	_points.empty() ? NULL : &_points[0],
+			_points.size() / 2,
+			r_min,
+			r_max );
 	return 0;
 }
 
@@ -213,6 +264,12 @@ int c_hough :: compute_hough_transform( 	const unsigned int * contour,
 		return -3;
 	}
 	
+	if ( ! _hough_space )
+	{
+		*err_stream << "Error : c_hough :: compute_hough_transform needs HOUGH_DENSE mode ( setup )" << endl;
+		return -2;
+	}
+	
 	if ( r_max == 0 )
 		r_max = _r_max;
 	
@@ -224,21 +281,155 @@ int c_hough :: compute_hough_transform( 	const unsigned int * contour,
 		return -1;
 	}
 	
-	// 0
-	memset ( _hough_space, 0, sizeof(int) * _r_step * _r_max );
-	for ( unsigned int i = 0; i < nb_pts_contour; ++i) 
+	//Computation
+	vote( 	contour,
+			nb_pts_contour,
+			r_min,
+			r_max );
+	
+	return 0;
+}
+
+void c_hough :: vote ( 	const unsigned int * points,
+						unsigned int nb_points,
+						unsigned int r_min,
+						unsigned int r_max )
+{
+	// 0 ( rayons hors de [r_min, r_max] ; les autres sont remis à 0 par leur thread )
+	if ( r_min > r_max )
+	{
+		memset ( _hough_space, 0, sizeof(int) * _r_step * _r_max );
+		return;
+	}
+	memset ( _hough_space, 0, sizeof(int) * _r_step * ( r_min - 1 ) );
+	memset ( 	_hough_space + _r_step * r_max, 
+				0, 
+				sizeof(int) * _r_step * ( _r_max - r_max ) );
+	
+	//Tranches de rayons de même nombre de votes
+	_task_points = points;
+	_task_nb_points = nb_points;
+	split_radii( r_min, r_max, HOUGH_TASK_VOTE );
+	dispatch( HOUGH_TASK_VOTE );
+}
+
+void c_hough :: vote_slab ( unsigned int id )
+{
+	unsigned int 	r_a = _slabs[id],
+					r_b = _slabs[id + 1];
+	if ( r_a >= r_b )
+		return;
+	memset ( 	_hough_space + _r_step * ( r_a - 1 ), 
+				0, 
+				sizeof(int) * _r_step * ( r_b - r_a ) );
+	for ( unsigned int i = 0; i < _task_nb_points; ++i) 
+	{
+		add_circles( 	_task_points[2 * i + 1],
+						_task_points[2 * i],
+						r_a,
+						r_b - 1 );
+	}
+}
+
+
+int c_hough :: compute_gradient_hough_transform( 	const unsigned char * img_data,
+													const unsigned char * edge_data,
+													unsigned int width,
+													unsigned int height,
+													unsigned int width_step,
+													unsigned int r_min,
+													unsigned int r_max,
+													int direction )
+{
+	if ( ! img_data || ! edge_data || ! height || ! width )
 	{
-		add_circles( 	contour[2 * i + 1],
-						contour[2 * i],
-						r_min,
-						r_max );
+		*err_stream << "Error : bad params in int c_hough :: compute_gradient_hough_transform" << endl;
+		return -3;
 	}
 	
+	if ( ! _gradient_space )
+	{
+		*err_stream << "Error : c_hough :: compute_gradient_hough_transform needs HOUGH_GRADIENT mode ( setup_gradient )" << endl;
+		return -2;
+	}
 	
+	if ( width_step == 0 )
+		width_step = width;
 	
+	if ( r_min == 0 )
+		r_min = _r_min;
+	
+	if ( r_max == 0 )
+		r_max = _r_max;
+	
+	if ( 	r_min < _r_min 		||
+			r_max > _r_max 		|| 
+			r_min > r_max 		||
+			width > _width 		|| 
+			height > _height )
+	{
+		*err_stream << "Error : width, height or radii out of range in int c_hough :: compute_gradient_hough_transform" << endl;
+		return -1;
+	}
+	
+	// 0
+	memset ( _gradient_space, 0, sizeof(unsigned short) * _r_step * ( _r_max - _r_min + 1 ) );
+	
+	//Computation ( gradient de Sobel, pas de vote sur les bords de l'image )
+	for ( unsigned int i = 1; i + 1 < height; ++ i )
+	{
+		const unsigned char 	* p = img_data + i * width_step,
+								* p_up = p - width_step,
+								* p_down = p + width_step,
+								* e = edge_data + i * width_step;
+		for ( unsigned int j = 1; j + 1 < width; ++ j )
+		{
+			if ( ! e[j] )
+				continue;
+			
+			int gx = 	( p_up[j + 1] + 2 * p[j + 1] + p_down[j + 1] ) -
+						( p_up[j - 1] + 2 * p[j - 1] + p_down[j - 1] ),
+				gy = 	( p_down[j - 1] + 2 * p_down[j] + p_down[j + 1] ) -
+						( p_up[j - 1] + 2 * p_up[j] + p_up[j + 1] );
+			if ( ! gx && ! gy )
+				continue;
+			
+			//Le gradient va du sombre vers le clair
+			float n = sqrt( (float) ( gx * gx + gy * gy ) ),
+				  dx = gx / n,
+				  dy = gy / n;
+			if ( direction != HOUGH_VOTE_BRIGHT_CENTER )
+				add_ray( i, j, -dx, -dy, r_min, r_max );
+			if ( direction != HOUGH_VOTE_DARK_CENTER )
+				add_ray( i, j, dx, dy, r_min, r_max );
+		}
+	}
 	return 0;
 }
 
+void c_hough :: add_ray ( 	unsigned int y, 
+							unsigned int x,
+							float dx,
+							float dy,
+							unsigned int r_min, 
+							unsigned int r_max )
+{
+	unsigned short * space = _gradient_space + _r_step * ( r_min - _r_min );
+	for ( unsigned int r = r_min; r <= r_max; ++ r, space += _r_step )
+	{
+		int cx = (int) floor( x + dx * r + 0.5f ),
+			cy = (int) floor( y + dy * r + 0.5f );
+		//Le pixel est dans l'image : une fois sortie, la demi-droite n'y revient pas
+		if ( 	cx < 0 					|| 
+				cy < 0 					|| 
+				cx >= (int) _width 		|| 
+				cy >= (int) _height )
+			break;
+		unsigned short & v = space[ cy * _width_step + cx ];
+		if ( v != 0xFFFF )
+			++ v;
+	}
+}
 
 /**@fn
  * @param x, y : coordinate of pixel
@@ -279,6 +470,10 @@ void c_hough :: free ()
 	}
 	if ( _nb_circles_points )
 		delete[] _nb_circles_points;
+	if ( _gradient_space )
+		delete[] _gradient_space;
+	if ( _plane )
+		delete[] _plane;
 	
 }
 
@@ -294,6 +489,10 @@ void c_hough :: initialize()
 	_width_step = 0;
 	_nb_circles_points = 0;
 	_circles_points = 0;
+	_mode = HOUGH_DENSE;
+	_r_min = 1;
+	_gradient_space = 0;
+	_plane = 0;
 	
 	
 	
@@ -302,6 +501,7 @@ c_hough :: ~c_hough()
 {
 	free();
 	initialize();
+	stop_threads();
 }
 
 unsigned int c_hough :: get_best_circle (	int & x,
@@ -312,26 +512,232 @@ unsigned int c_hough :: get_best_circle (	int & x,
 											unsigned int width,
 											unsigned int height )
 {
+	unsigned int max;
+	if ( _mode == HOUGH_GRADIENT )
+	{
+		//Centres dans l'image
+		if ( r_min < _r_min )
+			r_min = _r_min;
+		if ( r_max > _r_max )
+			r_max = _r_max;
+		if ( width > _width )
+			width = _width;
+		if ( height > _height )
+			height = _height;
+		max = 0;
+	}
+	else
+		max = _hough_space[ _r_step * ( r_min - 1 ) + _width_step * _r_max +  _r_max ];
 	x = 0;
 	y = 0;
 	r = r_min;
-	unsigned int max = _hough_space[ _r_step * ( r - 1 ) + _width_step * ( _r_max + y ) +  ( _r_max + x ) ];
-	for ( unsigned int i = r_min; i <= r_max; ++ i )
+	
+	//Maximum de chaque tranche de rayons
+	_task_width = width;
+	_task_height = height;
+	split_radii( r_min, r_max, HOUGH_TASK_BEST );
+	dispatch( HOUGH_TASK_BEST );
+	
+	//Premier maximum dans l'ordre ( r, y, x ), comme un parcours séquentiel
+	for ( unsigned int i = 0; i < _nb_threads; ++ i )
+	{
+		if ( _best_v[i] > (long long) max )
+		{
+			x = _best_x[i];
+			y = _best_y[i];
+			r = _best_r[i];
+			max = _best_v[i];
+		}
+	}
+	return max;
+}
+
+void c_hough :: best_circle_slab ( unsigned int id )
+{
+	unsigned int 	r_a = _slabs[id],
+					r_b = _slabs[id + 1],
+					width = _task_width,
+					height = _task_height;
+	long long max = -1;
+	int x = 0,
+		y = 0;
+	unsigned int r = r_a;
+	
+	if ( _mode == HOUGH_GRADIENT )
 	{
-		for ( int j = -i; j < (long long) height + i; ++ j )
+		//Score d'un centre : somme des votes sur 3 x 3 pixels ( la direction du gradient
+		//n'est précise qu'à quelques degrés près )
+		unsigned int * plane = _plane + _r_step * id;
+		for ( unsigned int i = r_a; i < r_b; ++ i )
 		{
-			for ( int k = -i; k < (long long) width + i; ++ k )
+			const unsigned short * space = _gradient_space + _r_step * ( i - _r_min );
+			//Sommes horizontales
+			for ( unsigned int j = 0; j < height; ++ j )
 			{
-				unsigned int v =  _hough_space[ _r_step * ( i - 1 ) + _width_step * ( _r_max + j ) +  ( _r_max + k ) ] ;
-				if ( v > max )
+				const unsigned short * line = space + _width_step * j;
+				unsigned int * sums = plane + _width_step * j;
+				for ( unsigned int k = 0; k < width; ++ k )
+					sums[k] = 	line[k] + 
+								( ( k > 0 ) ? line[k - 1] : 0 ) + 
+								( ( k + 1 < width ) ? line[k + 1] : 0 );
+			}
+			//Sommes verticales
+			for ( unsigned int j = 0; j < height; ++ j )
+			{
+				const unsigned int 	* sums = plane + _width_step * j,
+									* sums_up = ( j > 0 ) ? sums - _width_step : NULL,
+									* sums_down = ( j + 1 < height ) ? sums + _width_step : NULL;
+				for ( unsigned int k = 0; k < width; ++ k )
 				{
-					y = j;
-					x = k;
-					r = i;
-					max = v;
+					unsigned int v = sums[k];
+					if ( sums_up )
+						v += sums_up[k];
+					if ( sums_down )
+						v += sums_down[k];
+					if ( v > max )
+					{
+						y = j;
+						x = k;
+						r = i;
+						max = v;
+					}
 				}
 			}
 		}
 	}
-	return max;
+	else
+	{
+		for ( unsigned int i = r_a; i < r_b; ++ i )
+		{
+			for ( int j = -i; j < (long long) height + i; ++ j )
+			{
+				const unsigned int * line = _hough_space + _r_step * ( i - 1 ) + _width_step * ( _r_max + j ) + _r_max;
+				for ( int k = -i; k < (long long) width + i; ++ k )
+				{
+					if ( line[k] > max )
+					{
+						y = j;
+						x = k;
+						r = i;
+						max = line[k];
+					}
+				}
+			}
+		}
+	}
+	_best_x[id] = x;
+	_best_y[id] = y;
+	_best_r[id] = r;
+	_best_v[id] = max;
+}
+
+int c_hough :: set_nb_threads ( unsigned int nb_threads )
+{
+	stop_threads();
+	int ret = _pool.setup( nb_threads, err_stream );
+	_nb_threads = _pool.nb_threads();
+	_slabs = new unsigned int[_nb_threads + 1];
+	_best_x = new int[_nb_threads];
+	_best_y = new int[_nb_threads];
+	_best_r = new unsigned int[_nb_threads];
+	_best_v = new long long[_nb_threads];
+	
+	//Plans de scores du mode HOUGH_GRADIENT
+	if ( _plane )
+	{
+		delete[] _plane;
+		_plane = new unsigned int[ _r_step * _nb_threads ];
+	}
+	return ret;
+}
+
+void c_hough :: split_radii ( 	unsigned int r_min,
+								unsigned int r_max,
+								int task )
+{
+	_slabs[0] = r_min;
+	_slabs[_nb_threads] = ( r_max >= r_min ) ? r_max + 1 : r_min;
+	if ( _nb_threads == 1 )
+		return;
+	
+	//Coût d'un rayon : points du cercle ( votes ) ou centres parcourus ( maximum )
+	double total = 0;
+	for ( unsigned int i = r_min; i <= r_max; ++ i )
+		total += radius_cost( i, task );
+	double cost = 0;
+	unsigned int t = 1;
+	for ( unsigned int i = r_min; i <= r_max && t < _nb_threads; ++ i )
+	{
+		cost += radius_cost( i, task );
+		while ( t < _nb_threads && cost >= total * t / _nb_threads )
+			_slabs[t ++] = i + 1;
+	}
+	while ( t < _nb_threads )
+		_slabs[t ++] = _slabs[_nb_threads];
+}
+
+double c_hough :: radius_cost ( 	unsigned int r,
+									int task ) const
+{
+	if ( _mode == HOUGH_GRADIENT )
+		return 1;
+	if ( task == HOUGH_TASK_VOTE )
+		return _nb_circles_points[r - 1];
+	return ( (double) _task_width + 2 * r ) * ( (double) _task_height + 2 * r );
+}
+
+void c_hough :: run_task ( unsigned int id )
+{
+	if ( _task == HOUGH_TASK_VOTE )
+		vote_slab( id );
+	else
+		best_circle_slab( id );
+}
+
+void c_hough :: pool_task ( 	void * obj,
+								unsigned int id )
+{
+	( (c_hough *) obj )->run_task( id );
+}
+
+void c_hough :: dispatch ( int task )
+{
+	_task = task;
+	_pool.run( pool_task, this );
+}
+
+void c_hough :: initialize_threads ( )
+{
+	_nb_threads = 0;
+	_task = HOUGH_TASK_VOTE;
+	_task_points = 0;
+	_task_nb_points = 0;
+	_task_width = 0;
+	_task_height = 0;
+	_slabs = 0;
+	_best_x = 0;
+	_best_y = 0;
+	_best_r = 0;
+	_best_v = 0;
+	set_nb_threads( 1 );
+}
+
+void c_hough :: stop_threads ( )
+{
+	_pool.stop();
+	if ( _slabs )
+		delete[] _slabs;
+	if ( _best_x )
+		delete[] _best_x;
+	if ( _best_y )
+		delete[] _best_y;
+	if ( _best_r )
+		delete[] _best_r;
+	if ( _best_v )
+		delete[] _best_v;
+	_slabs = 0;
+	_best_x = 0;
+	_best_y = 0;
+	_best_r = 0;
+	_best_v = 0;
 }
@@ -1,5 +1,12 @@
 #include "c_hough_ellipse.hpp"
 #include <opencv/highgui.h>
+#include <algorithm>
+
+//Division entière arrondie vers -infini
+static inline int floor_div( int v, int s )
+{
+	return ( v >= 0 ) ? v / s : - ( ( - v + s - 1 ) / s );
+}
 
 c_hough_ellipse :: c_hough_ellipse()
 {
@@ -63,6 +70,38 @@ int c_hough_ellipse :: setup (	unsigned int nb_x,
 	return 0;
 }
 
+int c_hough_ellipse :: setup_pyramid (	unsigned int nb_thetas,
+											unsigned int r_min,
+											unsigned int r_max,
+											unsigned int thickness,
+											unsigned int max_cells )
+{
+	free();
+	initialize();
+	
+	if ( 	!nb_thetas		||
+			!max_cells		||
+			!thickness		||
+			r_min >= r_max	)
+	{
+		*err_stream << "Error in int c_hough_ellipse :: setup_pyramid : Invalid argument(s)!" << endl;
+		return 1;
+	}
+	
+	_mode = HOUGH_ELLIPSE_PYRAMID;
+	_nb_thetas = nb_thetas;
+	_r_min = r_min;
+	_r_max = r_max;
+	_nb_r = _r_max - _r_min;
+	_thickness = thickness;
+	_max_cells = max_cells;
+	//Image de dessin des gabarits du niveau 0 ( cf. generate_templates )
+	_canvas = cvCreateImage( 	cvSize( 2 * _r_max + 1, 2 * _r_max + 1 ),
+								8,
+								1 );
+	return 0;
+}
+
 int c_hough_ellipse :: compute_hough_transform( 	const unsigned char * img_data,
 													unsigned int width,
 													unsigned int height,
@@ -92,6 +131,23 @@ int c_hough_ellipse :: compute_hough_transform( 	const unsigned char * img_data,
 	if ( width_step == 0 )
 		width_step = width;
 	
+	//Pixels de contour pour search_best_ellipse
+	if ( _mode == HOUGH_ELLIPSE_PYRAMID )
+	{
+		_points.clear();
+		for ( unsigned int i = 0; i < height; ++ i )
+		{
+			for ( unsigned int j = 0; j < width; ++ j )
+			{
+				if ( img_data[ i * width_step + j ] )
+				{
+					_points.push_back( j );
+					_points.push_back( i );
+				}
+			}
+		}
+		return 0;
+	}
 	
 	//Check dim.	
 	if ( 	nb_x > _nb_x 		|| 
@@ -156,6 +212,13 @@ int c_hough_ellipse :: compute_hough_transform( 	const unsigned int * contour,
 		
 	}
 	
+	//Pixels de contour pour search_best_ellipse
+	if ( _mode == HOUGH_ELLIPSE_PYRAMID )
+	{
+		_points.assign( contour, contour + 2 * nb_pts_contour );
+		return 0;
+	}
+	
 	//Check dim.	
 	if ( 	nb_x > _nb_x 		|| 	
 			nb_y > _nb_y 		|| 
@@ -215,6 +278,131 @@ unsigned int c_hough_ellipse :: search_best_ellipse( 	int & x,
 	b = 0;
 	theta = - M_PI / 2;
 	unsigned int max = 0;
+	if ( _mode == HOUGH_ELLIPSE_PYRAMID )
+	{
+		if ( _points.empty() || x_end <= x_start || y_end <= y_start || r_max <= r_min )
+			return 0;
+		
+		//Niveau grossier : le plus petit dont l'accumulateur tient dans _max_cells
+		unsigned int level = 0;
+		pyramid_window w;
+		while ( true )
+		{
+			int s = 1 << level;
+			w.x_0 = floor_div( x_start, s );
+			w.x_1 = floor_div( x_end - 1, s ) + 1;
+			w.y_0 = floor_div( y_start, s );
+			w.y_1 = floor_div( y_end - 1, s ) + 1;
+			w.a_0 = 0;
+			w.a_1 = ( dr + s - 1 ) / s;
+			w.b_0 = 0;
+			w.b_1 = w.a_1;
+			w.t_0 = 0;
+			w.t_1 = _nb_thetas;
+			double nb_cells = 	( (double) w.x_1 - w.x_0 ) * ( w.y_1 - w.y_0 ) * 
+								( w.a_1 - w.a_0 ) * ( w.b_1 - w.b_0 ) * ( w.t_1 - w.t_0 );
+			if ( nb_cells <= _max_cells || level == 16 )
+				break;
+			++ level;
+		}
+		
+		//Meilleurs maxima du niveau grossier
+		pyramid_cell cells[HOUGH_ELLIPSE_NB_CANDIDATES];
+		unsigned int votes[HOUGH_ELLIPSE_NB_CANDIDATES];
+		pyramid_points( level );
+		unsigned int nb_cells = vote_level( level,
+											w,
+											r_min,
+											r_max,
+											cells,
+											votes,
+											( level ) ? HOUGH_ELLIPSE_NB_CANDIDATES : 1 );
+		if ( ! nb_cells )
+			return 0;
+		
+		//Affinage niveau par niveau
+		while ( level > 0 )
+		{
+			-- level;
+			int s = 1 << level;
+			pyramid_points( level );
+			for ( unsigned int i = 0; i < nb_cells; ++ i )
+			{
+				const pyramid_cell & c = cells[i];
+				w.x_0 = std::max( 2 * c.x - 1, floor_div( x_start, s ) );
+				w.x_1 = std::min( 2 * c.x + 3, floor_div( x_end - 1, s ) + 1 );
+				w.y_0 = std::max( 2 * c.y - 1, floor_div( y_start, s ) );
+				w.y_1 = std::min( 2 * c.y + 3, floor_div( y_end - 1, s ) + 1 );
+				w.a_0 = std::max( 2 * c.a - 1, 0 );
+				w.a_1 = std::min( 2 * c.a + 3, (int) ( ( dr + s - 1 ) / s ) );
+				w.b_0 = std::max( 2 * c.b - 1, 0 );
+				w.b_1 = std::min( 2 * c.b + 3, (int) ( ( dr + s - 1 ) / s ) );
+				w.t_0 = std::max( c.t - 1, 0 );
+				w.t_1 = std::min( c.t + 2, (int) _nb_thetas );
+				if ( ! vote_level( 	level,
+									w,
+									r_min,
+									r_max,
+									cells + i,
+									votes + i,
+									1 ) )
+					votes[i] = 0;
+			}
+		}
+		
+		//Votes exacts au niveau 0 : égalités départagées dans l'ordre du mode dense
+		//( a, b, theta, y, x ), le dernier maximum rencontré l'emporte
+		int best = -1;
+		for ( unsigned int i = 0; i < nb_cells; ++ i )
+		{
+			if ( 	best < 0 					||
+					votes[i] > max 				||
+					( 	votes[i] == max 		&&
+						dense_order( cells[best], cells[i] ) ) )
+			{
+				best = i;
+				max = votes[i];
+			}
+		}
+		
+		//Vérification dense autour du meilleur maximum, jusqu'à ce qu'il ne change plus
+		//( votes croissants ou égaux et plus loin dans l'ordre du mode dense : fin garantie )
+		pyramid_cell c = cells[best];
+		while ( true )
+		{
+			pyramid_cell c_new;
+			unsigned int v_new;
+			w.x_0 = std::max( c.x - HOUGH_ELLIPSE_CHECK_RADIUS, x_start );
+			w.x_1 = std::min( c.x + HOUGH_ELLIPSE_CHECK_RADIUS + 1, x_end );
+			w.y_0 = std::max( c.y - HOUGH_ELLIPSE_CHECK_RADIUS, y_start );
+			w.y_1 = std::min( c.y + HOUGH_ELLIPSE_CHECK_RADIUS + 1, y_end );
+			w.a_0 = std::max( c.a - HOUGH_ELLIPSE_CHECK_RADIUS, 0 );
+			w.a_1 = std::min( c.a + HOUGH_ELLIPSE_CHECK_RADIUS + 1, (int) dr );
+			w.b_0 = std::max( c.b - HOUGH_ELLIPSE_CHECK_RADIUS, 0 );
+			w.b_1 = std::min( c.b + HOUGH_ELLIPSE_CHECK_RADIUS + 1, (int) dr );
+			w.t_0 = std::max( c.t - 1, 0 );
+			w.t_1 = std::min( c.t + 2, (int) _nb_thetas );
+			if ( 	! vote_level( 	0,
+									w,
+									r_min,
+									r_max,
+									&c_new,
+									&v_new,
+									1 ) 		||
+					v_new < max					||
+					( 	v_new == max			&&
+						! dense_order( c, c_new ) ) )
+				break;
+			c = c_new;
+			max = v_new;
+		}
+		x = c.x;
+		y = c.y;
+		a = r_min + c.a;
+		b = r_min + c.b;
+		theta = ( c.t ) * M_PI / ( 2 * _nb_thetas );
+		return max;
+	}
 	for ( unsigned int i = r_min; i < r_max; ++ i )
 	{
 		for ( unsigned int j = r_min; j < r_max; ++ j )
@@ -249,6 +437,197 @@ unsigned int c_hough_ellipse :: search_best_ellipse( 	int & x,
 
 
 
+void c_hough_ellipse :: pyramid_points ( unsigned int level )
+{
+	//Coordonnées du niveau ( blocs de 2^level pixels ), triées sans doublons,
+	//et nombre de pixels de contour du bloc ( poids des votes )
+	int s = 1 << level;
+	vector< pair<int, int> > pts( _points.size() / 2 );
+	for ( unsigned int i = 0; i < pts.size(); ++ i )
+		pts[i] = make_pair( floor_div( _points[2 * i + 1], s ), 
+							floor_div( _points[2 * i], s ) );
+	sort( pts.begin(), pts.end() );
+	_level_points.clear();
+	for ( unsigned int i = 0; i < pts.size(); ++ i )
+	{
+		if ( i && pts[i] == pts[i - 1] )
+		{
+			if ( level )
+				++ _level_points.back();
+			continue;
+		}
+		_level_points.push_back( pts[i].second );
+		_level_points.push_back( pts[i].first );
+		_level_points.push_back( 1 );
+	}
+}
+
+void c_hough_ellipse :: pyramid_template ( 	unsigned int level,
+											double a,
+											double b,
+											unsigned int k )
+{
+	//Même paramétrage que cvEllipse ( angle en degrés, sens de l'image )
+	double 	s = 1 << level,
+			phi = ( 90.0 * k / _nb_thetas ) * M_PI / 180,
+			c_phi = cos( phi ),
+			s_phi = sin( phi );
+	//Au plus 1/2 cellule entre deux points
+	unsigned int nb = (unsigned int) ceil( 4 * M_PI * max( a, b ) / s ) + 8;
+	vector< pair<int, int> > pts( nb );
+	for ( unsigned int i = 0; i < nb; ++ i )
+	{
+		double 	t = 2 * M_PI * i / nb,
+				u = a * cos( t ),
+				v = b * sin( t );
+		pts[i] = make_pair( (int) floor( ( u * c_phi - v * s_phi ) / s + 0.5 ),
+							(int) floor( ( u * s_phi + v * c_phi ) / s + 0.5 ) );
+	}
+	sort( pts.begin(), pts.end() );
+	pts.erase( unique( pts.begin(), pts.end() ), pts.end() );
+	_template.resize( 2 * pts.size() );
+	for ( unsigned int i = 0; i < pts.size(); ++ i )
+	{
+		_template[2 * i] = pts[i].first;
+		_template[2 * i + 1] = pts[i].second;
+	}
+}
+
+const vector<int> & c_hough_ellipse :: level_0_template ( 	unsigned int a,
+															unsigned int b,
+															unsigned int k )
+{
+	unsigned long long n = ( ( (unsigned long long) a << 32 ) + b ) * _nb_thetas + k;
+	map< unsigned long long, vector<int> >::iterator it = _level_0_templates.find( n );
+	if ( it != _level_0_templates.end() )
+		return it->second;
+	vector<int> & pts = _level_0_templates[n];
+	draw_template( 	_canvas,
+					a,
+					b,
+					k,
+					pts );
+	return pts;
+}
+
+bool c_hough_ellipse :: dense_order ( 	const pyramid_cell & c_1,
+										const pyramid_cell & c_2 )
+{
+	if ( c_1.a != c_2.a )
+		return c_1.a < c_2.a;
+	if ( c_1.b != c_2.b )
+		return c_1.b < c_2.b;
+	if ( c_1.t != c_2.t )
+		return c_1.t < c_2.t;
+	if ( c_1.y != c_2.y )
+		return c_1.y < c_2.y;
+	return c_1.x < c_2.x;
+}
+
+unsigned int c_hough_ellipse :: vote_level ( 	unsigned int level,
+												const pyramid_window & w,
+												unsigned int r_min,
+												unsigned int r_max,
+												pyramid_cell * best,
+												unsigned int * votes,
+												unsigned int nb_best )
+{
+	int s = 1 << level,
+		nx = w.x_1 - w.x_0,
+		ny = w.y_1 - w.y_0,
+		na = w.a_1 - w.a_0,
+		nb = w.b_1 - w.b_0,
+		nt = w.t_1 - w.t_0;
+	if ( nx <= 0 || ny <= 0 || na <= 0 || nb <= 0 || nt <= 0 )
+		return 0;
+	_accumulator.assign( nx * ny * na * nb * nt, 0 );
+	
+	for ( int i = 0; i < na; ++ i )
+	{
+		//Demi-axe représentatif de la cellule ( milieu des demi-axes du bloc )
+		int a_lo = r_min + ( w.a_0 + i ) * s,
+			a_hi = min( a_lo + s, (int) r_max );
+		for ( int j = 0; j < nb; ++ j )
+		{
+			int b_lo = r_min + ( w.b_0 + j ) * s,
+				b_hi = min( b_lo + s, (int) r_max );
+			for ( int k = 0; k < nt; ++ k )
+			{
+				//Niveau 0 : gabarits cvEllipse du mode dense ( mêmes votes ), sinon échantillonnés
+				const vector<int> * t;
+				if ( level )
+				{
+					pyramid_template( 	level,
+										( a_lo + a_hi - 1 ) / 2.0,
+										( b_lo + b_hi - 1 ) / 2.0,
+										w.t_0 + k );
+					t = &_template;
+				}
+				else
+					t = &level_0_template( a_lo, b_lo, w.t_0 + k );
+				unsigned int * space = &_accumulator[ ( ( i * nb + j ) * nt + k ) * ny * nx ];
+				unsigned int nb_template = t->size() / 2;
+				for ( unsigned int p = 0; p < _level_points.size(); p += 3 )
+				{
+					int px = _level_points[p] - w.x_0,
+						py = _level_points[p + 1] - w.y_0;
+					unsigned int n = _level_points[p + 2];
+					for ( unsigned int l = 0; l < nb_template; ++ l )
+					{
+						//Centre = pixel + point du gabarit ( cf. add_ellipses )
+						int cx = px + (*t)[2 * l],
+							cy = py + (*t)[2 * l + 1];
+						if ( cx >= 0 && cx < nx && cy >= 0 && cy < ny )
+							space[ cy * nx + cx ] += n;
+					}
+				}
+			}
+		}
+	}
+	
+	//Maxima séparés d'au moins 2 cellules ( dernier en cas d'égalité, comme le mode dense )
+	unsigned int nb_found = 0;
+	for ( unsigned int n = 0; n < nb_best; ++ n )
+	{
+		long long v_max = -1;
+		unsigned int id = 0;
+		for ( unsigned int c = 0; c < _accumulator.size(); ++ c )
+		{
+			if ( (long long) _accumulator[c] < v_max )
+				continue;
+			if ( n )
+			{
+				int cx = c % nx,
+					cy = ( c / nx ) % ny,
+					ck = ( c / ( nx * ny ) ) % nt,
+					cb = ( c / ( nx * ny * nt ) ) % nb,
+					ca = c / ( nx * ny * nt * nb );
+				bool near = false;
+				for ( unsigned int m = 0; m < n && ! near; ++ m )
+					near = 	abs( best[m].x - w.x_0 - cx ) <= 1 &&
+							abs( best[m].y - w.y_0 - cy ) <= 1 &&
+							abs( best[m].a - w.a_0 - ca ) <= 1 &&
+							abs( best[m].b - w.b_0 - cb ) <= 1 &&
+							abs( best[m].t - w.t_0 - ck ) <= 1;
+				if ( near )
+					continue;
+			}
+			v_max = _accumulator[c];
+			id = c;
+		}
+		if ( v_max <= 0 )
+			break;
+		best[n].x = w.x_0 + id % nx;
+		best[n].y = w.y_0 + ( id / nx ) % ny;
+		best[n].t = w.t_0 + ( id / ( nx * ny ) ) % nt;
+		best[n].b = w.b_0 + ( id / ( nx * ny * nt ) ) % nb;
+		best[n].a = w.a_0 + id / ( nx * ny * nt * nb );
+		votes[n] = v_max;
+		++ nb_found;
+	}
+	return nb_found;
+}
+
 void c_hough_ellipse :: add_ellipses ( 	unsigned int y,
 											unsigned int x,
 											int x_start,
@@ -291,16 +670,13 @@ void c_hough_ellipse :: generate_templates ( )
 	
 
 	unsigned int dim;
-	unsigned char * temp_data;
-	unsigned int width_step;
+	vector<int> pts;
 	
 	IplImage * temp;					
 	dim = _r_max * 2 + 1;
 	temp =  cvCreateImage (	cvSize(dim, dim),
 							8,
 							1 );
-	temp_data = (unsigned char*) temp->imageData;
-	width_step = temp->widthStep;
 	//Alloc mémoire
 	_template_ellipses = new int *[ _nb_thetas * _nb_r * _nb_r ];
 	_nb_ellipses_points = new unsigned int[ _nb_r * _nb_r * _nb_thetas ];
@@ -312,49 +688,57 @@ void c_hough_ellipse :: generate_templates ( )
 			for ( unsigned int k = 0; k < _nb_thetas; ++ k ) 
 			{
 				unsigned int n = ( ( i - _r_min ) * _nb_r + ( j - _r_min ) ) * _nb_thetas + k; 
-				//Mise à zéro
-				memset( temp_data,
-						0,
-						sizeof(char) * temp->widthStep * temp->height );
-		
-				cvEllipse( 	temp,
-							cvPoint( _r_max, _r_max ),
-							cvSize ( i, j ),
-							(90.0 * k) / _nb_thetas,
-							0,
-							360,
-							CV_RGB(255, 255, 255 ),
-							_thickness ); 
-				_nb_ellipses_points[ n ] = 0;
-				for ( unsigned int y = 0; y < dim; ++ y )
-				{
-					for ( unsigned int x = 0; x < dim; ++ x )
-					{
-						if ( temp_data[ y * width_step + x ] )
-							( _nb_ellipses_points[n] ) ++;
-					}					
-				}
-			
-				unsigned int nb_pts = 0;
-				_template_ellipses[ n ] = new int[ 2 * _nb_ellipses_points[ n ] ];
-				for ( unsigned int y = 0; y < dim; ++ y )
-				{
-					for ( unsigned int x = 0; x < dim; ++ x )
-					{
-						if ( temp_data[ y * width_step + x ] )
-						{
-							_template_ellipses[ n ][ 2 * nb_pts ] = x - _r_max;
-							_template_ellipses[ n ][ 2 * nb_pts + 1 ] = y - _r_max;
-							nb_pts ++;
-						}
-					}
-				}
+				draw_template( 	temp,
+								i,
+								j,
+								k,
+								pts );
+				_nb_ellipses_points[ n ] = pts.size() / 2;
+				_template_ellipses[ n ] = new int[ pts.size() ];
+				if ( ! pts.empty() )
+					memcpy( _template_ellipses[ n ], &pts[0], sizeof(int) * pts.size() );
 			}
 		}		
 	}
 	cvReleaseImage( &temp );
 }
 
+void c_hough_ellipse :: draw_template ( 	IplImage * temp,
+											unsigned int a,
+											unsigned int b,
+											unsigned int k,
+											vector<int> & pts )
+{
+	unsigned char * temp_data = (unsigned char*) temp->imageData;
+	unsigned int 	width_step = temp->widthStep,
+					dim = temp->width;
+	//Mise à zéro
+	memset( temp_data,
+			0,
+			sizeof(char) * temp->widthStep * temp->height );
+
+	cvEllipse( 	temp,
+				cvPoint( _r_max, _r_max ),
+				cvSize ( a, b ),
+				(90.0 * k) / _nb_thetas,
+				0,
+				360,
+				CV_RGB(255, 255, 255 ),
+				_thickness ); 
+	pts.clear();
+	for ( unsigned int y = 0; y < dim; ++ y )
+	{
+		for ( unsigned int x = 0; x < dim; ++ x )
+		{
+			if ( temp_data[ y * width_step + x ] )
+			{
+				pts.push_back( x - _r_max );
+				pts.push_back( y - _r_max );
+			}
+		}
+	}
+}
+
 void c_hough_ellipse :: free ( )
 {
 	if ( _hough_space )
@@ -372,6 +756,13 @@ void c_hough_ellipse :: free ( )
 	}
 	if ( _nb_ellipses_points )
 		delete[] _nb_ellipses_points;
+	if ( _canvas )
+		cvReleaseImage( &_canvas );
+	_points.clear();
+	_level_points.clear();
+	_template.clear();
+	_accumulator.clear();
+	_level_0_templates.clear();
 }
 
 void c_hough_ellipse :: initialize()
@@ -386,6 +777,9 @@ void c_hough_ellipse :: initialize()
 	err_stream = &cout;
 	_template_ellipses = 0; //  4 PI ( r_max )³ x nb_thetas
 	_nb_ellipses_points = 0;
+	_mode = HOUGH_ELLIPSE_DENSE;
+	_max_cells = HOUGH_ELLIPSE_MAX_CELLS;
+	_canvas = 0;
 }
 
 c_hough_ellipse :: ~c_hough_ellipse()
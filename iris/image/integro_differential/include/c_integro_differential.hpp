@@ -2,7 +2,24 @@
 #ifndef _C_INTEGRO_DIFFERENTIAL_HPP_
 	#define _C_INTEGRO_DIFFERENTIAL_HPP_
 	#include <opencv/cv.h>
+	#include <vector>
 	#include "../../polar/lib_polar.hpp"
+	#include "../../utilities/lib_utilities.hpp"
+	using namespace std;
+	
+	//Modes de recherche du centre
+	#define C_INTEGRODIFF_EXHAUSTIVE 0
+	#define C_INTEGRODIFF_COARSE_TO_FINE 1
+	
+	//Pas de la grille grossière ( en points de la grille n_x * n_y )
+	#define C_INTEGRODIFF_COARSE_STEP 4
+	//Nombre de candidats raffinés
+	#define C_INTEGRODIFF_NB_CANDIDATES 3
+	//Facteur de réduction de l'image pour la grille grossière
+	#define C_INTEGRODIFF_COARSE_SCALE 2
+	//Nombre de divisions par 2 du pas de l'optimisation continue
+	#define C_INTEGRODIFF_NB_CONTINUOUS_LEVELS 3
+	
 	#define C_INTEGRODIFF_SEARCH_CIRCLE(type) \
 	template double c_integro_differential_operator :: search_best_circle_params (	const type * data,\
 																							const unsigned char * mask,\
@@ -22,6 +39,13 @@
 	/**@class
 	 * @brief
 	 * Classe qui permet d'utiliser l'opérateur intégro différentiel.
+	 * Les positions d'échantillonnage de la transformée polaire sont communes à tous
+	 * les centres ( c_polar_table ) : elles ne sont calculées qu'une fois par configuration.
+	 * La recherche C_INTEGRODIFF_COARSE_TO_FINE est approchée : elle peut rendre un autre
+	 * centre que la recherche exhaustive ( maximum local ). Comparaison des deux modes :
+	 * App bench_integro_differential.
+	 * Bibliothèque seulement : la segmentation ( iris/ ) utilise c_integro_differential_polar
+	 * et c_integro_differential_2d, aucune clé .cfg ne règle set_search_mode ou set_nb_threads.
 	 * 
 	 **/
 	class c_integro_differential_operator
@@ -101,8 +125,42 @@
 												unsigned int n_y,
 												double r_min,
 												double r_max );
-					
 			
+			/**@fn
+			 * @param mode : C_INTEGRODIFF_EXHAUSTIVE ( défaut ) ou C_INTEGRODIFF_COARSE_TO_FINE
+			 * @param coarse_step : pas de la grille grossière
+			 * @param nb_candidates : nombre de maxima de la grille grossière raffinés
+			 * @param continuous : optimisation continue du centre après le raffinement
+			 * @param downsample : grille grossière sur l'image réduite
+			 * @brief
+			 * Mode de recherche du centre. En mode C_INTEGRODIFF_COARSE_TO_FINE, la grille
+			 * n_x * n_y est d'abord parcourue avec un pas coarse_step, puis les nb_candidates
+			 * meilleurs centres sont raffinés ( montée locale, pas divisé par 2 jusqu'à 1 ).
+			 * Chaque centre n'est évalué qu'une fois à chaque résolution.
+			 * Si downsample, la grille grossière est évaluée sur l'image réduite d'un facteur
+			 * C_INTEGRODIFF_COARSE_SCALE ( moyenne des blocs, pixel valide si tout le bloc
+			 * l'est ), avec une transformée polaire réduite du même facteur. Le raffinement
+			 * est toujours fait à pleine résolution.
+			 * Résultat approché : le maximum exhaustif est perdu s'il n'est pas dans le bassin
+			 * d'un des nb_candidates candidats.
+			 **/
+			void set_search_mode (	int mode = C_INTEGRODIFF_COARSE_TO_FINE,
+									unsigned int coarse_step = C_INTEGRODIFF_COARSE_STEP,
+									unsigned int nb_candidates = C_INTEGRODIFF_NB_CANDIDATES,
+									bool continuous = false,
+									bool downsample = true );
+			
+			/**@fn
+			 * @param nb_threads : nombre de threads ( 0 : nombre de processeurs )
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon
+			 * @brief
+			 * Nombre de threads de l'évaluation des centres ( 1 par défaut ). Les centres
+			 * d'un même lot ( grille, grille grossière, voisins ) sont répartis entre des
+			 * threads créés une fois pour toutes, chacun avec sa propre mémoire de travail.
+			 **/
+			int set_nb_threads ( unsigned int nb_threads );
 			
 			/**@fn
 			 * @brief
@@ -124,14 +182,187 @@
 			{
 				return _r;
 			}
+			/**@fn
+			 * @brief
+			 * Nombre de transformées polaires de la dernière recherche.
+			 **/
+			inline unsigned int nb_evaluations() const
+			{
+				return _nb_evaluations;
+			}
+			/**@fn
+			 * @brief
+			 * Nombre de transformées polaires de la dernière recherche faites sur l'image
+			 * réduite ( comprises dans nb_evaluations ).
+			 **/
+			inline unsigned int nb_coarse_evaluations() const
+			{
+				return _nb_coarse_evaluations;
+			}
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre de threads.
+			 **/
+			inline unsigned int nb_threads() const
+			{
+				return _nb_threads;
+			}
 			
 		protected:
+			/**@struct
+			 * @brief
+			 * Paramètres d'une recherche ( image + grille des centres ).
+			 **/
+			template <class type> struct circle_search
+			{
+				const type * data;
+				const unsigned char * mask;
+				unsigned int width,
+							 height,
+							 width_step,
+							 mask_width_step,
+							 n_x,
+							 n_y;
+				double x_min,
+					   x_max,
+					   y_min,
+					   y_max,
+					   r_min,
+					   r_max;
+			};
 			
-			void compute_integral( );
+			/**@struct
+			 * @brief
+			 * Mémoire de travail d'un thread : positions d'échantillonnage, image polaire,
+			 * intégrales et dérivées.
+			 **/
+			struct center_scratch
+			{
+				unsigned int nb_samples,
+							 nb_directions;
+				c_polar_table table;
+				IplImage * polar_image,
+						 * polar_mask;
+				double * polar_data;
+				unsigned int polar_image_width_step;
+				unsigned char * polar_mask_data;
+				unsigned int polar_mask_width_step;
+				double * integrals,
+					   * derivates;
+			};
+			
+			/**@fn
+			 * @param sc : mémoire de travail
+			 * @param[out] r : indice du meilleur rayon
+			 * @brief
+			 * Transformée polaire + opérateur en un centre. Renvoie la valeur de l'opérateur.
+			 **/
+			template <class type> double evaluate_center (	center_scratch & sc,
+															unsigned int & r,
+															double x,
+															double y,
+															const circle_search<type> & s );
 			
-			void compute_derivate( );
+			/**@fn
+			 * @param scratch : mémoire de travail ( _scratch ou _coarse_scratch )
+			 * @brief
+			 * Evalue les centres ( _batch_x, _batch_y ) sur tous les threads.
+			 **/
+			template <class type> void evaluate_batch ( const circle_search<type> & s,
+														center_scratch * scratch );
 			
-			unsigned int select_best_radius( );
+			/**@fn
+			 * @param obj : opérateur
+			 * @param id : numéro du thread
+			 * @brief
+			 * Part du lot du thread id ( un centre sur nb_threads ).
+			 **/
+			template <class type> static void evaluate_task ( 	c_integro_differential_operator * obj,
+																unsigned int id );
+			
+			/**@fn
+			 * @param cells : points de la grille ( i * n_y + j )
+			 * @brief
+			 * Evalue en un lot les points de la grille non encore calculés.
+			 **/
+			template <class type> void evaluate_cells (	const vector<unsigned int> & cells,
+														const circle_search<type> & s );
+			
+			/**@fn
+			 * @param s : recherche à pleine résolution
+			 * @param[out] c : même recherche sur l'image réduite ( _coarse_data, _coarse_mask )
+			 * @return
+			 * - 0 si OK
+			 * - 1 si l'image ou l'intervalle des rayons réduits est vide
+			 * @brief
+			 * Réduction de l'image d'un facteur C_INTEGRODIFF_COARSE_SCALE et positions
+			 * d'échantillonnage de la transformée polaire réduite.
+			 **/
+			template <class type> int downsample_image (	const circle_search<type> & s,
+															circle_search<double> & c );
+			
+			/**@fn
+			 * @brief
+			 * Recherche exhaustive sur la grille.
+			 **/
+			template <class type> double exhaustive_search ( const circle_search<type> & s );
+			
+			/**@fn
+			 * @brief
+			 * Recherche grossière puis raffinement des meilleurs candidats.
+			 **/
+			template <class type> double coarse_to_fine_search ( const circle_search<type> & s );
+			
+			/**@fn
+			 * @brief
+			 * Optimisation continue ( recherche par motif ) autour de ( _x, _y ) : déplacement
+			 * vers le premier des 4 voisins qui améliore, comme une évaluation une à une.
+			 **/
+			template <class type> double continuous_search (	double value,
+																const circle_search<type> & s );
+			
+			void compute_integral( center_scratch & sc );
+			
+			void compute_derivate( center_scratch & sc );
+			
+			unsigned int select_best_radius( center_scratch & sc );
+			
+			/**@fn
+			 * @brief
+			 * Alloc. / lib. de la mémoire de travail ( une par thread et par résolution ).
+			 **/
+			void setup_scratch();
+			void free_scratch();
+			center_scratch * alloc_scratch ( 	unsigned int nb_samples,
+												unsigned int nb_directions );
+			void release_scratch ( center_scratch * & scratch );
+			
+			/**@fn
+			 * @brief
+			 * Lance la tâche courante sur tous les threads et attend la fin.
+			 **/
+			void dispatch ( );
+			
+			/**@fn
+			 * @param obj : c_integro_differential_operator
+			 * @param id : numéro du thread
+			 * @brief
+			 * Tâche du pool ( _task_function ).
+			 **/
+			static void pool_task ( 	void * obj,
+										unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * Ini. des threads ( un seul, le thread appelant ).
+			 **/
+			void initialize_threads ( );
+			
+			/**@fn
+			 * @brief
+			 * Arrêt des threads.
+			 **/
+			void stop_threads ( );
 			
 			void free();
 			void initialize();
@@ -142,28 +373,46 @@
 					_r;
 					
 			//Transformée polaire
-			c_polar * polar_obj;
 			unsigned int _nb_directions,
 						 _nb_samples;
-			
-			IplImage * polar_image,
-					 * polar_mask;
-						 
-				double * _polar_data;
-				unsigned int _polar_image_width_step;
-				
-				unsigned char * _polar_mask;
-				unsigned int _polar_mask_width_step;
+			center_scratch 	* _scratch, // nb_threads
+							* _coarse_scratch; // nb_threads, transformée polaire réduite
 			
 			//Noyau gaussian + maximisation
-			double * integrals,
-				   * derivates;
-			
 			double * gaussian_kernel;
 			unsigned int _kernel_size;
 			IplConvKernel * structuring_element_1;
 			
+			//Recherche grossière puis fine
+			int _search_mode;
+			unsigned int _coarse_step,
+						 _nb_candidates;
+			bool 	_continuous,
+					_downsample;
+			unsigned int 	_nb_evaluations,
+							_nb_coarse_evaluations;
+			//Image réduite ( grille grossière )
+			vector<double> _coarse_data;
+			vector<unsigned char> _coarse_mask;
+			//Valeurs ( < 0 : non calculée ) et rayons des points de la grille
+			vector<double> _grid_values;
+			vector<unsigned int> _grid_radii;
+			
+			//Lot de centres à évaluer
+			vector<double> 	_batch_x,
+							_batch_y,
+							_batch_values;
+			vector<unsigned int> _batch_radii,
+								 _batch_cells;
+			
+			//Threads ( le thread appelant traite la part 0 )
+			c_thread_pool _pool;
+			unsigned int _nb_threads; // _pool.nb_threads()
 			
+			//Tâche courante
+			void ( * _task_function ) ( c_integro_differential_operator *, unsigned int );
+			const void * _task_search;
+			center_scratch * _task_scratch;
 	};
 	
 	
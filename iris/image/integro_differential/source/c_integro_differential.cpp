@@ -1,11 +1,12 @@
 #include "c_integro_differential.hpp"
-#include "c_polar.hpp"
+#include "c_polar_table.hpp"
 #include "filter.hpp"
 #include <cmath>
 #include <cstdlib> 
 #include <complex> 
 #include "image_utility.hpp"
 #include <iostream>
+#include <algorithm>
 using namespace std;
 double compute_line_integral (	unsigned int & n_pixel,
 								const double * polar_row,
@@ -25,9 +26,12 @@ double compute_line_integral (	unsigned int & n_pixel,
 	}
 	return value;
 }
+
 c_integro_differential_operator :: c_integro_differential_operator()
 {
 	initialize();
+	initialize_threads();
+	set_search_mode( C_INTEGRODIFF_EXHAUSTIVE );
 }
 
 
@@ -39,6 +43,8 @@ c_integro_differential_operator :: c_integro_differential_operator ( 	unsigned i
 																		unsigned int kernel_size )
 {
 	initialize();
+	initialize_threads();
+	set_search_mode( C_INTEGRODIFF_EXHAUSTIVE );
 	setup ( width,
 			height,
 			nb_directions,
@@ -52,35 +58,12 @@ void c_integro_differential_operator :: setup (	unsigned int width,
 												unsigned int nb_samples,
 												unsigned int kernel_size )
 {
-	unsigned int nb_dir;
-	unsigned int dr_max;
 	free();
 	initialize();
-	dr_max = nb_samples;
-	nb_dir = nb_directions;
-	polar_obj = new c_polar( 	dr_max, 
-								nb_dir );
 
 	_nb_directions = nb_directions;
 	_nb_samples = nb_samples;
 	
-	polar_image = cvCreateImage ( 	cvSize( _nb_directions, _nb_samples ),
-									IPL_DEPTH_64F,
-									1 );
-									
-									
-	_polar_data = ( double * ) polar_image->imageData;
-	_polar_image_width_step = polar_image->widthStep / sizeof ( double );
-	
-	
-	polar_mask = cvCreateImage ( 	cvSize( _nb_directions, _nb_samples ),
-									IPL_DEPTH_8U,
-									1 );
-									
-	_polar_mask = ( unsigned char * ) polar_mask->imageData;
-	_polar_mask_width_step = polar_mask->widthStep;
-	
-	
 	structuring_element_1 = cvCreateStructuringElementEx( 2 * kernel_size + 1,
 														  2 * kernel_size + 1,
 														  kernel_size,
@@ -88,18 +71,6 @@ void c_integro_differential_operator :: setup (	unsigned int width,
 														  CV_SHAPE_ELLIPSE,
 														  NULL);
 	
-	
-	
-	integrals = new double[nb_samples];
-	memset( integrals,
-			0,
-			sizeof(double) * nb_samples );
-			
-	derivates = new double[nb_samples];
-	memset( derivates,
-			0,
-			sizeof(double) * nb_samples );
-			
 	gaussian_kernel = new double[2 * kernel_size + 1];
 	memset( gaussian_kernel,
 			0,
@@ -118,7 +89,74 @@ void c_integro_differential_operator :: setup (	unsigned int width,
 	}
 	gaussian_kernel[ kernel_size ] = 1;
 	
-	
+	//Mémoire de travail des threads
+	setup_scratch();
+}
+
+void c_integro_differential_operator :: setup_scratch()
+{
+	if ( _nb_samples == 0 || _nb_threads == 0 )
+		return;
+	_scratch = alloc_scratch( _nb_samples, _nb_directions );
+	//Transformée polaire réduite ( au moins 3 rayons et 8 directions )
+	if ( 	_nb_samples / C_INTEGRODIFF_COARSE_SCALE >= 3 &&
+			_nb_directions / C_INTEGRODIFF_COARSE_SCALE >= 8 )
+		_coarse_scratch = alloc_scratch( 	_nb_samples / C_INTEGRODIFF_COARSE_SCALE,
+											_nb_directions / C_INTEGRODIFF_COARSE_SCALE );
+}
+
+c_integro_differential_operator :: center_scratch * c_integro_differential_operator :: alloc_scratch ( 	unsigned int nb_samples,
+																										unsigned int nb_directions )
+{
+	center_scratch * scratch = new center_scratch[_nb_threads];
+	for ( unsigned int t = 0; t < _nb_threads; ++ t )
+	{
+		center_scratch & sc = scratch[t];
+		sc.nb_samples = nb_samples;
+		sc.nb_directions = nb_directions;
+		sc.polar_image = cvCreateImage ( 	cvSize( nb_directions, nb_samples ),
+											IPL_DEPTH_64F,
+											1 );
+		sc.polar_data = ( double * ) sc.polar_image->imageData;
+		sc.polar_image_width_step = sc.polar_image->widthStep / sizeof ( double );
+		
+		sc.polar_mask = cvCreateImage ( 	cvSize( nb_directions, nb_samples ),
+											IPL_DEPTH_8U,
+											1 );
+		sc.polar_mask_data = ( unsigned char * ) sc.polar_mask->imageData;
+		sc.polar_mask_width_step = sc.polar_mask->widthStep;
+		
+		sc.integrals = new double[nb_samples];
+		memset( sc.integrals,
+				0,
+				sizeof(double) * nb_samples );
+		sc.derivates = new double[nb_samples];
+		memset( sc.derivates,
+				0,
+				sizeof(double) * nb_samples );
+	}
+	return scratch;
+}
+
+void c_integro_differential_operator :: free_scratch()
+{
+	release_scratch( _scratch );
+	release_scratch( _coarse_scratch );
+}
+
+void c_integro_differential_operator :: release_scratch ( center_scratch * & scratch )
+{
+	if ( scratch == 0 )
+		return;
+	for ( unsigned int t = 0; t < _nb_threads; ++ t )
+	{
+		cvReleaseImage ( &scratch[t].polar_image );
+		cvReleaseImage ( &scratch[t].polar_mask );
+		delete[] scratch[t].integrals;
+		delete[] scratch[t].derivates;
+	}
+	delete[] scratch;
+	scratch = 0;
 }
 
 
@@ -137,70 +175,487 @@ template <class type> double c_integro_differential_operator :: search_best_circ
 																								double r_min,
 																								double r_max )
 {
-
-	
-	
 	double max = 0;
 	_x = 0;
 	_y = 0;
 	_r = 0;
+	_nb_evaluations = 0;
+	_nb_coarse_evaluations = 0;
 	
 	//Test de validité
-	if ( n_x < 2 || n_y < 2 )
+	if ( n_x < 2 || n_y < 2 || _scratch == 0 )
 		return nan("");
 	
+	circle_search<type> s;
+	s.data = data;
+	s.mask = mask;
+	s.width = width;
+	s.height = height;
+	s.width_step = width_step;
+	s.mask_width_step = mask_width_step;
+	s.n_x = n_x;
+	s.n_y = n_y;
+	s.x_min = x_min;
+	s.x_max = x_max;
+	s.y_min = y_min;
+	s.y_max = y_max;
+	s.r_min = r_min;
+	s.r_max = r_max;
+	
+	//Positions d'échantillonnage ( recalculées seulement si les rayons changent )
+	for ( unsigned int t = 0; t < _nb_threads; ++ t )
+		_scratch[t].table.setup( 	_nb_samples,
+									_nb_directions,
+									(unsigned int) r_min,
+									(unsigned int) r_max );
+	
+	if ( _search_mode == C_INTEGRODIFF_COARSE_TO_FINE )
+	{
+		max = coarse_to_fine_search( s );
+		if ( _continuous )
+			max = continuous_search( max, s );
+		return max;
+	}
+	return exhaustive_search( s );
+}
+
+template <class type> double c_integro_differential_operator :: evaluate_center (	center_scratch & sc,
+																					unsigned int & r,
+																					double x,
+																					double y,
+																					const circle_search<type> & s )
+{
+	//Transformée polaire ( directement à la taille nb_samples * nb_directions )
+	sc.table.compute( 	sc.polar_data,
+						sc.polar_mask_data,
+						sc.polar_image_width_step,
+						sc.polar_mask_width_step,
+						x,
+						y,
+						s.data,
+						s.mask,
+						s.width,
+						s.height,
+						s.width_step,
+						s.mask_width_step );
+	//Suppression des zones erronnées (Mask)
+	cvMorphologyEx(	sc.polar_mask,
+					sc.polar_mask,
+					NULL,
+					structuring_element_1,
+					CV_MOP_ERODE,
+					1);
+					
+	compute_integral( sc );
+	compute_derivate( sc );
+	r = select_best_radius( sc );
+	return abs( sc.derivates[r] );
+}
+
+template <class type> void c_integro_differential_operator :: evaluate_task ( 	c_integro_differential_operator * obj,
+																				unsigned int id )
+{
+	const circle_search<type> & s = *( (const circle_search<type> *) obj->_task_search );
+	center_scratch & sc = obj->_task_scratch[id];
+	unsigned int n = obj->_batch_x.size();
+	for ( unsigned int k = id; k < n; k += obj->_nb_threads )
+		obj->_batch_values[k] = obj->evaluate_center( 	sc,
+														obj->_batch_radii[k],
+														obj->_batch_x[k],
+														obj->_batch_y[k],
+														s );
+}
+
+template <class type> void c_integro_differential_operator :: evaluate_batch ( 	const circle_search<type> & s,
+																					center_scratch * scratch )
+{
+	unsigned int n = _batch_x.size();
+	_batch_values.resize( n );
+	_batch_radii.resize( n );
+	_nb_evaluations += n;
+	if ( scratch == _coarse_scratch )
+		_nb_coarse_evaluations += n;
+	if ( n == 0 )
+		return;
+	_task_search = &s;
+	_task_scratch = scratch;
+	_task_function = &evaluate_task<type>;
+	dispatch();
+}
+
+template <class type> void c_integro_differential_operator :: evaluate_cells (	const vector<unsigned int> & cells,
+																					const circle_search<type> & s )
+{
+	_batch_x.clear();
+	_batch_y.clear();
+	_batch_cells.clear();
+	for ( unsigned int k = 0; k < cells.size(); ++ k )
+	{
+		unsigned int c = cells[k];
+		if ( _grid_values[c] != -1 )
+			continue;
+		_grid_values[c] = -2; // En cours ( pas de doublon dans le lot )
+		_batch_cells.push_back( c );
+		_batch_x.push_back( s.x_min + ( c / s.n_y ) * ( s.x_max - s.x_min ) / ( s.n_x - 1 ) );
+		_batch_y.push_back( s.y_min + ( c % s.n_y ) * ( s.y_max - s.y_min ) / ( s.n_y - 1 ) );
+	}
+	evaluate_batch( s, _scratch );
+	for ( unsigned int k = 0; k < _batch_cells.size(); ++ k )
+	{
+		_grid_values[ _batch_cells[k] ] = _batch_values[k];
+		_grid_radii[ _batch_cells[k] ] = _batch_radii[k];
+	}
+}
+
+template <class type> int c_integro_differential_operator :: downsample_image (	const circle_search<type> & s,
+																					circle_search<double> & c )
+{
+	const unsigned int scale = C_INTEGRODIFF_COARSE_SCALE;
+	c.width = s.width / scale;
+	c.height = s.height / scale;
+	c.r_min = (unsigned int) ( s.r_min / scale );
+	c.r_max = (unsigned int) ( s.r_max / scale );
+	if ( c.width == 0 || c.height == 0 || c.r_max <= c.r_min )
+		return 1;
+	
+	//Moyenne des blocs, pixel valide si tout le bloc l'est
+	_coarse_data.resize( c.width * c.height );
+	_coarse_mask.resize( c.width * c.height );
+	for ( unsigned int v = 0; v < c.height; ++ v )
+	{
+		for ( unsigned int u = 0; u < c.width; ++ u )
+		{
+			double sum = 0;
+			bool valid = true;
+			for ( unsigned int i = v * scale; i < ( v + 1 ) * scale; ++ i )
+			{
+				for ( unsigned int j = u * scale; j < ( u + 1 ) * scale; ++ j )
+				{
+					sum += s.data[ i * s.width_step + j ];
+					valid = valid && s.mask[ i * s.mask_width_step + j ];
+				}
+			}
+			_coarse_data[ v * c.width + u ] = sum / ( scale * scale );
+			_coarse_mask[ v * c.width + u ] = ( valid ) ? 255 : 0;
+		}
+	}
+	c.data = &_coarse_data[0];
+	c.mask = &_coarse_mask[0];
+	c.width_step = c.width;
+	c.mask_width_step = c.width;
+	
+	//Même grille ( le bloc u est centré en scale * u + ( scale - 1 ) / 2 )
+	c.n_x = s.n_x;
+	c.n_y = s.n_y;
+	c.x_min = ( s.x_min - ( scale - 1 ) / 2.0 ) / scale;
+	c.x_max = ( s.x_max - ( scale - 1 ) / 2.0 ) / scale;
+	c.y_min = ( s.y_min - ( scale - 1 ) / 2.0 ) / scale;
+	c.y_max = ( s.y_max - ( scale - 1 ) / 2.0 ) / scale;
+	
+	for ( unsigned int t = 0; t < _nb_threads; ++ t )
+		_coarse_scratch[t].table.setup( 	_coarse_scratch[t].nb_samples,
+											_coarse_scratch[t].nb_directions,
+											(unsigned int) c.r_min,
+											(unsigned int) c.r_max );
+	return 0;
+}
+
+template <class type> double c_integro_differential_operator :: exhaustive_search ( const circle_search<type> & s )
+{
+	unsigned int n_x = s.n_x,
+				 n_y = s.n_y;
+	_grid_values.assign( n_x * n_y, -1 );
+	_grid_radii.assign( n_x * n_y, 0 );
+	
+	vector<unsigned int> cells( n_x * n_y );
+	for ( unsigned int c = 0; c < n_x * n_y; ++ c )
+		cells[c] = c;
+	evaluate_cells( cells, s );
+	
+	double max = 0;
 	for ( unsigned int i = 0; i < n_x; ++ i ) 
 	{
-		double x = x_min + i * (x_max - x_min ) / ( n_x - 1 );
 		for ( unsigned int j = 0; j < n_y; ++ j ) 
 		{
-			double y = y_min + j * (y_max - y_min ) / ( n_y - 1 );
-			unsigned int r = 0;
-			//Transformée polaire
-			polar_obj->compute( x, 
-								y, 
-								_nb_samples, 
-								_nb_directions, 
-								r_min, 
-								r_max,  
-								data,
-								mask,
-								width,
-								height,
-								width_step,
-								mask_width_step );
-								
-			polar_obj->resize( 	_polar_data,
-								_polar_mask,
-								_nb_samples,
-								_nb_directions,
-								_polar_image_width_step,
-								_polar_mask_width_step );
-			//Suppression des zones erronnées (Mask)
-			cvMorphologyEx(	polar_mask,
-							polar_mask,
-							NULL,
-							structuring_element_1,
-							CV_MOP_ERODE,
-							1);
-							
-			compute_integral();
-			compute_derivate();
-			r = select_best_radius();
-			if ( abs(derivates[r]) > max )
+			unsigned int c = i * n_y + j;
+			if ( _grid_values[c] > max )
 			{
-				_x = x;
-				_y = y;
-				_r = ( (double) r ) / (_nb_samples - 1) * (r_max - r_min) + r_min;
-				max = derivates[r];
+				_x = s.x_min + i * ( s.x_max - s.x_min ) / ( n_x - 1 );
+				_y = s.y_min + j * ( s.y_max - s.y_min ) / ( n_y - 1 );
+				_r = ( (double) _grid_radii[c] ) / (_nb_samples - 1) * ( s.r_max - s.r_min ) + s.r_min;
+				max = _grid_values[c];
 			}
-
-			
 		}
 	}
 	return max;
+}
+
+template <class type> double c_integro_differential_operator :: coarse_to_fine_search ( const circle_search<type> & s )
+{
+	unsigned int n_x = s.n_x,
+				 n_y = s.n_y;
+	_grid_values.assign( n_x * n_y, -1 );
+	_grid_radii.assign( n_x * n_y, 0 );
+	
+	unsigned int step = _coarse_step,
+				 nb_candidates = _nb_candidates;
+	if ( step == 0 )
+		step = 1;
+	if ( step > std::max( n_x, n_y ) - 1 )
+		step = std::max( n_x, n_y ) - 1;
+	if ( nb_candidates == 0 )
+		nb_candidates = 1;
+	
+	//Grille grossière ( le dernier point de chaque axe est toujours inclus )
+	vector<unsigned int> cells;
+	for ( unsigned int i = 0; i < n_x; i = ( i + 1 == n_x ) ? n_x : std::min( i + step, n_x - 1 ) )
+		for ( unsigned int j = 0; j < n_y; j = ( j + 1 == n_y ) ? n_y : std::min( j + step, n_y - 1 ) )
+			cells.push_back( i * n_y + j );
+	vector<double> coarse_values( cells.size() );
+	circle_search<double> c;
+	bool downsampled = _downsample && _coarse_scratch && ! downsample_image( s, c );
+	if ( downsampled )
+	{
+		//Sur l'image réduite ( valeurs seulement comparées entre elles )
+		_batch_x.clear();
+		_batch_y.clear();
+		for ( unsigned int l = 0; l < cells.size(); ++ l )
+		{
+			_batch_x.push_back( c.x_min + ( cells[l] / n_y ) * ( c.x_max - c.x_min ) / ( n_x - 1 ) );
+			_batch_y.push_back( c.y_min + ( cells[l] % n_y ) * ( c.y_max - c.y_min ) / ( n_y - 1 ) );
+		}
+		evaluate_batch( c, _coarse_scratch );
+		coarse_values = _batch_values;
+	}
+	else
+	{
+		evaluate_cells( cells, s );
+		for ( unsigned int l = 0; l < cells.size(); ++ l )
+			coarse_values[l] = _grid_values[ cells[l] ];
+	}
+	
+	//Candidats triés par valeur décroissante, séparés d'au moins un pas
+	vector<unsigned int> c_i,
+						 c_j;
+	vector<double> c_v;
+	for ( unsigned int l = 0; l < cells.size(); ++ l )
+	{
+		unsigned int i = cells[l] / n_y,
+					 j = cells[l] % n_y;
+		double v = coarse_values[l];
+		
+		//Voisin meilleur ou égal déjà retenu
+		bool dominated = false;
+		for ( unsigned int k = 0; k < c_v.size() && ! dominated; ++ k )
+		{
+			if ( c_v[k] >= v &&
+				 (unsigned int) abs( (int) c_i[k] - (int) i ) <= step &&
+				 (unsigned int) abs( (int) c_j[k] - (int) j ) <= step )
+				dominated = true;
+		}
+		if ( dominated )
+			continue;
+		
+		//Suppression des voisins moins bons
+		for ( unsigned int k = 0; k < c_v.size(); )
+		{
+			if ( (unsigned int) abs( (int) c_i[k] - (int) i ) <= step &&
+				 (unsigned int) abs( (int) c_j[k] - (int) j ) <= step )
+			{
+				c_i.erase( c_i.begin() + k );
+				c_j.erase( c_j.begin() + k );
+				c_v.erase( c_v.begin() + k );
+			}
+			else
+				++ k;
+		}
+		
+		//Insertion ( à égalité, le premier parcouru reste devant )
+		unsigned int k = 0;
+		while ( k < c_v.size() && c_v[k] >= v )
+			++ k;
+		if ( k >= nb_candidates )
+			continue;
+		c_i.insert( c_i.begin() + k, i );
+		c_j.insert( c_j.begin() + k, j );
+		c_v.insert( c_v.begin() + k, v );
+		if ( c_v.size() > nb_candidates )
+		{
+			c_i.pop_back();
+			c_j.pop_back();
+			c_v.pop_back();
+		}
+	}
 	
+	//Candidats à pleine résolution
+	if ( downsampled )
+	{
+		cells.clear();
+		for ( unsigned int k = 0; k < c_v.size(); ++ k )
+			cells.push_back( c_i[k] * n_y + c_j[k] );
+		evaluate_cells( cells, s );
+		for ( unsigned int k = 0; k < c_v.size(); ++ k )
+			c_v[k] = _grid_values[ cells[k] ];
+	}
+	
+	//Raffinement : montée locale sur les 8 voisins ( évalués en un lot ), pas divisé par 2
+	double max = -1;
+	unsigned int best_i = 0,
+				 best_j = 0;
+	for ( unsigned int k = 0; k < c_v.size(); ++ k )
+	{
+		unsigned int i = c_i[k],
+					 j = c_j[k];
+		double v = c_v[k];
+		for ( unsigned int d = step; d > 0; d /= 2 )
+		{
+			bool moved = true;
+			while ( moved )
+			{
+				moved = false;
+				cells.clear();
+				for ( int di = -1; di <= 1; ++ di )
+				{
+					if ( ( di < 0 && i < d ) || ( di > 0 && i + d >= n_x ) )
+						continue;
+					for ( int dj = -1; dj <= 1; ++ dj )
+					{
+						if ( ( di == 0 && dj == 0 ) || ( dj < 0 && j < d ) || ( dj > 0 && j + d >= n_y ) )
+							continue;
+						cells.push_back( ( i + di * (int) d ) * n_y + j + dj * (int) d );
+					}
+				}
+				evaluate_cells( cells, s );
+				
+				unsigned int c_best = i * n_y + j;
+				for ( unsigned int l = 0; l < cells.size(); ++ l )
+				{
+					if ( _grid_values[ cells[l] ] > v )
+					{
+						v = _grid_values[ cells[l] ];
+						c_best = cells[l];
+						moved = true;
+					}
+				}
+				i = c_best / n_y;
+				j = c_best % n_y;
+			}
+		}
+		if ( v > max )
+		{
+			max = v;
+			best_i = i;
+			best_j = j;
+		}
+	}
 	
+	_x = s.x_min + best_i * ( s.x_max - s.x_min ) / ( n_x - 1 );
+	_y = s.y_min + best_j * ( s.y_max - s.y_min ) / ( n_y - 1 );
+	_r = ( (double) _grid_radii[ best_i * n_y + best_j ] ) / (_nb_samples - 1) * ( s.r_max - s.r_min ) + s.r_min;
+	return max;
+}
+
+template <class type> double c_integro_differential_operator :: continuous_search (	double value,
+																						const circle_search<type> & s )
+{
+	double d_x = ( s.x_max - s.x_min ) / ( s.n_x - 1 ) / 2,
+		   d_y = ( s.y_max - s.y_min ) / ( s.n_y - 1 ) / 2;
+	static const int dirs[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+	vector<unsigned int> dir_ids;
+	for ( unsigned int l = 0; l < C_INTEGRODIFF_NB_CONTINUOUS_LEVELS; ++ l )
+	{
+		bool moved = true;
+		while ( moved )
+		{
+			//Passe sur les 4 directions, déplacement dès qu'un voisin améliore.
+			//Les directions restantes sont évaluées en un lot ; après un déplacement,
+			//les suivantes repartent de la nouvelle position ( même parcours qu'une
+			//évaluation une à une ).
+			moved = false;
+			unsigned int k_0 = 0;
+			while ( k_0 < 4 )
+			{
+				_batch_x.clear();
+				_batch_y.clear();
+				dir_ids.clear();
+				for ( unsigned int k = k_0; k < 4; ++ k )
+				{
+					double x = _x + dirs[k][0] * d_x,
+						   y = _y + dirs[k][1] * d_y;
+					if ( x < std::min( s.x_min, s.x_max ) || x > std::max( s.x_min, s.x_max ) ||
+						 y < std::min( s.y_min, s.y_max ) || y > std::max( s.y_min, s.y_max ) )
+						continue;
+					_batch_x.push_back( x );
+					_batch_y.push_back( y );
+					dir_ids.push_back( k );
+				}
+				evaluate_batch( s, _scratch );
+				
+				unsigned int first = 0;
+				while ( first < _batch_x.size() && ! ( _batch_values[first] > value ) )
+					++ first;
+				if ( first == _batch_x.size() )
+					break;
+				value = _batch_values[first];
+				_x = _batch_x[first];
+				_y = _batch_y[first];
+				_r = ( (double) _batch_radii[first] ) / (_nb_samples - 1) * ( s.r_max - s.r_min ) + s.r_min;
+				moved = true;
+				k_0 = dir_ids[first] + 1;
+			}
+		}
+		d_x /= 2;
+		d_y /= 2;
+	}
+	return value;
+}
+
+void c_integro_differential_operator :: set_search_mode (	int mode,
+															unsigned int coarse_step,
+															unsigned int nb_candidates,
+															bool continuous,
+															bool downsample )
+{
+	_search_mode = mode;
+	_coarse_step = coarse_step;
+	_nb_candidates = nb_candidates;
+	_continuous = continuous;
+	_downsample = downsample;
+}
+
+int c_integro_differential_operator :: set_nb_threads ( unsigned int nb_threads )
+{
+	free_scratch();
+	int ret = _pool.setup( nb_threads, NULL );
+	_nb_threads = _pool.nb_threads();
+	setup_scratch();
+	return ret;
+}
+
+void c_integro_differential_operator :: dispatch ( )
+{
+	_pool.run( pool_task, this );
+}
+
+void c_integro_differential_operator :: pool_task ( 	void * obj,
+														unsigned int id )
+{
+	c_integro_differential_operator * op = (c_integro_differential_operator *) obj;
+	op->_task_function( op, id );
+}
+
+void c_integro_differential_operator :: initialize_threads ( )
+{
+	_nb_threads = 0;
+	_task_function = 0;
+	_task_search = 0;
+	_task_scratch = 0;
+	set_nb_threads( 1 );
+}
+
+void c_integro_differential_operator :: stop_threads ( )
+{
+	_pool.stop();
 }
 
 double c_integro_differential_operator :: search_best_circle_params (	const IplImage * image,
@@ -466,17 +921,19 @@ c_integro_differential_operator :: ~c_integro_differential_operator()
 {
 	free();
 	initialize();
+	stop_threads();
 }
 
-void c_integro_differential_operator :: compute_integral()
+void c_integro_differential_operator :: compute_integral( center_scratch & sc )
 {
 	double * polar_row;
 	unsigned char * polar_mask_row;
-	for ( unsigned  i = 0; i < _nb_samples; ++ i)
+	unsigned int nb_directions = sc.nb_directions;
+	for ( unsigned  i = 0; i < sc.nb_samples; ++ i)
 	{
 		unsigned int nb_pixels = 0;
-		polar_row = _polar_data + i * _polar_image_width_step;
-		polar_mask_row = _polar_mask + i * _polar_mask_width_step;
+		polar_row = sc.polar_data + i * sc.polar_image_width_step;
+		polar_mask_row = sc.polar_mask_data + i * sc.polar_mask_width_step;
 		
 		//~ integrals[i] = compute_line_integral ( polar_row,
 											   //~ polar_mask_row,
@@ -485,40 +942,40 @@ void c_integro_differential_operator :: compute_integral()
 									   
 		
 		///Lignes suivantes inutiles vue la nature de l'opérateur intégro diff + détection "grossière"
-		integrals[i] = compute_line_integral ( 	nb_pixels,
+		sc.integrals[i] = compute_line_integral ( 	nb_pixels,
 												polar_row,
 												polar_mask_row ,
 												0,
-												_nb_directions / 8 );
+												nb_directions / 8 );
 											   
-		integrals[i] += compute_line_integral (	nb_pixels,
+		sc.integrals[i] += compute_line_integral (	nb_pixels,
 												polar_row,
 												polar_mask_row,
-												( 3 * _nb_directions ) / 8,
-												( 5 * _nb_directions ) / 8 );						   
+												( 3 * nb_directions ) / 8,
+												( 5 * nb_directions ) / 8 );						   
 										   
-		integrals[i] += compute_line_integral (	nb_pixels,
+		sc.integrals[i] += compute_line_integral (	nb_pixels,
 												polar_row,
 												polar_mask_row,
-												( 7 * _nb_directions ) / 8,
-												_nb_directions );
-			integrals[i] /= 2 * ( ( double ) _nb_directions ) / ( nb_pixels  );
+												( 7 * nb_directions ) / 8,
+												nb_directions );
+			sc.integrals[i] /= 2 * ( ( double ) nb_directions ) / ( nb_pixels  );
 	}
 	
 }
 
 
-void c_integro_differential_operator :: compute_derivate( )
+void c_integro_differential_operator :: compute_derivate( center_scratch & sc )
 {
-	unsigned int end = _nb_samples - 1;
+	unsigned int end = sc.nb_samples - 1;
 	for ( unsigned int i = 0; i < end; ++ i )
 	{
-		integrals[i] = integrals[ i + 1 ] - integrals[ i ];
+		sc.integrals[i] = sc.integrals[ i + 1 ] - sc.integrals[ i ];
 	}
 	
 	//Application du noyeau gaussien
-	filter_1d ( derivates,
-				integrals,
+	filter_1d ( sc.derivates,
+				sc.integrals,
 				end,
 				gaussian_kernel,
 				2 * _kernel_size + 1 );
@@ -526,21 +983,21 @@ void c_integro_differential_operator :: compute_derivate( )
 
 }
 
-unsigned int c_integro_differential_operator :: select_best_radius( )
+unsigned int c_integro_differential_operator :: select_best_radius( center_scratch & sc )
 {
 	double value = 0;
 	unsigned int r;
-	unsigned int end = _nb_samples - 1;
+	unsigned int end = sc.nb_samples - 1;
 	//Recherche du max de la dérivée
-	value = derivates[0];
+	value = sc.derivates[0];
 	r = 0;
 	for ( unsigned int i = 1; i < end; ++ i )
 	{
-		derivates[i] = abs( derivates[i] );
-		if ( value < derivates[i] )
+		sc.derivates[i] = abs( sc.derivates[i] );
+		if ( value < sc.derivates[i] )
 		{
 			r = i;
-		    value = derivates[i];
+		    value = sc.derivates[i];
 		}
 	}
 	return r;
@@ -548,16 +1005,7 @@ unsigned int c_integro_differential_operator :: select_best_radius( )
 
 void c_integro_differential_operator :: free()
 {
-	if ( polar_obj )
-		delete polar_obj;
-	if ( polar_image )
-		cvReleaseImage ( &polar_image);
-	if ( polar_mask )
-		cvReleaseImage ( &polar_mask);
-	if ( integrals )
-		delete[] integrals;
-	if ( derivates )
-		delete[] derivates;
+	free_scratch();
 	if ( gaussian_kernel )
 		delete[] gaussian_kernel;
 	if ( structuring_element_1 )
@@ -571,20 +1019,21 @@ void c_integro_differential_operator :: initialize()
 	_r = 0;
 					
 			//Transformée polaire
-	polar_obj = 0;
 	_nb_directions = 0;
 	_nb_samples = 0;
-	_polar_data = 0;
-	_polar_mask = 0;
-	polar_mask = 0;
-	polar_image = 0;
+	_scratch = 0;
+	_coarse_scratch = 0;
 	structuring_element_1 = 0;
 			//Noyau gaussian + maximisation
-	integrals = 0;
-	derivates = 0;
-			
 	gaussian_kernel = 0;
 	_kernel_size = 0;
+	
+	_nb_evaluations = 0;
+	_nb_coarse_evaluations = 0;
+	_grid_values.clear();
+	_coarse_data.clear();
+	_coarse_mask.clear();
+	_grid_radii.clear();
 }
 
 C_INTEGRODIFF_SEARCH_CIRCLE(unsigned char)
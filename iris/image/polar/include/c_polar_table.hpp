@@ -0,0 +1,126 @@
+/**@file c_polar_table.hpp
+ * @author Valérian Némesin
+ * @brief
+ * Transformée polaire à partir de positions d'échantillonnage précalculées.
+ *
+ */
+#ifndef _C_POLAR_TABLE_HPP_
+	#define _C_POLAR_TABLE_HPP_
+	#include "interpol_2d.hpp"
+	#define C_POLAR_TABLE_DEF(type) template void c_polar_table :: compute (	double * p_data,\
+																				unsigned char * p_mask,\
+																				unsigned int p_img_width_step,\
+																				unsigned int p_mask_width_step,\
+																				const double & x_center,\
+																				const double & y_center,\
+																				const type * img_data,\
+																				const unsigned char * img_mask,\
+																				unsigned int width,\
+																				unsigned int height,\
+																				unsigned int width_step,\
+																				unsigned int mask_width_step );
+
+	/**@class
+	 * @brief
+	 * Cette classe réalise la transformée polaire d'une image ( comme image_2_polar )
+	 * en un grand nombre de centres. Les positions relatives des échantillons ne
+	 * dépendent que de ( nb_radii, nb_dir, r_min, r_max ) : elles sont calculées une
+	 * fois par setup ( plus de cos / sin par centre ). L'interpolation est celle de
+	 * interpol_2d, avec les mêmes arrondis : même résultat que c_polar::compute
+	 * ( vérification : App check_polar_table ).
+	 *
+	 */
+	class c_polar_table
+	{
+		public:
+			/**@fn
+			 * @brief
+			 * Constructeur
+			 *
+			 **/
+			c_polar_table ( void );
+
+			/**@fn
+			 * @param nb_radii : nombre de rayons
+			 * @param nb_dir : nombre de directions
+			 * @param r_min : rayon min
+			 * @param r_max : rayon max
+			 * @brief
+			 * Calcul des positions relatives ( rien si la configuration n'a pas changé ).
+			 *
+			 **/
+			void setup ( 	unsigned int nb_radii,
+							unsigned int nb_dir,
+							unsigned int r_min,
+							unsigned int r_max );
+
+			/**@fn
+			 * @param p_data : pixels de la transformée polaire ( nb_radii lignes, nb_dir colonnes )
+			 * @param p_mask : masque de la transformée polaire
+			 * @param x_center : abscisse du centre de la transformée polaire
+			 * @param y_center : ordonnée du centre de la transformée polaire
+			 * @param img_data : pixels de l'image
+			 * @param img_mask : masque de l'image
+			 * @param width : largeur de l'image
+			 * @param height : hauteur de l'image
+			 * @param width_step : taille réelle d'une ligne de l'image.
+			 * @brief
+			 * Cette fonction calcule la transformée polaire de l'image.
+			 *
+			 **/
+			template <class type> void compute ( 	double * p_data,
+													unsigned char * p_mask,
+													unsigned int p_img_width_step,
+													unsigned int p_mask_width_step,
+													const double & x_center,
+													const double & y_center,
+													const type * img_data,
+													const unsigned char * img_mask,
+													unsigned int width,
+													unsigned int height,
+													unsigned int width_step,
+													unsigned int mask_width_step );
+
+			/**@fn
+			 * @brief
+			 * Destructeur
+			 *
+			 */
+			~c_polar_table();
+
+		//Accesseurs
+			inline unsigned int nb_radii() const
+			{
+				return _nb_radii;
+			}
+			inline unsigned int nb_directions() const
+			{
+				return _nb_dir;
+			}
+
+		protected:
+			/**@fn
+			 * @brief
+			 * Tout à zéro
+			 *
+			 **/
+			void initialize();
+			/**@fn
+			 * @brief
+			 * Lib. mémoire
+			 *
+			 **/
+			void free();
+
+			//Configuration
+			unsigned int _nb_radii,
+						 _nb_dir,
+						 _r_min,
+						 _r_max;
+
+			//Positions relatives des échantillons ( nb_radii * nb_dir )
+			double 	* _x_offsets,
+					* _y_offsets;
+	};
+
+#endif
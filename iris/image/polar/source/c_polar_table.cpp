@@ -0,0 +1,155 @@
+#include "c_polar_table.hpp"
+#include <cmath>
+
+c_polar_table :: c_polar_table ( void )
+{
+	initialize();
+}
+
+void c_polar_table :: setup ( 	unsigned int nb_radii,
+								unsigned int nb_dir,
+								unsigned int r_min,
+								unsigned int r_max )
+{
+	if ( _x_offsets &&
+		 nb_radii == _nb_radii &&
+		 nb_dir == _nb_dir &&
+		 r_min == _r_min &&
+		 r_max == _r_max )
+		return;
+	free();
+	initialize();
+
+	_nb_radii = nb_radii;
+	_nb_dir = nb_dir;
+	_r_min = r_min;
+	_r_max = r_max;
+	_x_offsets = new double[nb_radii * nb_dir];
+	_y_offsets = new double[nb_radii * nb_dir];
+
+	//Mêmes pas ( et mêmes arrondis ) que image_2_polar
+	double 	r,
+			theta,
+			r_step = ( r_max - r_min) / ( (double) nb_radii ),
+			theta_step = 2 * M_PI / nb_dir;
+	r = r_min;
+	for ( unsigned int i = 0; i < nb_radii; ++ i )
+	{
+		theta = 0;
+		for ( unsigned int j = 0; j < nb_dir; ++ j )
+		{
+			_x_offsets[ i * nb_dir + j ] = r * cos(theta);
+			_y_offsets[ i * nb_dir + j ] = r * sin(theta);
+			theta += theta_step;
+		}
+		r += r_step;
+	}
+}
+
+template <class type> void c_polar_table :: compute ( 	double * p_data,
+														unsigned char * p_mask,
+														unsigned int p_img_width_step,
+														unsigned int p_mask_width_step,
+														const double & x_center,
+														const double & y_center,
+														const type * img_data,
+														const unsigned char * img_mask,
+														unsigned int width,
+														unsigned int height,
+														unsigned int width_step,
+														unsigned int mask_width_step )
+{
+	for ( unsigned int i = 0; i < _nb_radii; ++ i )
+	{
+		double * p_row = p_data + i * p_img_width_step;
+		unsigned char * m_row = p_mask + i * p_mask_width_step;
+		const double 	* x_offset = _x_offsets + i * _nb_dir,
+						* y_offset = _y_offsets + i * _nb_dir;
+		for ( unsigned int j = 0; j < _nb_dir; ++ j )
+		{
+			//Mêmes opérations, dans le même ordre, que image_2_polar + interpol_2d
+			double 	x = x_offset[j] + x_center,
+					y = y_offset[j] + y_center;
+			long long 	x_0 = (long long) x,
+						y_0 = (long long) y;
+			double 	dx = x - x_0,
+					dy = y - y_0,
+					value = 0,
+					sum_coef = 0,
+					coef;
+
+			if ( check_pixel( x_0, y_0, img_mask, width, height, mask_width_step ) )
+			{
+				coef = ( 1 - dx ) * ( 1 - dy );
+				value += coef * img_data[ x_0 + y_0 * width_step ];
+				sum_coef += coef;
+			}
+			if ( check_pixel( x_0 + 1, y_0, img_mask, width, height, mask_width_step ) )
+			{
+				coef = dx * ( 1 - dy );
+				value += coef * img_data[ x_0 + 1 + y_0 * width_step ];
+				sum_coef += coef;
+			}
+			if ( check_pixel( x_0, y_0 + 1, img_mask, width, height, mask_width_step ) )
+			{
+				coef = ( 1 - dx ) * dy;
+				value += coef * img_data[ x_0 + ( y_0 + 1 ) * width_step ];
+				sum_coef += coef;
+			}
+			if ( check_pixel( x_0 + 1, y_0 + 1, img_mask, width, height, mask_width_step ) )
+			{
+				coef = dx * dy;
+				value += coef * img_data[ x_0 + 1 + ( y_0 + 1 ) * width_step ];
+				sum_coef += coef;
+			}
+
+			//Validité de la transformée polaire
+			if ( sum_coef == 0 )
+			{
+				p_row[j] = 0;
+				m_row[j] = 0;
+			}
+			else
+			{
+				m_row[j] = 255;
+				p_row[j] = value / sum_coef;
+			}
+		}
+	}
+}
+
+c_polar_table :: ~c_polar_table()
+{
+	free();
+	initialize();
+}
+
+void c_polar_table :: initialize()
+{
+	_nb_radii = 0;
+	_nb_dir = 0;
+	_r_min = 0;
+	_r_max = 0;
+	_x_offsets = 0;
+	_y_offsets = 0;
+}
+
+void c_polar_table :: free()
+{
+	if ( _x_offsets )
+		delete[] _x_offsets;
+	if ( _y_offsets )
+		delete[] _y_offsets;
+}
+
+C_POLAR_TABLE_DEF(unsigned char)
+C_POLAR_TABLE_DEF(char)
+
+C_POLAR_TABLE_DEF(unsigned short int)
+C_POLAR_TABLE_DEF(short int)
+
+C_POLAR_TABLE_DEF(unsigned long int)
+C_POLAR_TABLE_DEF(long int)
+
+C_POLAR_TABLE_DEF(float)
+C_POLAR_TABLE_DEF(double)
@@ -12,13 +12,73 @@
 	#include <stdexcept>
 	#include <cstring>
 	#include <cmath>
+	#include <vector>
+	#include <fftw3.h>
+	#include "../../utilities/lib_utilities.hpp"
 	using namespace std;
 	
+	//Engines
+	#define RADON_SCATTER 0 // 2x2 sub-pixels scattered into the transform ( reference )
+	#define RADON_GATHER 1 // Same sums, angles shared between threads, per-angle histogram
+	#define RADON_FFT 2 // Projection-slice theorem ( 2-D FFT + polar resampling ), experimental
+	
+	//Zero-padding factor of the 2-D FFT ( RADON_FFT )
+	#define RADON_FFT_OVERSAMPLING 2
+	//Width of the Kaiser-Bessel interpolation kernel ( grid cells, even )
+	#define RADON_FFT_KERNEL_WIDTH 4
+	//Samples of the kernel table per grid cell
+	#define RADON_FFT_KERNEL_TABLE 512
+	//Aliases of the RADON_SCATTER kernel added on each side of a slice
+	#define RADON_FFT_NB_ALIASES 1
+	
+	//Points processed at once by the RADON_GATHER kernel
+	#define RADON_CHUNK 256
+	
+	//Kernels of RADON_GATHER ( bins and weights of a chunk, set_gather_kernel )
+	#define RADON_KERNEL_AUTO 0 // Best kernel supported by the CPU ( default )
+	#define RADON_KERNEL_SCALAR 1
+	#define RADON_KERNEL_SSE2 2 // 2 points per instruction
+	#define RADON_KERNEL_AVX2 3 // 4 points per instruction
+	
+	//Thread tasks
+	#define RADON_TASK_GATHER 0
+	#define RADON_TASK_FFT 1
+	
+	/**
+	 * RADON_GATHER kernel : bins ( r_low ) and weights of the lower bin ( pixel_low ) of
+	 * nb sub-pixels ( x, y, w ) for one angle.
+	 **/
+	typedef void ( * gather_bins_prototype ) ( 	const double * x,
+												const double * y,
+												const double * w,
+												unsigned int nb,
+												double cosinus,
+												double sinus,
+												double r_size,
+												int * r_low,
+												double * pixel_low );
+	
 	
 	/**@class
 	 * @brief
 	 * This class is required for Radon's transformation computation.
 	 * 
+	 * Three engines share the same interface ( set_mode ):
+	 * - RADON_SCATTER : reference engine;
+	 * - RADON_GATHER : non-zero sub-pixels are listed once, then each thread builds
+	 *   whole angles in its own contiguous histogram ( no write conflicts ). Bins are
+	 *   summed in the same order as RADON_SCATTER. Bins and weights are computed by a
+	 *   SSE2 or AVX2 kernel chosen at run time ( same results as the scalar kernel );
+	 * - RADON_FFT ( experimental ) : each projection is the inverse 1-D FFT of a central
+	 *   slice of the 2-D FFT of the image, filtered by the sub-pixel and linear
+	 *   interpolation kernel of RADON_SCATTER. The slice is interpolated with a
+	 *   Kaiser-Bessel kernel ( image divided by its Fourier transform before the FFT ),
+	 *   and the RADON_FFT_NB_ALIASES aliases of the RADON_SCATTER kernel on each side are
+	 *   added. Approximate : relative L2 error against RADON_SCATTER below 2 % on
+	 *   synthetic images ( up to 18 % with bilinear interpolation and no alias ), see
+	 *   App check_radon. Never selected by default.
+	 * 
+	 * Library only : no .cfg key selects the engine or the number of threads.
 	 * 
 	 **/
 	class c_radon
@@ -80,6 +140,53 @@
 			 **/
 			int compute_transform ( const IplImage * image,
 									unsigned int nb_theta );
+			
+			/**@fn
+			 * @param mode : RADON_SCATTER ( default ), RADON_GATHER or RADON_FFT ( experimental )
+			 * @brief
+			 * Engine of compute_transform.
+			 * 
+			 **/
+			int set_mode ( int mode );
+			
+			/**@fn
+			 * @param nb_threads : number of threads ( 0 : number of CPUs )
+			 * @return
+			 * - 0 if OK
+			 * - 1 otherwise
+			 * @brief
+			 * Number of threads of the RADON_GATHER and RADON_FFT engines ( 1 by default ).
+			 * Threads are created once, the calling thread takes part.
+			 * 
+			 **/
+			int set_nb_threads ( unsigned int nb_threads );
+			
+			/**@fn
+			 * @param kernel : RADON_KERNEL_AUTO, RADON_KERNEL_SCALAR, RADON_KERNEL_SSE2 or RADON_KERNEL_AVX2
+			 * @return
+			 * - 0 if OK
+			 * - 1 if the CPU does not support the kernel ( kernel unchanged )
+			 * @brief
+			 * Kernel of the RADON_GATHER engine ( RADON_KERNEL_AUTO by default ).
+			 * 
+			 **/
+			int set_gather_kernel ( int kernel );
+			
+			/**@fn
+			 * @param kernel : RADON_KERNEL_*
+			 * @return
+			 * true if the CPU supports the kernel
+			 * 
+			 **/
+			static bool gather_kernel_supported ( int kernel );
+			
+			/**@fn
+			 * @param kernel : RADON_KERNEL_*
+			 * @return
+			 * name of the kernel
+			 * 
+			 **/
+			static const char * gather_kernel_name ( int kernel );
 		
 
 			/**@fn
@@ -141,6 +248,36 @@
 				return _nb_thetas;
 			}
 			
+			/**@fn
+			 * @return
+			 * engine
+			 * 
+			 **/
+			inline int mode() const
+			{
+				return _mode;
+			}
+			
+			/**@fn
+			 * @return
+			 * number of threads
+			 * 
+			 **/
+			inline unsigned int nb_threads() const
+			{
+				return _nb_threads;
+			}
+			
+			/**@fn
+			 * @return
+			 * kernel of the RADON_GATHER engine ( never RADON_KERNEL_AUTO )
+			 * 
+			 **/
+			inline int gather_kernel() const
+			{
+				return _gather_kernel;
+			}
+			
 			
 		protected:
 		
@@ -157,6 +294,96 @@
 			 * 
 			 **/
 			void initialize();
+			
+			/**@fn
+			 * @brief
+			 * RADON_GATHER : lists the non-zero sub-pixels ( same order as RADON_SCATTER ).
+			 * 
+			 **/
+			template<class type> void gather_points ( 	const type * img_data,
+														unsigned int img_width,
+														unsigned int img_height,
+														unsigned int img_width_step );
+			
+			/**@fn
+			 * @param id : thread id
+			 * @brief
+			 * RADON_GATHER : angles id, id + nb_threads, ...
+			 * 
+			 **/
+			void gather_angles ( unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * RADON_FFT : 2-D FFT of the image ( centred on its origin, zero-padded ).
+			 * 
+			 **/
+			template<class type> int fft_image ( 	const type * img_data,
+													unsigned int img_width,
+													unsigned int img_height,
+													unsigned int img_width_step );
+			
+			/**@fn
+			 * @param id : thread id
+			 * @brief
+			 * RADON_FFT : angles id, id + nb_threads, ...
+			 * 
+			 **/
+			void fft_angles ( unsigned int id );
+			
+			/**@fn
+			 * @param t : distance to the kernel centre ( grid cells )
+			 * @brief
+			 * RADON_FFT : Kaiser-Bessel interpolation kernel ( table ).
+			 * 
+			 **/
+			inline double fft_kernel ( double t ) const
+			{
+				double p = fabs( t ) * RADON_FFT_KERNEL_TABLE;
+				unsigned int n = (unsigned int) p;
+				if ( n + 1 >= _fft_kernel.size() )
+					return 0;
+				return _fft_kernel[n] + ( p - n ) * ( _fft_kernel[n + 1] - _fft_kernel[n] );
+			}
+			
+			/**@fn
+			 * @brief
+			 * Free FFT buffers and plans.
+			 * 
+			 **/
+			void free_fft();
+			
+			/**@fn
+			 * @param task : RADON_TASK_GATHER or RADON_TASK_FFT
+			 * @brief
+			 * Runs a task on every thread and waits for the end.
+			 * 
+			 **/
+			void dispatch ( int task );
+			
+			/**@fn
+			 * @param obj : c_radon
+			 * @param id : thread id
+			 * @brief
+			 * Pool task : processes the angles of the current task.
+			 * 
+			 **/
+			static void pool_task ( 	void * obj,
+										unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * Ini. threads ( only the calling thread ).
+			 * 
+			 **/
+			void initialize_threads ( );
+			
+			/**@fn
+			 * @brief
+			 * Stop threads.
+			 * 
+			 **/
+			void stop_threads ( );
 		
 		
 			unsigned int _r_size_max,
@@ -176,6 +403,32 @@
 				   * y_table,
 				   * x_cos_table,
 				   * y_sin_table;
+			
+			int _mode;
+			
+			//RADON_GATHER : non-zero sub-pixels ( x, y, weight ), one histogram per thread
+			vector<double> 	_points_x,
+							_points_y,
+							_points_w,
+							_histograms;
+			int _gather_kernel;
+			gather_bins_prototype _gather_bins;
+			
+			//RADON_FFT : image ( size² ), one line ( line_size ) in / out per thread, kernel table
+			vector<double> _fft_kernel;
+			unsigned int 	_fft_size,
+							_fft_line_size,
+							_fft_nb_lines;
+			fftw_complex 	* _fft_image,
+							* _fft_line_in,
+							* _fft_line_out;
+			fftw_plan 	_fft_image_plan,
+						_fft_line_plan;
+			
+			//Threads ( the calling thread takes id 0 )
+			c_thread_pool _pool;
+			unsigned int _nb_threads; // _pool.nb_threads()
+			int _task;
 		
 	};
 	
@@ -13,9 +13,9 @@ AUTHOR="Valérian Némesin"
 
 #Dépendances
 #Lib. statiques
-S_LIBS=
+S_LIBS=../utilities
 #Lib. dynamiques
-D_LIBS=opencv
+D_LIBS=opencv fftw3
 
 #Options principales
 M_OPTIONS=../../../compilation.mk
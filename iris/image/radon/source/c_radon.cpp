@@ -1,12 +1,168 @@
 #include "c_radon.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define RADON_X86 1
+#endif
+
+/**@fn
+ * @brief
+ * Modified Bessel function of the first kind, order 0 ( power series ).
+ * 
+ **/
+static double bessel_i0 ( double x )
+{
+	double sum = 1,
+		   term = 1,
+		   y = x * x / 4;
+	for ( unsigned int k = 1; k < 200 && term > 1e-17 * sum; ++ k )
+	{
+		term *= y / ( (double) k * k );
+		sum += term;
+	}
+	return sum;
+}
+
+/**@fn
+ * @brief
+ * Shape parameter of the Kaiser-Bessel kernel for RADON_FFT_OVERSAMPLING.
+ * 
+ **/
+static double kaiser_bessel_beta ( )
+{
+	double w = RADON_FFT_KERNEL_WIDTH,
+		   s = RADON_FFT_OVERSAMPLING;
+	return M_PI * sqrt( ( w * w ) / ( s * s ) * ( s - 0.5 ) * ( s - 0.5 ) - 0.8 );
+}
+
+/**@fn
+ * @param x : pixel coordinate
+ * @param size : FFT size
+ * @brief
+ * Fourier transform of the Kaiser-Bessel kernel at x ( deapodization ).
+ * 
+ **/
+static double kaiser_bessel_ft ( 	double x,
+									unsigned int size )
+{
+	double beta = kaiser_bessel_beta(),
+		   a = M_PI * RADON_FFT_KERNEL_WIDTH * x / size,
+		   z_2 = beta * beta - a * a;
+	if ( z_2 > 0 )
+		return RADON_FFT_KERNEL_WIDTH * sinh( sqrt( z_2 ) ) / sqrt( z_2 );
+	if ( z_2 < 0 )
+		return RADON_FFT_KERNEL_WIDTH * sin( sqrt( - z_2 ) ) / sqrt( - z_2 );
+	return RADON_FFT_KERNEL_WIDTH;
+}
+
+/**@fn
+ * @brief
+ * RADON_GATHER scalar kernel ( r_ind = x cos + r_size + y sin, lower bin and weight ).
+ * 
+ **/
+static void gather_bins_scalar ( 	const double * x,
+									const double * y,
+									const double * w,
+									unsigned int nb,
+									double cosinus,
+									double sinus,
+									double r_size,
+									int * r_low,
+									double * pixel_low )
+{
+	for ( unsigned int m = 0; m < nb; ++ m )
+	{
+		double r_ind = ( x[m] * cosinus + r_size ) + y[m] * sinus;
+		int l = (int) r_ind;
+		r_low[m] = l;
+		pixel_low[m] = w[m] * ( 1.0 - r_ind + l );
+	}
+}
+
+#ifdef RADON_X86
+
+/**@fn
+ * @brief
+ * RADON_GATHER SSE2 kernel : same operations in the same order as the scalar kernel
+ * ( no FMA, truncation by cvttpd2dq, r_ind >= 0 ), hence the same results.
+ * 
+ **/
+__attribute__((target("sse2"))) static void gather_bins_sse2 ( 	const double * x,
+																const double * y,
+																const double * w,
+																unsigned int nb,
+																double cosinus,
+																double sinus,
+																double r_size,
+																int * r_low,
+																double * pixel_low )
+{
+	const __m128d 	c = _mm_set1_pd( cosinus ),
+					s = _mm_set1_pd( sinus ),
+					r = _mm_set1_pd( r_size ),
+					one = _mm_set1_pd( 1.0 );
+	unsigned int m = 0;
+	for ( ; m + 2 <= nb; m += 2 )
+	{
+		__m128d r_ind = _mm_add_pd( _mm_add_pd( _mm_mul_pd( _mm_loadu_pd( x + m ), c ), r ),
+									_mm_mul_pd( _mm_loadu_pd( y + m ), s ) );
+		__m128i l = _mm_cvttpd_epi32( r_ind );
+		_mm_storel_epi64( (__m128i*) ( r_low + m ), l );
+		_mm_storeu_pd( 	pixel_low + m,
+						_mm_mul_pd( _mm_loadu_pd( w + m ),
+									_mm_add_pd( _mm_sub_pd( one, r_ind ), _mm_cvtepi32_pd( l ) ) ) );
+	}
+	gather_bins_scalar( x + m, y + m, w + m, nb - m, cosinus, sinus, r_size, r_low + m, pixel_low + m );
+}
+
+/**@fn
+ * @brief
+ * RADON_GATHER AVX2 kernel ( 4 points, same results as the scalar kernel ).
+ * 
+ **/
+__attribute__((target("avx2"))) static void gather_bins_avx2 ( 	const double * x,
+																const double * y,
+																const double * w,
+																unsigned int nb,
+																double cosinus,
+																double sinus,
+																double r_size,
+																int * r_low,
+																double * pixel_low )
+{
+	const __m256d 	c = _mm256_set1_pd( cosinus ),
+					s = _mm256_set1_pd( sinus ),
+					r = _mm256_set1_pd( r_size ),
+					one = _mm256_set1_pd( 1.0 );
+	unsigned int m = 0;
+	for ( ; m + 4 <= nb; m += 4 )
+	{
+		__m256d r_ind = _mm256_add_pd( 	_mm256_add_pd( _mm256_mul_pd( _mm256_loadu_pd( x + m ), c ), r ),
+										_mm256_mul_pd( _mm256_loadu_pd( y + m ), s ) );
+		__m128i l = _mm256_cvttpd_epi32( r_ind );
+		_mm_storeu_si128( (__m128i*) ( r_low + m ), l );
+		_mm256_storeu_pd( 	pixel_low + m,
+							_mm256_mul_pd( 	_mm256_loadu_pd( w + m ),
+											_mm256_add_pd( _mm256_sub_pd( one, r_ind ), _mm256_cvtepi32_pd( l ) ) ) );
+	}
+	gather_bins_scalar( x + m, y + m, w + m, nb - m, cosinus, sinus, r_size, r_low + m, pixel_low + m );
+}
+
+#endif
+
 c_radon :: c_radon ( )
 {
 	initialize();
+	initialize_threads();
+	set_mode( RADON_SCATTER );
+	set_gather_kernel( RADON_KERNEL_AUTO );
 }
 c_radon :: c_radon ( unsigned int r_size_max,
 					 unsigned int nb_thetas_max )
 {
 	initialize();
+	initialize_threads();
+	set_mode( RADON_SCATTER );
+	set_gather_kernel( RADON_KERNEL_AUTO );
 	if ( setup ( 	r_size_max,
 					nb_thetas_max ) )
 		throw ( invalid_argument("Invalid arguments in c_radon :: c_radon ( unsigned int r_size_max,  unsigned int nb_thetas_max ); !") );
@@ -97,6 +253,28 @@ template<class type> int c_radon :: compute_transform( 	const type * img_data,
 					sizeof(double) * _nb_thetas );
 	}
 
+	//Other engines
+	if ( _mode == RADON_GATHER )
+	{
+		gather_points( 	img_data,
+						img_width,
+						img_height,
+						img_width_step );
+		_histograms.resize( ( 2 * _r_size + 2 ) * _nb_threads );
+		dispatch( RADON_TASK_GATHER );
+		return 0;
+	}
+	if ( _mode == RADON_FFT )
+	{
+		if ( fft_image( img_data,
+						img_width,
+						img_height,
+						img_width_step ) )
+			return 1;
+		dispatch( RADON_TASK_FFT );
+		return 0;
+	}
+
 	angle_step = M_PI / nb_thetas;
 	for ( unsigned int i = 0; i < nb_thetas; ++ i )
 	{
@@ -174,6 +352,242 @@ template<class type> int c_radon :: compute_transform( 	const type * img_data,
 	return 0;
 }
 
+template<class type> void c_radon :: gather_points ( 	const type * img_data,
+														unsigned int img_width,
+														unsigned int img_height,
+														unsigned int img_width_step )
+{
+	unsigned int x_size = 2 * img_width,
+				 y_size = 2 * img_height;
+	_points_x.clear();
+	_points_y.clear();
+	_points_w.clear();
+	for ( unsigned int j = 0; j < y_size; ++ j )
+	{
+		for ( unsigned int k = 0; k < x_size; ++ k )
+		{
+			unsigned int n_pixel = img_width_step * ( j / 2 ) + ( k / 2 );
+			double pixel = img_data[n_pixel] /255;
+			if ( pixel != 0 )
+			{
+				_points_x.push_back( x_table[k] );
+				_points_y.push_back( y_table[j] );
+				_points_w.push_back( pixel * 0.25 );
+			}
+		}
+	}
+}
+
+void c_radon :: gather_angles ( unsigned int id )
+{
+	unsigned int n = _points_x.size(),
+				 n_bins = 2 * _r_size + 2;
+	double * histogram = &_histograms[ id * n_bins ];
+	const double 	* p_x = n ? &_points_x[0] : 0,
+					* p_y = n ? &_points_y[0] : 0,
+					* p_w = n ? &_points_w[0] : 0;
+	double r_size = _r_size,
+		   angle_step = M_PI / _nb_thetas;
+	int r_low[RADON_CHUNK];
+	double pixel_low[RADON_CHUNK];
+	
+	for ( unsigned int i = id; i < _nb_thetas; i += _nb_threads )
+	{
+		double angle = i * angle_step,
+			   sinus = sin( angle ),
+			   cosinus = cos( angle );
+		memset( histogram,
+				0,
+				sizeof(double) * n_bins );
+		
+		for ( unsigned int m_0 = 0; m_0 < n; m_0 += RADON_CHUNK )
+		{
+			unsigned int nb = ( n - m_0 < RADON_CHUNK ) ? n - m_0 : RADON_CHUNK;
+			const double * w = p_w + m_0;
+			
+			//Bins and weights ( set_gather_kernel )
+			_gather_bins( 	p_x + m_0,
+							p_y + m_0,
+							w,
+							nb,
+							cosinus,
+							sinus,
+							r_size,
+							r_low,
+							pixel_low );
+			
+			//Accumulation ( same order as RADON_SCATTER )
+			for ( unsigned int m = 0; m < nb; ++ m )
+			{
+				histogram[ r_low[m] ] += pixel_low[m];
+				histogram[ r_low[m] + 1 ] += w[m] - pixel_low[m];
+			}
+		}
+		
+		for ( unsigned int r = 0; r <= 2 * _r_size; ++ r )
+			_radon_transform[ r * _width_step + i ] = histogram[r];
+	}
+}
+
+template<class type> int c_radon :: fft_image ( 	const type * img_data,
+													unsigned int img_width,
+													unsigned int img_height,
+													unsigned int img_width_step )
+{
+	unsigned int size = RADON_FFT_OVERSAMPLING * ( ( img_width > img_height ) ? img_width : img_height ),
+				 line_size = 2 * _r_size + 2;
+	size += size % 2;
+	
+	//Buffers and plans ( kept while sizes do not change )
+	if ( size != _fft_size || line_size != _fft_line_size || _nb_threads != _fft_nb_lines )
+	{
+		free_fft();
+		_fft_size = size;
+		_fft_line_size = line_size;
+		_fft_nb_lines = _nb_threads;
+		_fft_image = (fftw_complex*) fftw_malloc( sizeof(fftw_complex) * size * size );
+		_fft_line_in = (fftw_complex*) fftw_malloc( sizeof(fftw_complex) * line_size * _nb_threads );
+		_fft_line_out = (fftw_complex*) fftw_malloc( sizeof(fftw_complex) * line_size * _nb_threads );
+		if ( _fft_image )
+			_fft_image_plan = fftw_plan_dft_2d( size,
+												size,
+												_fft_image,
+												_fft_image,
+												FFTW_FORWARD,
+												FFTW_ESTIMATE );
+		if ( _fft_line_in && _fft_line_out )
+			_fft_line_plan = fftw_plan_dft_1d( 	line_size,
+												_fft_line_in,
+												_fft_line_out,
+												FFTW_BACKWARD,
+												FFTW_ESTIMATE );
+		if ( ! _fft_image_plan || ! _fft_line_plan )
+		{
+			*err_stream << "Error : can't create FFT plans in template<class type> int c_radon :: fft_image" << endl;
+			free_fft();
+			return 1;
+		}
+	}
+	
+	//Kaiser-Bessel kernel on [0, width / 2]
+	if ( _fft_kernel.empty() )
+	{
+		double beta = kaiser_bessel_beta(),
+			   half = RADON_FFT_KERNEL_WIDTH / 2.0;
+		_fft_kernel.resize( RADON_FFT_KERNEL_WIDTH / 2 * RADON_FFT_KERNEL_TABLE + 1 );
+		for ( unsigned int n = 0; n < _fft_kernel.size(); ++ n )
+		{
+			double t = (double) n / RADON_FFT_KERNEL_TABLE / half;
+			_fft_kernel[n] = bessel_i0( beta * sqrt( max( 0.0, 1 - t * t ) ) );
+		}
+	}
+	
+	//Pixel ( x, y ) at ( x - x_origin, y_origin - y ), as in RADON_SCATTER ( y upwards ),
+	//divided by the Fourier transform of the kernel
+	int x_origin = img_width / 2,
+		y_origin = img_height / 2;
+	vector<double> 	deapod_x( img_width ),
+					deapod_y( img_height );
+	for ( unsigned int k = 0; k < img_width; ++ k )
+		deapod_x[k] = 1 / kaiser_bessel_ft( (int) k - x_origin, size );
+	for ( unsigned int j = 0; j < img_height; ++ j )
+		deapod_y[j] = 1 / kaiser_bessel_ft( (int) img_height - 1 - (int) j - y_origin, size );
+	memset( _fft_image,
+			0,
+			sizeof(fftw_complex) * size * size );
+	for ( unsigned int j = 0; j < img_height; ++ j )
+	{
+		int y = ( (int) img_height - 1 - (int) j - y_origin + (int) size ) % (int) size;
+		for ( unsigned int k = 0; k < img_width; ++ k )
+		{
+			int x = ( (int) k - x_origin + (int) size ) % (int) size;
+			_fft_image[ y * size + x ][0] = img_data[ img_width_step * j + k ] /255 * deapod_x[k] * deapod_y[j];
+		}
+	}
+	fftw_execute( _fft_image_plan );
+	return 0;
+}
+
+void c_radon :: fft_angles ( unsigned int id )
+{
+	unsigned int size = _fft_size,
+				 line_size = _fft_line_size;
+	fftw_complex 	* in = _fft_line_in + id * line_size,
+					* out = _fft_line_out + id * line_size;
+	double angle_step = M_PI / _nb_thetas;
+	double w_u[RADON_FFT_KERNEL_WIDTH],
+		   w_v[RADON_FFT_KERNEL_WIDTH];
+	unsigned int i_u[RADON_FFT_KERNEL_WIDTH],
+				 i_v[RADON_FFT_KERNEL_WIDTH];
+	
+	for ( unsigned int i = id; i < _nb_thetas; i += _nb_threads )
+	{
+		double angle = i * angle_step,
+			   sinus = sin( angle ),
+			   cosinus = cos( angle );
+		
+		//Central slice
+		for ( unsigned int m = 0; m < line_size; ++ m )
+		{
+			double f_0 = ( ( m < line_size / 2 ) ? (double) m : (double) m - line_size ) / line_size; // cycles / pixel
+			in[m][0] = 0;
+			in[m][1] = 0;
+			
+			//Sampled projection : aliases f_0 + k of the slice
+			for ( int k = - RADON_FFT_NB_ALIASES; k <= RADON_FFT_NB_ALIASES; ++ k )
+			{
+				double f = f_0 + k,
+					   u = f * size * cosinus,
+					   v = f * size * sinus;
+				
+				//Kernel of RADON_SCATTER : linear interpolation ( sinc² ) and 2x2 sub-pixels
+				double kernel = 1;
+				if ( f != 0 )
+				{
+					double sinc = sin( M_PI * f ) / ( M_PI * f );
+					kernel = sinc * sinc * cos( M_PI * f * cosinus / 2 ) * cos( M_PI * f * sinus / 2 );
+				}
+				
+				//Kaiser-Bessel interpolation of the 2-D FFT ( periodic )
+				long long 	a_0 = (long long) floor( u ) - RADON_FFT_KERNEL_WIDTH / 2 + 1,
+							b_0 = (long long) floor( v ) - RADON_FFT_KERNEL_WIDTH / 2 + 1;
+				for ( unsigned int t = 0; t < RADON_FFT_KERNEL_WIDTH; ++ t )
+				{
+					w_u[t] = fft_kernel( u - ( a_0 + t ) );
+					w_v[t] = fft_kernel( v - ( b_0 + t ) );
+					i_u[t] = ( ( a_0 + t ) % (long long) size + size ) % size;
+					i_v[t] = ( ( b_0 + t ) % (long long) size + size ) % size;
+				}
+				double re = 0,
+					   im = 0;
+				for ( unsigned int q = 0; q < RADON_FFT_KERNEL_WIDTH; ++ q )
+				{
+					const fftw_complex * row = _fft_image + i_v[q] * size;
+					double row_re = 0,
+						   row_im = 0;
+					for ( unsigned int t = 0; t < RADON_FFT_KERNEL_WIDTH; ++ t )
+					{
+						row_re += w_u[t] * row[ i_u[t] ][0];
+						row_im += w_u[t] * row[ i_u[t] ][1];
+					}
+					re += w_v[q] * row_re;
+					im += w_v[q] * row_im;
+				}
+				in[m][0] += kernel * re;
+				in[m][1] += kernel * im;
+			}
+		}
+		fftw_execute_dft( _fft_line_plan, in, out );
+		
+		//Bin r <=> distance r - r_size
+		for ( unsigned int r = 0; r <= 2 * _r_size; ++ r )
+		{
+			unsigned int n = ( r + line_size - _r_size ) % line_size;
+			_radon_transform[ r * _width_step + i ] = out[n][0] / line_size;
+		}
+	}
+}
+
 template int c_radon :: compute_transform( 	const unsigned char * img_data, 
 											unsigned int img_width,
 											unsigned int img_height,
@@ -381,10 +795,153 @@ int c_radon :: compute_transform ( 	const IplImage * image,
 	
 }
 											
+int c_radon :: set_mode ( int mode )
+{
+	if ( mode != RADON_SCATTER && mode != RADON_GATHER && mode != RADON_FFT )
+	{
+		*err_stream << "Error : Bad mode in int c_radon :: set_mode ( int mode );" << endl;
+		return 1;
+	}
+	_mode = mode;
+	return 0;
+}
+
+int c_radon :: set_nb_threads ( unsigned int nb_threads )
+{
+	int ret = _pool.setup( nb_threads, err_stream );
+	_nb_threads = _pool.nb_threads();
+	return ret;
+}
+
+int c_radon :: set_gather_kernel ( int kernel )
+{
+	if ( kernel == RADON_KERNEL_AUTO )
+	{
+		if ( gather_kernel_supported( RADON_KERNEL_AVX2 ) )
+			kernel = RADON_KERNEL_AVX2;
+		else if ( gather_kernel_supported( RADON_KERNEL_SSE2 ) )
+			kernel = RADON_KERNEL_SSE2;
+		else
+			kernel = RADON_KERNEL_SCALAR;
+	}
+	if ( ! gather_kernel_supported( kernel ) )
+	{
+		*err_stream << "Error : Kernel " << gather_kernel_name( kernel ) << " not supported in int c_radon :: set_gather_kernel ( int kernel );" << endl;
+		return 1;
+	}
+	switch ( kernel )
+	{
+#ifdef RADON_X86
+		case RADON_KERNEL_SSE2:
+			_gather_bins = gather_bins_sse2;
+			break;
+		case RADON_KERNEL_AVX2:
+			_gather_bins = gather_bins_avx2;
+			break;
+#endif
+		default:
+			_gather_bins = gather_bins_scalar;
+			break;
+	}
+	_gather_kernel = kernel;
+	return 0;
+}
+
+bool c_radon :: gather_kernel_supported ( int kernel )
+{
+#ifdef RADON_X86
+	//May be called before any other CPU check : ini. of __builtin_cpu_supports
+	__builtin_cpu_init();
+#endif
+	switch ( kernel )
+	{
+		case RADON_KERNEL_AUTO:
+		case RADON_KERNEL_SCALAR:
+			return true;
+#ifdef RADON_X86
+		case RADON_KERNEL_SSE2:
+			return __builtin_cpu_supports( "sse2" );
+		case RADON_KERNEL_AVX2:
+			return __builtin_cpu_supports( "avx2" );
+#endif
+		default:
+			return false;
+	}
+}
+
+const char * c_radon :: gather_kernel_name ( int kernel )
+{
+	switch ( kernel )
+	{
+		case RADON_KERNEL_AUTO:
+			return "auto";
+		case RADON_KERNEL_SCALAR:
+			return "scalar";
+		case RADON_KERNEL_SSE2:
+			return "SSE2";
+		case RADON_KERNEL_AVX2:
+			return "AVX2";
+		default:
+			return "unknown";
+	}
+}
+
+void c_radon :: dispatch ( int task )
+{
+	_task = task;
+	_pool.run( pool_task, this );
+}
+
+void c_radon :: pool_task ( 	void * obj,
+								unsigned int id )
+{
+	c_radon * radon = (c_radon *) obj;
+	if ( radon->_task == RADON_TASK_GATHER )
+		radon->gather_angles( id );
+	else
+		radon->fft_angles( id );
+}
+
+void c_radon :: initialize_threads ( )
+{
+	_nb_threads = 0;
+	_task = RADON_TASK_GATHER;
+	set_nb_threads( 1 );
+}
+
+void c_radon :: stop_threads ( )
+{
+	_pool.stop();
+	_nb_threads = 1;
+}
+
 c_radon :: ~c_radon()
 {
 	free();
 	initialize();
+	stop_threads();
+}
+
+void c_radon :: free_fft()
+{
+	if ( _fft_image_plan )
+		fftw_destroy_plan( _fft_image_plan );
+	if ( _fft_line_plan )
+		fftw_destroy_plan( _fft_line_plan );
+	if ( _fft_image )
+		fftw_free( _fft_image );
+	if ( _fft_line_in )
+		fftw_free( _fft_line_in );
+	if ( _fft_line_out )
+		fftw_free( _fft_line_out );
+	_fft_image_plan = 0;
+	_fft_line_plan = 0;
+	_fft_image = 0;
+	_fft_line_in = 0;
+	_fft_line_out = 0;
+	_fft_size = 0;
+	_fft_line_size = 0;
+	_fft_nb_lines = 0;
 }
 
 void c_radon :: free()
@@ -401,6 +958,11 @@ void c_radon :: free()
 		delete[] x_cos_table;
 	if ( y_sin_table )
 		delete[] y_sin_table;
+	free_fft();
+	_points_x.clear();
+	_points_y.clear();
+	_points_w.clear();
+	_histograms.clear();
 }
 
 void c_radon :: initialize()
@@ -417,6 +979,15 @@ void c_radon :: initialize()
 	x_cos_table = 0;
 	y_sin_table = 0;
 	radon_image = 0;
+	
+	_fft_size = 0;
+	_fft_line_size = 0;
+	_fft_nb_lines = 0;
+	_fft_image = 0;
+	_fft_line_in = 0;
+	_fft_line_out = 0;
+	_fft_image_plan = 0;
+	_fft_line_plan = 0;
 }
 
 double c_radon :: search_max ( 	double & r,
@@ -0,0 +1,124 @@
+/**@file c_thread_pool.hpp
+ *
+ **/
+#ifndef _C_THREAD_POOL_HPP_
+	#define _C_THREAD_POOL_HPP_
+	#include <iostream>
+	#include <pthread.h>
+	using namespace std;
+
+	/**@typedef thread_pool_task
+	 * @param obj : objet de la tâche
+	 * @param id : numéro de la part ( 0 : thread appelant )
+	 * @brief
+	 * Tâche exécutée par chaque thread du pool.
+	 **/
+	typedef void ( * thread_pool_task ) ( void * obj, unsigned int id );
+
+	/**@class c_thread_pool
+	 * @brief
+	 * Pool de threads créés une fois pour toutes.
+	 * run lance une tâche sur les parts 1 ... nb_threads - 1 ( threads du pool ),
+	 * traite la part 0 dans le thread appelant puis attend la fin des autres parts.
+	 * Les threads attendent un nouveau numéro de génération ; le mutex et les
+	 * conditions sont créés par le constructeur et détruits par le destructeur.
+	 **/
+	class c_thread_pool
+	{
+		public:
+			/**@fn
+			 * @brief
+			 * Constructeur : un seul thread ( le thread appelant ).
+			 **/
+			c_thread_pool();
+
+			/**@fn
+			 * @param nb_threads : nombre de threads ( 0 : nombre de processeurs )
+			 * @param err_stream : flux d'erreur
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon ( nb_threads() : threads créés + thread appelant )
+			 * @brief
+			 * Arrête les threads existants et crée nb_threads - 1 threads.
+			 **/
+			int setup ( 	unsigned int nb_threads,
+							ostream * err_stream = &cout );
+
+			/**@fn
+			 * @param task : tâche
+			 * @param obj : objet passé à la tâche
+			 * @brief
+			 * Exécute task( obj, id ) pour id = 0 ... nb_threads - 1 et attend la fin.
+			 **/
+			void run ( 	thread_pool_task task,
+						void * obj );
+
+			/**@fn
+			 * @brief
+			 * Arrêt des threads ( il ne reste que le thread appelant ).
+			 **/
+			void stop ( );
+
+			/**@fn
+			 * @brief
+			 * Verrou du pool ( sections critiques des tâches ).
+			 **/
+			void lock ( );
+			void unlock ( );
+
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre de threads ( thread appelant compris ).
+			 **/
+			inline unsigned int nb_threads() const
+			{
+				return _nb_threads;
+			}
+
+			/**@fn
+			 * @brief
+			 * Nombre de processeurs ( 1 si inconnu ).
+			 **/
+			static unsigned int nb_processors ( );
+
+			/**@fn
+			 * @brief
+			 * Destructeur.
+			 **/
+			~c_thread_pool();
+
+		protected:
+			/**@fn
+			 * @param id : numéro de la part
+			 * @brief
+			 * Boucle d'un thread : attend une tâche, traite sa part.
+			 **/
+			void thread_loop ( unsigned int id );
+
+			friend void * thread_pool_function ( void * params );
+
+			unsigned int _nb_threads;
+			pthread_t * _threads;
+			struct worker
+			{
+				c_thread_pool * pool;
+				unsigned int id;
+			};
+			worker * _workers;
+			pthread_mutex_t _mutex;
+			pthread_cond_t 	_start,
+							_done;
+			unsigned int 	_generation,
+							_nb_pending;
+			bool _stop;
+
+			//Tâche courante
+			thread_pool_task _task;
+			void * _obj;
+
+		private:
+			//Non copiable
+			c_thread_pool ( const c_thread_pool & );
+			c_thread_pool & operator= ( const c_thread_pool & );
+	};
+#endif
@@ -0,0 +1,144 @@
+#include "c_thread_pool.hpp"
+#include <unistd.h>
+
+void * thread_pool_function ( void * params )
+{
+	c_thread_pool::worker * w = (c_thread_pool::worker *) params;
+	w->pool->thread_loop( w->id );
+	return NULL;
+}
+
+c_thread_pool :: c_thread_pool()
+{
+	_nb_threads = 1;
+	_threads = 0;
+	_workers = 0;
+	_generation = 0;
+	_nb_pending = 0;
+	_stop = false;
+	_task = 0;
+	_obj = 0;
+	pthread_mutex_init( &_mutex, NULL );
+	pthread_cond_init( &_start, NULL );
+	pthread_cond_init( &_done, NULL );
+}
+
+int c_thread_pool :: setup ( 	unsigned int nb_threads,
+								ostream * err_stream )
+{
+	stop();
+	if ( nb_threads == 0 )
+		nb_threads = nb_processors();
+	_nb_threads = nb_threads;
+	if ( nb_threads == 1 )
+		return 0;
+
+	//Le thread appelant traite la part 0
+	_generation = 0;
+	_threads = new pthread_t[nb_threads - 1];
+	_workers = new worker[nb_threads - 1];
+	for ( unsigned int i = 0; i < nb_threads - 1; ++ i )
+	{
+		_workers[i].pool = this;
+		_workers[i].id = i + 1;
+		if ( pthread_create( 	_threads + i,
+								NULL,
+								thread_pool_function,
+								(void*) ( _workers + i ) ) )
+		{
+			if ( err_stream )
+				*err_stream << "Error : can't create thread n°" << i + 1 << " in int c_thread_pool :: setup" << endl;
+			_nb_threads = i + 1;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void c_thread_pool :: run ( 	thread_pool_task task,
+								void * obj )
+{
+	_task = task;
+	_obj = obj;
+	if ( _nb_threads > 1 )
+	{
+		pthread_mutex_lock( &_mutex );
+		++ _generation;
+		_nb_pending = _nb_threads - 1;
+		pthread_cond_broadcast( &_start );
+		pthread_mutex_unlock( &_mutex );
+	}
+	task( obj, 0 );
+	if ( _nb_threads > 1 )
+	{
+		pthread_mutex_lock( &_mutex );
+		while ( _nb_pending )
+			pthread_cond_wait( &_done, &_mutex );
+		pthread_mutex_unlock( &_mutex );
+	}
+}
+
+void c_thread_pool :: thread_loop ( unsigned int id )
+{
+	unsigned int generation = 0;
+	pthread_mutex_lock( &_mutex );
+	while ( true )
+	{
+		while ( generation == _generation && ! _stop )
+			pthread_cond_wait( &_start, &_mutex );
+		if ( _stop )
+			break;
+		generation = _generation;
+		pthread_mutex_unlock( &_mutex );
+
+		_task( _obj, id );
+
+		pthread_mutex_lock( &_mutex );
+		if ( -- _nb_pending == 0 )
+			pthread_cond_signal( &_done );
+	}
+	pthread_mutex_unlock( &_mutex );
+}
+
+void c_thread_pool :: stop ( )
+{
+	if ( _threads )
+	{
+		pthread_mutex_lock( &_mutex );
+		_stop = true;
+		pthread_cond_broadcast( &_start );
+		pthread_mutex_unlock( &_mutex );
+		for ( unsigned int i = 0; i < _nb_threads - 1; ++ i )
+			pthread_join( _threads[i], NULL );
+		delete[] _threads;
+		delete[] _workers;
+		_threads = 0;
+		_workers = 0;
+		_stop = false;
+	}
+	_nb_threads = 1;
+}
+
+void c_thread_pool :: lock ( )
+{
+	pthread_mutex_lock( &_mutex );
+}
+
+void c_thread_pool :: unlock ( )
+{
+	pthread_mutex_unlock( &_mutex );
+}
+
+unsigned int c_thread_pool :: nb_processors ( )
+{
+	long n = sysconf( _SC_NPROCESSORS_ONLN );
+	return ( n > 0 ) ? n : 1;
+}
+
+c_thread_pool :: ~c_thread_pool()
+{
+	stop();
+	pthread_mutex_destroy( &_mutex );
+	pthread_cond_destroy( &_start );
+	pthread_cond_destroy( &_done );
+}
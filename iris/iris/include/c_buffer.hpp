@@ -8,11 +8,19 @@
 	#include <exception> //Exceptions (pour ne pas faire planter le programme en cas de problèmes de mémoire ou autre)
 	#include <stdexcept>
 	#include <cstring>
+	#include <pthread.h>
 	#include "c_buffer_data.hpp"
+	#include "c_frame_pool.hpp"
 	using namespace std;
 
 	
 	/**@class c_buffer
+	 * @brief
+	 * File de priorité bornée partagée entre threads : les objets sont triés par
+	 * score décroissant ( score < 0 : emplacement vide ). Toutes les opérations
+	 * sont protégées par un mutex ; pop_object et push_object attendent ( sans
+	 * attente active ) un objet ou une place libre, jusqu'à la fermeture de la
+	 * file ( close, fin du flux ).
 	 */
 	class c_buffer
 	{
@@ -63,6 +71,37 @@
 					    ostream * _err_stream = NULL );
 			
 			
+			/**@fn
+			 * @param nb_obj : nombre d'objets
+			 * @param pool : réserve des objets
+			 * @param copy_function : fonction de recopie ( lecture par get_object )
+			 * @brief
+			 * Setup en mode référence : la file range des objets de la réserve
+			 * ( handles ) sans les recopier. Un objet ajouté appartient à la file,
+			 * qui le rend à la réserve s'il est écrasé, refusé ou effacé.
+			 * 
+			 */
+			int setup ( unsigned int nb_obj,
+						c_frame_pool * pool,
+						void (*copy_function) (	void * data,
+												const void * data_src ),
+					    ostream * _err_stream = NULL );
+			
+			/**@fn
+			 * @param id : id de l'objet
+			 * @param score : score de l'objet
+			 * @param handle : données lues ( objet de la réserve, NULL si fin du flux )
+			 * @return
+			 * - 0 si un objet est lu
+			 * - 1 si la file est fermée et vide ( fin du flux )
+			 * @brief
+			 * Mode référence : retire le meilleur objet en attendant qu'il y en ait un.
+			 * La référence passe à l'appelant, qui la rend à la réserve ( release ).
+			 */
+			int pop_handle(	unsigned int & id,
+							double & score,
+							void * & handle );
+			
 			/**@fn
 			 * @brief
 			 * Ajoute un objet.
@@ -74,6 +113,49 @@
 							const void * data );
 			
 			
+			/**@fn
+			 * @param id : id de l'objet
+			 * @param score : score de l'objet
+			 * @param data : données
+			 * @return
+			 * - 0 si l'objet est ajouté
+			 * - 1 si la file est fermée
+			 * @brief
+			 * Ajoute un objet en attendant une place libre ( pas d'écrasement ).
+			 */
+			int push_object(	unsigned int id,
+								double score,
+								const void * data );
+			
+			/**@fn
+			 * @param data : données lues
+			 * @return
+			 * - 0 si un objet est lu
+			 * - 1 si la file est fermée et vide ( fin du flux )
+			 * @brief
+			 * Retire le meilleur objet en attendant qu'il y en ait un.
+			 */
+			int pop_object( c_buffer_data * data );
+			
+			/**@fn
+			 * @brief
+			 * Ferme la file : plus aucun objet ne sera ajouté. Réveille les threads
+			 * en attente ; pop_object vide la file puis renvoie 1.
+			 */
+			void close();
+			
+			/**@fn
+			 * @brief
+			 * Renvoie si la file est fermée.
+			 */
+			bool closed();
+			
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre d'objets présents.
+			 */
+			unsigned int size();
+			
 			/**@fn
 			 * @param obj_id : id de l'objet
 			 * @brief
@@ -113,6 +195,14 @@
 			 **/
 			double score_min();
 		
+			/**@fn
+			 * @param score_id : rang de l'objet ( 0 : meilleur )
+			 * @brief
+			 * Renvoie le score de l'objet de rang score_id ( < 0 si l'emplacement est vide ).
+			 * 
+			 **/
+			double score( unsigned int score_id );
+		
 			/**@fn
 			 * @brief
 			 * Destructeur
@@ -121,7 +211,7 @@
 		
 			/**@fn
 			 * @brief
-			 * Reset des objets
+			 * Reset des objets ( la file est rouverte )
 			 * 
 			 */
 			void reset();		
@@ -153,50 +243,37 @@
 			
 			/**@fn
 			 * @brief
-			 * Efface l'obj. n°id.
-			 * 
+			 * Insère un objet à son rang ( mutex verrouillé ) : l'objet de plus
+			 * faible score est écrasé si la file est pleine.
+			 * @return
+			 * - 0 si l'objet est inséré
+			 * - 1 si son score est inférieur à tous les autres
 			 **/
-			void erase_object( unsigned int id );
-		
-			/**@fn
-			 * @brief
-			 * Efface l'obj. n°id.
-			 * 
-			 **/
-			void write_object(	unsigned int id,
+			int insert_object(	unsigned int id,
 								double score,
-								const void * data,
-								unsigned int obj_id );
-		
+								const void * data );
+			
 			/**@fn
 			 * @brief
-			 * Efface l'obj. n°id.
-			 * 
+			 * Retire l'objet de rang i ( mutex verrouillé ).
 			 **/
-			void read_object(	c_buffer_data * data,
-								unsigned int id  );
+			void remove_object( unsigned int i );
 		
-		
-			//Jetons
-			int _score_editting,
-				* _object_in_reading,
-				* _object_in_writting;
-		
-		
-			void start_object_writting ( unsigned int obj_id );
-			void end_object_writting ( unsigned int obj_id );
-			
-			void start_object_reading ( unsigned int obj_id );
-			void end_object_reading ( unsigned int obj_id );
-			
-			void start_score_editting ();
-			void end_score_editting();
+			//Synchronisation
+			pthread_mutex_t _mutex;
+			pthread_cond_t 	_not_empty,
+							_not_full;
+			bool _closed;
+			unsigned int _nb_used;
 		
 			//Nombre d'objets
 			unsigned int _nb_objects;
 			
 			c_buffer_data * buffer_data;
 			unsigned int * sorted_buffer_ids;
+			
+			//Réserve ( mode référence )
+			c_frame_pool * _pool;
 
 			ostream * err_stream;
 	};
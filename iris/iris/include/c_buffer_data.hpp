@@ -3,6 +3,7 @@
  */
 #ifndef _C_BUFFER_DATA_HPP_
 	#define _C_BUFFER_DATA_HPP_
+	class c_frame_pool;
 	/**@class
 	 * @brief
 	 * Cette structure permet de gérer un buffer de données
@@ -40,6 +41,26 @@
 													const void * data_src ),
 							void (*free_function) ( void * data ) );
 			
+			/**@fn
+			 * @param pool : réserve des objets
+			 * @param copy_function : fonction de recopie ( lecture par get )
+			 * @brief
+			 * Setup en mode référence : l'emplacement ne possède pas de données,
+			 * set y range un objet de la réserve ( la référence est transférée,
+			 * sans recopie ) et erase la libère.
+			 * 
+			 **/
+			int setup ( 	c_frame_pool * pool,
+							void (*copy_function) ( void * data,
+													const void * data_src ) );
+			
+			/**@fn
+			 * @brief
+			 * Mode référence : rend l'objet rangé ( et sa référence ) sans le libérer.
+			 * 
+			 **/
+			void * take_handle();
+			
 			/**@fn
 			 * @brief
 			 * Destructeur
@@ -138,6 +159,7 @@
 									const void * data_src );
 			
 			void * _data;
+			c_frame_pool * _pool;
 			double _score;
 			unsigned int _id;
 	};
@@ -11,6 +11,7 @@
 	#include "lib_api.hpp"
 	#include "iris_default.hpp"
 	#include "lib_image.hpp"
+	#include "gallery_file.hpp"
 	/**@class
 	 * @brief
 	 * Classe pour gérer une base de données d'iris codes
@@ -55,6 +56,33 @@
 								const char * fragility_map_file,
 								ostream * stream = NULL );
 		
+			/**@fn
+			 * @param file_name : fichier de galerie
+			 * @param fragile_bit_rate : taux de bits fragiles des iris codes binaires stockés
+			 * @param iris_code_file : nom du fichier de l'iris code ( contrôlé au chargement )
+			 * @param fragility_map_file : nom du fichier de la carte de fragilité ( contrôlé au chargement )
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon
+			 * @brief
+			 * Compile la base dans un fichier de galerie ( cf. gallery_file.hpp ).
+			 * Le fichier peut ensuite remplacer le répertoire dans setup : il est
+			 * projeté en mémoire sans décodage des images.
+			 **/
+			int save( 	const char * file_name,
+						double fragile_bit_rate,
+						const char * iris_code_file,
+						const char * fragility_map_file );
+			
+			/**@fn
+			 * @brief
+			 * Indique si la base est un fichier de galerie projeté en mémoire.
+			 **/
+			inline bool is_mapped() const
+			{
+				return ( _map_data != NULL );
+			}
+			
 			/**@fn
 			 * @param error_str : flux d'erreur
 			 * @brief
@@ -122,6 +150,102 @@
 			void compute_fragile_bit_threshold( double fragile_bit_rate );
 			
 			double get_fragile_bit_threshold ( unsigned int id ) const;
+			/**@fn
+			 * @brief
+			 * Renvoie le seuil de fragilité de l'iris code n°id pour le taux de bits
+			 * fragiles fragile_bit_rate, sans recalculer les iris codes binaires.
+			 **/
+			unsigned int fragile_bit_threshold( 	double fragile_bit_rate,
+													unsigned int id ) const;
+			/**@fn
+			 * @param[out] planes : iris code, masque puis bits fragiles de chaque taux ( 2 + nb_fbr plans de width_step * height mots )
+			 * @param[in] id : numéro de l'iris code
+			 * @param[in] fbr : taux de bits fragiles
+			 * @param[in] nb_fbr : nombre de taux
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon ( iris code absent )
+			 * @brief
+			 * Convertit l'iris code n°id pour plusieurs taux de bits fragiles à la fois.
+			 **/
+			int convert_levels( 	unsigned long long * planes,
+									unsigned int id,
+									const double * fbr,
+									unsigned int nb_fbr ) const;
+			
+			/**@fn
+			 * @param d_theta : plage de recadrage ( même définition que c_matching )
+			 * @param nb_rotations : nombre maximal de rotations stockées par iris code ( 0 : désactivée )
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon
+			 * @brief
+			 * Active la banque de rotations : chaque iris code binaire est stocké
+			 * pré-tourné pour les nb_rotations angles les plus proches de 0 de la
+			 * plage [-d_theta * width / 2, d_theta * width / 2[. Un recadrage devient
+			 * un simple décalage de pointeur. Mémoire : 3 * nb_rotations plans par classe.
+			 **/
+			int set_rotation_bank( 	double d_theta,
+									unsigned int nb_rotations );
+			
+			/**@fn
+			 * @param[in] id : numéro de l'iris code
+			 * @param[in] theta : angle de recadrage de l'iris code comparé
+			 * @param[out] code : iris code tourné de - theta
+			 * @param[out] mask : masque tourné de - theta
+			 * @param[out] fb : bits fragiles tournés de - theta
+			 * @return
+			 * - 0 si la rotation est dans la banque
+			 * - 1 sinon
+			 * @brief
+			 * Renvoie l'iris code n°id pré-tourné de - theta.
+			 **/
+			int rotated_template( 	unsigned int id,
+									int theta,
+									const unsigned long long *& code,
+									const unsigned long long *& mask,
+									const unsigned long long *& fb ) const;
+			
+			/**@fn
+			 * @brief
+			 * Renvoie les nombres de bits restants ligne par ligne du masque et des bits
+			 * fragiles de l'iris code n°i ( cf. distance::compute_row_counts ).
+			 **/
+			const unsigned int * row_counts( unsigned int id ) const;
+			
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre de rotations stockées par iris code.
+			 **/
+			inline unsigned int nb_bank_rotations() const
+			{
+				return _bank_nb_rotations;
+			}
+			
+			/**@fn
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon
+			 * @brief
+			 * Calcule les iris codes flous quantifiés ( cf. distance::quantize_fuzzy_code )
+			 * utilisés par la distance E(Hamming). Sans effet s'ils sont déjà calculés.
+			 **/
+			int compute_fuzzy_codes( void );
+			
+			/**@fn
+			 * @brief
+			 * Renvoie l'iris code flou quantifié n°id ( NULL si absent ou non calculé ).
+			 **/
+			const short * fuzzy_code( unsigned int id ) const;
+			
+			/**@fn
+			 * @brief
+			 * Renvoie la taille d'une ligne des iris codes flous ( 0 s'ils ne sont pas calculés ).
+			 **/
+			inline unsigned int fuzzy_width_step() const
+			{
+				return _fuzzy_width_step;
+			}
 			
 			
 		protected:
@@ -163,6 +287,33 @@
 						const char * iris_code_file,
 						const char * fragility_map_file );
 		
+			/**@fn
+			 * @brief
+			 * Chargement d'un fichier de galerie ( projection en mémoire ).
+			 * 
+			 */
+			int load_gallery (	const char * file_name,
+								const char * iris_code_file,
+								const char * fragility_map_file );
+			
+			/**@fn
+			 * @brief
+			 * Indique si le fichier est un fichier de galerie.
+			 **/
+			bool is_gallery_file( const char * file_name ) const;
+			
+			/**@fn
+			 * @brief
+			 * Indique si le pointeur appartient au fichier de galerie projeté.
+			 **/
+			bool in_map( const void * ptr ) const;
+			
+			/**@fn
+			 * @brief
+			 * Lib. d'un iris code binaire ( sauf s'il appartient au fichier projeté ).
+			 **/
+			void release_plane( unsigned long long *& plane );
+		
 			/**@fn
 			 * @brief
 			 * Calcule le taux de bits fragile pour chaque seuil.
@@ -172,6 +323,24 @@
 			
 			double get_fbt( double fbr, unsigned id );
 			
+			/**@fn
+			 * @brief
+			 * Calcule la banque de rotations de l'iris code n°id.
+			 **/
+			void compute_rotation_bank( unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * Calcule les nombres de bits restants ligne par ligne de l'iris code n°id.
+			 **/
+			void compute_row_counts( unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * Lib. des nombres de bits restants de l'iris code n°id ( sauf s'ils sont dans le fichier de galerie ).
+			 **/
+			void release_row_counts( unsigned int id );
+			
 			
 		
 			//Nombre de classes
@@ -188,6 +357,8 @@
 							   ** _masks,
 							   ** _fragile_bits;
 			unsigned int width_step;
+			//Bits restants ligne par ligne
+			unsigned int ** _row_counts;
 			//Flux d'erreurs
 			ostream * err_stream;
 			
@@ -199,6 +370,22 @@
 			
 			c_histogram hist;
 			
+			//Banque de rotations
+			unsigned long long ** _rotation_bank;
+			double _bank_d_theta;
+			unsigned int _bank_max_rotations;
+			unsigned int _bank_nb_rotations;
+			int _bank_theta_min;
+			
+			//Iris codes flous quantifiés
+			short ** _fuzzy_codes;
+			unsigned int _fuzzy_width_step;
+			
+			//Fichier de galerie projeté
+			void * _map_data;
+			size_t _map_size;
+			const double * _map_thresholds;
+			
 	};
 
 
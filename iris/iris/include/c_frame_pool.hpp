@@ -0,0 +1,150 @@
+/**@file c_frame_pool.hpp
+ * @author Valérian Némesin
+ * @brief
+ * Réserve d'objets préalloués à compteur de références.
+ */
+#ifndef _C_FRAME_POOL_HPP_
+	#define _C_FRAME_POOL_HPP_
+	#include <iostream>
+	#include <pthread.h>
+	using namespace std;
+
+	/**@class c_frame_pool
+	 * @brief
+	 * Réserve de nb_frames objets alloués une fois pour toutes ( même fonction
+	 * d'allocation que c_buffer ). Un objet est pris par acquire ( une référence ),
+	 * partagé par retain et rendu à la réserve quand sa dernière référence est
+	 * libérée ( release ). Les objets passent d'un thread à l'autre par leur
+	 * adresse : aucune allocation ni recopie en régime permanent.
+	 */
+	class c_frame_pool
+	{
+		public:
+			/**@fn
+			 * @brief
+			 * Constructeur
+			 *
+			 */
+			c_frame_pool( void );
+
+			/**@fn
+			 * @param nb_frames : nombre d'objets
+			 * @param alloc_function : fonction d'allocation
+			 * @param free_function : fonction de lib. mémoire
+			 * @param params : paramètres de construction
+			 * @param stream : flux d'erreurs ( NULL pour le désactiver )
+			 * @brief
+			 * Constructeur
+			 *
+			 */
+			c_frame_pool( 	unsigned int nb_frames,
+							void * (*alloc_function) ( const void * params ),
+							void (*free_function) ( void * data ),
+							const void * params,
+							ostream * stream = NULL );
+
+			/**@fn
+			 * @param nb_frames : nombre d'objets
+			 * @param alloc_function : fonction d'allocation
+			 * @param free_function : fonction de lib. mémoire
+			 * @param params : paramètres de construction
+			 * @param stream : flux d'erreurs ( NULL pour le désactiver )
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon
+			 * @brief
+			 * Setup : alloue tous les objets.
+			 *
+			 */
+			int setup( 	unsigned int nb_frames,
+						void * (*alloc_function) ( const void * params ),
+						void (*free_function) ( void * data ),
+						const void * params,
+						ostream * stream = NULL );
+
+			/**@fn
+			 * @brief
+			 * Prend un objet libre ( une référence ) ; attend qu'un objet soit rendu
+			 * si la réserve est vide.
+			 *
+			 */
+			void * acquire();
+
+			/**@fn
+			 * @brief
+			 * Ajoute une référence à un objet de la réserve.
+			 *
+			 */
+			void retain( void * frame );
+
+			/**@fn
+			 * @brief
+			 * Libère une référence ; l'objet retourne dans la réserve à la dernière.
+			 *
+			 */
+			void release( void * frame );
+
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre d'objets libres.
+			 *
+			 */
+			unsigned int nb_free();
+
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre d'objets de la réserve.
+			 **/
+			inline unsigned int nb_frames() const
+			{
+				return _nb_frames;
+			}
+
+			/**@fn
+			 * @brief
+			 * Destructeur
+			 *
+			 */
+			~c_frame_pool();
+
+		protected:
+			/**@fn
+			 * @brief
+			 * Ini. mémoire
+			 *
+			 */
+			void initialize();
+
+			/**@fn
+			 * @brief
+			 * Lib. mémoire
+			 *
+			 */
+			void free();
+
+			/**@fn
+			 * @brief
+			 * Renvoie le numéro d'un objet de la réserve ( nb_frames s'il n'en fait pas partie ).
+			 *
+			 */
+			unsigned int find( const void * frame ) const;
+
+			//Objets
+			unsigned int _nb_frames;
+			void ** _frames;
+			unsigned int * _refs;
+			void (*free_function) ( void * data );
+
+			//Pile des objets libres
+			unsigned int * _free_ids;
+			unsigned int _nb_free;
+
+			//Synchronisation
+			pthread_mutex_t _mutex;
+			pthread_cond_t _not_empty;
+
+			//Flux d'erreurs
+			ostream * err_stream;
+	};
+
+#endif
@@ -0,0 +1,161 @@
+/**@file c_frame_ring.hpp
+ * @author Valérian Némesin
+ * @brief
+ * File circulaire d'images décodées ( lecture anticipée de la vidéo ).
+ */
+#ifndef _C_FRAME_RING_HPP_
+	#define _C_FRAME_RING_HPP_
+	#include <iostream>
+	#include <pthread.h>
+	#include <opencv/cv.h>
+	using namespace std;
+
+	/**@class c_frame_ring
+	 * @brief
+	 * File circulaire de nb_frames images entre un thread de décodage ( push ) et
+	 * un thread de prétraitement ( front / pop ). Les images sont allouées à la
+	 * première image de la vidéo puis réutilisées ( réallouées seulement si la taille
+	 * change ). push attend une place libre, front attend une image : le décodage
+	 * garde au plus nb_frames images d'avance.
+	 */
+	class c_frame_ring
+	{
+		public:
+			/**@fn
+			 * @brief
+			 * Constructeur
+			 *
+			 */
+			c_frame_ring( void );
+
+			/**@fn
+			 * @param nb_frames : profondeur de la file
+			 * @param stream : flux d'erreurs ( NULL pour le désactiver )
+			 * @brief
+			 * Constructeur
+			 *
+			 */
+			c_frame_ring( 	unsigned int nb_frames,
+							ostream * stream = NULL );
+
+			/**@fn
+			 * @param nb_frames : profondeur de la file
+			 * @param stream : flux d'erreurs ( NULL pour le désactiver )
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon
+			 * @brief
+			 * Setup.
+			 *
+			 */
+			int setup( 	unsigned int nb_frames,
+						ostream * stream = NULL );
+
+			/**@fn
+			 * @param image : image décodée ( recopiée )
+			 * @return
+			 * - 0 si OK
+			 * - 1 si la file est fermée
+			 * @brief
+			 * Ajoute une image ; attend une place libre si la file est pleine.
+			 *
+			 */
+			int push( const IplImage * image );
+
+			/**@fn
+			 * @return
+			 * Image la plus ancienne ( NULL : file fermée et vide )
+			 * @brief
+			 * Attend une image. Elle reste valide jusqu'à pop.
+			 *
+			 */
+			const IplImage * front();
+
+			/**@fn
+			 * @brief
+			 * Rend la place de l'image renvoyée par front.
+			 *
+			 */
+			void pop();
+
+			/**@fn
+			 * @brief
+			 * Supprime les images en attente ( sauf celle en cours de lecture ),
+			 * par ex. après un saut dans la vidéo.
+			 *
+			 */
+			void flush();
+
+			/**@fn
+			 * @brief
+			 * Fermeture : réveille les threads en attente ; push échoue et front
+			 * renvoie NULL une fois la file vide.
+			 *
+			 */
+			void close();
+
+			/**@fn
+			 * @brief
+			 * Vide et rouvre la file ( début d'une vidéo ).
+			 *
+			 */
+			void reset();
+
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre d'images en attente.
+			 *
+			 */
+			unsigned int size();
+
+			/**@fn
+			 * @brief
+			 * Renvoie la profondeur de la file.
+			 **/
+			inline unsigned int nb_frames() const
+			{
+				return _nb_frames;
+			}
+
+			/**@fn
+			 * @brief
+			 * Destructeur
+			 *
+			 */
+			~c_frame_ring();
+
+		protected:
+			/**@fn
+			 * @brief
+			 * Ini. mémoire
+			 *
+			 */
+			void initialize();
+
+			/**@fn
+			 * @brief
+			 * Lib. mémoire
+			 *
+			 */
+			void free();
+
+			//Images
+			unsigned int _nb_frames;
+			IplImage ** _frames;
+
+			//Première image, nombre d'images ( dont celle en cours de lecture )
+			unsigned int 	_head,
+							_count;
+			bool 	_reading,
+					_closed;
+
+			//Synchronisation
+			pthread_mutex_t _mutex;
+			pthread_cond_t 	_not_empty,
+							_not_full;
+
+			//Flux d'erreurs
+			ostream * err_stream;
+	};
+
+#endif
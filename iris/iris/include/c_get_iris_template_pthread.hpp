@@ -8,14 +8,32 @@
 #include <pthread.h>
 #include "c_iris_thread.hpp"
 #include "c_buffer.hpp"
+#include "c_frame_ring.hpp"
 #include "c_focus_score.hpp"
 #include "display_functions.hpp"
+#include "c_stage_metrics.hpp"
 #include <ctime>
+
+class c_get_iris_template_pthread;
+
+/**@struct c_get_iris_template_worker
+ * @brief
+ * Paramètres d'un thread de segmentation : objet et numéro du thread dans son étage.
+ */
+struct c_get_iris_template_worker
+{
+	c_get_iris_template_pthread * obj;
+	unsigned int id;
+};
+
 /**@class c_get_iris_template_pthread
  * @brief
  * Gestion de la segmentation multi_thread de l'oeil
  * 
- * 
+ * Un thread d'acquisition, nb_pupil_threads threads de segmentation de la pupille et
+ * nb_iris_threads threads de segmentation de l'iris ( buffer.cfg ). Chaque thread a ses
+ * propres objets de traitement. Si buffer::prefetch_depth > 0, un thread de décodage
+ * lit la vidéo en avance ( prefetch_depth images ) pendant les prétraitements.
  */
 class c_get_iris_template_pthread
 {
@@ -33,12 +51,14 @@ class c_get_iris_template_pthread
 		 * argv[1] <-> data
 		 * argv[2] <-> save
 		 * argv[3 - n] <-> params
+		 * fps_name : fichier des statistiques ( dans save_dir )
 		 * @brief
 		 * Setup
 		 * 
 		 */
 		int setup ( unsigned int argc, char ** argv , const char * save_dir,
-					ostream * stream = NULL, bool display = false);
+					ostream * stream = NULL, bool display = false,
+					const char * fps_name = "fps.m" );
 	
 		/**@fn
 		 * @brief
@@ -47,6 +67,24 @@ class c_get_iris_template_pthread
 		 */
 		unsigned int help ( ostream & out, unsigned int id ) const;
 	
+		/**@fn
+		 * @param mode : true pour le traitement hors ligne
+		 * @brief
+		 * Mode hors ligne ( vidéos archivées, buffer::offline ) : les images sont
+		 * décodées au rythme des threads de segmentation ( pas de cadence à 25 fps ),
+		 * l'ajout dans les buffers image et pupille attend une place libre au lieu
+		 * d'écraser un objet, et les images passent dans l'ordre de la vidéo :
+		 * aucune image n'est perdue et le résultat ne dépend pas du temps de calcul.
+		 * Avec plusieurs threads pupille, chaque thread reçoit des suites de
+		 * buffer::pupil_run_length images consécutives ( run_buffers, créés par setup
+		 * si buffer::offline est activé ) pour que son tracking voie les images dans l'ordre.
+		 * 
+		 */
+		inline void set_offline( bool mode = true )
+		{
+			offline = mode;
+		}
+		
 		/**@fn
 		 * @brief
 		 * Lancement de l'objet.
@@ -63,7 +101,9 @@ class c_get_iris_template_pthread
 		
 		int test()
 		{
-			iris_thread->reset();
+			for ( unsigned int i = 0; i < nb_iris_threads; ++ i )
+				iris_threads[i]->reset();
+			return 0;
 		}
 		/**@fn
 		 * @brief
@@ -81,8 +121,10 @@ class c_get_iris_template_pthread
 		inline void set_error_stream( ostream & error_str = cout )
 		{
 			image_thread->set_error_stream( error_str );
-			pupil_thread->set_error_stream( error_str );
-			iris_thread->set_error_stream( error_str );
+			for ( unsigned int i = 0; i < nb_pupil_threads; ++ i )
+				pupil_threads[i]->set_error_stream( error_str );
+			for ( unsigned int i = 0; i < nb_iris_threads; ++ i )
+				iris_threads[i]->set_error_stream( error_str );
 			//~ focus_score_pupil->set_error_stream( error_str );
 			//~ focus_score_iris->set_error_stream( error_str );
 		}
@@ -110,18 +152,28 @@ class c_get_iris_template_pthread
 		void image_acquistion ( );
 	
 		/**@fn
+		 * @brief
+		 * Décodage de la vidéo dans frame_ring ( lecture anticipée ) ; les sauts
+		 * demandés par l'acquisition sont faits ici.
+		 * 
+		 */
+		void frame_decoding ( );
+	
+		/**@fn
+		 * @param id : numéro du thread
 		 * @brief
 		 * Segmentation de la pupille
 		 * 
 		 */
-		void pupil_segmentation ( );
+		void pupil_segmentation ( unsigned int id );
 	
 		/**@fn
+		 * @param id : numéro du thread
 		 * @brief
 		 * Segmentation de l'iris
 		 * 
 		 */
-		void iris_segmentation ( );
+		void iris_segmentation ( unsigned int id );
 	
 		/**@fn
 		 * @brief
@@ -129,24 +181,70 @@ class c_get_iris_template_pthread
 		 * 
 		 **/
 		void display();
+		
+		/**@fn
+		 * @brief
+		 * Arrêt anticipé ( thread iris ) : quand les stop_nb_templates meilleurs templates
+		 * dépassent stop_quality et que le score du K-ième n'a pas progressé de plus de
+		 * stop_gain ( relatif ) sur les stop_patience dernières images, l'acquisition
+		 * s'arrête et les buffers se vident.
+		 * 
+		 **/
+		void update_early_stop();
+		
+		/**@fn
+		 * @brief
+		 * Saut de skip_frames images après skip_patience images de score de netteté
+		 * inférieur à skip_focus ( si le format de la vidéo permet de se positionner ).
+		 * Appelé par le thread qui décode la vidéo.
+		 * 
+		 **/
+		void skip_ahead();
+		
+		/**@fn
+		 * @brief
+		 * Lecture / écriture d'un indicateur partagé entre les threads
+		 * ( early_stop, can_skip, img_end ) sous count_mutex.
+		 * 
+		 **/
+		bool get_flag( const bool & flag );
+		void set_flag( 	bool & flag,
+						bool value );
 	
 		//Pour l'acquisition d'image
 		CvCapture * video;
+		
+		//Images décodées en avance ( NULL : décodage dans le thread d'acquisition )
+		c_frame_ring * frame_ring;
 	
 		//Différents buffer
 		c_buffer  * buffer_image, // Score = id
 				  * buffer_pupil, 
 				  * buffer_iris;
 		
-		//Données tmp pour les différents buffer
-		c_buffer_data * b_data_image,
-					  * b_data_pupil,
-					  * b_data_iris;
+		//Hors ligne, plusieurs threads pupille : buffer image de chaque thread, qui
+		//reçoit les suites de pupil_run_length images n° t, t + nb_pupil_threads, ...
+		c_buffer ** run_buffers;
+		unsigned int pupil_run_length;
+		bool pupil_runs;
+		
+		//Réserves des objets échangés entre les threads ( pas de recopie )
+		c_frame_pool * pool_image,
+					 * pool_pupil,
+					 * pool_iris;
+		
+		//Données tmp pour la sauvegarde
+		c_buffer_data * b_data_iris;
 		
 		//Obj. de traitement
 		c_image_thread * image_thread;
-		c_pupil_thread * pupil_thread;
-		c_iris_thread * iris_thread;
+		c_pupil_thread ** pupil_threads;
+		c_iris_thread ** iris_threads;
+		unsigned int 	nb_pupil_threads,
+						nb_iris_threads;
+		
+		//Dernière image vue par le tracking de chaque thread pupille
+		unsigned int * last_frame_ids;
 		
 		//Calcul des scores
 		c_focus_score 	* focus_score_pupil,
@@ -155,7 +253,13 @@ class c_get_iris_template_pthread
 						r_height;
 					
 		//p_thread
-		pthread_t tab_threads[4]; 
+		pthread_t * tab_threads;
+		c_get_iris_template_worker * workers;
+		
+		//Threads encore actifs par étage, compteurs et indicateurs ( get_flag )
+		pthread_mutex_t count_mutex;
+		unsigned int 	nb_pupil_running,
+						nb_iris_running;
 		
 		//Variable d'arrêt
 		int * p_end;
@@ -166,6 +270,9 @@ class c_get_iris_template_pthread
 		const char * _filename;
 		
 		ofstream * fps_file;
+		
+		//Mesures de la vidéo courante ( écrites dans fps_file )
+		c_stage_metrics metrics;
 		unsigned int video_id;
 		
 		unsigned int nb_abb,
@@ -174,6 +281,7 @@ class c_get_iris_template_pthread
 					 nb_i_frames;
 		
 		
+		friend void * decode_function ( void * params );
 		friend void * image_function ( void * params );
 		friend void * pupil_function ( void * params );
 		friend void * iris_function ( void * params );
@@ -191,6 +299,27 @@ class c_get_iris_template_pthread
 			
 		bool display_on;
 		
+		//Traitement hors ligne
+		bool offline;
+		
+		//Arrêt anticipé ( buffer::stop_* )
+		unsigned int 	stop_nb_templates,
+						stop_patience,
+						nb_stale;
+		double 	stop_quality,
+				stop_gain,
+				best_score;
+		bool early_stop;
+		
+		//Saut des passages flous ( buffer::skip_* )
+		unsigned int 	skip_patience,
+						skip_frames,
+						nb_low_focus,
+						nb_skipped;
+		double skip_focus;
+		bool 	can_skip,
+				skip_request;
+		
 		
 		
 };
@@ -59,6 +59,19 @@ class c_image_thread
 		 */
 		int process(	const IplImage * image, 
 						const char * img_name);
+		
+		/**@fn
+		 * @param image : image
+		 * @param img_name : nom de l'image
+		 * @param out : données de sortie ( objet d'une réserve )
+		 * @brief
+		 * Prétraitements écrits directement dans out ( pas de recopie vers un buffer ).
+		 * La numérotation des images est celle de process.
+		 * 
+		 */
+		int process(	const IplImage * image, 
+						const char * img_name,
+						image_data * out );
 			/**@fn
 			 * @param error_str : flux d'erreur
 			 * @brief
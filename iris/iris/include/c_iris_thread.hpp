@@ -11,6 +11,7 @@
 #include "c_iris_code.hpp"
 #include <sys/stat.h>
 #include "iris_data.hpp"
+#include "c_stage_metrics.hpp"
 
 
 /**@class
@@ -49,6 +50,16 @@ public:
 	 * Routine
 	 */
 	int segment_iris( const pupil_data & p_data );
+	
+	/**@fn
+	 * @param p_data : pupille ( son contenu est transféré dans out )
+	 * @param out : données de sortie ( objet d'une réserve )
+	 * @brief
+	 * Segmentation écrite directement dans out : la pupille est échangée
+	 * avec celle de out au lieu d'être recopiée.
+	 */
+	int segment_iris( 	pupil_data & p_data,
+						iris_data * out );
 
 
 	/**@fn
@@ -89,6 +100,16 @@ public:
 		polar_iris->set_error_stream( error_str );
 		//~ focus_score->set_error_stream( error_str );
 	}
+	
+	/**@fn
+	 * @param _metrics : mesures ( NULL pour les désactiver )
+	 * @brief
+	 * Mesure des étapes ( segmentation, paupières, polaire, iris code ).
+	 */
+	inline void set_metrics( c_stage_metrics * _metrics )
+	{
+		metrics = _metrics;
+	}
 protected:
 
 	/**@fn
@@ -124,6 +145,9 @@ protected:
 	//Flux d'erreur
 	ostream * err_stream;
 	
+	//Mesures
+	c_stage_metrics * metrics;
+	
 	double _spot_threshold;
 	IplImage * mask_1,
 			 * mask_2,
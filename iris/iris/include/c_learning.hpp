@@ -2,12 +2,17 @@
 	#define _C_LEARNING_HPP_
 	#include <iostream>
 	#include <fstream>
+	#include <pthread.h>
 	#include "c_get_iris_template.hpp"
 	using namespace std;
 	
 	#define NB_PATH_MAX 250
 	#define NB_CLASS_MAX 300
 	
+	//Nombre de threads de segmentation ( 0 ou absent : 1 thread )
+	#define LEARNING_NAMESPACE "learning"
+	#define LEARNING_NB_THREADS "nb_threads"
+	
 	
 	
 	/**@struct
@@ -60,9 +65,27 @@
 
 	};
 	
+	/**@struct
+	 * @brief
+	 * Résultat de la segmentation d'une image
+	 * 
+	 */
+	struct learning_result
+	{
+		int status; // LEARNING_OPEN_FAILED, LEARNING_SEG_OK, LEARNING_SEG_FAILED
+		double time; // Durée ( horloge murale, s )
+		string errors; // Messages d'erreur de la segmentation
+	};
+	#define LEARNING_OPEN_FAILED 0
+	#define LEARNING_SEG_OK 1
+	#define LEARNING_SEG_FAILED 2
+	
 	/**@class
 	 * @brief
 	 * Classe pour l'apprentissage
+	 * Les images de toutes les classes sont segmentées par nb_threads threads ( 1 par défaut ),
+	 * chacun avec son propre objet de segmentation. Les logs sont écrits
+	 * à la fin, dans l'ordre des classes et des images.
 	 * 
 	 */
 	class c_learning
@@ -110,6 +133,15 @@
 			 * 
 			 */
 			int segment( );
+			
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre de threads de segmentation.
+			 */
+			inline unsigned int nb_threads() const
+			{
+				return _nb_threads;
+			}
 		
 			/**@fn
 			 * @brief
@@ -121,6 +153,15 @@
 			
 			void initialize();
 			
+			/**@fn
+			 * @param id : numéro du thread
+			 * @brief
+			 * Boucle d'un thread : prend l'image suivante jusqu'à la fin de la liste.
+			 */
+			void process( unsigned int id );
+			
+			friend void * learning_function ( void * params );
+			
 			//Données
 			struct iris_class_data ** data;
 			unsigned int _nb_classes;
@@ -130,6 +171,25 @@
 			string _save_rep;
 			c_get_iris_template obj;
 			
+			//Threads ( workers[0] == &obj )
+			unsigned int _nb_threads;
+			c_get_iris_template ** workers;
+			struct worker
+			{
+				c_learning * obj;
+				unsigned int id;
+			};
+			
+			//Liste des images ( toutes classes confondues )
+			unsigned int 	_nb_tasks,
+							_next_task,
+							_nb_done,
+							_nb_fails;
+			unsigned int 	* task_class,
+							* task_image;
+			learning_result * results;
+			pthread_mutex_t _mutex;
+			
 			//Log
 			ofstream * log;
 			
@@ -0,0 +1,194 @@
+/**@file c_lsh_index.hpp
+ * @author Valérian Némesin
+ * @brief
+ * Index de candidats par échantillonnage de bits ( LSH ) des iris codes binaires.
+ */
+#ifndef _C_LSH_INDEX_HPP_
+	#define _C_LSH_INDEX_HPP_
+	#include <iostream>
+	#include "c_database.hpp"
+	using namespace std;
+
+	/**@class c_lsh_index
+	 * @brief
+	 * Index multi-tables par échantillonnage de bits. Chaque table tire nb_bits
+	 * positions ( ligne, colonne ) de l'iris code ; la clé d'un iris code est la
+	 * valeur de ses bits en ces positions. Seuls les bits stables ( plan des bits
+	 * fragiles de c_database ) sont indexés : une clé contenant un bit masqué ou
+	 * fragile n'est pas insérée ( ni cherchée ).
+	 * Une requête calcule ses clés pour les décalages de la plage de recadrage
+	 * ( pas theta_step ) et chaque collision vote pour l'iris code indexé. Les
+	 * iris codes ayant le plus de votes sont les candidats, à vérifier ensuite
+	 * avec la distance exacte ( cf. c_matching::matching_candidates ).
+	 *
+	 * Compromis rappel / vitesse :
+	 * - nb_tables : plus de tables, meilleur rappel, requête plus lente
+	 * - nb_bits : plus de bits, moins de collisions d'imposteurs mais rappel plus faible
+	 * - theta_step : pas des décalages de la requête ( 1 : tous les décalages )
+	 * - nb_candidates ( requête ) : nombre d'iris codes vérifiés
+	 *
+	 * L'index dépend du taux de bits fragiles de la base : il doit être reconstruit
+	 * après c_database::compute_fragile_bit_threshold.
+	 */
+	class c_lsh_index
+	{
+		public:
+			/**@fn
+			 * @brief
+			 * Constructeur par défaut
+			 *
+			 */
+			c_lsh_index( void );
+
+			/**@fn
+			 * @param database : base d'iris codes ( iris codes binaires calculés )
+			 * @param nb_tables : nombre de tables
+			 * @param nb_bits : nombre de bits par clé ( 1 à 64 )
+			 * @param d_theta : plage de recadrage ( même définition que c_matching )
+			 * @param theta_step : pas des décalages de la requête
+			 * @param seed : graine du tirage des positions
+			 * @param stream : flux d'erreurs ( NULL pour le désactiver )
+			 * @brief
+			 * Constructeur
+			 *
+			 */
+			c_lsh_index( 	const c_database & database,
+							unsigned int nb_tables,
+							unsigned int nb_bits,
+							double d_theta,
+							unsigned int theta_step = 1,
+							unsigned int seed = 0,
+							ostream * stream = NULL );
+
+			/**@fn
+			 * @param database : base d'iris codes ( iris codes binaires calculés )
+			 * @param nb_tables : nombre de tables
+			 * @param nb_bits : nombre de bits par clé ( 1 à 64 )
+			 * @param d_theta : plage de recadrage ( même définition que c_matching )
+			 * @param theta_step : pas des décalages de la requête
+			 * @param seed : graine du tirage des positions
+			 * @param stream : flux d'erreurs ( NULL pour le désactiver )
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon
+			 * @brief
+			 * Construit l'index.
+			 *
+			 */
+			int setup( 	const c_database & database,
+						unsigned int nb_tables,
+						unsigned int nb_bits,
+						double d_theta,
+						unsigned int theta_step = 1,
+						unsigned int seed = 0,
+						ostream * stream = NULL );
+
+			/**@fn
+			 * @param[out] candidates : numéros des candidats ( votes décroissants )
+			 * @param[in] nb_candidates : nombre maximal de candidats
+			 * @param[in] iris_code_bis : iris code binaire
+			 * @param[in] fragile_bits : bits stables ( plan des bits fragiles )
+			 * @return
+			 * Nombre de candidats
+			 * @brief
+			 * Recherche des candidats d'un iris code ( même taille que ceux de la base ).
+			 * Non réentrant : utilise la mémoire de travail de l'index.
+			 *
+			 */
+			unsigned int query( 	unsigned int * candidates,
+									unsigned int nb_candidates,
+									const unsigned long long * iris_code_bis,
+									const unsigned long long * fragile_bits );
+
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre de tables.
+			 **/
+			inline unsigned int nb_tables() const
+			{
+				return _nb_tables;
+			}
+
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre d'entrées de l'index ( toutes tables ).
+			 **/
+			unsigned long long nb_entries() const;
+
+			/**@fn
+			 * @brief
+			 * Destructeur
+			 *
+			 */
+			~c_lsh_index();
+
+		protected:
+			/**@fn
+			 * @brief
+			 * Ini. mémoire
+			 *
+			 */
+			void initialize();
+
+			/**@fn
+			 * @brief
+			 * Lib. mémoire
+			 *
+			 */
+			void free();
+
+			/**@fn
+			 * @return
+			 * - 0 si tous les bits échantillonnés sont stables
+			 * - 1 sinon
+			 * @brief
+			 * Clé de la table n°t d'un iris code décalé de theta colonnes.
+			 *
+			 */
+			int get_key( 	unsigned long long & key,
+							unsigned int t,
+							const unsigned long long * iris_code_bis,
+							const unsigned long long * fragile_bits,
+							int theta ) const;
+
+			//Entrée d'une table ( triée par clé )
+			struct lsh_entry
+			{
+				unsigned long long key;
+				unsigned int id;
+				bool operator < ( const lsh_entry & e ) const
+				{
+					return ( key < e.key );
+				}
+			};
+
+			//Paramètres
+			unsigned int 	_nb_tables,
+							_nb_bits,
+							_theta_step;
+			int 	_theta_min,
+					_theta_max;
+
+			//Dimensions des iris codes indexés
+			unsigned int 	_width,
+							_height,
+							_width_step;
+
+			//Positions échantillonnées ( nb_tables * nb_bits )
+			unsigned int 	* _rows,
+							* _cols;
+
+			//Tables
+			lsh_entry ** _tables;
+			unsigned int * _table_sizes;
+
+			//Votes ( mémoire de travail )
+			unsigned int _nb_classes;
+			unsigned int * _votes;
+			unsigned int * _voted;
+
+			//Flux d'erreurs
+			ostream * err_stream;
+	};
+
+#endif
@@ -8,6 +8,16 @@
 	#include "distances.hpp"
 	#include "c_database.hpp"
 	
+	struct d_matching;
+	
+	//Tâches du pool de threads
+	#define MATCHING_TASK_QUERY 0
+	#define MATCHING_TASK_TILES 1
+	#define MATCHING_TASK_SORT 2
+	#define MATCHING_TASK_SWEEP 3
+	
+	//Mémoire visée par une tuile de matching_matrix ( octets, cache L2 )
+	#define MATCHING_TILE_CACHE_SIZE 262144
 	
 	/**@class c_matching
 	 * 
@@ -68,7 +78,9 @@
 									ostream * stream = NULL,
 									const char * n_space = "matching",
 									const char * distance_name = "distance",
-									const char * d_theta_name = "d_theta" );			
+									const char * d_theta_name = "d_theta",
+									const char * rotation_bank_name = "rotation_bank",
+									const char * nb_threads_name = "nb_threads" );			
 			
 			
 			/**@fn
@@ -98,13 +110,184 @@
 										const unsigned long long * _fragile_bits,
 										const char * class_name,
 										const char * video_name = NULL );				
+			
+			/**@fn
+			 * @param[out] distances : distances à chaque iris code de la base
+			 * @param[out] orders : classes par distances croissantes
+			 * @param[out] truth : classe de l'iris code
+			 * @param[in] fuzzy_code : iris code flou quantifié ( cf. c_database::fuzzy_code )
+			 * @param[in] class_name : nom de la classe
+			 * @param[in] video_name : nom de la vidéo
+			 * @return
+			 * Meilleure classe
+			 * @brief
+			 * Matching E(Hamming) sur les iris codes flous quantifiés ( cf. distance::registering_q ),
+			 * réparti entre les threads du pool. Même distance que matching à l'arrondi près.
+			 */
+			unsigned int matching_opt (	double * distances,
+										unsigned int * orders,
+										unsigned int & truth,
+										const short * fuzzy_code,
+										const char * class_name,
+										const char * video_name = NULL );
 									
 									
 									
+			/**@fn
+			 * @param[out] distances : k plus petites distances ( ordre croissant )
+			 * @param[out] ids : numéros des iris codes correspondants
+			 * @param[in] k : nombre de résultats
+			 * @param[in] _iris_codes_bis : iris code binaire
+			 * @param[in] _masks : masque binaire
+			 * @param[in] _fragile_bits : bits fragiles
+			 * @return
+			 * Nombre de résultats ( au plus k )
+			 * @brief
+			 * Recherche des k plus proches iris codes. Les k meilleurs sont gardés dans un tas ;
+			 * la comparaison d'une rotation est abandonnée ligne par ligne dès que sa distance
+			 * dépasse forcément la k-ième meilleure ( cf. distance::*_bounded ). Les distances
+			 * renvoyées sont identiques à celles de matching_opt. Non disponible pour E(Hamming).
+			 *
+			 */
+			unsigned int matching_top_k (	double * distances,
+											unsigned int * ids,
+											unsigned int k,
+											const unsigned long long * _iris_codes_bis,
+											const unsigned long long * _masks,
+											const unsigned long long * _fragile_bits );
+			
+			/**@fn
+			 * @brief
+			 * Nombre de rotations comparées et nombre de rotations abandonnées
+			 * avant la dernière ligne lors du dernier appel à matching_top_k.
+			 **/
+			inline unsigned long long nb_top_k_comparisons() const
+			{
+				return _nb_top_k_comparisons;
+			}
+			inline unsigned long long nb_top_k_aborted() const
+			{
+				return _nb_top_k_aborted;
+			}
+			
+			/**@fn
+			 * @param[out] distances : matrice des distances ( probes.nb_classes() x nb_classes(), ligne par iris code de probes )
+			 * @param[out] orders : classes de chaque ligne par distances croissantes ( même disposition )
+			 * @param[in] probes : iris codes comparés ( iris codes binaires ou, pour E(Hamming), iris codes flous calculés )
+			 * @param[in] probe_block : nombre d'iris codes de probes par tuile ( 0 : automatique )
+			 * @param[in] gallery_block : nombre d'iris codes de la base par tuile ( 0 : automatique )
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon ( E(Hamming) sans iris codes flous dans probes )
+			 * @brief
+			 * Matching de tous les iris codes de probes contre la base. La matrice est calculée
+			 * par tuiles ( bloc de probes x bloc de la base ) qui tiennent dans le cache
+			 * ( MATCHING_TILE_CACHE_SIZE ) ; les tuiles sont réparties entre les threads du pool.
+			 * Résultats identiques à matching_opt ligne par ligne.
+			 *
+			 */
+			int matching_matrix (	double * distances,
+									unsigned int * orders,
+									const c_database & probes,
+									unsigned int probe_block = 0,
+									unsigned int gallery_block = 0 );
+			
+			/**@fn
+			 * @param[out] orders : classes de chaque ligne par distances croissantes
+			 * @param[in] distances : matrice des distances ( nb_rows x nb_classes() )
+			 * @param[in] nb_rows : nombre de lignes
+			 * @brief
+			 * Trie chaque ligne d'une matrice de distances ( même tri que matching_opt ).
+			 *
+			 */
+			void sort_matrix (	unsigned int * orders,
+								double * distances,
+								unsigned int nb_rows );
+			
+			/**@fn
+			 * @param[out] distances : matrices des distances de chaque couple ( fbr[k], alpha[a] ),
+			 * rangées par k puis a ( matrice n° k * nb_alpha + a, même disposition que matching_matrix )
+			 * @param[in] probes : iris codes comparés
+			 * @param[in] fbr : taux de bits fragiles
+			 * @param[in] nb_fbr : nombre de taux
+			 * @param[in] alpha : valeurs de alpha ( Hamming_FBD ; ignorées sinon )
+			 * @param[in] nb_alpha : nombre de valeurs de alpha
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon ( E(Hamming) )
+			 * @brief
+			 * Matching de tous les iris codes de probes pour toute une grille ( FBR, alpha ) en
+			 * un seul recadrage : pour chaque couple et chaque rotation, les bits fragiles de
+			 * tous les taux sont tournés ensemble et comptés une fois ; chaque point de la grille
+			 * est ensuite déduit des comptages. Distances identiques à matching_opt ( sans banque
+			 * de rotations ) après compute_fragile_bit_threshold( fbr[k] ) et set_alpha( alpha[a] ).
+			 * Mémoire : nb_fbr * nb_alpha matrices.
+			 *
+			 */
+			int matching_sweep (	double * distances,
+									const c_database & probes,
+									const double * fbr,
+									unsigned int nb_fbr,
+									const double * alpha,
+									unsigned int nb_alpha );
+			
+			/**@fn
+			 * @param[out] distances : distances des candidats ( ordre croissant )
+			 * @param[out] ids : numéros des iris codes correspondants
+			 * @param[in] candidates : numéros des iris codes à vérifier ( cf. c_lsh_index::query )
+			 * @param[in] nb_candidates : nombre de candidats
+			 * @param[in] _iris_codes_bis : iris code binaire
+			 * @param[in] _masks : masque binaire
+			 * @param[in] _fragile_bits : bits fragiles
+			 * @return
+			 * Nombre de résultats
+			 * @brief
+			 * Matching restreint à une liste de candidats : chaque candidat est recadré
+			 * comme dans matching_opt ( distances identiques ).
+			 *
+			 */
+			unsigned int matching_candidates (	double * distances,
+												unsigned int * ids,
+												const unsigned int * candidates,
+												unsigned int nb_candidates,
+												const unsigned long long * _iris_codes_bis,
+												const unsigned long long * _masks,
+												const unsigned long long * _fragile_bits );
+			
+			/**@fn
+			 * @param nb_rotations : nombre de rotations stockées par iris code ( 0 : désactivée )
+			 * @brief
+			 * Active la banque de rotations de la base pour matching_opt.
+			 *
+			 */
+			int set_rotation_bank( unsigned int nb_rotations );
+			
+			/**@fn
+			 * @param nb_threads : nombre de threads ( 1 : pas de threads )
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon
+			 * @brief
+			 * Crée le pool de threads de matching_opt : la base est découpée en
+			 * nb_threads parts traitées en parallèle pour un même iris code, puis
+			 * les distances triées de chaque part sont fusionnées.
+			 *
+			 */
+			int set_nb_threads( unsigned int nb_threads );
+			
+			/**@fn
+			 * @brief
+			 * Renvoie le nombre de threads de matching_opt.
+			 **/
+			inline unsigned int nb_threads() const
+			{
+				return _nb_threads;
+			}
+
 			/**@fn
 			 * @brief
 			 * Destructeur
-			 * 
+			 *
 			 */
 			~c_matching();
 			
@@ -141,15 +324,155 @@
 			 * 
 			 */
 			void free();
-		
+
+			/**@fn
+			 * @brief
+			 * Recadrage de l'iris code n°id à l'aide de la banque de rotations.
+			 * Les angles absents de la banque sont calculés dans _code_2_data, _mask_2_data, _fb_2_data.
+			 *
+			 */
+			int registering_bank ( 	double & d,
+									int & theta,
+									unsigned int id,
+									const unsigned long long * code_data,
+									const unsigned long long * mask_data,
+									const unsigned long long * fb_data,
+									int theta_min,
+									int theta_max,
+									const void * params,
+									unsigned long long * _code_2_data,
+									unsigned long long * _mask_2_data,
+									unsigned long long * _fb_2_data );
+
+			/**@fn
+			 * @brief
+			 * Recadrage de l'iris code n°i avec la mémoire de travail n°scratch_id
+			 * ( banque de rotations si activée ). d = 1 si l'iris code est absent.
+			 *
+			 */
+			void register_template(	double & d,
+									unsigned int i,
+									const unsigned long long * iris_code_bis,
+									const unsigned long long * mask,
+									const unsigned long long * fragile_bits,
+									double p,
+									unsigned int scratch_id );
+
+			/**@fn
+			 * @brief
+			 * Recadrage E(Hamming) de l'iris code flou n°i. d = 1 si l'iris code est absent.
+			 *
+			 */
+			void register_fuzzy(	double & d,
+									unsigned int i,
+									const short * fuzzy_code );
+
+			/**@fn
+			 * @brief
+			 * Calcule et trie les distances de la part n°id de la base ( requête courante ).
+			 *
+			 */
+			void matching_part( unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * Calcule les tuiles de matching_matrix jusqu'à épuisement ( thread n°id ).
+			 *
+			 */
+			void matrix_tiles( unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * Trie les lignes de la part n°id de matching_matrix.
+			 *
+			 */
+			void matrix_sort( unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * Calcule les lignes de la part n°id de matching_sweep.
+			 *
+			 */
+			void sweep_part( unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * Exécute la tâche courante du pool pour le thread n°id.
+			 *
+			 */
+			void run_task( unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * Lance une tâche sur tous les threads du pool et attend sa fin.
+			 *
+			 */
+			void run_pool( unsigned int task );
+			
+			/**@fn
+			 * @brief
+			 * Tâche du pool ( run_task ).
+			 *
+			 */
+			static void pool_task( void * obj, unsigned int id );
+			
+			/**@fn
+			 * @brief
+			 * Arrêt du pool de threads.
+			 *
+			 */
+			void stop_threads();
+			
 			//Distance employée
 			distance::function_prototype_bis dist;
 			distance::function_prototype_64b dist_bis;
+			distance::function_prototype_64b_aligned dist_aligned;
+			distance::function_prototype_64b_bounded dist_bounded;
+			
+			//Statistiques du dernier matching_top_k
+			unsigned long long 	_nb_top_k_comparisons,
+								_nb_top_k_aborted;
 
 			
 			double d_theta;
 			void * dist_params;
 			
+			//Pool de threads
+			c_thread_pool _pool;
+			unsigned int _nb_threads; // _pool.nb_threads()
+			unsigned int _pool_task;
+			
+			//Mémoire de travail de chaque thread ( iris code tourné )
+			unsigned long long ** _scratch;
+			unsigned int _scratch_size;
+			
+			//Requête courante
+			double * _q_distances;
+			d_matching * _q_results;
+			const unsigned long long 	* _q_iris_code,
+										* _q_mask,
+										* _q_fragile_bits;
+			const short * _q_fuzzy_code;
+			double _q_p;
+			
+			//Matrice courante ( matching_matrix )
+			unsigned int * _m_orders;
+			const c_database * _m_probes;
+			unsigned int 	_m_nb_rows,
+							_m_probe_block,
+							_m_gallery_block,
+							_m_nb_gallery_blocks,
+							_m_nb_tiles,
+							_m_next_tile;
+			
+			//Grille courante ( matching_sweep )
+			unsigned long long 	** _s_gallery,
+								** _s_probes;
+			unsigned int 	_s_nb_planes,
+							_s_nb_fbr,
+							_s_nb_alpha;
+			const double * _s_alpha;
+			
 
 	};
 	
@@ -58,6 +58,17 @@ class c_pupil_thread
 		 * 
 		 */
 		int segment_pupil( 	const image_data & img_data );
+		
+		/**@fn
+		 * @param img_data : image ( son contenu est transféré dans out )
+		 * @param out : données de sortie ( objet d'une réserve )
+		 * @brief
+		 * Segmentation écrite directement dans out : l'image est échangée
+		 * avec celle de out au lieu d'être recopiée.
+		 * 
+		 */
+		int segment_pupil( 	image_data & img_data,
+							pupil_data * out );
 						
 		/**@fn
 		 * @brief
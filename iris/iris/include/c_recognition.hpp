@@ -3,6 +3,9 @@
 	#define _C_RECOGNITION_HPP_
 	#include "c_matching.hpp"
 	
+	//Nombre de FRR visés pour far_at_frr ( 10%, 1%, 0.1% )
+	#define RECOGNITION_NB_FRR 3
+	
 	/**@class
 	 * @brief
 	 * Classe de gestion de la reconnaissance d'iris.
@@ -59,6 +62,45 @@
 			int match( 	double fbr, 
 						double alpha = 0);
 			
+			/**@fn
+			 * @param fbr : taux de bits fragiles
+			 * @param nb_fbr : nombre de taux
+			 * @param alpha : valeurs de alpha
+			 * @param nb_alpha : nombre de valeurs de alpha
+			 * @return
+			 * - 0 si OK
+			 * - 1 sinon
+			 * @brief
+			 * Matching de toute une grille ( FBR, alpha ) en un seul passage
+			 * ( cf. c_matching::matching_sweep ). Chaque point est ensuite
+			 * sélectionné par select_sweep.
+			 * 
+			 */
+			int match_sweep( 	const double * fbr,
+								unsigned int nb_fbr,
+								const double * alpha,
+								unsigned int nb_alpha );
+			
+			/**@fn
+			 * @brief
+			 * Résultats du point ( fbr[k], alpha[a] ) de la dernière grille :
+			 * identiques à match( fbr[k], alpha[a] ).
+			 * 
+			 */
+			int select_sweep( 	unsigned int k,
+								unsigned int a );
+			
+			/**@fn
+			 * @brief
+			 * Mémoire ( octets ) des distances d'une grille de nb_fbr x nb_alpha points.
+			 * 
+			 */
+			size_t sweep_memory( 	unsigned int nb_fbr,
+									unsigned int nb_alpha ) const
+			{
+				return sizeof(double) * nb_fbr * nb_alpha * videos->nb_classes() * images->nb_classes();
+			}
+			
 			/**@fn
 			 * @brief
 			 * Sauvegarde
@@ -129,6 +171,14 @@
 			 */
 			void free();
 			
+			/**@fn
+			 * @brief
+			 * Courbes ROC / DET, EER et FAR pour les FRR visés, en un seul balayage des
+			 * distances authentiques et imposteurs triées ( O(N log N) ).
+			 * - nb_thresholds > 0 : seuils i / nb_thresholds
+			 * - nb_thresholds = 0 : seuils exacts ( chaque distance distincte )
+			 * L'EER et les FAR sont toujours calculés sur les seuils exacts.
+			 **/
 			void get_roc_data();
 			
 			void get_top_rank();
@@ -161,6 +211,21 @@
 					* g_distances;
 					
 			double err;
+			
+			//Distances de la dernière grille ( FBR, alpha )
+			double * sweep_distances;
+			unsigned int 	_sweep_nb_fbr,
+							_sweep_nb_alpha;
+			
+			//Nombre de points des courbes ROC
+			unsigned int _nb_roc_points;
+			
+			//Taux d'égale erreur et seuil correspondant
+			double 	eer,
+					eer_threshold;
+			
+			//FAR pour les FRR visés
+			double far_at_frr[RECOGNITION_NB_FRR];
 			unsigned int _nb_video;
 			
 			
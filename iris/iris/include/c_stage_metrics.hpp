@@ -0,0 +1,184 @@
+/**@file c_stage_metrics.hpp
+ * @author Valérian Némesin
+ * @brief
+ * Mesures de temps ( horloge murale monotone ) et compteurs des étapes du pipeline.
+ */
+#ifndef _C_STAGE_METRICS_HPP_
+#define _C_STAGE_METRICS_HPP_
+#include <pthread.h>
+#include <iostream>
+using namespace std;
+
+//Histogrammes : classes logarithmiques de METRIC_MIN_VALUE à METRIC_MIN_VALUE * 10^METRIC_NB_DECADES
+#define METRIC_BINS_PER_DECADE 20
+#define METRIC_NB_DECADES 11
+#define METRIC_MIN_VALUE 1e-7
+#define METRIC_NB_BINS ( METRIC_BINS_PER_DECADE * METRIC_NB_DECADES + 2 )
+
+/**@enum metric_id
+ * @brief
+ * Mesures du pipeline ( durées en s, sauf les tailles de file ).
+ **/
+enum metric_id
+{
+	METRIC_DECODE = 0,
+	//Attente d'une image décodée ( lecture anticipée )
+	METRIC_DECODE_WAIT,
+	METRIC_PREPROCESSING,
+	METRIC_FOCUS_SCORE,
+	METRIC_PUPIL_SEGMENTATION,
+	METRIC_IRIS_SEGMENTATION,
+	METRIC_EYELIDS,
+	METRIC_POLAR,
+	METRIC_IRIS_CODE,
+	METRIC_SAVE,
+	//Attente des files ( ajout / retrait ) et nombre d'objets après ajout
+	METRIC_IMAGE_PUSH_WAIT,
+	METRIC_IMAGE_POP_WAIT,
+	METRIC_IMAGE_DEPTH,
+	METRIC_PUPIL_PUSH_WAIT,
+	METRIC_PUPIL_POP_WAIT,
+	METRIC_PUPIL_DEPTH,
+	METRIC_IRIS_PUSH_WAIT,
+	METRIC_IRIS_DEPTH,
+	METRIC_COUNT
+};
+
+/**@fn
+ * @brief
+ * Horloge murale monotone ( s ).
+ **/
+double monotonic_time( void );
+
+/**@class c_metric_histogram
+ * @brief
+ * Histogramme à classes logarithmiques ( 20 par décade, ~12 % de résolution ) :
+ * nombre, somme, min, max et quantiles approchés, en mémoire constante.
+ */
+class c_metric_histogram
+{
+	public:
+		c_metric_histogram ( void );
+
+		/**@fn
+		 * @brief
+		 * Ajoute une valeur ( >= 0 ).
+		 **/
+		void add ( double value );
+
+		/**@fn
+		 * @brief
+		 * Remise à zéro.
+		 **/
+		void reset ( void );
+
+		/**@fn
+		 * @param p : quantile ( 0 - 1 )
+		 * @brief
+		 * Quantile approché ( centre géométrique de la classe, borné par min et max ).
+		 **/
+		double quantile ( double p ) const;
+
+		inline unsigned long long count() const
+		{
+			return _count;
+		}
+		inline double sum() const
+		{
+			return _sum;
+		}
+		inline double min() const
+		{
+			return _min;
+		}
+		inline double max() const
+		{
+			return _max;
+		}
+
+	protected:
+		unsigned long long _bins[METRIC_NB_BINS];
+		unsigned long long _count;
+		double 	_sum,
+				_min,
+				_max;
+};
+
+/**@class c_stage_metrics
+ * @brief
+ * Mesures d'un pipeline ( une vidéo ), partagées entre ses threads ( mutex ).
+ */
+class c_stage_metrics
+{
+	public:
+		/**@fn
+		 * @brief
+		 * Constructeur
+		 **/
+		c_stage_metrics ( void );
+
+		/**@fn
+		 * @brief
+		 * Ajoute une mesure.
+		 **/
+		void add ( 	metric_id id,
+					double value );
+
+		/**@fn
+		 * @brief
+		 * Remise à zéro ( début d'une vidéo ).
+		 **/
+		void reset ( void );
+
+		/**@fn
+		 * @param out : flux
+		 * @param video_id : numéro de la vidéo ( à partir de 1 )
+		 * @brief
+		 * Ecriture au format Matlab ( comme fps.m ) : pour chaque mesure,
+		 * metrics(video_id).nom = [ nombre, somme, moyenne, p50, p95, p99, max ];
+		 **/
+		void save ( ostream & out,
+					unsigned int video_id );
+		
+		/**@fn
+		 * @brief
+		 * Ecriture d'une seule mesure ( cf. save ).
+		 **/
+		void save ( ostream & out,
+					unsigned int video_id,
+					metric_id id );
+
+		/**@fn
+		 * @brief
+		 * Nom d'une mesure.
+		 **/
+		static const char * name ( metric_id id );
+
+		/**@fn
+		 * @brief
+		 * Destructeur
+		 **/
+		~c_stage_metrics();
+
+	protected:
+		c_metric_histogram _histograms[METRIC_COUNT];
+		pthread_mutex_t _mutex;
+};
+
+/**@class c_scoped_timer
+ * @brief
+ * Mesure la durée de vie de l'objet ( rien si metrics == NULL ).
+ */
+class c_scoped_timer
+{
+	public:
+		c_scoped_timer ( 	c_stage_metrics * metrics,
+							metric_id id );
+		~c_scoped_timer();
+	protected:
+		c_stage_metrics * _metrics;
+		metric_id _id;
+		double _start;
+};
+
+#endif
@@ -0,0 +1,148 @@
+/**@file c_video_scheduler.hpp
+ * @author Valérian Némesin
+ * @brief
+ * Traitement simultané de plusieurs vidéos.
+ */
+#ifndef _C_VIDEO_SCHEDULER_HPP_
+#define _C_VIDEO_SCHEDULER_HPP_
+#include <pthread.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include "c_get_iris_template_pthread.hpp"
+
+//Nombre de vidéos traitées simultanément ( buffer.cfg )
+#define SCHEDULER_NB_VIDEOS "nb_videos"
+
+/**@struct video_job
+ * @brief
+ * Vidéo à traiter : fichier, rép. de sauvegarde et fichier de log ( vide : pas de log ).
+ */
+struct video_job
+{
+	string filename,
+		   save_dir,
+		   log_filename;
+};
+
+/**@class c_video_scheduler
+ * @brief
+ * Ordonnanceur de vidéos : nb_videos pipelines ( c_get_iris_template_pthread ) sont
+ * créés une fois pour toutes et prennent les vidéos de la liste au fur et à mesure.
+ * Chaque pipeline a ses propres threads, buffers et objets de tracking : les vidéos
+ * traitées en même temps sont indépendantes. Les phases de démarrage et de fin d'une
+ * vidéo courte sont recouvertes par le traitement des autres.
+ */
+class c_video_scheduler
+{
+	public:
+		/**@fn
+		 * @brief
+		 * Constructeur
+		 */
+		c_video_scheduler ( void );
+
+		/**@fn
+		 * @param argc : nombre de fichiers de paramètres
+		 * @param argv : fichiers de paramètres
+		 * @param save_dir : rép. des fichiers fps_<n>.m
+		 * @param stream : flux d'erreurs
+		 * @return
+		 * - 0 si OK
+		 * - 1 sinon
+		 * @brief
+		 * Setup : buffer::nb_videos pipelines ( 1 par défaut ), sans affichage.
+		 */
+		int setup ( unsigned int argc,
+					char ** argv,
+					const char * save_dir,
+					ostream * stream = NULL );
+
+		/**@fn
+		 * @param filename : vidéo
+		 * @param save_dir : rép. de sauvegarde des templates
+		 * @param log_filename : fichier de log ( NULL : pas de log )
+		 * @brief
+		 * Ajoute une vidéo à la liste ( avant run ).
+		 */
+		void add_job ( 	const char * filename,
+						const char * save_dir,
+						const char * log_filename = NULL );
+
+		/**@fn
+		 * @param end : variable d'arrêt ( != 0 : arrêt des vidéos en cours )
+		 * @return
+		 * Nombre de vidéos en échec
+		 * @brief
+		 * Traite toutes les vidéos de la liste et attend la fin.
+		 */
+		unsigned int run ( int & end );
+
+		/**@fn
+		 * @brief
+		 * Destructeur
+		 */
+		~c_video_scheduler();
+
+		/**@fn
+		 * @brief
+		 * Renvoie le nombre de vidéos traitées simultanément.
+		 */
+		inline unsigned int nb_videos() const
+		{
+			return _nb_videos;
+		}
+
+		/**@fn
+		 * @brief
+		 * Renvoie le nombre de vidéos dans la liste.
+		 */
+		inline unsigned int nb_jobs() const
+		{
+			return _jobs.size();
+		}
+
+	protected:
+		/**@fn
+		 * @brief
+		 * Ini.
+		 */
+		void initialize();
+
+		/**@fn
+		 * @brief
+		 * Lib. mémoire
+		 */
+		void free();
+
+		/**@fn
+		 * @param id : numéro du pipeline
+		 * @brief
+		 * Boucle d'un pipeline : prend la vidéo suivante jusqu'à la fin de la liste.
+		 */
+		void process ( unsigned int id );
+
+		friend void * video_scheduler_function ( void * params );
+
+		//Pipelines
+		unsigned int _nb_videos;
+		c_get_iris_template_pthread ** _pipelines;
+		pthread_t * _threads;
+		struct worker
+		{
+			c_video_scheduler * obj;
+			unsigned int id;
+		};
+		worker * _workers;
+
+		//Liste des vidéos
+		vector<video_job> _jobs;
+		unsigned int 	_next_job,
+						_nb_done,
+						_nb_failed;
+		pthread_mutex_t _mutex;
+		int * p_end;
+
+		ostream * err_stream;
+};
+#endif
@@ -9,6 +9,8 @@
 	#include <opencv/cv.h>
 	#include <opencv/highgui.h>
 	#include "lib_image.hpp"
+	#include "popcount.hpp"
+	#include "expectation.hpp"
 	#define ACC 1
 
 	namespace distance
@@ -446,13 +448,320 @@
 																											
 																
 																		
+		#define DIST_ALIGNED(type)\
+		template int distance :: Hamming_aligned ( 	double & d,\
+													const type * code_1_data,\
+													const type * mask_1_data,\
+													const type * fb_data_1,\
+													const type * code_2_data,\
+													const type * mask_2_data,\
+													const type * fb_data_2,\
+													unsigned int width,\
+													unsigned int height,\
+													unsigned int width_step,\
+													const void * params );\
+		template int distance :: fragile_bit_distance_aligned ( double & d,\
+																const type * code_1_data,\
+																const type * mask_1_data,\
+																const type * fb_data_1,\
+																const type * code_2_data,\
+																const type * mask_2_data,\
+																const type * fb_data_2,\
+																unsigned int width,\
+																unsigned int height,\
+																unsigned int width_step,\
+																const void * params );\
+		template int distance :: Hamming_FBD_aligned ( 	double & d,\
+														const type * code_1_data,\
+														const type * mask_1_data,\
+														const type * fb_data_1,\
+														const type * code_2_data,\
+														const type * mask_2_data,\
+														const type * fb_data_2,\
+														unsigned int width,\
+														unsigned int height,\
+														unsigned int width_step,\
+														const void * params );
+
+		/**@typedef
+		 * @param[out] d : distance entre les deux iris-codes
+		 * @param[in] code_1_data : iris code 1
+		 * @param[in] mask_1_data : masque 1
+		 * @param[in] fb_1_data : bits fragiles 1
+		 * @param[in] code_2_data : iris code 2 ( déjà recadré )
+		 * @param[in] mask_2_data : masque 2 ( déjà recadré )
+		 * @param[in] fb_2_data : bits fragiles 2 ( déjà recadrés )
+		 * @param[in] width : nombre de directions angulaires de l'iris code
+		 * @param[in] height : 2 fois le nombre de rayons de l'iris code
+		 * @param[in] width_step : nombre de mots par ligne
+		 * @param[in] params : paramètres de la distance
+		 * @return
+		 * - 0 si matching réussi
+		 * - 1 si échec (0 pixel à comparer!)
+		 * @brief
+		 * Prototype pour la comparaison de deux iris codes binaires sans rotation.
+		 *
+		 */
+		typedef int (*function_prototype_64b_aligned) ( double & d,
+														const unsigned long long * code_1_data,
+														const unsigned long long * mask_1_data,
+														const unsigned long long * fb_1_data,
+														const unsigned long long * code_2_data,
+														const unsigned long long * mask_2_data,
+														const unsigned long long * fb_2_data,
+														unsigned int width,
+														unsigned int height,
+														unsigned int width_step,
+														const void * params );
+
+		/**@fn
+		 * @brief
+		 * Distance de Hamming rapide entre deux iris codes déjà recadrés.
+		 * 
+		 **/
+		template <class type> int Hamming_aligned ( double & d,
+													const type * code_1_data,
+													const type * mask_1_data,
+													const type * fb_data_1,
+													const type * code_2_data,
+													const type * mask_2_data,
+													const type * fb_data_2,
+													unsigned int width,
+													unsigned int height,
+													unsigned int width_step,
+													const void * params );
+
+		/**@fn
+		 * @brief
+		 * Distance des bits fragiles rapide entre deux iris codes déjà recadrés.
+		 * 
+		 **/
+		template <class type> int fragile_bit_distance_aligned ( 	double & d,
+																	const type * code_1_data,
+																	const type * mask_1_data,
+																	const type * fb_data_1,
+																	const type * code_2_data,
+																	const type * mask_2_data,
+																	const type * fb_data_2,
+																	unsigned int width,
+																	unsigned int height,
+																	unsigned int width_step,
+																	const void * params );
+
+		/**@fn
+		 * @brief
+		 * Hamming + FBD rapide entre deux iris codes déjà recadrés.
+		 * 
+		 **/
+		template <class type> int Hamming_FBD_aligned ( double & d,
+														const type * code_1_data,
+														const type * mask_1_data,
+														const type * fb_data_1,
+														const type * code_2_data,
+														const type * mask_2_data,
+														const type * fb_data_2,
+														unsigned int width,
+														unsigned int height,
+														unsigned int width_step,
+														const void * params );
+
+		#define DIST_BOUNDED(type)\
+		template void distance :: compute_row_counts ( 	unsigned int * row_counts,\
+														const type * mask_data,\
+														const type * fb_data,\
+														unsigned int width_step,\
+														unsigned int height );\
+		template int distance :: Hamming_bounded ( 	double & d,\
+													const type * code_1_data,\
+													const type * mask_1_data,\
+													const type * fb_data_1,\
+													const type * code_2_data,\
+													const type * mask_2_data,\
+													const type * fb_data_2,\
+													unsigned int width,\
+													unsigned int height,\
+													unsigned int width_step,\
+													int theta,\
+													const void * params,\
+													double d_max,\
+													const unsigned int * row_counts_1,\
+													const unsigned int * row_counts_2,\
+													type * _code_2_data,\
+													type * _mask_2_data,\
+													type * _fb_data_2 );\
+		template int distance :: fragile_bit_distance_bounded ( double & d,\
+																const type * code_1_data,\
+																const type * mask_1_data,\
+																const type * fb_data_1,\
+																const type * code_2_data,\
+																const type * mask_2_data,\
+																const type * fb_data_2,\
+																unsigned int width,\
+																unsigned int height,\
+																unsigned int width_step,\
+																int theta,\
+																const void * params,\
+																double d_max,\
+																const unsigned int * row_counts_1,\
+																const unsigned int * row_counts_2,\
+																type * _code_2_data,\
+																type * _mask_2_data,\
+																type * _fb_data_2 );\
+		template int distance :: Hamming_FBD_bounded ( 	double & d,\
+														const type * code_1_data,\
+														const type * mask_1_data,\
+														const type * fb_data_1,\
+														const type * code_2_data,\
+														const type * mask_2_data,\
+														const type * fb_data_2,\
+														unsigned int width,\
+														unsigned int height,\
+														unsigned int width_step,\
+														int theta,\
+														const void * params,\
+														double d_max,\
+														const unsigned int * row_counts_1,\
+														const unsigned int * row_counts_2,\
+														type * _code_2_data,\
+														type * _mask_2_data,\
+														type * _fb_data_2 );
+
+		/**@fn
+		 * @param[out] row_counts : nombres de bits restants ( 2 * ( height + 1 ) entiers )
+		 * @param[in] mask_data : masque
+		 * @param[in] fb_data : bits fragiles
+		 * @param[in] width_step : nombre de mots par ligne
+		 * @param[in] height : nombre de lignes
+		 * @brief
+		 * Calcule, pour chaque ligne r, le nombre de bits du masque ( row_counts[r] )
+		 * et des bits fragiles ( row_counts[height + 1 + r] ) des lignes r à height - 1.
+		 * Ces nombres ne dépendent pas de la rotation : ils bornent les comptages
+		 * restants des distances *_bounded.
+		 **/
+		template <class type> void compute_row_counts ( 	unsigned int * row_counts,
+															const type * mask_data,
+															const type * fb_data,
+															unsigned int width_step,
+															unsigned int height );
+
+		/**@typedef
+		 * @param[out] d : distance entre les deux iris-codes ( minorant supérieur à d_max si interrompu )
+		 * @param[in] theta : angle de recadrage de l'iris code 2
+		 * @param[in] d_max : distance au-delà de laquelle le calcul peut être interrompu
+		 * @param[in] row_counts_1 : bits restants de l'iris code 1 ( cf. compute_row_counts )
+		 * @param[in] row_counts_2 : bits restants de l'iris code 2 ( cf. compute_row_counts )
+		 * @param[out] _code_2_data, _mask_2_data, _fb_2_data : iris code 2 tourné ( NULL : iris code 2 déjà recadré, theta ignoré )
+		 * @return
+		 * - 0 si matching réussi
+		 * - 1 si échec (0 pixel à comparer!)
+		 * - 2 si interrompu ( d > d_max )
+		 * @brief
+		 * Prototype pour la comparaison ligne par ligne de deux iris codes binaires avec abandon
+		 * dès que la distance dépasse forcément d_max. Sinon, d est identique à celle de *_opt.
+		 *
+		 */
+		typedef int (*function_prototype_64b_bounded) ( double & d,
+														const unsigned long long * code_1_data,
+														const unsigned long long * mask_1_data,
+														const unsigned long long * fb_1_data,
+														const unsigned long long * code_2_data,
+														const unsigned long long * mask_2_data,
+														const unsigned long long * fb_2_data,
+														unsigned int width,
+														unsigned int height,
+														unsigned int width_step,
+														int theta,
+														const void * params,
+														double d_max,
+														const unsigned int * row_counts_1,
+														const unsigned int * row_counts_2,
+														unsigned long long * _code_2_data,
+														unsigned long long * _mask_2_data,
+														unsigned long long * _fb_2_data );
+
+		/**@fn
+		 * @brief
+		 * Distance de Hamming ligne par ligne avec abandon au-delà de d_max.
+		 * Minorant : diff / ( valid + bits fragiles restants ).
+		 * 
+		 **/
+		template <class type> int Hamming_bounded ( double & d,
+													const type * code_1_data,
+													const type * mask_1_data,
+													const type * fb_data_1,
+													const type * code_2_data,
+													const type * mask_2_data,
+													const type * fb_data_2,
+													unsigned int width,
+													unsigned int height,
+													unsigned int width_step,
+													int theta,
+													const void * params,
+													double d_max,
+													const unsigned int * row_counts_1,
+													const unsigned int * row_counts_2,
+													type * _code_2_data,
+													type * _mask_2_data,
+													type * _fb_data_2 );
+
+		/**@fn
+		 * @brief
+		 * Distance des bits fragiles ligne par ligne avec abandon au-delà de d_max.
+		 * Minorant : 1 - ( both + B ) / ( valid + B ), B : bits fragiles restants.
+		 * 
+		 **/
+		template <class type> int fragile_bit_distance_bounded ( 	double & d,
+																	const type * code_1_data,
+																	const type * mask_1_data,
+																	const type * fb_data_1,
+																	const type * code_2_data,
+																	const type * mask_2_data,
+																	const type * fb_data_2,
+																	unsigned int width,
+																	unsigned int height,
+																	unsigned int width_step,
+																	int theta,
+																	const void * params,
+																	double d_max,
+																	const unsigned int * row_counts_1,
+																	const unsigned int * row_counts_2,
+																	type * _code_2_data,
+																	type * _mask_2_data,
+																	type * _fb_data_2 );
+
+		/**@fn
+		 * @brief
+		 * Hamming + FBD ligne par ligne avec abandon au-delà de d_max ( 0 <= alpha <= 1 ).
+		 * 
+		 **/
+		template <class type> int Hamming_FBD_bounded ( double & d,
+														const type * code_1_data,
+														const type * mask_1_data,
+														const type * fb_data_1,
+														const type * code_2_data,
+														const type * mask_2_data,
+														const type * fb_data_2,
+														unsigned int width,
+														unsigned int height,
+														unsigned int width_step,
+														int theta,
+														const void * params,
+														double d_max,
+														const unsigned int * row_counts_1,
+														const unsigned int * row_counts_2,
+														type * _code_2_data,
+														type * _mask_2_data,
+														type * _fb_data_2 );
+
 		#define DIST_ALL(type)\
 				DIST_ROTATE(type)\
 				DIST_CONVERT(type)\
 				DIST_DEBUG(type)\
 				DIST_FBD(type)\
 				DIST_HAMMING(type)\
-				DIST_H_FBD(type)
+				DIST_H_FBD(type)\
+				DIST_ALIGNED(type)\
+				DIST_BOUNDED(type)
 		//Distance de Hamming
 		/**@struct
 		 * @var fragile_bit_threshold_1 : seuil de bit fragiles 1
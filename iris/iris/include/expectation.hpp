@@ -0,0 +1,171 @@
+/**@file expectation.hpp
+ * @author Valérian Némesin
+ * @brief
+ * Espérance de la distance de Hamming ( E(Hamming) ) sur des iris codes flous quantifiés.
+ * Le noyau utilisé est choisi à l'exécution (scalaire, SSE2, AVX2).
+ */
+#ifndef _EXPECTATION_HPP_
+	#define _EXPECTATION_HPP_
+	#include <cstddef>
+	#include <opencv/cv.h>
+
+	//Valeur maximale de la carte de fragilité ( 8 bits )
+	#define FUZZY_CODE_MAX 255
+
+	namespace distance
+	{
+		/**@enum
+		 * @brief
+		 * Noyaux disponibles.
+		 * - FUZZY_AUTO : meilleur noyau supporté par le processeur
+		 * - FUZZY_SCALAR : boucle scalaire
+		 * - FUZZY_SSE2 : pmaddwd sur 8 entiers 16 bits
+		 * - FUZZY_AVX2 : vpmaddwd sur 16 entiers 16 bits
+		 **/
+		enum fuzzy_kernel
+		{
+			FUZZY_AUTO = 0,
+			FUZZY_SCALAR,
+			FUZZY_SSE2,
+			FUZZY_AVX2
+		};
+
+		/**@struct
+		 * @var dot : somme des produits code_1 * code_2
+		 * @var valid : nombre de pixels où code_1 et code_2 sont non nuls
+		 * @brief
+		 * Résultat du noyau sur un couple de lignes d'iris codes flous.
+		 **/
+		struct fuzzy_counts
+		{
+			long long dot;
+			unsigned long long valid;
+		};
+
+		/**@typedef
+		 * @brief
+		 * Prototype des noyaux ( cf. count_fuzzy ).
+		 **/
+		typedef void (*count_fuzzy_prototype) (	fuzzy_counts & counts,
+													const short * code_1,
+													const short * code_2,
+													size_t size );
+
+		/**@fn
+		 * @param[out] counts : sommes
+		 * @param[in] code_1 : iris code flou 1
+		 * @param[in] code_2 : iris code flou 2
+		 * @param[in] size : nombre de pixels
+		 * @brief
+		 * Produit scalaire et nombre de pixels valides de deux lignes d'iris codes
+		 * flous avec le noyau courant.
+		 **/
+		void count_fuzzy (	fuzzy_counts & counts,
+							const short * code_1,
+							const short * code_2,
+							size_t size );
+
+		/**@fn
+		 * @param[in] width : nombre de directions angulaires de l'iris code
+		 * @brief
+		 * Taille d'une ligne d'un iris code flou ( entiers 16 bits ) : la ligne est
+		 * stockée deux fois de suite pour lire toute rotation de façon contiguë.
+		 **/
+		unsigned int fuzzy_code_width_step( unsigned int width );
+
+		/**@fn
+		 * @param[out] code_out : iris code flou ( height * fuzzy_code_width_step( width ) entiers )
+		 * @param[in] code : iris code
+		 * @param[in] fragility_map : carte de fragilité
+		 * @return
+		 * - 0 si OK
+		 * - 1 sinon ( tailles ou profondeurs incompatibles )
+		 * @brief
+		 * Quantifie un iris code flou : chaque pixel vaut + fm si le bit est à 1, - fm sinon
+		 * ( fm : carte de fragilité, 0 pour un pixel masqué ).
+		 **/
+		int quantize_fuzzy_code( 	short * code_out,
+									const IplImage * code,
+									const IplImage * fragility_map );
+
+		/**@fn
+		 * @param[out] d : distance entre les deux iris codes
+		 * @param[in] code_1 : iris code flou 1
+		 * @param[in] code_2 : iris code flou 2 ( tourné de theta )
+		 * @param[in] width : nombre de directions angulaires de l'iris code
+		 * @param[in] height : 2 fois le nombre de rayons de l'iris code
+		 * @param[in] width_step : taille d'une ligne ( cf. fuzzy_code_width_step )
+		 * @param[in] theta : angle de recadrage
+		 * @return
+		 * - 0 si matching réussi
+		 * - 1 si échec (0 pixel à comparer!)
+		 * @brief
+		 * Même distance que Hamming_expectation, calculée en entiers : pour un pixel valide,
+		 * l'espérance vaut ( 1 - s * fm_1 * fm_2 / 255² ) / 2 avec s = +1 si les bits
+		 * sont égaux, -1 sinon, soit d = ( 1 - sum( code_1 * code_2 ) / ( 255² * n ) ) / 2.
+		 * La somme est exacte ; seule la division finale est arrondie.
+		 **/
+		int Hamming_expectation_q ( 	double & d,
+										const short * code_1,
+										const short * code_2,
+										unsigned int width,
+										unsigned int height,
+										unsigned int width_step,
+										int theta );
+
+		/**@fn
+		 * @param[out] d : distance minimale
+		 * @param[out] theta : angle de recadrage
+		 * @param[in] code_1 : iris code flou 1
+		 * @param[in] code_2 : iris code flou 2 ( tourné )
+		 * @param[in] width : nombre de directions angulaires de l'iris code
+		 * @param[in] height : 2 fois le nombre de rayons de l'iris code
+		 * @param[in] width_step : taille d'une ligne ( cf. fuzzy_code_width_step )
+		 * @param[in] theta_min : angle de recadrage minimal
+		 * @param[in] theta_max : angle de recadrage maximal ( exclu )
+		 * @return
+		 * - 0 si matching réussi
+		 * - 1 si échec
+		 * @brief
+		 * Recadrage ( cf. registering ) avec Hamming_expectation_q.
+		 **/
+		int registering_q (	double & d,
+								int & theta,
+								const short * code_1,
+								const short * code_2,
+								unsigned int width,
+								unsigned int height,
+								unsigned int width_step,
+								int theta_min,
+								int theta_max );
+
+		/**@fn
+		 * @param[in] kernel : noyau
+		 * @return
+		 * - 0 si le noyau est sélectionné
+		 * - 1 si le processeur ne le supporte pas
+		 * @brief
+		 * Sélectionne le noyau (pour les tests et les benchmarks).
+		 **/
+		int set_fuzzy_kernel( fuzzy_kernel kernel );
+
+		/**@fn
+		 * @brief
+		 * Renvoie le noyau courant.
+		 **/
+		fuzzy_kernel get_fuzzy_kernel( void );
+
+		/**@fn
+		 * @brief
+		 * Indique si le processeur supporte le noyau.
+		 **/
+		bool fuzzy_kernel_supported( fuzzy_kernel kernel );
+
+		/**@fn
+		 * @brief
+		 * Renvoie le nom du noyau.
+		 **/
+		const char * fuzzy_kernel_name( fuzzy_kernel kernel );
+	};
+
+#endif
@@ -0,0 +1,72 @@
+/**@file gallery_file.hpp
+ * @author Valérian Némesin
+ * @brief
+ * Format binaire d'une base d'iris codes ( fichier de galerie ).
+ * Le fichier est projeté en mémoire ( mmap ) tel quel par c_database :
+ * toutes les sections sont alignées sur GALLERY_FILE_ALIGNMENT octets
+ * et aucune donnée n'est décodée au chargement.
+ *
+ * Contenu ( dans l'ordre ) :
+ * - en-tête ( gallery_file_header )
+ * - validité de chaque échantillon ( 1 octet par échantillon )
+ * - seuils de fragilité des bits fragiles stockés ( 1 double par échantillon )
+ * - index des noms et des noms de classes ( 1 position par échantillon dans la table des chaînes )
+ * - table des chaînes ( chaînes terminées par '\0' )
+ * - taux de fragilité ( 256 doubles par échantillon )
+ * - iris codes et cartes de fragilité 8 bits ( image_width_step * height octets par échantillon )
+ * - iris codes, masques et bits fragiles binaires ( width_step * height mots de 64 bits par échantillon )
+ * - nombres de bits restants ligne par ligne ( 2 * ( height + 1 ) entiers de 32 bits par échantillon,
+ *   cf. distance::compute_row_counts )
+ */
+#ifndef _GALLERY_FILE_HPP_
+	#define _GALLERY_FILE_HPP_
+	#include <stdint.h>
+
+	#define GALLERY_FILE_MAGIC "IRISGAL"
+	#define GALLERY_FILE_VERSION 2
+	#define GALLERY_FILE_BYTE_ORDER 0x01020304
+	#define GALLERY_FILE_ALIGNMENT 64
+	#define GALLERY_FILE_NAME_SIZE 64
+
+	/**@struct
+	 * @brief
+	 * En-tête d'un fichier de galerie. Les positions sont en octets depuis le début du fichier.
+	 **/
+	struct gallery_file_header
+	{
+		//Identification
+		char magic[8];
+		uint32_t version;
+		uint32_t byte_order;
+		uint32_t header_size;
+
+		//Dimensions ( communes à tous les échantillons )
+		uint32_t nb_classes;
+		uint32_t width;
+		uint32_t height;
+		uint32_t image_width_step;
+		uint32_t width_step;
+
+		//Paramètres de compilation
+		double fragile_bit_rate;
+		char iris_code_file[GALLERY_FILE_NAME_SIZE];
+		char fragility_map_file[GALLERY_FILE_NAME_SIZE];
+
+		//Sections
+		uint64_t valid_offset;
+		uint64_t thresholds_offset;
+		uint64_t names_offset;
+		uint64_t class_names_offset;
+		uint64_t strings_offset;
+		uint64_t strings_size;
+		uint64_t fragility_rate_offset;
+		uint64_t iris_codes_offset;
+		uint64_t fragility_maps_offset;
+		uint64_t codes_offset;
+		uint64_t masks_offset;
+		uint64_t fragile_bits_offset;
+		uint64_t row_counts_offset;
+		uint64_t file_size;
+	};
+
+#endif
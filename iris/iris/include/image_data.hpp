@@ -94,6 +94,13 @@
 		 */
 		image_data & operator=( const image_data & _p_data );
 		
+		/**@fn
+		 * @brief
+		 * Echange le contenu de deux objets ( sans recopie des images ).
+		 * 
+		 */
+		void swap( image_data & data );
+		
 		/**@fn
 		 * @brief
 		 * Destructeur
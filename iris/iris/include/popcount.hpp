@@ -0,0 +1,107 @@
+/**@file popcount.hpp
+ * @author Valérian Némesin
+ * @brief
+ * Comptage rapide des bits (popcount) sur des iris codes binaires 64 bits.
+ * Le noyau utilisé est choisi à l'exécution (scalaire, AVX2, AVX-512 VPOPCNTDQ).
+ */
+#ifndef _POPCOUNT_HPP_
+	#define _POPCOUNT_HPP_
+	#include <cstddef>
+
+	namespace distance
+	{
+		/**@enum
+		 * @brief
+		 * Noyaux de comptage disponibles.
+		 * - POPCOUNT_AUTO : meilleur noyau supporté par le processeur
+		 * - POPCOUNT_SCALAR : __builtin_popcountll ( instruction popcnt si disponible )
+		 * - POPCOUNT_AVX2 : table de nibbles (vpshufb) + vpsadbw
+		 * - POPCOUNT_AVX512 : vpopcntq
+		 **/
+		enum popcount_kernel
+		{
+			POPCOUNT_AUTO = 0,
+			POPCOUNT_SCALAR,
+			POPCOUNT_AVX2,
+			POPCOUNT_AVX512
+		};
+
+		/**@struct
+		 * @var valid : nombre de bits de v_1 & v_2
+		 * @var diff : nombre de bits de ( x_1 ^ x_2 ) & v_1 & v_2
+		 * @var both : nombre de bits de s_1 & s_2 & v_1 & v_2
+		 * @brief
+		 * Résultat d'un comptage de bits sur un couple d'iris codes.
+		 **/
+		struct bit_counts
+		{
+			unsigned long long valid;
+			unsigned long long diff;
+			unsigned long long both;
+		};
+
+		/**@typedef
+		 * @brief
+		 * Prototype des noyaux de comptage ( cf. count_bits ).
+		 **/
+		typedef void (*count_bits_prototype) (	bit_counts & counts,
+												const unsigned long long * x_1,
+												const unsigned long long * x_2,
+												const unsigned long long * v_1,
+												const unsigned long long * v_2,
+												const unsigned long long * s_1,
+												const unsigned long long * s_2,
+												size_t size );
+
+		/**@fn
+		 * @param[out] counts : comptages
+		 * @param[in] x_1 : bits comparés (ou exclusif) 1
+		 * @param[in] x_2 : bits comparés (ou exclusif) 2
+		 * @param[in] v_1 : bits valides 1
+		 * @param[in] v_2 : bits valides 2
+		 * @param[in] s_1 : bits sélectionnés 1 ( NULL : counts.both non calculé )
+		 * @param[in] s_2 : bits sélectionnés 2 ( NULL : counts.both non calculé )
+		 * @param[in] size : nombre de mots de 64 bits
+		 * @brief
+		 * Compte les bits valides, différents et communs de deux iris codes
+		 * avec le noyau courant.
+		 **/
+		void count_bits (	bit_counts & counts,
+							const unsigned long long * x_1,
+							const unsigned long long * x_2,
+							const unsigned long long * v_1,
+							const unsigned long long * v_2,
+							const unsigned long long * s_1,
+							const unsigned long long * s_2,
+							size_t size );
+
+		/**@fn
+		 * @param[in] kernel : noyau
+		 * @return
+		 * - 0 si le noyau est sélectionné
+		 * - 1 si le processeur ne le supporte pas
+		 * @brief
+		 * Sélectionne le noyau de comptage (pour les tests et les benchmarks).
+		 **/
+		int set_popcount_kernel( popcount_kernel kernel );
+
+		/**@fn
+		 * @brief
+		 * Renvoie le noyau de comptage courant.
+		 **/
+		popcount_kernel get_popcount_kernel( void );
+
+		/**@fn
+		 * @brief
+		 * Indique si le processeur supporte le noyau.
+		 **/
+		bool popcount_kernel_supported( popcount_kernel kernel );
+
+		/**@fn
+		 * @brief
+		 * Renvoie le nom du noyau.
+		 **/
+		const char * popcount_kernel_name( popcount_kernel kernel );
+	};
+
+#endif
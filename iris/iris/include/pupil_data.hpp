@@ -84,6 +84,13 @@
 		 */
 		pupil_data & operator=( const pupil_data & _p_data );
 		
+		/**@fn
+		 * @brief
+		 * Echange le contenu de deux objets ( sans recopie des images ).
+		 * 
+		 */
+		void swap( pupil_data & data );
+		
 		/**@fn
 		 * @brief
 		 * Destructeur
@@ -1,5 +1,4 @@
 #include "c_buffer.hpp"
-#include <unistd.h>
 c_buffer :: c_buffer ( )
 {
 	initialize();
@@ -7,10 +6,13 @@ c_buffer :: c_buffer ( )
 
 void c_buffer ::reset()
 {
-	start_score_editting();
+	pthread_mutex_lock( &_mutex );
 	for ( unsigned int i = 0; i < _nb_objects; ++ i )
-		erase_object( i );
-	end_score_editting();
+		buffer_data[i].erase();
+	_nb_used = 0;
+	_closed = false;
+	pthread_cond_broadcast( &_not_full );
+	pthread_mutex_unlock( &_mutex );
 }
 
 
@@ -54,6 +56,9 @@ int c_buffer :: setup ( 	unsigned int nb_obj,
 		return 1;
 	}
 	
+	pthread_mutex_init( &_mutex, NULL );
+	pthread_cond_init( &_not_empty, NULL );
+	pthread_cond_init( &_not_full, NULL );
 	_nb_objects = nb_obj;
 	buffer_data = new c_buffer_data[nb_obj];
 	
@@ -76,18 +81,45 @@ int c_buffer :: setup ( 	unsigned int nb_obj,
 		sorted_buffer_ids[i] = i;
 	}
 	
-	_object_in_reading = new int[nb_obj];
-	_object_in_writting = new int[nb_obj];
-	memset(	_object_in_reading, 
-			0, 
-			sizeof(int) * nb_obj );
-	memset(	_object_in_writting, 
-			0, 
-			sizeof(int) * nb_obj );
-			
 	return 0;
 }
 
+int c_buffer :: setup ( 	unsigned int nb_obj,
+							c_frame_pool * pool,
+							void (*copy_function) ( void * data,
+													const void * data_src ),
+							ostream * _err_stream )
+{
+	free();
+	initialize();
+	err_stream = _err_stream;
+	if ( 	nb_obj == 0 		||
+			pool == 0			||
+			copy_function == 0	 )
+	{
+		if ( err_stream )
+			*err_stream << "Error : Argument(s) of c_buffer :: setup!" << endl;
+		return 1;
+	}
+	
+	pthread_mutex_init( &_mutex, NULL );
+	pthread_cond_init( &_not_empty, NULL );
+	pthread_cond_init( &_not_full, NULL );
+	_nb_objects = nb_obj;
+	_pool = pool;
+	buffer_data = new c_buffer_data[nb_obj];
+	
+	for ( unsigned int i = 0; i < nb_obj; ++ i )
+		buffer_data[i].setup( pool, copy_function );
+	
+	sorted_buffer_ids = new unsigned int[nb_obj];
+	for ( unsigned int i = 0; i < nb_obj; ++ i )
+	{
+		sorted_buffer_ids[i] = i;
+	}
+	
+	return 0;
+}
 
 int c_buffer :: add_object(	const c_buffer_data * data )
 {
@@ -99,11 +131,115 @@ int c_buffer :: add_object(	const c_buffer_data * data )
 int c_buffer :: add_object( 	unsigned int _id,
 								double _score,
 								const void * _data )
+{
+	pthread_mutex_lock( &_mutex );
+	int q = insert_object( 	_id,
+							_score,
+							_data );
+	pthread_mutex_unlock( &_mutex );
+	return q;
+}
+
+int c_buffer :: push_object( 	unsigned int _id,
+								double _score,
+								const void * _data )
+{
+	pthread_mutex_lock( &_mutex );
+	//Attente d'une place libre
+	while ( _nb_used == _nb_objects && ! _closed )
+		pthread_cond_wait( &_not_full, &_mutex );
+	if ( _closed )
+	{
+		pthread_mutex_unlock( &_mutex );
+		//L'objet refusé retourne dans la réserve
+		if ( _pool && _data )
+			_pool->release( (void *) _data );
+		return 1;
+	}
+	int q = insert_object( 	_id,
+							_score,
+							_data );
+	pthread_mutex_unlock( &_mutex );
+	return q;
+}
+
+int c_buffer :: pop_object( c_buffer_data * data )
+{
+	pthread_mutex_lock( &_mutex );
+	//Attente d'un objet
+	while ( _nb_used == 0 && ! _closed )
+		pthread_cond_wait( &_not_empty, &_mutex );
+	if ( _nb_used == 0 )
+	{
+		//Fin du flux
+		data->erase();
+		pthread_mutex_unlock( &_mutex );
+		return 1;
+	}
+	buffer_data[ sorted_buffer_ids[0] ].get( *data );
+	remove_object( 0 );
+	pthread_mutex_unlock( &_mutex );
+	return 0;
+}
+
+int c_buffer :: pop_handle(	unsigned int & id,
+								double & score,
+								void * & handle )
+{
+	pthread_mutex_lock( &_mutex );
+	//Attente d'un objet
+	while ( _nb_used == 0 && ! _closed )
+		pthread_cond_wait( &_not_empty, &_mutex );
+	if ( _nb_used == 0 )
+	{
+		//Fin du flux
+		id = 0;
+		score = -1;
+		handle = NULL;
+		pthread_mutex_unlock( &_mutex );
+		return 1;
+	}
+	c_buffer_data & obj = buffer_data[ sorted_buffer_ids[0] ];
+	id = obj.id();
+	score = obj.score();
+	//La référence passe à l'appelant
+	handle = obj.take_handle();
+	remove_object( 0 );
+	pthread_mutex_unlock( &_mutex );
+	return 0;
+}
+
+void c_buffer :: close()
+{
+	pthread_mutex_lock( &_mutex );
+	_closed = true;
+	pthread_cond_broadcast( &_not_empty );
+	pthread_cond_broadcast( &_not_full );
+	pthread_mutex_unlock( &_mutex );
+}
+
+bool c_buffer :: closed()
+{
+	pthread_mutex_lock( &_mutex );
+	bool q = _closed;
+	pthread_mutex_unlock( &_mutex );
+	return q;
+}
+
+unsigned int c_buffer :: size()
+{
+	pthread_mutex_lock( &_mutex );
+	unsigned int n = _nb_used;
+	pthread_mutex_unlock( &_mutex );
+	return n;
+}
+
+int c_buffer :: insert_object( 	unsigned int _id,
+								double _score,
+								const void * _data )
 {
 	unsigned int id, i;
 	
-	//Indique au buffer que le score va être éditer
-	start_score_editting();
 	//Recherche la position de l'objet
 	for ( i = 0; i < _nb_objects; ++ i )
 	{
@@ -113,6 +249,9 @@ int c_buffer :: add_object( 	unsigned int _id,
 		{
 
 			id = sorted_buffer_ids[_nb_objects - 1];
+			//Le dernier objet est écrasé s'il n'est pas vide
+			if ( buffer_data[ id ].score() < 0 )
+				++ _nb_used;
 			//Tri des scores
 			for ( unsigned int j = ( _nb_objects - 2 ); j != (i - 1) ; -- j )
 			{
@@ -120,91 +259,89 @@ int c_buffer :: add_object( 	unsigned int _id,
 			}
 			sorted_buffer_ids[ i ] = id;
 			//Ecriture de l'objet
-			write_object( 	_id, 
-							_score, 
-							_data, 
-							id );
+			buffer_data[ id ].set( 	_id, 
+									_score, 
+									_data );
+			pthread_cond_signal( &_not_empty );
 			break;
 		}	
 	}	
 	
-	//Déblocage du score
-	end_score_editting();
 	if ( i == _nb_objects )
+	{
+		//L'objet refusé retourne dans la réserve
+		if ( _pool && _data )
+			_pool->release( (void *) _data );
 		return 1;
+	}
 	return 0;
 }
 
-int c_buffer :: delete_object( const c_buffer_data * data )
+void c_buffer :: remove_object( unsigned int i )
 {
+	unsigned int id = sorted_buffer_ids[i];
+	if ( buffer_data[ id ].score() >= 0 )
+		-- _nb_used;
+	buffer_data[ id ].erase();
+
+	//Tri des scores
+	for ( unsigned int j = i; j < ( _nb_objects - 1 ); ++ j )
+	{
+		sorted_buffer_ids[ j ] = sorted_buffer_ids[ j + 1 ];
+	}
+	sorted_buffer_ids[_nb_objects - 1] = id;
+	pthread_cond_signal( &_not_full );
+}
 
-	//cout << "delete" << endl;
-	start_score_editting();
+int c_buffer :: delete_object( const c_buffer_data * data )
+{
+	pthread_mutex_lock( &_mutex );
 	for ( unsigned int i = 0; i < _nb_objects; ++ i )
 	{
-		unsigned int k;
-		unsigned int id;
-			id = sorted_buffer_ids[i];
-		//Lecture du score de l'objet
-		k = buffer_data[ id ].id();
-		if ( data->id() == k )
+		if ( data->id() == buffer_data[ sorted_buffer_ids[i] ].id() )
 		{
-			//Delete
-
-			erase_object( id );
-
-			//Tri des scores
-
-			for ( unsigned int j = i; j < ( _nb_objects - 1 ); ++ j )
-			{
-				sorted_buffer_ids[ j ] = sorted_buffer_ids[ j + 1 ];
-			}
-			sorted_buffer_ids[_nb_objects - 1] = id;
-
+			remove_object( i );
 			break;
-			
 		}
 	}
-
-	end_score_editting();
-	//cout << "delete - ok" << endl;
+	pthread_mutex_unlock( &_mutex );
 	return 0;
 }
 
 int c_buffer :: get_object (	c_buffer_data * data,
 								unsigned int score_id )
 {
-	read_object(	data, 
-					sorted_buffer_ids[score_id] );
+	pthread_mutex_lock( &_mutex );
+	buffer_data[ sorted_buffer_ids[score_id] ].get( *data );
+	pthread_mutex_unlock( &_mutex );
 	return 0;
 }
 int c_buffer :: get_object_with_id (	c_buffer_data * data,
 										unsigned int obj_id )
 {
 	bool find = false;
+	pthread_mutex_lock( &_mutex );
 	for ( unsigned int i = 0; ( i < _nb_objects ) && ( !find ); ++ i )
 	{
-		start_object_reading( i );
-			if ( obj_id == buffer_data[i].id() )
-			{
-				find = true;
-				read_object(	data, 
-								i );
-			}
-		end_object_reading( i );
+		if ( obj_id == buffer_data[i].id() )
+		{
+			find = true;
+			buffer_data[i].get( *data );
+		}
 	}
+	pthread_mutex_unlock( &_mutex );
 	return find;
 }
 int c_buffer :: inclued ( const c_buffer_data * data )
 {
 	bool find = false;
+	pthread_mutex_lock( &_mutex );
 	for ( unsigned int i = 0; i < _nb_objects && !find; ++ i )
 	{
-		start_object_reading( i );
-			if ( data->id() == buffer_data[i].id() && buffer_data[i].score() > 0 )
-				find = true;
-		end_object_reading( i );
+		if ( data->id() == buffer_data[i].id() && buffer_data[i].score() > 0 )
+			find = true;
 	}
+	pthread_mutex_unlock( &_mutex );
 	return find;
 }
 
@@ -218,27 +355,28 @@ c_buffer :: ~c_buffer()
 void c_buffer :: free()
 {
 	if ( buffer_data )
+	{
 		delete[] buffer_data;
+		pthread_mutex_destroy( &_mutex );
+		pthread_cond_destroy( &_not_empty );
+		pthread_cond_destroy( &_not_full );
+	}
 
 	if ( sorted_buffer_ids )
 		delete[] sorted_buffer_ids;
-	if ( _object_in_reading )
-		delete[] _object_in_reading;
-	if ( _object_in_writting )
-		delete[] _object_in_writting;
 
 }
 
 void c_buffer :: initialize()
 {
-	_object_in_reading = 0;
-	_object_in_writting = 0;
-	_score_editting = 0;
+	_closed = false;
+	_nb_used = 0;
 		
 	_nb_objects = 0;
 			
 	buffer_data = 0;
 	sorted_buffer_ids = 0;
+	_pool = 0;
 
 	err_stream = NULL;
 }
@@ -246,91 +384,18 @@ void c_buffer :: initialize()
 double c_buffer :: score_min()
 {
 	double score;
-	start_score_editting();
+	pthread_mutex_lock( &_mutex );
 		score = buffer_data[sorted_buffer_ids[_nb_objects - 1]].score();
-	end_score_editting();
+	pthread_mutex_unlock( &_mutex );
 	return score;
 }
 
-void c_buffer :: erase_object( unsigned int id )
-{
-	start_object_writting( id );
-		buffer_data[id].erase();
-	end_object_writting( id );
-}
-
-void c_buffer :: write_object(	unsigned int id,
-								double score,
-								const void * data,
-								unsigned int obj_id )
+double c_buffer :: score( unsigned int score_id )
 {
-	start_object_writting( obj_id );
-		buffer_data[obj_id].set( id, score, data);
-	end_object_writting( obj_id );
-}
-
-void c_buffer :: read_object(	c_buffer_data * data,
-								unsigned int id )
-{
-	start_object_reading( id );
-		buffer_data[id].get( *data );
-	end_object_reading( id );
-}
-
-
-void c_buffer :: start_object_writting ( unsigned int obj_id )
-{	
-	while ( _object_in_reading[obj_id] 	||
-			_object_in_writting[obj_id] )
-	{
-		usleep( 1000 );
-	}
-	
-	_object_in_writting[obj_id] = 1;
-}
-
-void c_buffer :: end_object_writting ( unsigned int obj_id )
-{	
-	_object_in_writting[obj_id] = 0;
-}
-
-void c_buffer :: start_object_reading ( unsigned int obj_id )
-{
-	while ( _object_in_writting[obj_id] )
-	{
-		usleep( 1000 );
-	}
-	_object_in_reading[obj_id] ++;	
-}
-
-void c_buffer :: end_object_reading ( unsigned int obj_id )
-{	
-	_object_in_reading[obj_id] --;
-			
-}
-
-void c_buffer :: start_score_editting ()
-{
-	while ( _score_editting )
-	{
-		usleep( 1000 );
-	}
-
-	_score_editting = 1;
-}
-
-void c_buffer :: end_score_editting ()
-{
-	_score_editting = 0;
+	double score = -1;
+	pthread_mutex_lock( &_mutex );
+	if ( score_id < _nb_objects )
+		score = buffer_data[sorted_buffer_ids[score_id]].score();
+	pthread_mutex_unlock( &_mutex );
+	return score;
 }
-
-
-
-
-
-
-
-
-
-
-
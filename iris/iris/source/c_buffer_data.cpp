@@ -1,4 +1,5 @@
 #include "c_buffer_data.hpp"
+#include "c_frame_pool.hpp"
 #include <iostream>
 using namespace std;
 c_buffer_data :: c_buffer_data( )
@@ -40,6 +41,30 @@ int c_buffer_data :: setup ( 	const void * params,
 	return 0;
 }
 
+int c_buffer_data :: setup ( 	c_frame_pool * pool,
+								void (*_copy_function)  ( 	void * data,
+															const void * data_src ) )
+{
+	free();
+	initialize();
+	
+	if ( ! pool || ! _copy_function )
+		return 1;
+	
+	//Pas d'alloc : les objets appartiennent à la réserve
+	_pool = pool;
+	copy_function = _copy_function;
+	
+	return 0;
+}
+
+void * c_buffer_data :: take_handle()
+{
+	void * handle = _data;
+	_data = 0;
+	return handle;
+}
+
 c_buffer_data :: ~c_buffer_data()
 {
 	free();
@@ -52,7 +77,15 @@ void c_buffer_data :: set( 	unsigned int id,
 {
 	_id = id;
 	_score = score;
-	copy_function ( _data, data );
+	if ( _pool )
+	{
+		//Transfert de la référence
+		if ( _data && _data != data )
+			_pool->release( _data );
+		_data = (void *) data;
+	}
+	else
+		copy_function ( _data, data );
 }
 void c_buffer_data :: set( const c_buffer_data & data )
 {
@@ -66,7 +99,9 @@ void c_buffer_data :: get( 	unsigned int & id,
 {
 	id = _id;
 	score = _score;
-	copy_function ( data, _data );
+	//Emplacement vide en mode référence
+	if ( _data )
+		copy_function ( data, _data );
 }
 
 void c_buffer_data :: get( c_buffer_data & data ) const
@@ -83,6 +118,7 @@ void c_buffer_data :: initialize()
 	free_function = 0;
 	copy_function = 0;
 	_data = 0;
+	_pool = 0;
 	_score = -1;
 	_id = 0;
 }
@@ -90,7 +126,12 @@ void c_buffer_data :: initialize()
 void c_buffer_data :: free()
 {
 	if ( _data )
-		free_function( _data );
+	{
+		if ( _pool )
+			_pool->release( _data );
+		else
+			free_function( _data );
+	}
 }
 
 bool c_buffer_data :: operator< ( c_buffer_data & buffer_data ) const
@@ -103,6 +144,11 @@ bool c_buffer_data :: operator< ( c_buffer_data & buffer_data ) const
 
 void c_buffer_data :: erase()
 {
+	if ( _pool && _data )
+	{
+		_pool->release( _data );
+		_data = 0;
+	}
 	_id = 0;
 	_score = -1;
 }
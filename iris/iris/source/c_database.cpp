@@ -1,6 +1,11 @@
 #include "c_database.hpp"
 #include "distances.hpp"
 #include "utils.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
 c_database :: c_database ( void )
 {
 	initialize();
@@ -36,6 +41,20 @@ int c_database :: setup ( 	const char * rep,
 		return 1;
 	}
 
+	//Chargement d'un fichier de galerie
+	if ( is_gallery_file( rep ) )
+	{
+		if ( load_gallery( 	rep,
+							iris_code_file,
+							fragility_map_file ) )
+		{
+			if ( err_stream )
+				*err_stream << "Error : Failed to load gallery file " << rep << "!" << endl;
+			return 1;
+		}
+		return 0;
+	}
+
 	//Chargement de la base de données
 	if ( load( 	rep, 
 				iris_code_file, 
@@ -127,7 +146,10 @@ void c_database :: free()
 	{
 		for ( unsigned int i = 0; i < _nb_classes; ++ i )
 		{
-			cvReleaseImage ( _iris_codes + i );
+			if ( _map_data )
+				cvReleaseImageHeader ( _iris_codes + i );
+			else
+				cvReleaseImage ( _iris_codes + i );
 		}
 		delete[] _iris_codes;
 	}
@@ -135,7 +157,10 @@ void c_database :: free()
 	{
 		for ( unsigned int i = 0; i < _nb_classes; ++ i )
 		{
-			cvReleaseImage ( _fragility_maps + i );
+			if ( _map_data )
+				cvReleaseImageHeader ( _fragility_maps + i );
+			else
+				cvReleaseImage ( _fragility_maps + i );
 		}
 		delete[] _fragility_maps;
 	}
@@ -143,7 +168,7 @@ void c_database :: free()
 	{
 		for ( unsigned int i = 0; i < _nb_classes; ++ i )
 		{
-			if ( _fragility_rate[i] )
+			if ( _fragility_rate[i] && ! in_map( _fragility_rate[i] ) )
 				delete[] _fragility_rate[i];
 
 		}
@@ -153,8 +178,7 @@ void c_database :: free()
 	{
 		for ( unsigned int i = 0; i < _nb_classes; ++ i )
 		{
-			if ( _iris_codes_bis[i]  )
-				delete[] _iris_codes_bis[i];
+			release_plane( _iris_codes_bis[i] );
 		}
 		delete[] _iris_codes_bis;
 	}
@@ -163,8 +187,7 @@ void c_database :: free()
 	{
 		for ( unsigned int i = 0; i < _nb_classes; ++ i )
 		{
-			if ( _masks[i]  )
-				delete[] _masks[i];
+			release_plane( _masks[i] );
 		}
 		delete[] _masks;
 		
@@ -174,8 +197,7 @@ void c_database :: free()
 	{
 		for ( unsigned int i = 0; i < _nb_classes; ++ i )
 		{
-			if ( _fragile_bits[i]  )
-				delete[] _fragile_bits[i];
+			release_plane( _fragile_bits[i] );
 		}
 		delete[] _fragile_bits;
 		
@@ -184,6 +206,35 @@ void c_database :: free()
 	if ( _fragile_bit_thresholds )
 		delete[] _fragile_bit_thresholds;
 	
+	if ( _row_counts )
+	{
+		for ( unsigned int i = 0; i < _nb_classes; ++ i )
+			release_row_counts( i );
+		delete[] _row_counts;
+	}
+	
+	if ( _rotation_bank )
+	{
+		for ( unsigned int i = 0; i < _nb_classes; ++ i )
+		{
+			if ( _rotation_bank[i] )
+				delete[] _rotation_bank[i];
+		}
+		delete[] _rotation_bank;
+	}
+	
+	if ( _fuzzy_codes )
+	{
+		for ( unsigned int i = 0; i < _nb_classes; ++ i )
+		{
+			if ( _fuzzy_codes[i] )
+				delete[] _fuzzy_codes[i];
+		}
+		delete[] _fuzzy_codes;
+	}
+	
+	if ( _map_data )
+		munmap( _map_data, _map_size );
 }
 
 void c_database :: initialize()
@@ -200,7 +251,17 @@ void c_database :: initialize()
 	_iris_codes_bis = NULL;
 	_masks = NULL;
 	_fragile_bits = NULL;
-	
+	_rotation_bank = NULL;
+	_row_counts = NULL;
+	_bank_d_theta = 0;
+	_bank_max_rotations = 0;
+	_bank_nb_rotations = 0;
+	_bank_theta_min = 0;
+	_fuzzy_codes = NULL;
+	_fuzzy_width_step = 0;
+	_map_data = NULL;
+	_map_size = 0;
+	_map_thresholds = NULL;
 }
 
 unsigned int c_database :: get_nb_classes(	const char * rep ) const
@@ -350,7 +411,8 @@ void c_database :: alloc()
 	_iris_codes_bis = new unsigned long long*[_nb_classes];
 	_masks = new unsigned long long*[_nb_classes];
 	_fragile_bits = new unsigned long long*[_nb_classes];
-	
+	_rotation_bank = new unsigned long long*[_nb_classes];
+	_row_counts = new unsigned int*[_nb_classes];
 	
 	
 	for ( unsigned int i = 0; i < _nb_classes; ++ i )
@@ -358,6 +420,8 @@ void c_database :: alloc()
 		_iris_codes_bis[i] = NULL;
 		_masks[i] = NULL;
 		_fragile_bits[i] = NULL;
+		_rotation_bank[i] = NULL;
+		_row_counts[i] = NULL;
 		_fragility_rate[i] = new double[256];
 	}
 	
@@ -377,19 +441,23 @@ double c_database :: get_fbt( double fbr, unsigned id )
 			if ( _fragility_rate[id][i] >= fbr )
 			{
 				//Calcul des seuils
-				if ( _iris_codes_bis[id] || _masks[id] || _fragile_bits[id] )
+				release_plane( _iris_codes_bis[id] );
+				release_plane( _masks[id] );
+				release_plane( _fragile_bits[id] );
+				
+				//Iris codes binaires stockés dans le fichier de galerie
+				if ( _map_data && _map_thresholds[id] == i )
 				{
-					delete[] _iris_codes_bis[id];
-					delete[] _masks[id];
-					delete[] _fragile_bits[id];	
-					_iris_codes_bis[id] = NULL;
-					_masks[id] = NULL;
-					_fragile_bits[id] = NULL;
-					
-					
+					const gallery_file_header * header = (const gallery_file_header *) _map_data;
+					size_t size = header->width_step * header->height;
+					_iris_codes_bis[id] = (unsigned long long *) ( (char*) _map_data + header->codes_offset ) + size * id;
+					_masks[id] = (unsigned long long *) ( (char*) _map_data + header->masks_offset ) + size * id;
+					_fragile_bits[id] = (unsigned long long *) ( (char*) _map_data + header->fragile_bits_offset ) + size * id;
+					compute_rotation_bank( id );
+					release_row_counts( id );
+					_row_counts[id] = (unsigned int *) ( (char*) _map_data + header->row_counts_offset ) + 2 * ( header->height + 1 ) * id;
 				}
-				
-				if ( _iris_codes[id] && _fragility_maps[id] )
+				else if ( _iris_codes[id] && _fragility_maps[id] )
 				{
 					_iris_codes_bis[id] = new unsigned long long[ ((_iris_codes[id]->width + 63) /64 ) *  _iris_codes[id]->height];
 					_masks[id] = new unsigned long long[ ((_iris_codes[id]->width + 63) /64 ) *  _iris_codes[id]->height];
@@ -401,6 +469,8 @@ double c_database :: get_fbt( double fbr, unsigned id )
 												(const IplImage*) _iris_codes[id],
 												(const IplImage*) _fragility_maps[id],
 												i );
+					compute_rotation_bank( id );
+					compute_row_counts( id );
 				}
 				return i;
 			}
@@ -425,6 +495,48 @@ void c_database :: compute_fragile_bit_threshold( double fragile_bit_rate )
 	}
 }
 
+unsigned int c_database :: fragile_bit_threshold( 	double fragile_bit_rate,
+													unsigned int id ) const
+{
+	if ( _fragility_rate[id] == NULL )
+		return 255;
+	for ( unsigned int i = 1; i < 256; ++ i )
+	{
+		if ( _fragility_rate[id][i] >= fragile_bit_rate )
+			return i;
+	}
+	return 255;
+}
+
+int c_database :: convert_levels( 	unsigned long long * planes,
+									unsigned int id,
+									const double * fbr,
+									unsigned int nb_fbr ) const
+{
+	if ( 	id >= _nb_classes 		||
+			! _iris_codes[id] 		||
+			! _fragility_maps[id] 	||
+			! _fragility_rate[id] 	||
+			nb_fbr == 0 			)
+		return 1;
+	unsigned int 	ws,
+					size = ( ( _iris_codes[id]->width + 63 ) / 64 ) * _iris_codes[id]->height;
+	//Iris code et masque ( indépendants du seuil ) : conservés pour le premier taux
+	unsigned long long * tmp = new unsigned long long[ 2 * size ];
+	for ( unsigned int k = 0; k < nb_fbr; ++ k )
+	{
+		distance::convert(	( k == 0 ) ? planes : tmp,
+							( k == 0 ) ? planes + size : tmp + size,
+							planes + ( 2 + k ) * size,
+							ws,
+							(const IplImage*) _iris_codes[id],
+							(const IplImage*) _fragility_maps[id],
+							fragile_bit_threshold( fbr[k], id ) );
+	}
+	delete[] tmp;
+	return 0;
+}
+
 double c_database :: get_fragile_bit_threshold ( unsigned int id ) const
 {
 	if ( id >= _nb_classes )
@@ -432,3 +544,556 @@ double c_database :: get_fragile_bit_threshold ( unsigned int id ) const
 	else
 		return _fragile_bit_thresholds[id];
 }
+
+int c_database :: set_rotation_bank( 	double d_theta,
+										unsigned int nb_rotations )
+{
+	if ( d_theta < 0 )
+		return 1;
+	_bank_d_theta = d_theta;
+	_bank_max_rotations = nb_rotations;
+	_bank_nb_rotations = 0;
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+		compute_rotation_bank( i );
+	return 0;
+}
+
+void c_database :: compute_rotation_bank( unsigned int id )
+{
+	if ( _rotation_bank[id] )
+	{
+		delete[] _rotation_bank[id];
+		_rotation_bank[id] = NULL;
+	}
+	if ( _bank_max_rotations == 0 || ! _iris_codes_bis[id] )
+		return;
+	
+	//Plage de recadrage ( cf. c_matching )
+	unsigned int 	width = _iris_codes[id]->width,
+					height = _iris_codes[id]->height,
+					size = width_step * height;
+	int theta_min = - (_bank_d_theta * width) / 2,
+		theta_max = + (_bank_d_theta * width) / 2;
+	if ( theta_max <= theta_min )
+		return;
+	
+	//Rotations les plus proches de 0
+	unsigned int nb = _bank_max_rotations;
+	if ( nb > (unsigned int) ( theta_max - theta_min ) )
+		nb = theta_max - theta_min;
+	int start = - (int) ( nb / 2 );
+	if ( start < theta_min )
+		start = theta_min;
+	if ( start + (int) nb > theta_max )
+		start = theta_max - nb;
+	_bank_nb_rotations = nb;
+	_bank_theta_min = start;
+	
+	//Rotation de - theta : comparer l'iris code tourné de - theta revient
+	//à comparer l'iris code non tourné avec l'autre tourné de theta.
+	_rotation_bank[id] = new unsigned long long[ 3 * size * nb ];
+	for ( unsigned int k = 0; k < nb; ++ k )
+	{
+		unsigned long long * data = _rotation_bank[id] + 3 * size * k;
+		distance::rotate(	data,
+							data + size,
+							data + 2 * size,
+							(const unsigned long long *) _iris_codes_bis[id],
+							(const unsigned long long *) _masks[id],
+							(const unsigned long long *) _fragile_bits[id],
+							width,
+							height,
+							width_step,
+							- ( start + (int) k ) );
+	}
+}
+
+void c_database :: release_row_counts( unsigned int id )
+{
+	if ( _row_counts[id] && ! in_map( _row_counts[id] ) )
+		delete[] _row_counts[id];
+	_row_counts[id] = NULL;
+}
+
+void c_database :: compute_row_counts( unsigned int id )
+{
+	release_row_counts( id );
+	if ( ! _masks[id] || ! _fragile_bits[id] )
+		return;
+	unsigned int height = _iris_codes[id]->height;
+	_row_counts[id] = new unsigned int[ 2 * ( height + 1 ) ];
+	distance::compute_row_counts(	_row_counts[id],
+									(const unsigned long long *) _masks[id],
+									(const unsigned long long *) _fragile_bits[id],
+									width_step,
+									height );
+}
+
+const unsigned int * c_database :: row_counts( unsigned int id ) const
+{
+	if ( id < _nb_classes )
+		return _row_counts[id];
+	else
+		return NULL;
+}
+
+int c_database :: rotated_template( 	unsigned int id,
+										int theta,
+										const unsigned long long *& code,
+										const unsigned long long *& mask,
+										const unsigned long long *& fb ) const
+{
+	if ( 	id >= _nb_classes 						|| 
+			! _rotation_bank 						||
+			! _rotation_bank[id] 					||
+			theta < _bank_theta_min 				||
+			theta >= _bank_theta_min + (int) _bank_nb_rotations )
+		return 1;
+	
+	unsigned int size = width_step * _iris_codes[id]->height;
+	code = _rotation_bank[id] + 3 * size * ( theta - _bank_theta_min );
+	mask = code + size;
+	fb = code + 2 * size;
+	return 0;
+}
+
+int c_database :: compute_fuzzy_codes( void )
+{
+	if ( _fuzzy_codes )
+		return 0;
+	
+	//Dimensions ( premier iris code de la base )
+	unsigned int 	width = 0,
+					height = 0;
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+	{
+		if ( _iris_codes[i] && _fragility_maps[i] )
+		{
+			width = _iris_codes[i]->width;
+			height = _iris_codes[i]->height;
+			break;
+		}
+	}
+	if ( width == 0 || height == 0 )
+		return 1;
+	_fuzzy_width_step = distance::fuzzy_code_width_step( width );
+	_fuzzy_codes = new short*[_nb_classes];
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+	{
+		_fuzzy_codes[i] = NULL;
+		if ( 	! _iris_codes[i] 											||
+				! _fragility_maps[i] 										||
+				(unsigned int) _iris_codes[i]->width != width 				||
+				(unsigned int) _iris_codes[i]->height != height 			)
+			continue;
+		_fuzzy_codes[i] = new short[ _fuzzy_width_step * height ];
+		if ( distance::quantize_fuzzy_code( 	_fuzzy_codes[i],
+												_iris_codes[i],
+												_fragility_maps[i] ) )
+		{
+			if ( err_stream )
+				*err_stream << "Error : Unable to quantize " << _names[i] << "!" << endl;
+			delete[] _fuzzy_codes[i];
+			_fuzzy_codes[i] = NULL;
+		}
+	}
+	return 0;
+}
+
+const short * c_database :: fuzzy_code( unsigned int id ) const
+{
+	if ( _fuzzy_codes && id < _nb_classes )
+		return _fuzzy_codes[id];
+	else
+		return NULL;
+}
+
+bool c_database :: in_map( const void * ptr ) const
+{
+	return ( 	_map_data 											&&
+				(const char *) ptr >= (const char *) _map_data 		&&
+				(const char *) ptr < (const char *) _map_data + _map_size );
+}
+
+void c_database :: release_plane( unsigned long long *& plane )
+{
+	if ( plane && ! in_map( plane ) )
+		delete[] plane;
+	plane = NULL;
+}
+
+bool c_database :: is_gallery_file( const char * file_name ) const
+{
+	char magic[8];
+	int fd = open( file_name, O_RDONLY );
+	if ( fd < 0 )
+		return false;
+	ssize_t n = read( fd, magic, sizeof(magic) );
+	close( fd );
+	return ( n == sizeof(magic) && ! memcmp( magic, GALLERY_FILE_MAGIC, sizeof(magic) ) );
+}
+
+//Position alignée d'une section
+static uint64_t gallery_align( uint64_t pos )
+{
+	return ( pos + GALLERY_FILE_ALIGNMENT - 1 ) / GALLERY_FILE_ALIGNMENT * GALLERY_FILE_ALIGNMENT;
+}
+
+//Ecriture de zéros jusqu'à la position offset
+static int gallery_pad( FILE * file, uint64_t & pos, uint64_t offset )
+{
+	static const char zeros[GALLERY_FILE_ALIGNMENT] = { 0 };
+	while ( pos < offset )
+	{
+		size_t n = offset - pos;
+		if ( n > sizeof(zeros) )
+			n = sizeof(zeros);
+		if ( fwrite( zeros, 1, n, file ) != n )
+			return 1;
+		pos += n;
+	}
+	return 0;
+}
+
+//Ecriture d'un bloc de données ( NULL : zéros )
+static int gallery_write( FILE * file, uint64_t & pos, const void * data, size_t size )
+{
+	if ( ! data )
+		return gallery_pad( file, pos, pos + size );
+	if ( fwrite( data, 1, size, file ) != size )
+		return 1;
+	pos += size;
+	return 0;
+}
+
+//Section hors du fichier ou mal alignée
+static bool gallery_bad_section( const gallery_file_header * header, uint64_t offset, uint64_t size )
+{
+	return ( 	offset % GALLERY_FILE_ALIGNMENT 		||
+				offset > header->file_size 				||
+				size > header->file_size - offset 		);
+}
+
+int c_database :: load_gallery (	const char * file_name,
+									const char * iris_code_file,
+									const char * fragility_map_file )
+{
+	//Projection du fichier
+	int fd = open( file_name, O_RDONLY );
+	if ( fd < 0 )
+		return 1;
+	struct stat status;
+	if ( fstat( fd, &status ) || (size_t) status.st_size < sizeof(gallery_file_header) )
+	{
+		close( fd );
+		return 1;
+	}
+	void * data = mmap( NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if ( data == MAP_FAILED )
+		return 1;
+	_map_data = data;
+	_map_size = status.st_size;
+	
+	//Vérification de l'en-tête
+	const gallery_file_header * header = (const gallery_file_header *) _map_data;
+	const char * base = (const char *) _map_data;
+	if ( 	memcmp( header->magic, GALLERY_FILE_MAGIC, sizeof(header->magic) ) 	||
+			header->byte_order != GALLERY_FILE_BYTE_ORDER 							||
+			header->header_size != sizeof(gallery_file_header) 						||
+			header->file_size != _map_size 											)
+	{
+		if ( err_stream )
+			*err_stream << "Error : " << file_name << " is not a valid gallery file!" << endl;
+		return 1;
+	}
+	if ( header->version != GALLERY_FILE_VERSION )
+	{
+		if ( err_stream )
+			*err_stream << "Error : " << file_name << " has version " << header->version << " ( expected " << GALLERY_FILE_VERSION << " ), compile the gallery again!" << endl;
+		return 1;
+	}
+	if ( 	strncmp( header->iris_code_file, iris_code_file, GALLERY_FILE_NAME_SIZE ) 			||
+			strncmp( header->fragility_map_file, fragility_map_file, GALLERY_FILE_NAME_SIZE ) 	)
+	{
+		if ( err_stream )
+			*err_stream << "Error : " << file_name << " was compiled from " << header->iris_code_file << " and " << header->fragility_map_file << "!" << endl;
+		return 1;
+	}
+	
+	uint64_t 	nb = header->nb_classes,
+				image_size = (uint64_t) header->image_width_step * header->height,
+				plane_size = (uint64_t) header->width_step * header->height * sizeof(unsigned long long),
+				row_counts_size = 2 * ( (uint64_t) header->height + 1 );
+	if ( 	nb == 0 																		||
+			header->width_step != ( header->width + 63 ) / 64 								||
+			header->image_width_step < header->width 										||
+			gallery_bad_section( header, header->valid_offset, nb ) 						||
+			gallery_bad_section( header, header->thresholds_offset, nb * sizeof(double) ) 	||
+			gallery_bad_section( header, header->names_offset, nb * sizeof(uint64_t) ) 	||
+			gallery_bad_section( header, header->class_names_offset, nb * sizeof(uint64_t) ) ||
+			gallery_bad_section( header, header->strings_offset, header->strings_size ) 	||
+			header->strings_size == 0 														||
+			base[header->strings_offset + header->strings_size - 1] != '\0' 				||
+			gallery_bad_section( header, header->fragility_rate_offset, nb * 256 * sizeof(double) ) ||
+			gallery_bad_section( header, header->iris_codes_offset, nb * image_size ) 		||
+			gallery_bad_section( header, header->fragility_maps_offset, nb * image_size ) 	||
+			gallery_bad_section( header, header->codes_offset, nb * plane_size ) 			||
+			gallery_bad_section( header, header->masks_offset, nb * plane_size ) 			||
+			gallery_bad_section( header, header->fragile_bits_offset, nb * plane_size ) 	||
+			gallery_bad_section( header, header->row_counts_offset, nb * row_counts_size * sizeof(uint32_t) ) )
+	{
+		if ( err_stream )
+			*err_stream << "Error : " << file_name << " is corrupted!" << endl;
+		return 1;
+	}
+	
+	//Alloc. mémoire ( pointeurs vers le fichier )
+	_nb_classes = header->nb_classes;
+	_class_names = new string[_nb_classes];
+	_names = new string[_nb_classes];
+	_iris_codes = new IplImage*[_nb_classes];
+	_fragility_maps = new IplImage*[_nb_classes];
+	_fragility_rate = new double*[_nb_classes];
+	_iris_codes_bis = new unsigned long long*[_nb_classes];
+	_masks = new unsigned long long*[_nb_classes];
+	_fragile_bits = new unsigned long long*[_nb_classes];
+	_rotation_bank = new unsigned long long*[_nb_classes];
+	_row_counts = new unsigned int*[_nb_classes];
+	_fragile_bit_thresholds = new double[_nb_classes];
+	
+	const unsigned char * valid = (const unsigned char *) ( base + header->valid_offset );
+	const uint64_t 	* names = (const uint64_t *) ( base + header->names_offset ),
+					* class_names = (const uint64_t *) ( base + header->class_names_offset );
+	_map_thresholds = (const double *) ( base + header->thresholds_offset );
+	width_step = header->width_step;
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+	{
+		if ( 	names[i] < header->strings_size )
+			_names[i] = base + header->strings_offset + names[i];
+		if ( 	class_names[i] < header->strings_size )
+			_class_names[i] = base + header->strings_offset + class_names[i];
+		_rotation_bank[i] = NULL;
+		_row_counts[i] = NULL;
+		_fragile_bit_thresholds[i] = _map_thresholds[i];
+		_iris_codes[i] = NULL;
+		_fragility_maps[i] = NULL;
+		_fragility_rate[i] = NULL;
+		_iris_codes_bis[i] = NULL;
+		_masks[i] = NULL;
+		_fragile_bits[i] = NULL;
+		if ( ! valid[i] )
+			continue;
+		
+		_iris_codes[i] = cvCreateImageHeader( cvSize( header->width, header->height ), IPL_DEPTH_8U, 1 );
+		cvSetData( 	_iris_codes[i],
+					(void *) ( base + header->iris_codes_offset + i * image_size ),
+					header->image_width_step );
+		_fragility_maps[i] = cvCreateImageHeader( cvSize( header->width, header->height ), IPL_DEPTH_8U, 1 );
+		cvSetData( 	_fragility_maps[i],
+					(void *) ( base + header->fragility_maps_offset + i * image_size ),
+					header->image_width_step );
+		_fragility_rate[i] = (double *) ( base + header->fragility_rate_offset ) + 256 * i;
+		_iris_codes_bis[i] = (unsigned long long *) ( base + header->codes_offset + i * plane_size );
+		_masks[i] = (unsigned long long *) ( base + header->masks_offset + i * plane_size );
+		_fragile_bits[i] = (unsigned long long *) ( base + header->fragile_bits_offset + i * plane_size );
+		_row_counts[i] = (unsigned int *) ( base + header->row_counts_offset ) + i * row_counts_size;
+	}
+	
+	//Les iris codes binaires correspondent au taux de bits fragiles de la compilation
+	_previous_fragile_bit_rate = header->fragile_bit_rate;
+	
+	//Lecture anticipée des iris codes binaires
+	uint64_t page = sysconf( _SC_PAGESIZE ),
+			 start = header->codes_offset / page * page;
+	madvise( 	(void *) ( base + start ),
+				_map_size - start,
+				MADV_WILLNEED );
+	return 0;
+}
+
+int c_database :: save( 	const char * file_name,
+							double fragile_bit_rate,
+							const char * iris_code_file,
+							const char * fragility_map_file )
+{
+	if ( 	! file_name 													|| 
+			! iris_code_file 												|| 
+			! fragility_map_file 											||
+			strlen( iris_code_file ) >= GALLERY_FILE_NAME_SIZE 				||
+			strlen( fragility_map_file ) >= GALLERY_FILE_NAME_SIZE 			)
+	{
+		if ( err_stream )
+			*err_stream << "Error : Invalid gallery file arguments!" << endl;
+		return 1;
+	}
+	
+	//Iris codes binaires
+	compute_fragile_bit_threshold( fragile_bit_rate );
+	
+	//Dimensions ( communes à tous les échantillons )
+	unsigned int 	width = 0,
+					height = 0,
+					nb_valid = 0;
+	unsigned char * valid = new unsigned char[_nb_classes];
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+	{
+		valid[i] = ( 	_iris_codes[i] 		&& 
+						_fragility_maps[i] 	&& 
+						_iris_codes_bis[i] 	&&
+						_row_counts[i] 		);
+		if ( ! valid[i] )
+			continue;
+		if ( nb_valid == 0 )
+		{
+			width = _iris_codes[i]->width;
+			height = _iris_codes[i]->height;
+		}
+		if ( 	(unsigned int) _iris_codes[i]->width != width 			||
+				(unsigned int) _iris_codes[i]->height != height 		||
+				(unsigned int) _fragility_maps[i]->width != width 		||
+				(unsigned int) _fragility_maps[i]->height != height 	)
+		{
+			if ( err_stream )
+				*err_stream << "Error : " << _names[i] << " has not the same size as the other iris codes!" << endl;
+			delete[] valid;
+			return 1;
+		}
+		++ nb_valid;
+	}
+	if ( nb_valid == 0 )
+	{
+		if ( err_stream )
+			*err_stream << "Error : No iris code to save!" << endl;
+		delete[] valid;
+		return 1;
+	}
+	
+	//En-tête
+	gallery_file_header header;
+	memset( &header, 0, sizeof(header) );
+	memcpy( header.magic, GALLERY_FILE_MAGIC, sizeof(header.magic) );
+	header.version = GALLERY_FILE_VERSION;
+	header.byte_order = GALLERY_FILE_BYTE_ORDER;
+	header.header_size = sizeof(header);
+	header.nb_classes = _nb_classes;
+	header.width = width;
+	header.height = height;
+	header.image_width_step = ( width + 3 ) / 4 * 4;
+	header.width_step = ( width + 63 ) / 64;
+	header.fragile_bit_rate = fragile_bit_rate;
+	strcpy( header.iris_code_file, iris_code_file );
+	strcpy( header.fragility_map_file, fragility_map_file );
+	
+	//Table des chaînes
+	uint64_t 	* names = new uint64_t[_nb_classes],
+				* class_names = new uint64_t[_nb_classes];
+	uint64_t strings_size = 0;
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+	{
+		names[i] = strings_size;
+		strings_size += _names[i].size() + 1;
+		class_names[i] = strings_size;
+		strings_size += _class_names[i].size() + 1;
+	}
+	
+	//Sections
+	uint64_t 	image_size = (uint64_t) header.image_width_step * height,
+				plane_size = (uint64_t) header.width_step * height * sizeof(unsigned long long),
+				row_counts_size = 2 * ( (uint64_t) height + 1 ),
+				pos = sizeof(header);
+	header.valid_offset = gallery_align( pos );
+	header.thresholds_offset = gallery_align( header.valid_offset + _nb_classes );
+	header.names_offset = gallery_align( header.thresholds_offset + _nb_classes * sizeof(double) );
+	header.class_names_offset = gallery_align( header.names_offset + _nb_classes * sizeof(uint64_t) );
+	header.strings_offset = gallery_align( header.class_names_offset + _nb_classes * sizeof(uint64_t) );
+	header.strings_size = strings_size;
+	header.fragility_rate_offset = gallery_align( header.strings_offset + strings_size );
+	header.iris_codes_offset = gallery_align( header.fragility_rate_offset + _nb_classes * 256 * sizeof(double) );
+	header.fragility_maps_offset = gallery_align( header.iris_codes_offset + _nb_classes * image_size );
+	header.codes_offset = gallery_align( header.fragility_maps_offset + _nb_classes * image_size );
+	header.masks_offset = gallery_align( header.codes_offset + _nb_classes * plane_size );
+	header.fragile_bits_offset = gallery_align( header.masks_offset + _nb_classes * plane_size );
+	header.row_counts_offset = gallery_align( header.fragile_bits_offset + _nb_classes * plane_size );
+	header.file_size = gallery_align( header.row_counts_offset + _nb_classes * row_counts_size * sizeof(uint32_t) );
+	
+	//Ecriture
+	FILE * file = fopen( file_name, "wb" );
+	if ( ! file )
+	{
+		if ( err_stream )
+			*err_stream << "Error : Unable to create " << file_name << "!" << endl;
+		delete[] valid;
+		delete[] names;
+		delete[] class_names;
+		return 1;
+	}
+	pos = 0;
+	int q = gallery_write( file, pos, &header, sizeof(header) );
+	
+	q |= gallery_pad( file, pos, header.valid_offset );
+	q |= gallery_write( file, pos, valid, _nb_classes );
+	
+	q |= gallery_pad( file, pos, header.thresholds_offset );
+	q |= gallery_write( file, pos, _fragile_bit_thresholds, _nb_classes * sizeof(double) );
+	
+	q |= gallery_pad( file, pos, header.names_offset );
+	q |= gallery_write( file, pos, names, _nb_classes * sizeof(uint64_t) );
+	q |= gallery_pad( file, pos, header.class_names_offset );
+	q |= gallery_write( file, pos, class_names, _nb_classes * sizeof(uint64_t) );
+	q |= gallery_pad( file, pos, header.strings_offset );
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+	{
+		q |= gallery_write( file, pos, _names[i].c_str(), _names[i].size() + 1 );
+		q |= gallery_write( file, pos, _class_names[i].c_str(), _class_names[i].size() + 1 );
+	}
+	
+	q |= gallery_pad( file, pos, header.fragility_rate_offset );
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+		q |= gallery_write( file, pos, valid[i] ? _fragility_rate[i] : NULL, 256 * sizeof(double) );
+	
+	//Images 8 bits
+	IplImage ** images[2] = { _iris_codes, _fragility_maps };
+	uint64_t offsets[2] = { header.iris_codes_offset, header.fragility_maps_offset };
+	for ( unsigned int k = 0; k < 2; ++ k )
+	{
+		q |= gallery_pad( file, pos, offsets[k] );
+		for ( unsigned int i = 0; i < _nb_classes; ++ i )
+		{
+			for ( unsigned int j = 0; j < height; ++ j )
+			{
+				q |= gallery_write( file, pos, valid[i] ? images[k][i]->imageData + j * images[k][i]->widthStep : NULL, width );
+				q |= gallery_pad( file, pos, pos + header.image_width_step - width );
+			}
+		}
+	}
+	
+	//Iris codes binaires
+	unsigned long long ** planes[3] = { _iris_codes_bis, _masks, _fragile_bits };
+	uint64_t plane_offsets[3] = { header.codes_offset, header.masks_offset, header.fragile_bits_offset };
+	for ( unsigned int k = 0; k < 3; ++ k )
+	{
+		q |= gallery_pad( file, pos, plane_offsets[k] );
+		for ( unsigned int i = 0; i < _nb_classes; ++ i )
+			q |= gallery_write( file, pos, valid[i] ? planes[k][i] : NULL, plane_size );
+	}
+	
+	//Bits restants ligne par ligne ( pas de calcul au chargement )
+	q |= gallery_pad( file, pos, header.row_counts_offset );
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+		q |= gallery_write( file, pos, valid[i] ? _row_counts[i] : NULL, row_counts_size * sizeof(uint32_t) );
+	q |= gallery_pad( file, pos, header.file_size );
+	
+	if ( fclose( file ) )
+		q = 1;
+	delete[] valid;
+	delete[] names;
+	delete[] class_names;
+	if ( q )
+	{
+		if ( err_stream )
+			*err_stream << "Error : Unable to write " << file_name << "!" << endl;
+		return 1;
+	}
+	return 0;
+}
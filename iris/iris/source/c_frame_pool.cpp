@@ -0,0 +1,142 @@
+#include "c_frame_pool.hpp"
+
+c_frame_pool :: c_frame_pool( void )
+{
+	initialize();
+}
+
+c_frame_pool :: c_frame_pool( 	unsigned int nb_frames,
+								void * (*alloc_function) ( const void * params ),
+								void (*free_function) ( void * data ),
+								const void * params,
+								ostream * stream )
+{
+	initialize();
+	setup( 	nb_frames,
+			alloc_function,
+			free_function,
+			params,
+			stream );
+}
+
+int c_frame_pool :: setup( 	unsigned int nb_frames,
+							void * (*alloc_function) ( const void * params ),
+							void (*_free_function) ( void * data ),
+							const void * params,
+							ostream * stream )
+{
+	free();
+	initialize();
+	err_stream = stream;
+	if ( 	nb_frames == 0 			||
+			alloc_function == 0 	||
+			_free_function == 0 	)
+	{
+		if ( err_stream )
+			*err_stream << "Error : Argument(s) of c_frame_pool :: setup!" << endl;
+		return 1;
+	}
+
+	pthread_mutex_init( &_mutex, NULL );
+	pthread_cond_init( &_not_empty, NULL );
+	free_function = _free_function;
+	_nb_frames = nb_frames;
+	_frames = new void*[nb_frames];
+	_refs = new unsigned int[nb_frames];
+	_free_ids = new unsigned int[nb_frames];
+	for ( unsigned int i = 0; i < nb_frames; ++ i )
+	{
+		_frames[i] = alloc_function( params );
+		_refs[i] = 0;
+		_free_ids[i] = nb_frames - 1 - i;
+	}
+	_nb_free = nb_frames;
+	return 0;
+}
+
+void * c_frame_pool :: acquire()
+{
+	pthread_mutex_lock( &_mutex );
+	while ( _nb_free == 0 )
+		pthread_cond_wait( &_not_empty, &_mutex );
+	unsigned int i = _free_ids[ -- _nb_free ];
+	_refs[i] = 1;
+	pthread_mutex_unlock( &_mutex );
+	return _frames[i];
+}
+
+void c_frame_pool :: retain( void * frame )
+{
+	pthread_mutex_lock( &_mutex );
+	unsigned int i = find( frame );
+	if ( i < _nb_frames )
+		++ _refs[i];
+	pthread_mutex_unlock( &_mutex );
+}
+
+void c_frame_pool :: release( void * frame )
+{
+	pthread_mutex_lock( &_mutex );
+	unsigned int i = find( frame );
+	if ( i < _nb_frames && _refs[i] )
+	{
+		-- _refs[i];
+		//Retour dans la réserve
+		if ( _refs[i] == 0 )
+		{
+			_free_ids[ _nb_free ++ ] = i;
+			pthread_cond_signal( &_not_empty );
+		}
+	}
+	pthread_mutex_unlock( &_mutex );
+}
+
+unsigned int c_frame_pool :: nb_free()
+{
+	pthread_mutex_lock( &_mutex );
+	unsigned int n = _nb_free;
+	pthread_mutex_unlock( &_mutex );
+	return n;
+}
+
+unsigned int c_frame_pool :: find( const void * frame ) const
+{
+	//Réserves de quelques objets : recherche linéaire
+	unsigned int i = 0;
+	while ( i < _nb_frames && _frames[i] != frame )
+		++ i;
+	return i;
+}
+
+c_frame_pool :: ~c_frame_pool()
+{
+	free();
+}
+
+void c_frame_pool :: initialize()
+{
+	_nb_frames = 0;
+	_frames = NULL;
+	_refs = NULL;
+	free_function = 0;
+	_free_ids = NULL;
+	_nb_free = 0;
+	err_stream = NULL;
+}
+
+void c_frame_pool :: free()
+{
+	if ( _frames )
+	{
+		for ( unsigned int i = 0; i < _nb_frames; ++ i )
+			free_function( _frames[i] );
+		delete[] _frames;
+		pthread_mutex_destroy( &_mutex );
+		pthread_cond_destroy( &_not_empty );
+	}
+	if ( _refs )
+		delete[] _refs;
+	if ( _free_ids )
+		delete[] _free_ids;
+	initialize();
+}
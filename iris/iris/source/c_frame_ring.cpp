@@ -0,0 +1,167 @@
+#include "c_frame_ring.hpp"
+
+c_frame_ring :: c_frame_ring( void )
+{
+	initialize();
+}
+
+c_frame_ring :: c_frame_ring( 	unsigned int nb_frames,
+								ostream * stream )
+{
+	initialize();
+	setup( 	nb_frames,
+			stream );
+}
+
+int c_frame_ring :: setup( 	unsigned int nb_frames,
+							ostream * stream )
+{
+	free();
+	initialize();
+	err_stream = stream;
+	if ( nb_frames == 0 )
+	{
+		if ( err_stream )
+			*err_stream << "Error : Argument(s) of c_frame_ring :: setup!" << endl;
+		return 1;
+	}
+
+	pthread_mutex_init( &_mutex, NULL );
+	pthread_cond_init( &_not_empty, NULL );
+	pthread_cond_init( &_not_full, NULL );
+	_nb_frames = nb_frames;
+	_frames = new IplImage*[nb_frames];
+	for ( unsigned int i = 0; i < nb_frames; ++ i )
+		_frames[i] = NULL;
+	return 0;
+}
+
+int c_frame_ring :: push( const IplImage * image )
+{
+	pthread_mutex_lock( &_mutex );
+	while ( _count == _nb_frames && ! _closed )
+		pthread_cond_wait( &_not_full, &_mutex );
+	if ( _closed )
+	{
+		pthread_mutex_unlock( &_mutex );
+		return 1;
+	}
+	unsigned int i = ( _head + _count ) % _nb_frames;
+	pthread_mutex_unlock( &_mutex );
+
+	//Une seule écriture à la fois : la place i n'est pas lue avant l'ajout
+	IplImage *& frame = _frames[i];
+	if ( 	frame 											&&
+			( 	frame->width != image->width 			||
+				frame->height != image->height 			||
+				frame->depth != image->depth 			||
+				frame->nChannels != image->nChannels ) )
+		cvReleaseImage( &frame );
+	if ( ! frame )
+		frame = cvCreateImage( 	cvGetSize( image ),
+								image->depth,
+								image->nChannels );
+	frame->origin = image->origin;
+	cvCopyImage( 	image,
+					frame );
+
+	pthread_mutex_lock( &_mutex );
+	++ _count;
+	pthread_cond_signal( &_not_empty );
+	pthread_mutex_unlock( &_mutex );
+	return 0;
+}
+
+const IplImage * c_frame_ring :: front()
+{
+	pthread_mutex_lock( &_mutex );
+	while ( _count == 0 && ! _closed )
+		pthread_cond_wait( &_not_empty, &_mutex );
+	IplImage * frame = NULL;
+	if ( _count )
+	{
+		frame = _frames[_head];
+		_reading = true;
+	}
+	pthread_mutex_unlock( &_mutex );
+	return frame;
+}
+
+void c_frame_ring :: pop()
+{
+	pthread_mutex_lock( &_mutex );
+	if ( _reading )
+	{
+		_head = ( _head + 1 ) % _nb_frames;
+		-- _count;
+		_reading = false;
+		pthread_cond_signal( &_not_full );
+	}
+	pthread_mutex_unlock( &_mutex );
+}
+
+void c_frame_ring :: flush()
+{
+	pthread_mutex_lock( &_mutex );
+	_count = ( _reading ) ? 1 : 0;
+	pthread_cond_signal( &_not_full );
+	pthread_mutex_unlock( &_mutex );
+}
+
+void c_frame_ring :: close()
+{
+	pthread_mutex_lock( &_mutex );
+	_closed = true;
+	pthread_cond_broadcast( &_not_empty );
+	pthread_cond_broadcast( &_not_full );
+	pthread_mutex_unlock( &_mutex );
+}
+
+void c_frame_ring :: reset()
+{
+	pthread_mutex_lock( &_mutex );
+	_head = 0;
+	_count = 0;
+	_reading = false;
+	_closed = false;
+	pthread_mutex_unlock( &_mutex );
+}
+
+unsigned int c_frame_ring :: size()
+{
+	pthread_mutex_lock( &_mutex );
+	unsigned int n = _count;
+	pthread_mutex_unlock( &_mutex );
+	return n;
+}
+
+c_frame_ring :: ~c_frame_ring()
+{
+	free();
+}
+
+void c_frame_ring :: initialize()
+{
+	_nb_frames = 0;
+	_frames = NULL;
+	_head = 0;
+	_count = 0;
+	_reading = false;
+	_closed = false;
+	err_stream = NULL;
+}
+
+void c_frame_ring :: free()
+{
+	if ( _frames )
+	{
+		for ( unsigned int i = 0; i < _nb_frames; ++ i )
+			if ( _frames[i] )
+				cvReleaseImage( _frames + i );
+		delete[] _frames;
+		pthread_mutex_destroy( &_mutex );
+		pthread_cond_destroy( &_not_empty );
+		pthread_cond_destroy( &_not_full );
+	}
+	initialize();
+}
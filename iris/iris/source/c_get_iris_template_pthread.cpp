@@ -2,6 +2,13 @@
 #include "distances.hpp"
 #include <ctime>
 #include <signal.h>
+void * decode_function ( void * params )
+{
+	c_get_iris_template_pthread * data = (c_get_iris_template_pthread *) params;
+	data->frame_decoding();
+	return NULL;
+}
+
 void * image_function ( void * params )
 {
 	c_get_iris_template_pthread * data = (c_get_iris_template_pthread *) params;
@@ -11,15 +18,15 @@ void * image_function ( void * params )
 
 void * pupil_function ( void * params )
 {
-	c_get_iris_template_pthread * data = (c_get_iris_template_pthread *) params;
-	data->pupil_segmentation();
+	c_get_iris_template_worker * worker = (c_get_iris_template_worker *) params;
+	worker->obj->pupil_segmentation( worker->id );
 	return NULL;
 }
 
 void * iris_function ( void * params )
 {
-	c_get_iris_template_pthread * data = (c_get_iris_template_pthread *) params;
-	data->iris_segmentation();
+	c_get_iris_template_worker * worker = (c_get_iris_template_worker *) params;
+	worker->obj->iris_segmentation( worker->id );
 	return NULL;
 }
 
@@ -30,7 +37,7 @@ c_get_iris_template_pthread :: c_get_iris_template_pthread ( void )
 }
 
 int c_get_iris_template_pthread :: setup ( unsigned int argc, char ** argv, const char * save_rep,
-											ostream * stream, bool display  )
+											ostream * stream, bool display, const char * fps_name )
 {
 	api_parameters params;
 	stringstream oss;
@@ -43,10 +50,124 @@ int c_get_iris_template_pthread :: setup ( unsigned int argc, char ** argv, cons
 		return 1;
 	}
 
+	for ( unsigned int i = 0; i < argc; ++ i )
+		params.load( argv[i] );
+
+	//Nombre de threads par étage ( 1 par défaut )
+	oss << BUFFER_NAMESPACE << "::" << "nb_pupil_threads";
+	if ( api_get_positive_integer( 	params,
+									oss.str().c_str(),
+									&nb_pupil_threads,
+									NULL ) )
+		nb_pupil_threads = 1;
+	oss.str("");
+	oss << BUFFER_NAMESPACE << "::" << "nb_iris_threads";
+	if ( api_get_positive_integer( 	params,
+									oss.str().c_str(),
+									&nb_iris_threads,
+									NULL ) )
+		nb_iris_threads = 1;
+	oss.str("");
+	unsigned int offline_mode;
+	oss << BUFFER_NAMESPACE << "::" << "offline";
+	if ( api_get_positive_integer( 	params,
+									oss.str().c_str(),
+									&offline_mode,
+									NULL ) )
+		offline_mode = 0;
+	oss.str("");
+	offline = ( offline_mode != 0 );
+
+	//Arrêt anticipé et saut des passages flous ( désactivés par défaut )
+	oss << BUFFER_NAMESPACE << "::" << "stop_nb_templates";
+	if ( api_get_positive_integer( 	params,
+									oss.str().c_str(),
+									&stop_nb_templates,
+									NULL ) )
+		stop_nb_templates = 0;
+	oss.str("");
+	oss << BUFFER_NAMESPACE << "::" << "stop_quality";
+	if ( api_get_double( 	params,
+							oss.str().c_str(),
+							&stop_quality,
+							NULL ) )
+		stop_quality = 0;
+	oss.str("");
+	oss << BUFFER_NAMESPACE << "::" << "stop_gain";
+	if ( api_get_double( 	params,
+							oss.str().c_str(),
+							&stop_gain,
+							NULL ) )
+		stop_gain = 0.01;
+	oss.str("");
+	oss << BUFFER_NAMESPACE << "::" << "stop_patience";
+	if ( api_get_positive_integer( 	params,
+									oss.str().c_str(),
+									&stop_patience,
+									NULL ) )
+		stop_patience = 50;
+	oss.str("");
+	oss << BUFFER_NAMESPACE << "::" << "skip_focus";
+	if ( api_get_double( 	params,
+							oss.str().c_str(),
+							&skip_focus,
+							NULL ) )
+		skip_focus = 0;
+	oss.str("");
+	oss << BUFFER_NAMESPACE << "::" << "skip_patience";
+	if ( api_get_positive_integer( 	params,
+									oss.str().c_str(),
+									&skip_patience,
+									NULL ) )
+		skip_patience = 25;
+	oss.str("");
+	oss << BUFFER_NAMESPACE << "::" << "skip_frames";
+	if ( api_get_positive_integer( 	params,
+									oss.str().c_str(),
+									&skip_frames,
+									NULL ) )
+		skip_frames = 0;
+	oss.str("");
+	unsigned int prefetch_depth;
+	oss << BUFFER_NAMESPACE << "::" << "prefetch_depth";
+	if ( api_get_positive_integer( 	params,
+									oss.str().c_str(),
+									&prefetch_depth,
+									NULL ) )
+		prefetch_depth = 0;
+	oss.str("");
+	oss << BUFFER_NAMESPACE << "::" << "pupil_run_length";
+	if ( api_get_positive_integer( 	params,
+									oss.str().c_str(),
+									&pupil_run_length,
+									NULL ) || pupil_run_length == 0 )
+		pupil_run_length = 25;
+	oss.str("");
+	if ( nb_pupil_threads == 0 )
+		nb_pupil_threads = 1;
+	if ( nb_iris_threads == 0 )
+		nb_iris_threads = 1;
+
 	//Allco
 	image_thread = new c_image_thread;
-	pupil_thread = new c_pupil_thread;
-	iris_thread = new c_iris_thread;
+	pupil_threads = new c_pupil_thread*[nb_pupil_threads];
+	for ( unsigned int i = 0; i < nb_pupil_threads; ++ i )
+		pupil_threads[i] = new c_pupil_thread;
+	iris_threads = new c_iris_thread*[nb_iris_threads];
+	for ( unsigned int i = 0; i < nb_iris_threads; ++ i )
+		iris_threads[i] = new c_iris_thread;
+	last_frame_ids = new unsigned int[nb_pupil_threads];
+	tab_threads = new pthread_t[2 + nb_pupil_threads + nb_iris_threads];
+	workers = new c_get_iris_template_worker[nb_pupil_threads + nb_iris_threads];
+	for ( unsigned int i = 0; i < nb_pupil_threads + nb_iris_threads; ++ i )
+	{
+		workers[i].obj = this;
+		workers[i].id = ( i < nb_pupil_threads ) ? i : i - nb_pupil_threads;
+	}
+	pthread_mutex_init( &count_mutex, NULL );
+	if ( prefetch_depth )
+		frame_ring = new c_frame_ring( 	prefetch_depth,
+										stream );
 	focus_score_iris = new c_focus_score;
 	focus_score_pupil = new c_focus_score;
 
@@ -54,17 +175,19 @@ int c_get_iris_template_pthread :: setup ( unsigned int argc, char ** argv, cons
 								argc,
 								stream) )
 		q = 1;
-	if ( pupil_thread->setup(	argv,
-								argc,
-								stream) )
-		q = 1;
-	if ( iris_thread->setup(	argv,
-								argc,
-								stream) )
-		q = 1;
-
-	for ( unsigned int i = 0; i < argc; ++ i )
-		params.load( argv[i] );
+	for ( unsigned int i = 0; i < nb_pupil_threads; ++ i )
+		if ( pupil_threads[i]->setup(	argv,
+										argc,
+										stream) )
+			q = 1;
+	for ( unsigned int i = 0; i < nb_iris_threads; ++ i )
+	{
+		if ( iris_threads[i]->setup(	argv,
+										argc,
+										stream) )
+			q = 1;
+		iris_threads[i]->set_metrics( &metrics );
+	}
 
 	if ( focus_score_iris->setup( 	params ) )
 		q = 1;
@@ -101,6 +224,8 @@ int c_get_iris_template_pthread :: setup ( unsigned int argc, char ** argv, cons
 									stream ) )
 		q = 1;
 	oss.str("");
+	if ( stop_nb_templates > size_buffer_iris )
+		stop_nb_templates = size_buffer_iris;
 	oss << "score" << "::" << "width";
 	if ( api_get_positive_integer( 	params,
 									oss.str().c_str(),
@@ -116,7 +241,7 @@ int c_get_iris_template_pthread :: setup ( unsigned int argc, char ** argv, cons
 		q = 1;
 	oss.str("");
 
-	oss << save_rep << "/" << "fps.m";
+	oss << save_rep << "/" << fps_name;
 	fps_file = new ofstream( oss.str().c_str() );
 	if ( ! (*fps_file) )
 	{
@@ -136,35 +261,46 @@ int c_get_iris_template_pthread :: setup ( unsigned int argc, char ** argv, cons
 	{
 		CvSize tmp = cvSize( 	image_thread->data().width,
 								image_thread->data().height );
-		buffer_image
-			= new c_buffer ( 	size_buffer_image,
-								image_data_alloc,
-								image_data_copy,
-								image_data_free,
-								(void*) &tmp );
-
-		b_data_image = new c_buffer_data ( (void*) &tmp,
-											 image_data_alloc,
-											 image_data_copy,
-											 image_data_free );
+		//Objets du buffer, en cours d'écriture et en cours de lecture
+		//( hors ligne, plusieurs threads pupille : une suite d'images par thread )
+		unsigned int size_runs = 0;
+		if ( offline && nb_pupil_threads > 1 )
+			size_runs = nb_pupil_threads * pupil_run_length;
+		pool_image
+			= new c_frame_pool ( 	size_buffer_image + size_runs + 1 + nb_pupil_threads,
+									image_data_alloc,
+									image_data_free,
+									(void*) &tmp );
+		buffer_image = new c_buffer;
+		buffer_image->setup (	size_buffer_image,
+								pool_image,
+								image_data_copy );
+		if ( size_runs )
+		{
+			run_buffers = new c_buffer*[nb_pupil_threads];
+			for ( unsigned int i = 0; i < nb_pupil_threads; ++ i )
+			{
+				run_buffers[i] = new c_buffer;
+				run_buffers[i]->setup (	pupil_run_length,
+										pool_image,
+										image_data_copy );
+			}
+		}
 	}
 
 	//Buffer pupille
 	{
 		CvSize tmp = cvSize( 	image_thread->data().width,
 								image_thread->data().height );
-		buffer_pupil
-			= new c_buffer ( 	size_buffer_pupil,
-								pupil_data_alloc,
-								pupil_data_copy,
-								pupil_data_free,
-								(void*) &tmp );
-
-		b_data_pupil = new c_buffer_data ( (void*) &tmp,
-											 pupil_data_alloc,
-											 pupil_data_copy,
-											 pupil_data_free );
-
+		pool_pupil
+			= new c_frame_pool ( 	size_buffer_pupil + nb_pupil_threads + nb_iris_threads,
+									pupil_data_alloc,
+									pupil_data_free,
+									(void*) &tmp );
+		buffer_pupil = new c_buffer;
+		buffer_pupil->setup (	size_buffer_pupil,
+								pool_pupil,
+								pupil_data_copy );
 	}
 
 	//Buffer iris
@@ -172,19 +308,23 @@ int c_get_iris_template_pthread :: setup ( unsigned int argc, char ** argv, cons
 		iris_data_params tmp;
 			tmp.img_width = image_thread->data().width;
 			tmp.img_height = image_thread->data().height;
-			tmp.polar_width = iris_thread->iris_seg_data().nb_directions;
-			tmp.polar_height = iris_thread->iris_seg_data().nb_samples;
-			tmp.nb_samples_iris = iris_thread->iris_seg_data().nb_samples_iris;
-			tmp.iris_code_width = iris_thread->iris_seg_data().nb_directions_code;
-			tmp.iris_code_height = iris_thread->iris_seg_data().nb_samples_code;
-			tmp.iris_width = iris_thread->iris_seg_data().iris_width;
-			tmp.iris_height = iris_thread->iris_seg_data().iris_height;
-		buffer_iris
-			= new c_buffer ( 	size_buffer_iris,
-								iris_data_alloc,
-								iris_data_copy,
-								iris_data_free,
-								(void*) &tmp );
+			tmp.polar_width = iris_threads[0]->iris_seg_data().nb_directions;
+			tmp.polar_height = iris_threads[0]->iris_seg_data().nb_samples;
+			tmp.nb_samples_iris = iris_threads[0]->iris_seg_data().nb_samples_iris;
+			tmp.iris_code_width = iris_threads[0]->iris_seg_data().nb_directions_code;
+			tmp.iris_code_height = iris_threads[0]->iris_seg_data().nb_samples_code;
+			tmp.iris_width = iris_threads[0]->iris_seg_data().iris_width;
+			tmp.iris_height = iris_threads[0]->iris_seg_data().iris_height;
+		//Objets du buffer et en cours d'écriture
+		pool_iris
+			= new c_frame_pool ( 	size_buffer_iris + nb_iris_threads,
+									iris_data_alloc,
+									iris_data_free,
+									(void*) &tmp );
+		buffer_iris = new c_buffer;
+		buffer_iris->setup (	size_buffer_iris,
+								pool_iris,
+								iris_data_copy );
 
 		b_data_iris = new c_buffer_data ( (void*) &tmp,
 											 iris_data_alloc,
@@ -209,8 +349,8 @@ int c_get_iris_template_pthread :: setup ( unsigned int argc, char ** argv, cons
 		
 		unsigned int 	width = image_thread->data().width,
 						height = image_thread->data().height,
-						p_height = iris_thread->iris_seg_data().nb_samples * (image_thread->data().width / ( (double) iris_thread->iris_seg_data().nb_directions ) ),
-						c_height = iris_thread->iris_seg_data().nb_samples_code * (image_thread->data().width / ( (double) iris_thread->iris_seg_data().nb_directions_code ) );
+						p_height = iris_threads[0]->iris_seg_data().nb_samples * (image_thread->data().width / ( (double) iris_threads[0]->iris_seg_data().nb_directions ) ),
+						c_height = iris_threads[0]->iris_seg_data().nb_samples_code * (image_thread->data().width / ( (double) iris_threads[0]->iris_seg_data().nb_directions_code ) );
 		
 		
 		image_display_obj = new c_display_image_data;
@@ -286,7 +426,9 @@ int c_get_iris_template_pthread :: run ( 	const char * filename,
 	nb_i_frames = 0;
 	nb_p_frames = 0;
 	_filename = filename;
-	clock_t time_1 = clock();
+	//Horloge murale ( clock() somme le temps CPU de tous les threads )
+	double time_1 = monotonic_time();
+	metrics.reset();
 	if ( video )
 		cvReleaseCapture(&video );
 	//Chargement de la vidéo
@@ -310,49 +452,81 @@ int c_get_iris_template_pthread :: run ( 	const char * filename,
 		buffer_pupil->reset();
 		buffer_image->reset();
 		buffer_iris->reset();
+		pupil_runs = ( offline && run_buffers );
+		if ( run_buffers )
+			for ( unsigned int i = 0; i < nb_pupil_threads; ++ i )
+				run_buffers[i]->reset();
 		image_thread->reset_id();
-		pupil_thread->reset();
-		iris_thread->reset();
+		for ( unsigned int i = 0; i < nb_pupil_threads; ++ i )
+		{
+			pupil_threads[i]->reset();
+			last_frame_ids[i] = 0;
+		}
+		for ( unsigned int i = 0; i < nb_iris_threads; ++ i )
+			iris_threads[i]->reset();
 
 	//end
 		p_end = &end;
 		img_end = false;
 		pupil_end = false;
 		iris_end = false;
+		nb_pupil_running = nb_pupil_threads;
+		nb_iris_running = nb_iris_threads;
+		early_stop = false;
+		nb_stale = 0;
+		best_score = -1;
+		nb_low_focus = 0;
+		nb_skipped = 0;
+		can_skip = ( skip_frames > 0 && skip_focus > 0 );
+		skip_request = false;
+		if ( frame_ring )
+			frame_ring->reset();
 
 	//Création des threads
+		unsigned int nb_threads = 1 + nb_pupil_threads + nb_iris_threads;
+		if ( frame_ring )
+			pthread_create( tab_threads + nb_threads ++,
+							NULL,
+							decode_function,
+							(void*) ( this ) ) ;
+
 		pthread_create( tab_threads + 0,
 						NULL,
 						image_function,
 						(void*) ( this ) ) ;
 
-		pthread_create( tab_threads + 1,
-						NULL,
-						pupil_function,
-						(void*) ( this ) ) ;
-						//~ 
-		pthread_create( tab_threads + 2,
-						NULL,
-						iris_function,
-						(void*) ( this ) ) ;
-						
-						//~ 
-						//~ 
-						
-						
+		for ( unsigned int i = 0; i < nb_pupil_threads; ++ i )
+			pthread_create( tab_threads + 1 + i,
+							NULL,
+							pupil_function,
+							(void*) ( workers + i ) ) ;
+
+		for ( unsigned int i = 0; i < nb_iris_threads; ++ i )
+			pthread_create( tab_threads + 1 + nb_pupil_threads + i,
+							NULL,
+							iris_function,
+							(void*) ( workers + nb_pupil_threads + i ) ) ;
 						
 		display();
 	//Jonction des threads
-	for ( unsigned i = 0; i < 3; ++ i )
+	for ( unsigned i = 0; i < nb_threads; ++ i )
 		pthread_join( tab_threads[i], NULL);
-	clock_t time_2 = clock();
+	double time_2 = monotonic_time();
 	
 	*fps_file << "nb_frames(" << video_id + 1 << ") = " << cvGetCaptureProperty( video , CV_CAP_PROP_FRAME_COUNT )  <<";"  << endl;
-	*fps_file << "times(" << video_id + 1 << ") = " << (time_2 - time_1) / ( (double) CLOCKS_PER_SEC )  <<";"  << endl;
-	*fps_file << "fps(" << video_id + 1 << ") = " << ( cvGetCaptureProperty( video , CV_CAP_PROP_FRAME_COUNT ) ) * ( (double) CLOCKS_PER_SEC ) / (time_2 - time_1)  <<";"  << endl;
+	*fps_file << "times(" << video_id + 1 << ") = " << (time_2 - time_1) <<";"  << endl;
+	//Débit : images réellement traitées ( arrêt anticipé et sauts exclus, cf. nb_skipped )
+	*fps_file << "nb_processed(" << video_id + 1 << ") = " << nb_frames <<";"  << endl;
+	*fps_file << "fps(" << video_id + 1 << ") = " << nb_frames / (time_2 - time_1)  <<";"  << endl;
 	*fps_file << "p_thread_pupil(" << video_id + 1 << ") = " << nb_p_frames / ((double) nb_frames ) <<";"  << endl;
 	*fps_file << "p_thread_iris(" << video_id + 1 << ") = " << nb_i_frames / ((double) nb_frames )  <<";"  << endl;
 	*fps_file << "p_abberations(" << video_id + 1 << ") = " <<  nb_abb / ((double) nb_i_frames ) <<";"  << endl;
+	*fps_file << "early_stop(" << video_id + 1 << ") = " << early_stop <<";"  << endl;
+	*fps_file << "nb_skipped(" << video_id + 1 << ") = " << nb_skipped <<";"  << endl;
+	//Mesures des étapes ( la sauvegarde est écrite par save )
+	for ( unsigned int i = 0; i < METRIC_COUNT; ++ i )
+		if ( i != METRIC_SAVE )
+			metrics.save( *fps_file, video_id + 1, (metric_id) i );
 	
 	video_id ++;
 	return 0;
@@ -367,22 +541,34 @@ c_get_iris_template_pthread :: ~c_get_iris_template_pthread()
 void c_get_iris_template_pthread :: initialize()
 {
 	video = 0;
+	frame_ring = 0;
 	buffer_image = 0; // Score = id
+	run_buffers = 0;
+	pupil_run_length = 0;
+	pupil_runs = false;
 	buffer_pupil = 0;
 	buffer_iris = 0;
 	fps_file = 0;
 	image_thread = 0;
-	pupil_thread = 0;
-	iris_thread = 0;
+	pupil_threads = 0;
+	iris_threads = 0;
+	nb_pupil_threads = 0;
+	nb_iris_threads = 0;
+	last_frame_ids = 0;
+	tab_threads = 0;
+	workers = 0;
+	nb_pupil_running = 0;
+	nb_iris_running = 0;
 	focus_score_pupil = 0;
 	focus_score_iris = 0;
 	p_end = 0;
 	img_end = true;
 	pupil_end = true;
 	iris_end = true;
-	b_data_image = 0;
+	pool_image = 0;
+	pool_pupil = 0;
+	pool_iris = 0;
 	b_data_iris = 0;
-	b_data_pupil = 0;
 	r_width = 0;
 	r_height = 0;
 	video_id = 0;
@@ -397,6 +583,21 @@ void c_get_iris_template_pthread :: initialize()
 	pupil_display_obj = 0;
 	iris_display_obj = 0;
 	display_on = false;
+	offline = false;
+	stop_nb_templates = 0;
+	stop_patience = 0;
+	nb_stale = 0;
+	stop_quality = 0;
+	stop_gain = 0;
+	best_score = -1;
+	early_stop = false;
+	skip_patience = 0;
+	skip_frames = 0;
+	nb_low_focus = 0;
+	nb_skipped = 0;
+	skip_focus = 0;
+	can_skip = false;
+	skip_request = false;
 	
 }
 
@@ -404,28 +605,56 @@ void c_get_iris_template_pthread :: free()
 {
 	if ( video )
 		cvReleaseCapture(&video );
+	if ( frame_ring )
+		delete frame_ring;
 	if ( buffer_image )
 		delete buffer_image;
+	if ( run_buffers )
+	{
+		for ( unsigned int i = 0; i < nb_pupil_threads; ++ i )
+			delete run_buffers[i];
+		delete[] run_buffers;
+	}
 	if ( buffer_pupil )
 		delete buffer_pupil;
 	if ( buffer_iris )
 		delete buffer_iris;
+	//Après les buffers, qui rendent leurs objets aux réserves
+	if ( pool_image )
+		delete pool_image;
+	if ( pool_pupil )
+		delete pool_pupil;
+	if ( pool_iris )
+		delete pool_iris;
 	if ( image_thread )
 		delete image_thread;
-	if ( pupil_thread )
-		delete pupil_thread;
-	if ( iris_thread )
-		delete iris_thread;
+	if ( pupil_threads )
+	{
+		for ( unsigned int i = 0; i < nb_pupil_threads; ++ i )
+			delete pupil_threads[i];
+		delete[] pupil_threads;
+	}
+	if ( iris_threads )
+	{
+		for ( unsigned int i = 0; i < nb_iris_threads; ++ i )
+			delete iris_threads[i];
+		delete[] iris_threads;
+	}
+	if ( last_frame_ids )
+		delete[] last_frame_ids;
+	if ( tab_threads )
+		delete[] tab_threads;
+	if ( workers )
+	{
+		delete[] workers;
+		pthread_mutex_destroy( &count_mutex );
+	}
 	if ( focus_score_pupil )
 		delete focus_score_pupil;
 	if ( focus_score_iris )
 		delete focus_score_iris;
-	if ( b_data_image )
-		delete b_data_image;
 	if ( b_data_iris )
 		delete b_data_iris;
-	if ( b_data_pupil )
-		delete b_data_pupil;
 	if ( fps_file)
 	{
 		fps_file->close();
@@ -456,148 +685,348 @@ void c_get_iris_template_pthread :: free()
 
 void c_get_iris_template_pthread :: image_acquistion ( )
 {
-	clock_t time_1, time_2;
-	IplImage * image = NULL;
+	double time_1, time_2;
+	const IplImage * image = NULL;
 	do
 	{
-		time_1 = clock();
-		image = cvQueryFrame(video);
+		time_1 = monotonic_time();
+		if ( frame_ring )
+		{
+			//Image décodée par frame_decoding
+			c_scoped_timer timer( &metrics, METRIC_DECODE_WAIT );
+			image = frame_ring->front();
+		}
+		else
+		{
+			c_scoped_timer timer( &metrics, METRIC_DECODE );
+			image = cvQueryFrame(video);
+		}
 		if (image)
 		{
-			image_thread->process( image, _filename );
-			if ( image_thread->data().img_ok )
+			//Prétraitements dans un objet de la réserve
+			image_data * frame = (image_data*) pool_image->acquire();
+			{
+				c_scoped_timer timer( &metrics, METRIC_PREPROCESSING );
+				image_thread->process( image, _filename, frame );
+			}
+			//L'image décodée n'est plus utilisée
+			if ( frame_ring )
+				frame_ring->pop();
+			if ( frame->img_ok )
 			{
 				nb_frames ++;
-				image_thread->set_score(
-					focus_score_pupil->get_score( 	image_thread->data().image ) );													
-				buffer_image->add_object( 	image_thread->data().frame_id,
-											image_thread->data().score,
-											(void*) & (image_thread->data()) );
+				{
+					c_scoped_timer timer( &metrics, METRIC_FOCUS_SCORE );
+					frame->score = focus_score_pupil->get_score( frame->image );
+				}
+				
+				//Passage flou
+				if ( get_flag( can_skip ) )
+				{
+					if ( frame->score < skip_focus )
+						++ nb_low_focus;
+					else
+						nb_low_focus = 0;
+					if ( nb_low_focus >= skip_patience )
+					{
+						//Avec la lecture anticipée, le saut est fait par le thread de décodage
+						if ( frame_ring )
+						{
+							pthread_mutex_lock( &count_mutex );
+							skip_request = true;
+							pthread_mutex_unlock( &count_mutex );
+						}
+						else
+							skip_ahead();
+						nb_low_focus = 0;
+					}
+				}
 				
 				if ( display_on )	
 				{
 					pthread_mutex_lock ( &mutex1 );
-					image_display_obj->display(image_thread->data());
+					image_display_obj->display( *frame );
 					pthread_mutex_unlock ( &mutex1 );
-				}		
+				}
 				
-				time_2 = clock();
-				int q = 40000 - ( (time_2 - time_1) * 1000000 ) / CLOCKS_PER_SEC; 
-				if ( q > 0 )
-					usleep( q );
+				//L'objet appartient désormais au buffer
+				double t = monotonic_time();
+				c_buffer * buffer = buffer_image;
+				if ( pupil_runs )
+					buffer = run_buffers[ ( frame->frame_id / pupil_run_length ) % nb_pupil_threads ];
+				if ( offline )
+				{
+					//Attente d'une place libre, images dans l'ordre ( priorité décroissante avec frame_id )
+					buffer->push_object( 	frame->frame_id,
+											1.0 / frame->frame_id,
+											(void*) frame );
+				}
+				else
+				{
+					buffer->add_object( 	frame->frame_id,
+											frame->score,
+											(void*) frame );
+				}
+				metrics.add( METRIC_IMAGE_PUSH_WAIT, monotonic_time() - t );
+				metrics.add( METRIC_IMAGE_DEPTH, buffer->size() );
+				
+				if ( ! offline )
+				{
+					//Cadence temps réel
+					time_2 = monotonic_time();
+					int q = 40000 - (int) ( ( time_2 - time_1 ) * 1000000 ); 
+					if ( q > 0 )
+						usleep( q );
+				}
 
 			}
+			else
+				pool_image->release( frame );
 
 		}
 
-	} while ( !(*p_end ) && image != NULL);
-	img_end = true;
+	} while ( !(*p_end ) && ! get_flag( early_stop ) && image != NULL);
+	set_flag( img_end, true );
+	//Arrêt du décodage
+	if ( frame_ring )
+		frame_ring->close();
+	//Fin du flux : réveil de la segmentation de la pupille
+	buffer_image->close();
+	if ( run_buffers )
+		for ( unsigned int i = 0; i < nb_pupil_threads; ++ i )
+			run_buffers[i]->close();
 }
 
-void c_get_iris_template_pthread :: pupil_segmentation ( )
+void c_get_iris_template_pthread :: frame_decoding ( )
 {
-
-	bool end = false;	
+	IplImage * image = NULL;
 	do
 	{
-		if ( img_end )
-			end = true;
-			
-		buffer_image->get_object (	b_data_image,
-									0 );
-		buffer_image->delete_object( b_data_image );	
-		if ( b_data_image->score() > 0 )
+		//Saut demandé par l'acquisition : les images en attente sont antérieures
+		pthread_mutex_lock( &count_mutex );
+		bool skip = skip_request && can_skip;
+		skip_request = false;
+		pthread_mutex_unlock( &count_mutex );
+		if ( skip )
+		{
+			skip_ahead();
+			frame_ring->flush();
+		}
+		
 		{
-			pupil_thread->segment_pupil( *( (image_data*) b_data_image->data() ) );
+			c_scoped_timer timer( &metrics, METRIC_DECODE );
+			image = cvQueryFrame(video);
+		}
+		//Recopie dans la file ( échec : acquisition terminée )
+		if ( image && frame_ring->push( image ) )
+			break;
+	} while ( !(*p_end ) && ! get_flag( early_stop ) && image != NULL );
+	frame_ring->close();
+}
+
+void c_get_iris_template_pthread :: pupil_segmentation ( unsigned int t_id )
+{
+	unsigned int id;
+	double score;
+	void * handle;
+	//Meilleure image en attente ( attente passive, fin à la fermeture du buffer )
+	//Hors ligne avec plusieurs threads : suites d'images consécutives de ce thread
+	c_buffer * input = pupil_runs ? run_buffers[t_id] : buffer_image;
+	double t = monotonic_time();
+	while ( input->pop_handle( id, score, handle ) == 0 )
+	{
+		metrics.add( METRIC_IMAGE_POP_WAIT, monotonic_time() - t );
+		image_data * frame = (image_data*) handle;
+		//Score de l'image ( la priorité du buffer est l'ordre des images hors ligne )
+		score = frame->score;
+		if ( score > 0 )
+		{
+			//Le tracking suppose des images dans l'ordre : il repart de zéro si
+			//l'image est antérieure à la dernière vue par ce thread ou au début
+			//d'une nouvelle suite ( hors ligne, plusieurs threads )
+			bool new_run = 	pupil_runs &&
+							frame->frame_id / pupil_run_length != last_frame_ids[t_id] / pupil_run_length;
+			if ( frame->frame_id <= last_frame_ids[t_id] || new_run )
+				pupil_threads[t_id]->reset();
+			last_frame_ids[t_id] = frame->frame_id;
+			
+			//L'image est transférée dans l'objet de sortie
+			pupil_data * p_frame = (pupil_data*) pool_pupil->acquire();
+			{
+				c_scoped_timer timer( &metrics, METRIC_PUPIL_SEGMENTATION );
+				pupil_threads[t_id]->segment_pupil( *frame, p_frame );
+			}
+			pool_image->release( frame );
 
-			if ( pupil_thread->pupil_seg_data().seg_ok )
+			if ( p_frame->seg_ok )
 			{
 
+				pthread_mutex_lock( &count_mutex );
 				nb_p_frames ++;
-				//Score
-				buffer_pupil->add_object( 	pupil_thread->pupil_seg_data()._img_data.frame_id,
-											b_data_image->score(),
-											(void*) & (pupil_thread->pupil_seg_data() ) );
-		
+				pthread_mutex_unlock( &count_mutex );
 				if ( display_on )	
 				{
 					pthread_mutex_lock ( &mutex2 );
-					pupil_display_obj->display(pupil_thread->pupil_seg_data());
+					pupil_display_obj->display( *p_frame );
 					pthread_mutex_unlock ( &mutex2 );
 				}	
 		
-											
+				//Score
+				t = monotonic_time();
+				if ( offline )
+					buffer_pupil->push_object( 	p_frame->_img_data.frame_id,
+												score,
+												(void*) p_frame );
+				else
+					buffer_pupil->add_object( 	p_frame->_img_data.frame_id,
+												score,
+												(void*) p_frame );
+				metrics.add( METRIC_PUPIL_PUSH_WAIT, monotonic_time() - t );
+				metrics.add( METRIC_PUPIL_DEPTH, buffer_pupil->size() );
 			}
+			else
+				pool_pupil->release( p_frame );
 		}
-	} while ( !end  );
-	pupil_end = true;
+		else
+			pool_image->release( frame );
+		t = monotonic_time();
+	}
+	//Le dernier thread ferme le buffer
+	pthread_mutex_lock( &count_mutex );
+	bool last = ( -- nb_pupil_running == 0 );
+	if ( last )
+		pupil_end = true;
+	pthread_mutex_unlock( &count_mutex );
+	if ( last )
+		buffer_pupil->close();
 }
 
-void c_get_iris_template_pthread :: iris_segmentation ( )
+void c_get_iris_template_pthread :: iris_segmentation ( unsigned int t_id )
 {
-	bool end = false;
-	do
+	unsigned int id;
+	double score;
+	void * handle;
+	//Meilleure pupille en attente ( attente passive, fin à la fermeture du buffer )
+	double t = monotonic_time();
+	while ( buffer_pupil->pop_handle( id, score, handle ) == 0 )
 	{
-
-		if ( pupil_end )
-			end = true;
-
-		buffer_pupil->get_object (	b_data_pupil,
-									0 );		
-		buffer_pupil->delete_object( b_data_pupil );
-		if ( b_data_pupil->score() > 0 )
+		metrics.add( METRIC_PUPIL_POP_WAIT, monotonic_time() - t );
+		pupil_data * p_frame = (pupil_data*) handle;
+		if ( score > 0 )
 		{
-	
-			iris_thread->segment_iris( *( (pupil_data*) b_data_pupil->data() ) );
+			//La pupille est transférée dans l'objet de sortie
+			iris_data * i_frame = (iris_data*) pool_iris->acquire();
+			iris_threads[t_id]->segment_iris( *p_frame, i_frame );
+			pool_pupil->release( p_frame );
 
-			if ( iris_thread->iris_seg_data().seg_ok )
+			bool added = false;
+			if ( i_frame->seg_ok )
 			{
-				
-				
-				
+				pthread_mutex_lock( &count_mutex );
 				nb_i_frames ++;
-				//Détection des chgts d'yeux ou des abérations
-				buffer_iris->get_object (	b_data_iris,
-											0 );
-				
+				pthread_mutex_unlock( &count_mutex );
 				
 				//Score
-				CvRect rect = cvRect( 	iris_thread->iris_seg_data().new_x_iris - iris_thread->iris_seg_data().new_r_iris,
-										iris_thread->iris_seg_data().new_y_iris - iris_thread->iris_seg_data().new_r_iris,
-										2 * iris_thread->iris_seg_data().new_r_iris,
-										2 * iris_thread->iris_seg_data().new_r_iris );
-				if ( ! ( 	rect.x + rect.width > iris_thread->iris_seg_data().iris_image->width 	||
-							rect.y + rect.height > iris_thread->iris_seg_data().iris_image->height 	||
-							rect.x <= 0 														   	||
+				CvRect rect = cvRect( 	i_frame->new_x_iris - i_frame->new_r_iris,
+										i_frame->new_y_iris - i_frame->new_r_iris,
+										2 * i_frame->new_r_iris,
+										2 * i_frame->new_r_iris );
+				if ( ! ( 	rect.x + rect.width > i_frame->iris_image->width 	||
+							rect.y + rect.height > i_frame->iris_image->height 	||
+							rect.x <= 0 									   	||
 							rect.y <= 0) )
 				{
-					buffer_iris->add_object( 	iris_thread->iris_seg_data().p_data._img_data.frame_id,
-												iris_thread->iris_seg_data().nrj_ratio,
-												(void*) & (iris_thread->iris_seg_data() ) );
-												
 					if ( display_on )	
 					{
 						pthread_mutex_lock ( &mutex3 );
-						//~ pupil_display_obj->display(iris_thread->iris_seg_data().p_data);
-						iris_display_obj->display(iris_thread->iris_seg_data());
+						//~ pupil_display_obj->display(i_frame->p_data);
+						iris_display_obj->display( *i_frame );
 						pthread_mutex_unlock ( &mutex3 );
-					}										
+					}
+					
+					t = monotonic_time();
+					buffer_iris->add_object( 	i_frame->p_data._img_data.frame_id,
+												i_frame->nrj_ratio,
+												(void*) i_frame );
+					metrics.add( METRIC_IRIS_PUSH_WAIT, monotonic_time() - t );
+					metrics.add( METRIC_IRIS_DEPTH, buffer_iris->size() );
+					added = true;
 				}								
 			}
+			if ( ! added )
+				pool_iris->release( i_frame );
+			if ( stop_nb_templates )
+				update_early_stop();
 		}
-		usleep(1000);
-
-	} while ( !end );
+		else
+			pool_pupil->release( p_frame );
+		t = monotonic_time();
+	}
 	
-	iris_end = true;
+	pthread_mutex_lock( &count_mutex );
+	if ( -- nb_iris_running == 0 )
+		iris_end = true;
+	pthread_mutex_unlock( &count_mutex );
+}
+
+void c_get_iris_template_pthread :: update_early_stop ( )
+{
+	//Score du K-ième meilleur template
+	double score = buffer_iris->score( stop_nb_templates - 1 );
+	pthread_mutex_lock( &count_mutex );
+	if ( score >= 0 && score >= stop_quality )
+	{
+		if ( score > best_score * ( 1 + stop_gain ) || best_score < 0 )
+		{
+			best_score = score;
+			nb_stale = 0;
+		}
+		else if ( ++ nb_stale >= stop_patience )
+			early_stop = true;
+	}
+	pthread_mutex_unlock( &count_mutex );
+}
+
+void c_get_iris_template_pthread :: skip_ahead ( )
+{
+	double pos = cvGetCaptureProperty( video, CV_CAP_PROP_POS_FRAMES ),
+		   target = pos + skip_frames;
+	double nb = cvGetCaptureProperty( video, CV_CAP_PROP_FRAME_COUNT );
+	if ( nb > 0 && target >= nb )
+		return;
+	//Format sans positionnement : plus de saut pour cette vidéo
+	if ( 	pos < 0 																||
+			! cvSetCaptureProperty( video, CV_CAP_PROP_POS_FRAMES, target ) 	||
+			cvGetCaptureProperty( video, CV_CAP_PROP_POS_FRAMES ) < target - 0.5 )
+	{
+		set_flag( can_skip, false );
+		return;
+	}
+	nb_skipped += skip_frames;
+}
+
+bool c_get_iris_template_pthread :: get_flag ( const bool & flag )
+{
+	pthread_mutex_lock( &count_mutex );
+	bool value = flag;
+	pthread_mutex_unlock( &count_mutex );
+	return value;
+}
+
+void c_get_iris_template_pthread :: set_flag ( 	bool & flag,
+												bool value )
+{
+	pthread_mutex_lock( &count_mutex );
+	flag = value;
+	pthread_mutex_unlock( &count_mutex );
 }
 
 void c_get_iris_template_pthread :: display ( )
 {
 	unsigned int 	width = image_thread->data().width,
 					height = image_thread->data().height,
-					p_height = iris_thread->iris_seg_data().nb_samples * (image_thread->data().width / ( (double) iris_thread->iris_seg_data().nb_directions ) ),
-					c_height = iris_thread->iris_seg_data().nb_samples_code * (image_thread->data().width / ( (double) iris_thread->iris_seg_data().nb_directions_code ) );
+					p_height = iris_threads[0]->iris_seg_data().nb_samples * (image_thread->data().width / ( (double) iris_threads[0]->iris_seg_data().nb_directions ) ),
+					c_height = iris_threads[0]->iris_seg_data().nb_samples_code * (image_thread->data().width / ( (double) iris_threads[0]->iris_seg_data().nb_directions_code ) );
 	
 	if ( display_on )
 	{
@@ -706,9 +1135,13 @@ int c_get_iris_template_pthread :: save ( const char * rep_name )
 			if ( b_data_iris->score() < 0 )
 				break;
 
+			c_scoped_timer timer( &metrics, METRIC_SAVE );
 			if ( ( (iris_data *) b_data_iris->data() )->save( rep_name, i ) )
 				q = 1;
 		}
+		//Vidéo traitée par le dernier run
+		if ( fps_file && video_id )
+			metrics.save( *fps_file, video_id, METRIC_SAVE );
 	}
 	return q;
 }
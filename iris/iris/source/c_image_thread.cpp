@@ -158,6 +158,20 @@ int c_image_thread :: process(	const IplImage * image,
 	return 0;
 }
 
+int c_image_thread :: process(	const IplImage * image, 
+									const char * img_name,
+									image_data * out )
+{
+	//Travail dans out
+	image_data * tmp = _data;
+	out->frame_id = tmp->frame_id;
+	_data = out;
+	int q = process( image, img_name );
+	_data = tmp;
+	_data->frame_id = out->frame_id;
+	return q;
+}
+
 c_image_thread :: ~c_image_thread()
 {
 	free();
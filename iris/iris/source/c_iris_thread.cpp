@@ -207,6 +207,18 @@ int c_iris_thread :: setup( 	char ** argv,
 	return 0;
 }
 
+int c_iris_thread :: segment_iris( 	pupil_data & p_data,
+									iris_data * out )
+{
+	//Travail dans out
+	iris_data * tmp = i_data;
+	out->p_data.swap( p_data );
+	i_data = out;
+	int q = segment_iris( out->p_data );
+	i_data = tmp;
+	return q;
+}
+
 int c_iris_thread :: segment_iris( const pupil_data & p_data )
 {
 
@@ -253,15 +265,20 @@ int c_iris_thread :: segment_iris( const pupil_data & p_data )
 		//Op. intégro diff.
 
 
-		if ( ! iris_segmentation->segment_iris( 	p_data._img_data.image,
-													p_data.smoothed_image,
-													mask_1,
-													mask_1,
-													p_data.x_pupil,
-													p_data.y_pupil,
-													p_data.a_pupil,
-													p_data.b_pupil,
-													p_data.theta_pupil ) )
+		int q_seg;
+		{
+			c_scoped_timer timer( metrics, METRIC_IRIS_SEGMENTATION );
+			q_seg = iris_segmentation->segment_iris( 	p_data._img_data.image,
+														p_data.smoothed_image,
+														mask_1,
+														mask_1,
+														p_data.x_pupil,
+														p_data.y_pupil,
+														p_data.a_pupil,
+														p_data.b_pupil,
+														p_data.theta_pupil );
+		}
+		if ( ! q_seg )
 		{
 			//Seuillage /p_threhsold et /spot_threshold
 			if ( !mask_1 || !mask_2 || ! mask_3)
@@ -322,15 +339,18 @@ int c_iris_thread :: segment_iris( const pupil_data & p_data )
 						CV_RGB(0,0,0),
 						CV_FILLED);
 	
-			eyelid_obj->compute( 	p_data.smoothed_image, 
-									mask_2, 
-									iris_segmentation->new_x(), 
-									iris_segmentation->new_y(), 
-									iris_segmentation->new_r(),
-									iris_segmentation->new_x_pupil(), 
-									iris_segmentation->new_y_pupil(), 
-									iris_segmentation->new_a_pupil(), 
-									iris_segmentation->new_b_pupil() );
+			{
+				c_scoped_timer timer( metrics, METRIC_EYELIDS );
+				eyelid_obj->compute( 	p_data.smoothed_image, 
+										mask_2, 
+										iris_segmentation->new_x(), 
+										iris_segmentation->new_y(), 
+										iris_segmentation->new_r(),
+										iris_segmentation->new_x_pupil(), 
+										iris_segmentation->new_y_pupil(), 
+										iris_segmentation->new_a_pupil(), 
+										iris_segmentation->new_b_pupil() );
+			}
 									
 			memset(	mask_2->imageData, 
 					0, 
@@ -370,33 +390,42 @@ int c_iris_thread :: segment_iris( const pupil_data & p_data )
 
 			
 			//Transformée polaire normalisée
-			if (! polar_iris->compute(	iris_segmentation->new_image(),
-										mask_1,
-										iris_segmentation->new_x_pupil(),
-										iris_segmentation->new_y_pupil(),
-										iris_segmentation->new_a_pupil(),
-										iris_segmentation->new_b_pupil(),
-										iris_segmentation->new_theta_pupil(),
-										iris_segmentation->new_x(),
-										iris_segmentation->new_y(),
-										iris_segmentation->new_r() ) )
+			int q_polar;
+			{
+				c_scoped_timer timer( metrics, METRIC_POLAR );
+				q_polar = polar_iris->compute(	iris_segmentation->new_image(),
+												mask_1,
+												iris_segmentation->new_x_pupil(),
+												iris_segmentation->new_y_pupil(),
+												iris_segmentation->new_a_pupil(),
+												iris_segmentation->new_b_pupil(),
+												iris_segmentation->new_theta_pupil(),
+												iris_segmentation->new_x(),
+												iris_segmentation->new_y(),
+												iris_segmentation->new_r() );
+			}
+			if (! q_polar )
 			{
 				{
-					image_resize ( 	(double *) tmp_p_img->imageData,
-									(unsigned char *) tmp_p_mask->imageData,
-									iris_code->nb_directions(),
-									iris_code->nb_samples(),
-									tmp_p_img->widthStep / sizeof(double),
-									tmp_p_mask->widthStep / sizeof(char),
-									(double *) polar_iris->polar_image()->imageData,
-									(unsigned char *) polar_iris->polar_mask()->imageData,
-									polar_iris->nb_directions(),
-									polar_iris->nb_samples_iris(),
-									polar_iris->polar_image()->widthStep / sizeof(double),
-									polar_iris->polar_mask()->widthStep / sizeof(char) );
-
-					if ( !iris_code->compute_iris_code( 	tmp_p_img,
-															tmp_p_mask ) )
+					int q_code;
+					{
+						c_scoped_timer timer( metrics, METRIC_IRIS_CODE );
+						image_resize ( 	(double *) tmp_p_img->imageData,
+										(unsigned char *) tmp_p_mask->imageData,
+										iris_code->nb_directions(),
+										iris_code->nb_samples(),
+										tmp_p_img->widthStep / sizeof(double),
+										tmp_p_mask->widthStep / sizeof(char),
+										(double *) polar_iris->polar_image()->imageData,
+										(unsigned char *) polar_iris->polar_mask()->imageData,
+										polar_iris->nb_directions(),
+										polar_iris->nb_samples_iris(),
+										polar_iris->polar_image()->widthStep / sizeof(double),
+										polar_iris->polar_mask()->widthStep / sizeof(char) );
+						q_code = iris_code->compute_iris_code( 	tmp_p_img,
+																tmp_p_mask );
+					}
+					if ( ! q_code )
 					{
 						if ( get_image_mean ( iris_code->mask() ) > _validness_factor * 255 )
 						{
@@ -562,6 +591,7 @@ void c_iris_thread :: free()
 
 void c_iris_thread :: initialize()
 {
+	metrics = 0;
 	tmp_p_img = 0;
 	tmp_p_mask = 0;
 	structuring_element_1 = 0;
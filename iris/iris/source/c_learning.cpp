@@ -3,6 +3,15 @@
 #include <ctime>
 #include <dirent.h>
 #include <sstream>
+#include "c_stage_metrics.hpp"
+
+void * learning_function ( void * params )
+{
+	c_learning::worker * w = (c_learning::worker *) params;
+	w->obj->process( w->id );
+	return NULL;
+}
+
 iris_class_data :: iris_class_data( 	
 	const string & name,
 	unsigned int nb_img_max )
@@ -105,6 +114,38 @@ int c_learning :: setup(
 		return 1;
 	}
 	
+	//Nombre de threads ( 1 par défaut : chaque thread a son objet de segmentation,
+	//avec ses accumulateurs et ses propres threads )
+	{
+		api_parameters params;
+		for ( int i = 2; i < argc; ++ i )
+			params.load( argv[i] );
+		stringstream oss;
+		oss << LEARNING_NAMESPACE << "::" << LEARNING_NB_THREADS;
+		if ( 	api_get_positive_integer( 	params,
+											oss.str().c_str(),
+											&_nb_threads,
+											NULL ) || _nb_threads == 0 )
+			_nb_threads = 1;
+	}
+	
+	//Un objet de segmentation par thread
+	workers = new c_get_iris_template*[_nb_threads];
+	workers[0] = &obj;
+	for ( unsigned int i = 1; i < _nb_threads; ++ i )
+		workers[i] = NULL;
+	for ( unsigned int i = 1; i < _nb_threads; ++ i )
+	{
+		workers[i] = new c_get_iris_template;
+		if ( workers[i]->setup( argv + 2, 
+								argc - 2, 
+								log ) )
+		{
+			cout << "Error: Can't setup segmentation thread " << i << " !" << endl;
+			return 1;
+		}
+	}
+	
 	
 	//Chargemnent des métadata
 	{
@@ -184,7 +225,65 @@ int c_learning :: setup(
 
 int c_learning :: segment( )
 {
-	unsigned int total = 0, nb_fails = 0;
+	if ( ! workers )
+		return 1;
+	
+	//Liste des images
+	_nb_tasks = 0;
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+		_nb_tasks += data[i]->nb_images;
+	task_class = new unsigned int[_nb_tasks];
+	task_image = new unsigned int[_nb_tasks];
+	results = new learning_result[_nb_tasks];
+	{
+		unsigned int k = 0;
+		for ( unsigned int i = 0; i < _nb_classes; ++ i )
+		{
+			stringstream oss;
+			oss << _save_rep << "/" << data[i]->name;
+			mkdir( oss.str().c_str(), 014777 );
+			for ( unsigned int j = 0; j < data[i]->nb_images; ++ j, ++ k )
+			{
+				task_class[k] = i;
+				task_image[k] = j;
+			}
+		}
+	}
+	
+	//Segmentation
+	unsigned int nb_threads = ( _nb_threads < _nb_tasks ) ? _nb_threads : _nb_tasks;
+	if ( nb_threads == 0 )
+		nb_threads = 1;
+	_next_task = 0;
+	_nb_done = 0;
+	_nb_fails = 0;
+	pthread_mutex_init( &_mutex, NULL );
+	double time_1 = monotonic_time();
+	if ( nb_threads == 1 )
+		process( 0 );
+	else
+	{
+		pthread_t * threads = new pthread_t[nb_threads];
+		worker * w = new worker[nb_threads];
+		for ( unsigned int i = 0; i < nb_threads; ++ i )
+		{
+			w[i].obj = this;
+			w[i].id = i;
+			pthread_create( threads + i,
+							NULL,
+							learning_function,
+							(void*) ( w + i ) );
+		}
+		for ( unsigned int i = 0; i < nb_threads; ++ i )
+			pthread_join( threads[i], NULL );
+		delete[] threads;
+		delete[] w;
+	}
+	double time_2 = monotonic_time();
+	pthread_mutex_destroy( &_mutex );
+	cout << endl << " time: " << time_2 - time_1 << " s ( " << nb_threads << " threads )" << endl;
+	
+	//Ecriture des résultats dans l'ordre des classes et des images
 	stringstream oss;
 	oss << _save_rep << "/" << "seg.txt";
 	ofstream seg_data(oss.str().c_str());
@@ -194,164 +293,108 @@ int c_learning :: segment( )
 	ofstream time_file(oss.str().c_str());
 	oss.str("");
 	
-	
-	
-	//Segmentation par classes
+	unsigned int k = 0;
 	for ( unsigned int i = 0; i < _nb_classes; ++ i )
 	{
 		unsigned int success = 0;
-		oss << _save_rep << "/" << data[i]->name;
-			mkdir( oss.str().c_str(), 014777 );
-		oss.str("");
 		oss << _save_rep << "/" << data[i]->name << "/" << "log.txt";
-			ofstream log_class( oss.str().c_str() );
-		
+		ofstream log_class( oss.str().c_str() );
 		oss.str("");
 		
-
-
 		seg_data << "#" << data[i]->name << endl;
 		seg_data << data[i]->name << "::nb_images = " << data[i]->nb_images << endl;
-	
-
-		obj.set_error_stream( log_class );
-
-		oss << _save_rep << "/" << data[i]->name;
-
-		for ( unsigned int j = 0; j < data[i]->nb_images; ++ j )
+		
+		for ( unsigned int j = 0; j < data[i]->nb_images; ++ j, ++ k )
 		{
-			
-			
-			
-			
+			const learning_result & r = results[k];
 			log_class << ((*data[i])[j])->c_str() << "\t";
-			clock_t time_1 = clock();
-			IplImage * image = 
-				cvLoadImage( ((*data[i])[j])->c_str(), 0 );
-			if ( image ) 
+			if ( r.status == LEARNING_OPEN_FAILED )
+				log_class << "OPEN_FAILED" << "\t";
+			else
 			{
-
-				log_class << "OPEN_OK" << "\t";
-				if ( ! obj.segment( image, 
-									((*data[i])[j])->c_str() ) )
+				log_class << "OPEN_OK" << "\t" << r.errors;
+				if ( r.status == LEARNING_SEG_OK )
 				{
-					log_class << "SEG_OK" << "\t";		
+					log_class << "SEG_OK" << "\t";
 					success ++;
 				}
 				else
-				{
-					nb_fails ++;
-					log_class << "SEG_FAILED" << "\t";	
-				}
-				obj.data().save( oss.str().c_str(), j );	
-				
-				clock_t time_2 = clock();	
-				
-				time_file << "times(" << total + j + 1 << ") = " << (time_2 - time_1) / ( (double) CLOCKS_PER_SEC ) << ";" << endl;
-				
-				cvReleaseImage( &image );
-			}
-			else
-			{
-				log_class << "OPEN_FAILED" << "\t";				
-				
+					log_class << "SEG_FAILED" << "\t";
+				time_file << "times(" << k + 1 << ") = " << r.time << ";" << endl;
 			}
 			log_class << endl;
-		
-			system("clear");
-			cout << " ( " << i + 1 << " / " << _nb_classes << " ) " << endl;
-			total ++;
-			if ( total > 0 )
-			{
-				double f = ( (10000 * nb_fails) / total ) / 100.0;
-				cout << " fails: " << f << "%" << endl;
-				if ( f < 2.5 )
-				{
-					cout <<
-	"                    __ooooooooo__" << endl <<
-	"                 oOOOOOOOOOOOOOOOOOOOOOo" << endl <<
-	"             oOOOOOOOOOOOOOOOOOOOOOOOOOOOOOo" << endl <<
-	"          oOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOo" << endl <<
-	"        oOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOo" << endl <<
-	"      oOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOo" << endl <<
-	"     oOOOOOOOOOOO*  *OOOOOOOOOOOOOO*  *OOOOOOOOOOOOo" << endl <<
-	"    oOOOOOOOOOOO      OOOOOOOOOOOO      OOOOOOOOOOOOo" << endl <<
-	"    oOOOOOOOOOOOOo  oOOOOOOOOOOOOOOo  oOOOOOOOOOOOOOo" << endl <<
-	"   oOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOo" << endl <<
-	"   oOOOO     OOOOOOOOOOOOOOOOOOOOOOOOOOOOOOO     OOOOo" << endl <<
-	"   oOOOOOO OOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOO OOOOOOo" << endl <<
-	"    *OOOOO  OOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOOO  OOOOO*" << endl <<
-	"    *OOOOOO  *OOOOOOOOOOOOOOOOOOOOOOOOOOOOO*  OOOOOO*" << endl <<
-	"     *OOOOOO  *OOOOOOOOOOOOOOOOOOOOOOOOOOO*  OOOOOO*" << endl <<
-	"      *OOOOOOo  *OOOOOOOOOOOOOOOOOOOOOOO*  oOOOOOO*" << endl <<
-	"       *OOOOOOOo  *OOOOOOOOOOOOOOOOO*  oOOOOOOO*" << endl <<
-	"         *OOOOOOOOo  *OOOOOOOOOOO*  oOOOOOOOO*   " << endl <<
-	"             *OOOOOOOOo           oOOOOOOOO*   " << endl <<
-	"                 *OOOOOOOOOOOOOOOOOOOOO* " << endl <<
-	"                      \"\"ooooooooo\"" << endl;
-				}
-				else if ( f < 5 )
-				{
-					
-					cout <<		
-	"                    @@@" << endl <<
-	"                             @@@" << endl <<
-	"                              @@@" << endl <<
-	"                              @@@" << endl <<
-	"                      @@@@@@@@@@@@@@@@@@@@@@" << endl <<
-	"                    @@@@@@@@@@@@@@@@@@@@@@@@@@" << endl <<
-	"                  @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@" << endl <<
-	"                @@@@@@@@ @@@@@@@@@@@@@@@@ @@@@@@@@" << endl <<
-	"              @@@@@@@@@   @@@@@@@@@@@@@@   @@@@@@@@@" << endl <<
-	"            @@@@@@@@@@     @@@@@@@@@@@@     @@@@@@@@@@" << endl <<
-	"           @@@@@@@@@@       @@@@  @@@@       @@@@@@@@@@" << endl <<
-	"           @@@@@@@@@@@@@@@@@@@@    @@@@@@@@@@@@@@@@@@@@" << endl <<
-	"           @@@@@@@@@@@@@@@@@@        @@@@@@@@@@@@@@@@@@" << endl <<
-	"           @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@" << endl <<
-	"           @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@" << endl <<
-	"           @@@@@@@@@ @@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@" << endl <<
-	"            @@@@@@@@  @@ @@ @@ @@ @@ @@ @@ @  @@@@@@@@" << endl <<
-	"              @@@@@@@                        @@@@@@@" << endl <<
-	"                @@@@@@  @@ @@ @@ @@ @@ @@ @ @@@@@@" << endl <<
-	"                  @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@" << endl <<
-	"                    @@@@@@@@@@@@@@@@@@@@@@@@@@" << endl <<
-	"                      @@@@@@@@@@@@@@@@@@@@@@" << endl;
-					
-				}
-				else
-				{
-	cout << 
-	"             ____"<< endl <<
-	"      _,-ddd888888bbb-._"<< endl <<
-	"    d88888888888888888888b"<< endl <<
-	"  d888888888888888888888888b"<< endl <<
-	" 6888888888888888888888888889"<< endl <<
-	" 68888b8""8q8888888p8""8d88889"<< endl <<
-	" `d8887     p88888q     4888b\'"<< endl <<
-	"  `d8887    p88888q    4888b\'"<< endl <<
-	"    `d887   p88888q   488b\'"<< endl <<
-	"      `d8bod8888888dob8b\'"<< endl <<
-	"        `d88888888888d\'"<< endl <<
-	"          `d8888888b\' hjw"<< endl <<
-	"            `d8888b\' `97"<< endl <<
-	"              `bd\'"<< endl;
-				}
-		
-			}
 		}
 		log_class.close();
-		oss.str("");
 		seg_data << data[i]->name << "::nb_success = " << success << endl;
 	}
 	seg_data << "#Global" << endl;
-	seg_data << "nb_images = " << total << endl;
-	seg_data << "nb_fails = " << nb_fails << endl;
-	seg_data << "nb_success = " << total - nb_fails << endl;
+	seg_data << "nb_images = " << _nb_tasks << endl;
+	seg_data << "nb_fails = " << _nb_fails << endl;
+	seg_data << "nb_success = " << _nb_tasks - _nb_fails << endl;
+	time_file << "total_time = " << time_2 - time_1 << ";" << endl;
+	time_file << "nb_threads = " << nb_threads << ";" << endl;
 	time_file.close();
 	seg_data.close();
+	
+	delete[] task_class;
+	delete[] task_image;
+	delete[] results;
+	task_class = NULL;
+	task_image = NULL;
+	results = NULL;
 	return 0;
 }
 
+void c_learning :: process( unsigned int id )
+{
+	c_get_iris_template * w = workers[id];
+	while ( true )
+	{
+		//Image suivante
+		pthread_mutex_lock( &_mutex );
+		if ( _next_task >= _nb_tasks )
+		{
+			pthread_mutex_unlock( &_mutex );
+			break;
+		}
+		unsigned int k = _next_task ++;
+		pthread_mutex_unlock( &_mutex );
+		
+		const iris_class_data & c = *data[ task_class[k] ];
+		const char * path = c[ task_image[k] ]->c_str();
+		learning_result & r = results[k];
+		
+		//Les erreurs sont gardées pour le log de la classe
+		stringstream errors;
+		w->set_error_stream( errors );
+		
+		double time_1 = monotonic_time();
+		IplImage * image = cvLoadImage( path, 0 );
+		if ( image ) 
+		{
+			r.status = ( w->segment( image, path ) ) ? LEARNING_SEG_FAILED : LEARNING_SEG_OK;
+			stringstream oss;
+			oss << _save_rep << "/" << c.name;
+			w->data().save( oss.str().c_str(), task_image[k] );
+			cvReleaseImage( &image );
+		}
+		else
+			r.status = LEARNING_OPEN_FAILED;
+		r.time = monotonic_time() - time_1;
+		w->set_error_stream( log ? *log : cout );
+		r.errors = errors.str();
+		
+		//Progression
+		pthread_mutex_lock( &_mutex );
+		_nb_done ++;
+		if ( r.status == LEARNING_SEG_FAILED )
+			_nb_fails ++;
+		double f = ( (10000 * _nb_fails) / _nb_done ) / 100.0;
+		cout << "\r ( " << _nb_done << " / " << _nb_tasks << " ) fails: " << f << "%   " << flush;
+		pthread_mutex_unlock( &_mutex );
+	}
+}
+
 c_learning :: ~c_learning()
 {
 	free();
@@ -369,6 +412,14 @@ void c_learning :: free()
 		delete[] data;
 	}
 	
+	if ( workers )
+	{
+		for ( unsigned int i = 1; i < _nb_threads; ++ i )
+			if ( workers[i] )
+				delete workers[i];
+		delete[] workers;
+	}
+	
 	if ( log )
 	{
 		log->close();
@@ -383,6 +434,15 @@ void c_learning :: initialize()
 	_nb_classes = 0;
 	_nb_classes_max = 0;
 	_nb_img_max = 0;
+	_nb_threads = 0;
+	workers = 0;
+	_nb_tasks = 0;
+	_next_task = 0;
+	_nb_done = 0;
+	_nb_fails = 0;
+	task_class = 0;
+	task_image = 0;
+	results = 0;
 	
 }
 
@@ -0,0 +1,286 @@
+#include "c_lsh_index.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+//Fraction des positions les plus souvent stables où sont tirées les clés ( 1 / n )
+#define LSH_INDEX_STABLE_FRACTION 4
+
+//Bit ( ligne, colonne ) d'un plan binaire ( 64 colonnes par mot, bit de poids fort en premier )
+static inline unsigned long long get_bit( 	const unsigned long long * data,
+											unsigned int width_step,
+											unsigned int row,
+											unsigned int col )
+{
+	return ( data[ row * width_step + ( col >> 6 ) ] >> ( 63 - ( col & 63 ) ) ) & 1ULL;
+}
+
+//Tri des candidats par votes décroissants
+struct lsh_vote
+{
+	unsigned int id;
+	unsigned int votes;
+	bool operator < ( const lsh_vote & v ) const
+	{
+		if ( votes != v.votes )
+			return ( votes > v.votes );
+		return ( id < v.id );
+	}
+};
+
+c_lsh_index :: c_lsh_index( void )
+{
+	initialize();
+}
+
+c_lsh_index :: c_lsh_index( 	const c_database & database,
+								unsigned int nb_tables,
+								unsigned int nb_bits,
+								double d_theta,
+								unsigned int theta_step,
+								unsigned int seed,
+								ostream * stream )
+{
+	initialize();
+	setup( 	database,
+			nb_tables,
+			nb_bits,
+			d_theta,
+			theta_step,
+			seed,
+			stream );
+}
+
+int c_lsh_index :: setup( 	const c_database & database,
+							unsigned int nb_tables,
+							unsigned int nb_bits,
+							double d_theta,
+							unsigned int theta_step,
+							unsigned int seed,
+							ostream * stream )
+{
+	free();
+	err_stream = stream;
+	if ( 	nb_tables == 0 	||
+			nb_bits == 0 	||
+			nb_bits > 64 	||
+			theta_step == 0 )
+	{
+		if ( err_stream )
+			*err_stream << "Error: invalid LSH index parameters!" << endl;
+		return 1;
+	}
+
+	//Dimensions ( premier iris code de la base )
+	for ( unsigned int i = 0; i < database.nb_classes(); ++ i )
+	{
+		if ( database.iris_code_bis( i ) )
+		{
+			_width = database.iris_code( i )->width;
+			_height = database.iris_code( i )->height;
+			break;
+		}
+	}
+	if ( _width == 0 || _height == 0 )
+	{
+		if ( err_stream )
+			*err_stream << "Error: no binary iris code in the database!" << endl;
+		return 1;
+	}
+	_width_step = ( _width + 63 ) / 64;
+	_nb_tables = nb_tables;
+	_nb_bits = nb_bits;
+	_theta_step = theta_step;
+	_theta_min = - (d_theta * _width) / 2;
+	_theta_max = + (d_theta * _width) / 2;
+	if ( _theta_max <= _theta_min )
+		_theta_max = _theta_min + 1;
+
+	//Positions classées par nombre d'iris codes où le bit est stable
+	unsigned int nb_positions = _width * _height;
+	lsh_vote * positions = new lsh_vote[ nb_positions ];
+	for ( unsigned int k = 0; k < nb_positions; ++ k )
+	{
+		positions[k].id = k;
+		positions[k].votes = 0;
+	}
+	for ( unsigned int i = 0; i < database.nb_classes(); ++ i )
+	{
+		if ( 	! database.iris_code_bis( i ) 								||
+				(unsigned int) database.iris_code( i )->width != _width 	||
+				(unsigned int) database.iris_code( i )->height != _height 	)
+			continue;
+		for ( unsigned int k = 0; k < nb_positions; ++ k )
+			positions[k].votes += get_bit( database.fragile_bits( i ), _width_step, k / _width, k % _width );
+	}
+	sort( positions, positions + nb_positions );
+	
+	//Tirage des positions parmi les plus stables
+	unsigned int nb_stable = nb_positions / LSH_INDEX_STABLE_FRACTION;
+	if ( nb_stable < _nb_bits )
+		nb_stable = nb_positions;
+	_rows = new unsigned int[ _nb_tables * _nb_bits ];
+	_cols = new unsigned int[ _nb_tables * _nb_bits ];
+	for ( unsigned int k = 0; k < _nb_tables * _nb_bits; ++ k )
+	{
+		unsigned int n = positions[ rand_r( &seed ) % nb_stable ].id;
+		_rows[k] = n / _width;
+		_cols[k] = n % _width;
+	}
+	delete[] positions;
+
+	//Tables
+	_nb_classes = database.nb_classes();
+	_votes = new unsigned int[ _nb_classes ];
+	_voted = new unsigned int[ _nb_classes ];
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+		_votes[i] = 0;
+	_tables = new lsh_entry*[ _nb_tables ];
+	_table_sizes = new unsigned int[ _nb_tables ];
+	for ( unsigned int t = 0; t < _nb_tables; ++ t )
+	{
+		_tables[t] = new lsh_entry[ _nb_classes ];
+		_table_sizes[t] = 0;
+		for ( unsigned int i = 0; i < _nb_classes; ++ i )
+		{
+			if ( 	! database.iris_code_bis( i ) 								||
+					(unsigned int) database.iris_code( i )->width != _width 	||
+					(unsigned int) database.iris_code( i )->height != _height 	)
+				continue;
+			unsigned long long key;
+			if ( get_key( 	key,
+							t,
+							database.iris_code_bis( i ),
+							database.fragile_bits( i ),
+							0 ) )
+				continue;
+			_tables[t][ _table_sizes[t] ].key = key;
+			_tables[t][ _table_sizes[t] ].id = i;
+			++ _table_sizes[t];
+		}
+		sort( _tables[t], _tables[t] + _table_sizes[t] );
+	}
+	return 0;
+}
+
+int c_lsh_index :: get_key( 	unsigned long long & key,
+								unsigned int t,
+								const unsigned long long * iris_code_bis,
+								const unsigned long long * fragile_bits,
+								int theta ) const
+{
+	const unsigned int 	* rows = _rows + t * _nb_bits,
+						* cols = _cols + t * _nb_bits;
+	//Colonne comparée à la colonne c de la base : c - theta ( modulo width )
+	int shift = - theta % (int) _width;
+	if ( shift < 0 )
+		shift += _width;
+	key = 0;
+	for ( unsigned int k = 0; k < _nb_bits; ++ k )
+	{
+		unsigned int col = cols[k] + shift;
+		if ( col >= _width )
+			col -= _width;
+		if ( ! get_bit( fragile_bits, _width_step, rows[k], col ) )
+			return 1;
+		key = ( key << 1 ) | get_bit( iris_code_bis, _width_step, rows[k], col );
+	}
+	return 0;
+}
+
+unsigned int c_lsh_index :: query( 	unsigned int * candidates,
+									unsigned int nb_candidates,
+									const unsigned long long * iris_code_bis,
+									const unsigned long long * fragile_bits )
+{
+	if ( ! _tables || ! iris_code_bis || ! fragile_bits || nb_candidates == 0 )
+		return 0;
+
+	//Votes de chaque décalage et de chaque table
+	unsigned int nb_voted = 0;
+	for ( int theta = _theta_min; theta < _theta_max; theta += _theta_step )
+	{
+		for ( unsigned int t = 0; t < _nb_tables; ++ t )
+		{
+			lsh_entry e;
+			if ( get_key( e.key, t, iris_code_bis, fragile_bits, theta ) )
+				continue;
+			e.id = 0;
+			const lsh_entry * it = lower_bound( _tables[t], _tables[t] + _table_sizes[t], e );
+			for ( ; it != _tables[t] + _table_sizes[t] && it->key == e.key; ++ it )
+			{
+				if ( _votes[ it->id ] == 0 )
+					_voted[ nb_voted ++ ] = it->id;
+				++ _votes[ it->id ];
+			}
+		}
+	}
+
+	//Meilleurs candidats
+	lsh_vote * tmp = new lsh_vote[ nb_voted ];
+	for ( unsigned int j = 0; j < nb_voted; ++ j )
+	{
+		tmp[j].id = _voted[j];
+		tmp[j].votes = _votes[ _voted[j] ];
+		_votes[ _voted[j] ] = 0;
+	}
+	unsigned int n = ( nb_voted < nb_candidates ) ? nb_voted : nb_candidates;
+	partial_sort( tmp, tmp + n, tmp + nb_voted );
+	for ( unsigned int j = 0; j < n; ++ j )
+		candidates[j] = tmp[j].id;
+	delete[] tmp;
+	return n;
+}
+
+unsigned long long c_lsh_index :: nb_entries() const
+{
+	unsigned long long n = 0;
+	for ( unsigned int t = 0; t < _nb_tables; ++ t )
+		n += _table_sizes[t];
+	return n;
+}
+
+c_lsh_index :: ~c_lsh_index()
+{
+	free();
+}
+
+void c_lsh_index :: initialize()
+{
+	_nb_tables = 0;
+	_nb_bits = 0;
+	_theta_step = 1;
+	_theta_min = 0;
+	_theta_max = 0;
+	_width = 0;
+	_height = 0;
+	_width_step = 0;
+	_rows = NULL;
+	_cols = NULL;
+	_tables = NULL;
+	_table_sizes = NULL;
+	_nb_classes = 0;
+	_votes = NULL;
+	_voted = NULL;
+	err_stream = NULL;
+}
+
+void c_lsh_index :: free()
+{
+	if ( _rows )
+		delete[] _rows;
+	if ( _cols )
+		delete[] _cols;
+	if ( _tables )
+	{
+		for ( unsigned int t = 0; t < _nb_tables; ++ t )
+			delete[] _tables[t];
+		delete[] _tables;
+	}
+	if ( _table_sizes )
+		delete[] _table_sizes;
+	if ( _votes )
+		delete[] _votes;
+	if ( _voted )
+		delete[] _voted;
+	initialize();
+}
@@ -1,4 +1,5 @@
 #include "c_matching.hpp"
+#include <queue>
 
 c_matching :: c_matching ( void ) 
 : c_database( )
@@ -49,21 +50,35 @@ int c_matching :: setup ( 	const char * rep_name,
 	{
 		dist_params = (void*) new distance::Hamming_parameters;
 		dist_bis = distance :: Hamming_opt<unsigned long long>;
+		dist_aligned = distance :: Hamming_aligned<unsigned long long>;
+		dist_bounded = distance :: Hamming_bounded<unsigned long long>;
 	}
 	else if ( c_matching :: dist ==  (distance::function_prototype_bis) distance :: fragile_bit_distance )
 	{
 		dist_params = (void*) new distance::Hamming_parameters;
 		dist_bis = distance :: fragile_bit_distance_opt<unsigned long long>;
+		dist_aligned = distance :: fragile_bit_distance_aligned<unsigned long long>;
+		dist_bounded = distance :: fragile_bit_distance_bounded<unsigned long long>;
 	}
 	else if ( c_matching :: dist == (distance::function_prototype_bis) distance :: Hamming_FBD )
 	{
 		dist_params = (void*) new distance::Hamming_FBD_parameters;
 		dist_bis = distance :: Hamming_FBD_opt<unsigned long long>;
+		dist_aligned = distance :: Hamming_FBD_aligned<unsigned long long>;
+		dist_bounded = distance :: Hamming_FBD_bounded<unsigned long long>;
 	}
 	else if ( c_matching :: dist == (distance::function_prototype_bis) distance :: Hamming_expectation )
 	{
 		dist_params = NULL;
 		dist_bis = NULL;
+		dist_aligned = NULL;
+		dist_bounded = NULL;
+		if ( compute_fuzzy_codes() )
+		{
+			if ( err_stream )
+				*err_stream << "Error: Unable to quantize the fuzzy iris codes!" << endl;
+			return 1;
+		}
 	}
 	else
 	{
@@ -72,7 +87,7 @@ int c_matching :: setup ( 	const char * rep_name,
 		return 1;
 	}
 	c_matching :: d_theta = d_theta;
-	return 0;
+	return set_nb_threads( 1 );
 }
 	
 int c_matching :: setup ( 	const char * rep_name, 
@@ -82,7 +97,9 @@ int c_matching :: setup ( 	const char * rep_name,
 							ostream * stream,
 							const char * n_space,
 							const char * distance_name,
-							const char * d_theta_name )	
+							const char * d_theta_name,
+							const char * rotation_bank_name,
+							const char * nb_threads_name )	
 {
 	c_matching :: free();
 	c_matching :: initialize();
@@ -125,15 +142,113 @@ int c_matching :: setup ( 	const char * rep_name,
 						 stream ) )
 		q = 1;
 	oss.str("");
+	
+	//Banque de rotations ( optionnelle )
+	unsigned int nb_rotations = 0;
+	oss << n_space << "::" << rotation_bank_name;
+	if ( api_get_positive_integer( 	params, 
+									oss.str().c_str(), 
+									&nb_rotations,
+									NULL ) )
+		nb_rotations = 0;
+	oss.str("");
+	
+	//Nombre de threads ( optionnel )
+	unsigned int nb_threads = 1;
+	oss << n_space << "::" << nb_threads_name;
+	if ( 	api_get_positive_integer( 	params, 
+										oss.str().c_str(), 
+										&nb_threads,
+										NULL ) 			||
+			nb_threads == 0 							)
+		nb_threads = 1;
+	oss.str("");
 	if ( q )
 		return 1;
 
-	return setup( 	rep_name, 
-					iris_code_file,
-					fragility_map_file,
-					_dist,
-					d_theta,
-					stream  );
+	if ( setup( rep_name, 
+				iris_code_file,
+				fragility_map_file,
+				_dist,
+				d_theta,
+				stream  ) )
+		return 1;
+	if ( set_nb_threads( nb_threads ) )
+		return 1;
+	return set_rotation_bank( nb_rotations );
+}
+
+int c_matching :: set_rotation_bank( unsigned int nb_rotations )
+{
+	if ( ! dist_aligned && nb_rotations )
+		return 1;
+	return c_database :: set_rotation_bank( d_theta, nb_rotations );
+}
+
+int c_matching :: registering_bank ( 	double & d,
+										int & theta,
+										unsigned int id,
+										const unsigned long long * code_data,
+										const unsigned long long * mask_data,
+										const unsigned long long * fb_data,
+										int theta_min,
+										int theta_max,
+										const void * params,
+										unsigned long long * _code_2_data,
+										unsigned long long * _mask_2_data,
+										unsigned long long * _fb_2_data )
+{
+	unsigned int 	width = _iris_codes[id]->width,
+					height = _iris_codes[id]->height;
+	d = 2;
+	theta = theta_min;
+	for( int i = theta_min; i < theta_max; ++ i )
+	{
+		const unsigned long long 	* code,
+									* mask,
+									* fb;
+		//Rotation absente de la banque
+		if ( rotated_template( id, i, code, mask, fb ) )
+		{
+			distance::rotate(	_code_2_data,
+								_mask_2_data,
+								_fb_2_data,
+								(const unsigned long long *) _iris_codes_bis[id],
+								(const unsigned long long *) _masks[id],
+								(const unsigned long long *) _fragile_bits[id],
+								width,
+								height,
+								width_step,
+								- i );
+			code = _code_2_data;
+			mask = _mask_2_data;
+			fb = _fb_2_data;
+		}
+		
+		double v = 2;
+		if (	dist_aligned(	v,
+								code,
+								mask,
+								fb,
+								code_data,
+								mask_data,
+								fb_data,
+								width,
+								height,
+								width_step,
+								params ) == 0 )
+		{		
+			if ( v < d )
+			{
+				theta = i;
+				d = v;
+			}
+		}
+	}
+
+	if ( d == 2 )
+		return 1;
+	return 0;
 }
 
 
@@ -258,64 +373,796 @@ unsigned int c_matching :: matching_opt (	double * distances,
 		p = ( (distance::Hamming_FBD_parameters* ) dist_params)->alpha;
 	}
 	
-	//Calcul des distances
+	//Requête
+	d_matching * tmp = new d_matching[_nb_classes];
+	_q_distances = distances;
+	_q_results = tmp;
+	_q_iris_code = iris_code_bis;
+	_q_mask = mask;
+	_q_fragile_bits = fragile_bits;
+	_q_p = p;
 	
-	unsigned long long * _code_2_data = new unsigned long long[width_step * 40];
-	unsigned long long * _mask_2_data = new unsigned long long[width_step * 40];
-	unsigned long long * _fb_2_data = new unsigned long long[width_step * 40];
-			
+	//Calcul et tri des distances de chaque part
+	run_pool( MATCHING_TASK_QUERY );
+	if ( _nb_threads > 1 )
+	{
+		//Fusion des parts triées
+		for ( unsigned int k = 1; k < _nb_threads; ++ k )
+			inplace_merge( 	tmp,
+							tmp + ( (unsigned long long) _nb_classes * k ) / _nb_threads,
+							tmp + ( (unsigned long long) _nb_classes * ( k + 1 ) ) / _nb_threads );
+	}
 	
-	for ( unsigned int i = 0; i < _nb_classes; ++ i)
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
 	{
-		if (  iris_code_bis &&  _iris_codes_bis[i] )
-		{
+		orders[i] = tmp[i].id;
+	}	
+
+	delete[] tmp;
+	return orders[0];
+}
 
+unsigned int c_matching :: matching_opt (	double * distances,
+											unsigned int * orders,
+											unsigned int & truth,
+											const short * fuzzy_code,
+											const char * class_name,
+											const char * video_name)
+{
+	//Vérité
+	truth = _nb_classes;
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+	{
+		if ( _class_names[i] == class_name )
+		{	
+			truth = i;
+			break;
+		}
+	}
+	
+	//Requête
+	d_matching * tmp = new d_matching[_nb_classes];
+	_q_distances = distances;
+	_q_results = tmp;
+	_q_fuzzy_code = fuzzy_code;
+	
+	//Calcul et tri des distances de chaque part
+	run_pool( MATCHING_TASK_QUERY );
+	if ( _nb_threads > 1 )
+	{
+		//Fusion des parts triées
+		for ( unsigned int k = 1; k < _nb_threads; ++ k )
+			inplace_merge( 	tmp,
+							tmp + ( (unsigned long long) _nb_classes * k ) / _nb_threads,
+							tmp + ( (unsigned long long) _nb_classes * ( k + 1 ) ) / _nb_threads );
+	}
+	
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+	{
+		orders[i] = tmp[i].id;
+	}	
+
+	delete[] tmp;
+	_q_fuzzy_code = NULL;
+	return orders[0];
+}
+
+unsigned int c_matching :: matching_top_k (	double * distances,
+												unsigned int * ids,
+												unsigned int k,
+												const unsigned long long * iris_code_bis,
+												const unsigned long long * mask,
+												const unsigned long long * fragile_bits )
+{
+	_nb_top_k_comparisons = 0;
+	_nb_top_k_aborted = 0;
+	if ( ! dist_bounded || ! iris_code_bis || k == 0 || ! _scratch )
+		return 0;
+	
+	double p = 0;
+	if ( 	dist == (distance::function_prototype_bis) distance :: Hamming_FBD 	)
+	{
+		p = ( (distance::Hamming_FBD_parameters* ) dist_params)->alpha;
+	}
+	
+	unsigned long long 	* _code_2_data = _scratch[0],
+						* _mask_2_data = _scratch[0] + _scratch_size,
+						* _fb_2_data = _scratch[0] + 2 * _scratch_size;
+	unsigned int 	* probe_row_counts = NULL,
+					probe_height = 0;
+	
+	//Tas des k meilleurs ( le pire en tête )
+	priority_queue<d_matching> best;
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+	{
+		if ( ! _iris_codes_bis[i] || ! _row_counts[i] )
+			continue;
+		unsigned int 	width = _iris_codes[i]->width,
+						height = _iris_codes[i]->height;
+		int theta_min = - (d_theta * width) / 2,
+			theta_max = + (d_theta * width) / 2;
+		
+		//Bits restants ligne par ligne de l'iris code comparé
+		if ( height != probe_height )
+		{
+			if ( probe_row_counts )
+				delete[] probe_row_counts;
+			probe_row_counts = new unsigned int[ 2 * ( height + 1 ) ];
+			distance::compute_row_counts( probe_row_counts, mask, fragile_bits, width_step, height );
+			probe_height = height;
+		}
+		
+		//Recadrage avec abandon au-delà de la k-ième distance
+		double 	bound = ( best.size() == k ) ? best.top().dist : 2,
+				d = 2;
+		for ( int theta = theta_min; theta < theta_max; ++ theta )
+		{
+			double v = 2;
+			const unsigned long long 	* code,
+										* m,
+										* fb;
+			int q;
+			bool aligned = ( rotated_template( i, theta, code, m, fb ) == 0 );
 			
-			//Recadrage
-			int theta;
-			distance::registering_64b(	distances[i],
-										theta,
-										_iris_codes_bis[i],
-										_masks[i],
-										_fragile_bits[i],
-										iris_code_bis,
-										mask,
-										fragile_bits,
-										_iris_codes[i]->width,
-										_iris_codes[i]->height,
-										width_step,
-										- (d_theta * _iris_codes[i]->width) / 2,
-										+ (d_theta * _iris_codes[i]->width) / 2,
-										dist_bis,
-										(const void*) &p,
-										_code_2_data,
-										_mask_2_data,
-										_fb_2_data
-								 );	
+			//Rotation absente de la banque ( cf. registering_bank )
+			if ( ! aligned && nb_bank_rotations() )
+			{
+				distance::rotate(	_code_2_data,
+									_mask_2_data,
+									_fb_2_data,
+									(const unsigned long long *) _iris_codes_bis[i],
+									(const unsigned long long *) _masks[i],
+									(const unsigned long long *) _fragile_bits[i],
+									width,
+									height,
+									width_step,
+									- theta );
+				code = _code_2_data;
+				m = _mask_2_data;
+				fb = _fb_2_data;
+				aligned = true;
+			}
+			if ( aligned )
+				q = dist_bounded(	v,
+									code,
+									m,
+									fb,
+									iris_code_bis,
+									mask,
+									fragile_bits,
+									width,
+									height,
+									width_step,
+									0,
+									(const void*) &p,
+									min( d, bound ),
+									_row_counts[i],
+									probe_row_counts,
+									NULL,
+									NULL,
+									NULL );
+			else
+				q = dist_bounded(	v,
+									_iris_codes_bis[i],
+									_masks[i],
+									_fragile_bits[i],
+									iris_code_bis,
+									mask,
+									fragile_bits,
+									width,
+									height,
+									width_step,
+									theta,
+									(const void*) &p,
+									min( d, bound ),
+									_row_counts[i],
+									probe_row_counts,
+									_code_2_data,
+									_mask_2_data,
+									_fb_2_data );
+			++ _nb_top_k_comparisons;
+			if ( q == 2 )
+				++ _nb_top_k_aborted;
+			if ( q == 0 && v < d )
+				d = v;
 		}
+		if ( d == 2 )
+			continue;
+		
+		d_matching tmp;
+		tmp.id = i;
+		tmp.dist = d;
+		if ( best.size() < k )
+			best.push( tmp );
+		else if ( d < best.top().dist )
+		{
+			best.pop();
+			best.push( tmp );
+		}
+	}
+	if ( probe_row_counts )
+		delete[] probe_row_counts;
+	
+	//Résultats par distances croissantes
+	unsigned int n = best.size();
+	for ( unsigned int j = n; j-- > 0; )
+	{
+		distances[j] = best.top().dist;
+		ids[j] = best.top().id;
+		best.pop();
+	}
+	return n;
+}
+
+unsigned int c_matching :: matching_candidates (	double * distances,
+													unsigned int * ids,
+													const unsigned int * candidates,
+													unsigned int nb_candidates,
+													const unsigned long long * iris_code_bis,
+													const unsigned long long * mask,
+													const unsigned long long * fragile_bits )
+{
+	if ( ! dist_bis || ! iris_code_bis || ! _scratch )
+		return 0;
+	
+	double p = 0;
+	if ( 	dist == (distance::function_prototype_bis) distance :: Hamming_FBD 	)
+	{
+		p = ( (distance::Hamming_FBD_parameters* ) dist_params)->alpha;
+	}
+	
+	//Vérification exacte des candidats
+	d_matching * tmp = new d_matching[nb_candidates];
+	unsigned int n = 0;
+	for ( unsigned int j = 0; j < nb_candidates; ++ j )
+	{
+		unsigned int i = candidates[j];
+		if ( i >= _nb_classes || ! _iris_codes_bis[i] )
+			continue;
+		register_template(	tmp[n].dist,
+							i,
+							iris_code_bis,
+							mask,
+							fragile_bits,
+							p,
+							0 );
+		tmp[n].id = i;
+		++ n;
+	}
+	sort( tmp, tmp + n );
+	
+	for ( unsigned int j = 0; j < n; ++ j )
+	{
+		distances[j] = tmp[j].dist;
+		ids[j] = tmp[j].id;
+	}
+	delete[] tmp;
+	return n;
+}
+
+void c_matching :: register_template(	double & d,
+										unsigned int i,
+										const unsigned long long * iris_code_bis,
+										const unsigned long long * mask,
+										const unsigned long long * fragile_bits,
+										double p,
+										unsigned int scratch_id )
+{
+	unsigned long long 	* _code_2_data = _scratch[scratch_id],
+						* _mask_2_data = _scratch[scratch_id] + _scratch_size,
+						* _fb_2_data = _scratch[scratch_id] + 2 * _scratch_size;
+	if ( ! iris_code_bis || ! _iris_codes_bis[i] )
+	{
+		d = 1.0;
+		return;
+	}
+	
+	//Recadrage
+	int theta;
+	if ( nb_bank_rotations() )
+		registering_bank(	d,
+							theta,
+							i,
+							iris_code_bis,
+							mask,
+							fragile_bits,
+							- (d_theta * _iris_codes[i]->width) / 2,
+							+ (d_theta * _iris_codes[i]->width) / 2,
+							(const void*) &p,
+							_code_2_data,
+							_mask_2_data,
+							_fb_2_data );
+	else
+		distance::registering_64b(	d,
+									theta,
+									_iris_codes_bis[i],
+									_masks[i],
+									_fragile_bits[i],
+									iris_code_bis,
+									mask,
+									fragile_bits,
+									_iris_codes[i]->width,
+									_iris_codes[i]->height,
+									width_step,
+									- (d_theta * _iris_codes[i]->width) / 2,
+									+ (d_theta * _iris_codes[i]->width) / 2,
+									dist_bis,
+									(const void*) &p,
+									_code_2_data,
+									_mask_2_data,
+									_fb_2_data
+							 );	
+}
+
+void c_matching :: register_fuzzy(	double & d,
+										unsigned int i,
+										const short * fuzzy_code )
+{
+	if ( ! fuzzy_code || ! _fuzzy_codes[i] )
+	{
+		d = 1.0;
+		return;
+	}
+	
+	//Recadrage
+	int theta;
+	distance::registering_q(	d,
+								theta,
+								_fuzzy_codes[i],
+								fuzzy_code,
+								_iris_codes[i]->width,
+								_iris_codes[i]->height,
+								_fuzzy_width_step,
+								- (d_theta * _iris_codes[i]->width) / 2,
+								+ (d_theta * _iris_codes[i]->width) / 2 );
+}
+
+void c_matching :: matching_part( unsigned int id )
+{
+	unsigned int 	begin = ( (unsigned long long) _nb_classes * id ) / _nb_threads,
+					end = ( (unsigned long long) _nb_classes * ( id + 1 ) ) / _nb_threads;
+	if ( begin == end )
+		return;
+	
+	for ( unsigned int i = begin; i < end; ++ i)
+	{
+		if ( dist_bis )
+			register_template(	_q_distances[i],
+								i,
+								_q_iris_code,
+								_q_mask,
+								_q_fragile_bits,
+								_q_p,
+								id );
 		else
-			distances[i] = 1.0;	
+			register_fuzzy(	_q_distances[i],
+							i,
+							_q_fuzzy_code );
+		_q_results[i].id = i;
+		_q_results[i].dist = _q_distances[i];
 	}
-	delete[] _code_2_data;
-	delete[] _mask_2_data;
-	delete[] _fb_2_data;
 		
 	//Tri des distances
-	d_matching * tmp = new d_matching[_nb_classes];
+	sort ( _q_results + begin, _q_results + end );
+}
+
+int c_matching :: matching_matrix (	double * distances,
+										unsigned int * orders,
+										const c_database & probes,
+										unsigned int probe_block,
+										unsigned int gallery_block )
+{
+	if ( ! _scratch || ( ! dist_bis && ( ! _fuzzy_codes || probes.fuzzy_width_step() != _fuzzy_width_step ) ) )
+	{
+		if ( err_stream )
+			*err_stream << "Error: matching_matrix needs binary or fuzzy iris codes!" << endl;
+		return 1;
+	}
+	
+	//Taille des blocs ( iris codes des deux blocs dans MATCHING_TILE_CACHE_SIZE octets )
+	unsigned int template_size = 3 * _scratch_size * sizeof(unsigned long long);
+	for ( unsigned int i = 0; ! dist_bis && i < _nb_classes; ++ i )
+	{
+		//Iris codes flous
+		if ( _fuzzy_codes[i] )
+		{
+			template_size = _fuzzy_width_step * _iris_codes[i]->height * sizeof(short);
+			break;
+		}
+	}
+	if ( template_size == 0 )
+		template_size = 1;
+	if ( probe_block == 0 )
+		probe_block = MATCHING_TILE_CACHE_SIZE / ( 4 * template_size );
+	if ( gallery_block == 0 )
+		gallery_block = ( 3 * MATCHING_TILE_CACHE_SIZE ) / ( 4 * template_size );
+	if ( probe_block == 0 )
+		probe_block = 1;
+	if ( gallery_block == 0 )
+		gallery_block = 1;
+	
+	double p = 0;
+	if ( 	dist == (distance::function_prototype_bis) distance :: Hamming_FBD 	)
+	{
+		p = ( (distance::Hamming_FBD_parameters* ) dist_params)->alpha;
+	}
+	
+	//Requête
+	_q_distances = distances;
+	_q_p = p;
+	_m_orders = orders;
+	_m_probes = &probes;
+	_m_nb_rows = probes.nb_classes();
+	_m_probe_block = probe_block;
+	_m_gallery_block = gallery_block;
+	_m_nb_gallery_blocks = ( _nb_classes + gallery_block - 1 ) / gallery_block;
+	_m_nb_tiles = ( ( probes.nb_classes() + probe_block - 1 ) / probe_block ) * _m_nb_gallery_blocks;
+	_m_next_tile = 0;
+	
+	//Distances ( tuiles ), puis tri de chaque ligne
+	run_pool( MATCHING_TASK_TILES );
+	run_pool( MATCHING_TASK_SORT );
+	
+	_q_distances = NULL;
+	_m_orders = NULL;
+	_m_probes = NULL;
+	return 0;
+}
+
+void c_matching :: sort_matrix (	unsigned int * orders,
+									double * distances,
+									unsigned int nb_rows )
+{
+	_q_distances = distances;
+	_m_orders = orders;
+	_m_nb_rows = nb_rows;
+	run_pool( MATCHING_TASK_SORT );
+	_q_distances = NULL;
+	_m_orders = NULL;
+}
+
+int c_matching :: matching_sweep (	double * distances,
+									const c_database & probes,
+									const double * fbr,
+									unsigned int nb_fbr,
+									const double * alpha,
+									unsigned int nb_alpha )
+{
+	if ( 	! dist_bis 																	|| 
+			! _scratch 																	||
+			dist == (distance::function_prototype_bis) distance :: Hamming_expectation 	)
+	{
+		if ( err_stream )
+			*err_stream << "Error: matching_sweep needs a binary distance!" << endl;
+		return 1;
+	}
+	if ( nb_fbr == 0 || nb_alpha == 0 )
+		return 1;
+	
+	//Iris codes convertis pour tous les taux ( plans complétés à un multiple de 3 pour rotate )
+	unsigned int nb_planes = 3 * ( ( 2 + nb_fbr + 2 ) / 3 );
+	_s_nb_planes = nb_planes;
+	_s_gallery = new unsigned long long*[ _nb_classes ];
+	_s_probes = new unsigned long long*[ probes.nb_classes() ];
 	for ( unsigned int i = 0; i < _nb_classes; ++ i )
 	{
-		tmp[i].id = i;
-		tmp[i].dist = distances[i];
+		_s_gallery[i] = NULL;
+		if ( ! _iris_codes[i] )
+			continue;
+		size_t size = ( ( _iris_codes[i]->width + 63 ) / 64 ) * _iris_codes[i]->height;
+		_s_gallery[i] = new unsigned long long[ nb_planes * size ];
+		if ( convert_levels( _s_gallery[i], i, fbr, nb_fbr ) )
+		{
+			delete[] _s_gallery[i];
+			_s_gallery[i] = NULL;
+		}
+	}
+	for ( unsigned int i = 0; i < probes.nb_classes(); ++ i )
+	{
+		_s_probes[i] = NULL;
+		if ( ! probes.iris_code( i ) )
+			continue;
+		size_t size = ( ( probes.iris_code( i )->width + 63 ) / 64 ) * probes.iris_code( i )->height;
+		_s_probes[i] = new unsigned long long[ nb_planes * size ];
+		memset( _s_probes[i], 0, sizeof(unsigned long long) * nb_planes * size );
+		if ( probes.convert_levels( _s_probes[i], i, fbr, nb_fbr ) )
+		{
+			delete[] _s_probes[i];
+			_s_probes[i] = NULL;
+		}
 	}
-	sort ( tmp, tmp + _nb_classes );
+	
+	//Requête
+	_q_distances = distances;
+	_m_probes = &probes;
+	_m_nb_rows = probes.nb_classes();
+	_s_nb_fbr = nb_fbr;
+	_s_alpha = alpha;
+	_s_nb_alpha = nb_alpha;
+	
+	run_pool( MATCHING_TASK_SWEEP );
 	
 	for ( unsigned int i = 0; i < _nb_classes; ++ i )
 	{
-		orders[i] = tmp[i].id;
-	}	
+		if ( _s_gallery[i] )
+			delete[] _s_gallery[i];
+	}
+	for ( unsigned int i = 0; i < probes.nb_classes(); ++ i )
+	{
+		if ( _s_probes[i] )
+			delete[] _s_probes[i];
+	}
+	delete[] _s_gallery;
+	delete[] _s_probes;
+	_s_gallery = NULL;
+	_s_probes = NULL;
+	_s_alpha = NULL;
+	_q_distances = NULL;
+	_m_probes = NULL;
+	return 0;
+}
+
+void c_matching :: sweep_part( unsigned int id )
+{
+	unsigned int 	begin = ( (unsigned long long) _m_nb_rows * id ) / _nb_threads,
+					end = ( (unsigned long long) _m_nb_rows * ( id + 1 ) ) / _nb_threads,
+					nb_fbr = _s_nb_fbr,
+					nb_alpha = _s_nb_alpha,
+					nb_points = nb_fbr * nb_alpha;
+	if ( begin == end )
+		return;
+	size_t matrix_size = (size_t) _m_nb_rows * _nb_classes;
+	bool 	hamming = ( dist == (distance::function_prototype_bis) distance :: Hamming ),
+			fbd = ( dist == (distance::function_prototype_bis) distance :: fragile_bit_distance );
+	
+	unsigned long long * rot = new unsigned long long[ _s_nb_planes * _scratch_size ];
+	double * best = new double[ nb_points ];
+	distance::bit_counts 	counts,
+							* level_counts = new distance::bit_counts[ nb_fbr ];
+	
+	for ( unsigned int i = begin; i < end; ++ i )
+	{
+		for ( unsigned int j = 0; j < _nb_classes; ++ j )
+		{
+			//Iris code absent
+			if ( ! _s_probes[i] || ! _s_gallery[j] )
+			{
+				for ( unsigned int n = 0; n < nb_points; ++ n )
+					_q_distances[ n * matrix_size + (size_t) i * _nb_classes + j ] = 1.0;
+				continue;
+			}
+			
+			unsigned int 	width = _iris_codes[j]->width,
+							height = _iris_codes[j]->height,
+							ws = ( width + 63 ) / 64;
+			size_t size = (size_t) ws * height;
+			int theta_min = - (d_theta * width) / 2,
+				theta_max = + (d_theta * width) / 2;
+			const unsigned long long 	* code_1 = _s_gallery[j],
+										* mask_1 = _s_gallery[j] + size,
+										* code_2 = rot,
+										* mask_2 = rot + size;
+			for ( unsigned int n = 0; n < nb_points; ++ n )
+				best[n] = 2;
+			
+			//Recadrage ( cf. distance::registering_64b )
+			for ( int theta = theta_min; theta < theta_max; ++ theta )
+			{
+				//Rotation de l'iris code, du masque et des bits fragiles de tous les taux
+				for ( unsigned int k = 0; k < _s_nb_planes; k += 3 )
+					distance::rotate(	rot + k * size,
+										rot + ( k + 1 ) * size,
+										rot + ( k + 2 ) * size,
+										(const unsigned long long *) _s_probes[i] + k * size,
+										(const unsigned long long *) _s_probes[i] + ( k + 1 ) * size,
+										(const unsigned long long *) _s_probes[i] + ( k + 2 ) * size,
+										width,
+										height,
+										ws,
+										theta );
+				
+				//Comptages communs ( masques ) puis par taux ( bits fragiles )
+				if ( ! hamming )
+					distance::count_bits(	counts,
+											code_1,
+											code_2,
+											mask_1,
+											mask_2,
+											(const unsigned long long *) NULL,
+											(const unsigned long long *) NULL,
+											size );
+				for ( unsigned int k = 0; k < nb_fbr; ++ k )
+					distance::count_bits(	level_counts[k],
+											code_1,
+											code_2,
+											_s_gallery[j] + ( 2 + k ) * size,
+											rot + ( 2 + k ) * size,
+											mask_1,
+											mask_2,
+											size );
+				
+				//Distances ( mêmes formules que distance::*_aligned )
+				for ( unsigned int k = 0; k < nb_fbr; ++ k )
+				{
+					for ( unsigned int a = 0; a < nb_alpha; ++ a )
+					{
+						double v;
+						if ( hamming )
+						{
+							if ( level_counts[k].valid == 0 )
+								continue;
+							v = level_counts[k].diff;
+							v /= level_counts[k].valid;
+						}
+						else if ( fbd )
+						{
+							if ( counts.valid == 0 )
+								continue;
+							v = level_counts[k].both;
+							v /= counts.valid;
+							v = 1 - v;
+						}
+						else
+						{
+							if ( counts.valid == 0 )
+								continue;
+							double 	d1 = level_counts[k].both,
+									d2 = counts.diff;
+							d1 /= counts.valid;
+							d2 /= counts.valid;
+							v = _s_alpha[a] * (1 - d1) + (1 - _s_alpha[a]) * d2;
+						}
+						if ( v < best[ k * nb_alpha + a ] )
+							best[ k * nb_alpha + a ] = v;
+					}
+				}
+			}
+			for ( unsigned int n = 0; n < nb_points; ++ n )
+				_q_distances[ n * matrix_size + (size_t) i * _nb_classes + j ] = best[n];
+		}
+	}
+	delete[] rot;
+	delete[] best;
+	delete[] level_counts;
+}
 
+void c_matching :: matrix_tiles( unsigned int id )
+{
+	unsigned int nb_probes = _m_probes->nb_classes();
+	while ( true )
+	{
+		//Tuile suivante
+		unsigned int tile;
+		if ( _nb_threads > 1 )
+		{
+			_pool.lock();
+			tile = _m_next_tile ++;
+			_pool.unlock();
+		}
+		else
+			tile = _m_next_tile ++;
+		if ( tile >= _m_nb_tiles )
+			return;
+		
+		unsigned int 	p_begin = ( tile / _m_nb_gallery_blocks ) * _m_probe_block,
+						g_begin = ( tile % _m_nb_gallery_blocks ) * _m_gallery_block,
+						p_end = min( p_begin + _m_probe_block, nb_probes ),
+						g_end = min( g_begin + _m_gallery_block, _nb_classes );
+		for ( unsigned int i = p_begin; i < p_end; ++ i )
+		{
+			for ( unsigned int j = g_begin; j < g_end; ++ j )
+			{
+				if ( dist_bis )
+					register_template(	_q_distances[ (size_t) i * _nb_classes + j ],
+										j,
+										_m_probes->iris_code_bis( i ),
+										_m_probes->mask( i ),
+										_m_probes->fragile_bits( i ),
+										_q_p,
+										id );
+				else
+					register_fuzzy(	_q_distances[ (size_t) i * _nb_classes + j ],
+									j,
+									_m_probes->fuzzy_code( i ) );
+			}
+		}
+	}
+}
+
+void c_matching :: matrix_sort( unsigned int id )
+{
+	unsigned int 	begin = ( (unsigned long long) _m_nb_rows * id ) / _nb_threads,
+					end = ( (unsigned long long) _m_nb_rows * ( id + 1 ) ) / _nb_threads;
+	if ( begin == end )
+		return;
+	d_matching * tmp = new d_matching[_nb_classes];
+	for ( unsigned int i = begin; i < end; ++ i )
+	{
+		//Même tri que matching_opt
+		for ( unsigned int j = 0; j < _nb_classes; ++ j )
+		{
+			tmp[j].id = j;
+			tmp[j].dist = _q_distances[ (size_t) i * _nb_classes + j ];
+		}
+		sort( tmp, tmp + _nb_classes );
+		for ( unsigned int j = 0; j < _nb_classes; ++ j )
+			_m_orders[ (size_t) i * _nb_classes + j ] = tmp[j].id;
+	}
 	delete[] tmp;
-	return orders[0];
+}
+
+void c_matching :: run_task( unsigned int id )
+{
+	switch ( _pool_task )
+	{
+		case MATCHING_TASK_QUERY:
+			matching_part( id );
+			break;
+		case MATCHING_TASK_TILES:
+			matrix_tiles( id );
+			break;
+		case MATCHING_TASK_SORT:
+			matrix_sort( id );
+			break;
+		case MATCHING_TASK_SWEEP:
+			sweep_part( id );
+			break;
+	}
+}
+
+void c_matching :: run_pool( unsigned int task )
+{
+	_pool_task = task;
+	_pool.run( pool_task, this );
+}
+
+void c_matching :: pool_task( void * obj, unsigned int id )
+{
+	( (c_matching *) obj )->run_task( id );
+}
+
+int c_matching :: set_nb_threads( unsigned int nb_threads )
+{
+	if ( nb_threads == 0 )
+		return 1;
+	stop_threads();
+	
+	//Mémoire de travail ( plus grand iris code de la base )
+	unsigned int 	width = 0,
+					height = 0;
+	for ( unsigned int i = 0; i < _nb_classes; ++ i )
+	{
+		if ( _iris_codes[i] )
+		{
+			if ( width < (unsigned int) _iris_codes[i]->width )
+				width = _iris_codes[i]->width;
+			if ( height < (unsigned int) _iris_codes[i]->height )
+				height = _iris_codes[i]->height;
+		}
+	}
+	_scratch_size = ( ( width + 63 ) / 64 ) * height;
+	
+	//Threads ( en cas d'échec, les parts sont réparties entre les threads créés )
+	int ret = _pool.setup( nb_threads, err_stream );
+	_nb_threads = _pool.nb_threads();
+	_scratch = new unsigned long long*[_nb_threads];
+	for ( unsigned int k = 0; k < _nb_threads; ++ k )
+		_scratch[k] = new unsigned long long[ 3 * _scratch_size ];
+	return ret;
+}
+
+void c_matching :: stop_threads()
+{
+	_pool.stop();
+	if ( _scratch )
+	{
+		for ( unsigned int k = 0; k < _nb_threads; ++ k )
+			delete[] _scratch[k];
+		delete[] _scratch;
+	}
+	_scratch = NULL;
+	_scratch_size = 0;
+	_nb_threads = 1;
 }
 
 
@@ -332,14 +1179,45 @@ c_matching :: ~c_matching()
 void c_matching :: initialize()
 {
 	dist = 0;
+	dist_bis = 0;
+	dist_aligned = 0;
+	dist_bounded = 0;
+	_nb_top_k_comparisons = 0;
+	_nb_top_k_aborted = 0;
 	dist_params = 0;	
 	d_theta = 0;	
+	_nb_threads = 1;
+	_scratch = NULL;
+	_scratch_size = 0;
+	_q_distances = NULL;
+	_q_results = NULL;
+	_q_iris_code = NULL;
+	_q_mask = NULL;
+	_q_fragile_bits = NULL;
+	_q_fuzzy_code = NULL;
+	_q_p = 0;
+	_pool_task = MATCHING_TASK_QUERY;
+	_m_orders = NULL;
+	_m_probes = NULL;
+	_m_nb_rows = 0;
+	_m_probe_block = 0;
+	_m_gallery_block = 0;
+	_m_nb_gallery_blocks = 0;
+	_m_nb_tiles = 0;
+	_m_next_tile = 0;
+	_s_gallery = NULL;
+	_s_probes = NULL;
+	_s_nb_planes = 0;
+	_s_nb_fbr = 0;
+	_s_alpha = NULL;
+	_s_nb_alpha = 0;
 	//Distances
 
 }
 
 void c_matching :: free()
 {
+	stop_threads();
 	if ( dist_params )
 	{
 		if ( dist == (distance::function_prototype_bis) distance :: Hamming ) 
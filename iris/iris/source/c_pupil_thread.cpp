@@ -81,6 +81,18 @@ int c_pupil_thread :: setup (	char ** argv,
 	return 0;
 }
 
+int c_pupil_thread :: segment_pupil(	image_data & img_data,
+										pupil_data * out )
+{
+	//Travail dans out
+	pupil_data * tmp = p_data;
+	out->_img_data.swap( img_data );
+	p_data = out;
+	int q = segment_pupil( out->_img_data );
+	p_data = tmp;
+	return q;
+}
+
 int c_pupil_thread :: segment_pupil(	const image_data & img_data )
 {
 	p_data->_img_data = img_data;	
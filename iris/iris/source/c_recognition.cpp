@@ -1,5 +1,11 @@
 #include "c_recognition.hpp"
 #include <ctime>
+#include <cmath>
+#include <algorithm>
+
+//FRR visés pour far_at_frr
+static const double frr_targets[RECOGNITION_NB_FRR] = { 1e-1, 1e-2, 1e-3 };
+
 c_recognition :: c_recognition()
 {
 	initialize();
@@ -116,8 +122,6 @@ int c_recognition :: setup(  	int argc,
 int c_recognition :: match( double fbr, 
 							double alpha)
 {
-	double matchings = 0;
-	double time = 0;
 	//Calcul des FBR
 	if ( use_fbr() )
 	{
@@ -130,43 +134,18 @@ int c_recognition :: match( double fbr,
 		images->set_alpha( alpha );
 	
 	
-	//Matching
-	for ( _nb_video = 0;  _nb_video < videos->nb_classes(); ++ _nb_video )	
-	{
-		//~ system("clear");
-		clock_t time_1 = clock();
-		unsigned int q_truth;
-		if ( images->get_distance() == (distance::function_prototype_bis) & (distance :: Hamming_expectation) )
-		{
-			images->matching( 	distances + _nb_video * images->nb_classes(),
-								orders + _nb_video * images->nb_classes(),
-								q_truth,
-								videos->iris_code(_nb_video), 
-								videos->fragility_map(_nb_video), 
-								videos->get_fragile_bit_threshold(_nb_video),
-								videos->class_name(_nb_video),
-								videos->name(_nb_video)
-								);
-		}
-		else
-		{		
-			images->matching_opt( 	distances + _nb_video * images->nb_classes(),
-									orders + _nb_video * images->nb_classes(),
-									q_truth,
-									videos->iris_code_bis(_nb_video), 
-									videos->mask(_nb_video), 
-									videos->fragile_bits(_nb_video),
-									videos->class_name(_nb_video),
-									videos->name(_nb_video)
-									);				
-								
-		}
-		clock_t time_2 = clock();
-		matchings += images->nb_classes();
-		time += (time_2 - time_1) / ( (double) CLOCKS_PER_SEC );
-		
-		
-	}
+	//Matching ( E(Hamming) : iris codes flous quantifiés )
+	if ( 	images->get_distance() == (distance::function_prototype_bis) & (distance :: Hamming_expectation) 	&&
+			videos->compute_fuzzy_codes() 																		)
+		return 1;
+	
+	//Matrice complète par tuiles ( cf. c_matching::matching_matrix )
+	if ( images->matching_matrix( 	distances,
+									orders,
+									*videos ) )
+		return 1;
+	_nb_video = videos->nb_classes();
+	
 	//Roc
 	sort_distances();
 
@@ -179,6 +158,55 @@ int c_recognition :: match( double fbr,
 	return 0;
 }
 
+
+
+int c_recognition :: match_sweep( 	const double * fbr,
+									unsigned int nb_fbr,
+									const double * alpha,
+									unsigned int nb_alpha )
+{
+	if ( sweep_distances )
+		delete[] sweep_distances;
+	sweep_distances = new double[ (size_t) nb_fbr * nb_alpha * videos->nb_classes() * images->nb_classes() ];
+	_sweep_nb_fbr = nb_fbr;
+	_sweep_nb_alpha = nb_alpha;
+	if ( images->matching_sweep( 	sweep_distances,
+									*videos,
+									fbr,
+									nb_fbr,
+									alpha,
+									nb_alpha ) )
+	{
+		delete[] sweep_distances;
+		sweep_distances = 0;
+		return 1;
+	}
+	return 0;
+}
+
+int c_recognition :: select_sweep( 	unsigned int k,
+									unsigned int a )
+{
+	if ( ! sweep_distances || k >= _sweep_nb_fbr || a >= _sweep_nb_alpha )
+		return 1;
+	size_t size = (size_t) videos->nb_classes() * images->nb_classes();
+	memcpy( distances, 
+			sweep_distances + ( k * _sweep_nb_alpha + a ) * size,
+			sizeof(double) * size );
+	images->sort_matrix( 	orders,
+							distances,
+							videos->nb_classes() );
+	_nb_video = videos->nb_classes();
+	
+	//Roc
+	sort_distances();
+
+	get_roc_data();
+
+	//Top rank
+	get_top_rank();
+	return 0;
+}
 		
 int c_recognition :: save( const char * rep ) const
 {
@@ -276,9 +304,9 @@ int c_recognition :: save( const char * rep ) const
 	{
 		gsl_matrix toto;
 		toto.size1 = 1;
-		toto.size2 = _nb_thresholds;
+		toto.size2 = _nb_roc_points;
 		toto.data = thresholds;
-		toto.tda = _nb_thresholds;
+		toto.tda = _nb_roc_points;
 		
 		poulet_terminator << "s";
 		fprintf( file, "%s = ", poulet_terminator.str().c_str() );
@@ -291,9 +319,9 @@ int c_recognition :: save( const char * rep ) const
 	{
 		gsl_matrix toto;
 		toto.size1 = 1;
-		toto.size2 = _nb_thresholds;
+		toto.size2 = _nb_roc_points;
 		toto.data = v_p;
-		toto.tda = _nb_thresholds;
+		toto.tda = _nb_roc_points;
 		
 		poulet_terminator << "v_p_" << id;
 		fprintf( file, "%s = ", poulet_terminator.str().c_str() );
@@ -306,9 +334,9 @@ int c_recognition :: save( const char * rep ) const
 	{
 		gsl_matrix toto;
 		toto.size1 = 1;
-		toto.size2 = _nb_thresholds;
+		toto.size2 = _nb_roc_points;
 		toto.data = v_n;
-		toto.tda = _nb_thresholds;
+		toto.tda = _nb_roc_points;
 		
 		poulet_terminator << "v_n_" << id;
 		fprintf( file, "%s = ", poulet_terminator.str().c_str() );
@@ -321,9 +349,9 @@ int c_recognition :: save( const char * rep ) const
 	{
 		gsl_matrix toto;
 		toto.size1 = 1;
-		toto.size2 = _nb_thresholds;
+		toto.size2 = _nb_roc_points;
 		toto.data = f_n;
-		toto.tda = _nb_thresholds;
+		toto.tda = _nb_roc_points;
 		
 		poulet_terminator << "f_n_" << id;
 		fprintf( file, "%s = ", poulet_terminator.str().c_str() );
@@ -337,9 +365,9 @@ int c_recognition :: save( const char * rep ) const
 	{
 		gsl_matrix toto;
 		toto.size1 = 1;
-		toto.size2 = _nb_thresholds;
+		toto.size2 = _nb_roc_points;
 		toto.data = f_p;
-		toto.tda = _nb_thresholds;
+		toto.tda = _nb_roc_points;
 		
 		poulet_terminator << "f_p_" << id;
 		fprintf( file, "%s = ", poulet_terminator.str().c_str() );
@@ -381,6 +409,18 @@ int c_recognition :: save( const char * rep ) const
 	}
 	fprintf( file, "err = %lf;\n", err );
 	
+	//EER et FAR pour les FRR visés
+	fprintf( file, "eer_%u = %lf;\n", id, eer );
+	fprintf( file, "eer_threshold_%u = %lf;\n", id, eer_threshold );
+	fprintf( file, "frr_targets = [" );
+	for ( unsigned int k = 0; k < RECOGNITION_NB_FRR; ++ k )
+		fprintf( file, "\t%lf", frr_targets[k] );
+	fprintf( file, "];\n" );
+	fprintf( file, "far_at_frr_%u = [", id );
+	for ( unsigned int k = 0; k < RECOGNITION_NB_FRR; ++ k )
+		fprintf( file, "\t%lf", far_at_frr[k] );
+	fprintf( file, "];\n" );
+	
 	//Sauvegarde des noms
 	{
 		fprintf( file, "video_names = {};" );
@@ -426,6 +466,11 @@ void c_recognition :: initialize()
 	_nb_video = 0;		
 	_id = 0;
 	_nb_thresholds = 0;
+	_nb_roc_points = 0;
+	eer = -1;
+	eer_threshold = -1;
+	for ( unsigned int k = 0; k < RECOGNITION_NB_FRR; ++ k )
+		far_at_frr[k] = 1;
 	truth = 0;
 	orders = 0;
 	top_rank = 0;
@@ -438,6 +483,9 @@ void c_recognition :: initialize()
 	thresholds = 0;
 	i_distances = 0;
 	g_distances = 0;
+	sweep_distances = 0;
+	_sweep_nb_fbr = 0;
+	_sweep_nb_alpha = 0;
 	
 }
 
@@ -481,6 +529,9 @@ void c_recognition :: free()
 	
 	if ( thresholds )
 		delete[] thresholds;
+	
+	if ( sweep_distances )
+		delete[] sweep_distances;
 
 }
 
@@ -507,6 +558,17 @@ void c_recognition :: sort_distances()
 	}
 }
 
+//Nombre de scores de x ( trié ) strictement inférieurs à t, à partir de n
+static inline unsigned int count_below( 	const double * x,
+											unsigned int size,
+											unsigned int n,
+											double t )
+{
+	while ( n < size && x[n] < t )
+		++ n;
+	return n;
+}
+
 void c_recognition :: get_roc_data()
 {
 	unsigned int nb_videos = videos->nb_classes();
@@ -522,33 +584,137 @@ void c_recognition :: get_roc_data()
 	err = 1.0 - nb_videos / ( (double) videos->nb_classes() );
 	unsigned int t_n = (images->nb_classes() - 1);
 
-	
-	
-	for ( unsigned int i = 0; i <_nb_thresholds; ++ i )
+	//Scores triés ( authentiques valides et imposteurs )
+	unsigned int 	nb_g = 0,
+					nb_i = 0;
+	double 	* g_sorted = new double[ videos->nb_classes() + 1 ],
+			* i_sorted = new double[ videos->nb_classes() * t_n + 1 ];
+	for ( unsigned int j = 0; j < videos->nb_classes(); ++j )
 	{
-		unsigned int nb_i = 0, nb_g = 0;
-		
-		thresholds[i] = i / ( (double) _nb_thresholds );  
-		
-		for ( unsigned int j = 0; j < videos->nb_classes(); ++j )
+		if ( g_distances[j] != 1 )
+			g_sorted[ nb_g ++ ] = g_distances[j];
+		for ( unsigned int k = 1; k < t_n; ++k )
+			i_sorted[ nb_i ++ ] = i_distances[j * t_n + k];
+	}
+	sort( g_sorted, g_sorted + nb_g );
+	sort( i_sorted, i_sorted + nb_i );
+	double 	g_norm = nb_videos,
+			i_norm = ( (double) t_n ) * nb_videos;
+
+	//Seuils exacts : chaque score distinct, puis au-delà du plus grand score
+	unsigned int nb_exact = 0;
+	double * exact_thresholds = new double[ nb_g + nb_i + 1 ];
+	{
+		unsigned int 	a = 0,
+						b = 0;
+		while ( a < nb_g || b < nb_i )
 		{
-			if ( g_distances[j] != 1 )
-			{
-				if ( g_distances[j] < thresholds[i] )
-					++ nb_g;
-			}
-			for ( unsigned int k = 1; k < t_n; ++k )
+			double t;
+			if ( b == nb_i || ( a < nb_g && g_sorted[a] < i_sorted[b] ) )
+				t = g_sorted[a];
+			else
+				t = i_sorted[b];
+			exact_thresholds[ nb_exact ++ ] = t;
+			while ( a < nb_g && g_sorted[a] == t )
+				++ a;
+			while ( b < nb_i && i_sorted[b] == t )
+				++ b;
+		}
+		if ( nb_exact )
+			exact_thresholds[ nb_exact ] = nextafter( exact_thresholds[ nb_exact - 1 ], HUGE_VAL );
+		else
+			exact_thresholds[ nb_exact ] = 0;
+		++ nb_exact;
+	}
+
+	//Courbes ROC / DET ( un seul balayage des scores triés )
+	if ( _nb_thresholds == 0 )
+	{
+		//Sortie exacte
+		if ( thresholds )
+			delete[] thresholds;
+		if ( v_p )
+			delete[] v_p;
+		if ( v_n )
+			delete[] v_n;
+		if ( f_p )
+			delete[] f_p;
+		if ( f_n )
+			delete[] f_n;
+		_nb_roc_points = nb_exact;
+		thresholds = exact_thresholds;
+		exact_thresholds = NULL;
+		v_p = new double[_nb_roc_points];
+		v_n = new double[_nb_roc_points];
+		f_p = new double[_nb_roc_points];
+		f_n = new double[_nb_roc_points];
+	}
+	else
+	{
+		_nb_roc_points = _nb_thresholds;
+		for ( unsigned int i = 0; i < _nb_roc_points; ++ i )
+			thresholds[i] = i / ( (double) _nb_thresholds );
+	}
+	{
+		unsigned int 	a = 0,
+						b = 0;
+		for ( unsigned int i = 0; i < _nb_roc_points; ++ i )
+		{
+			a = count_below( g_sorted, nb_g, a, thresholds[i] );
+			b = count_below( i_sorted, nb_i, b, thresholds[i] );
+			v_p[i] = ( (double) a ) / g_norm;
+			f_p[i] = ( (double) b ) / i_norm;
+			v_n[i] = 1.0 - v_p[i];
+			f_n[i] = 1.0 - f_p[i];
+		}
+	}
+
+	//EER et FAR pour les FRR visés ( seuils exacts )
+	{
+		const double * t_exact = ( exact_thresholds ) ? exact_thresholds : thresholds;
+		unsigned int 	a = 0,
+						b = 0,
+						n_frr = 0;
+		double 	prev_far = 0,
+				prev_frr = 1,
+				prev_t = 0;
+		eer = -1;
+		eer_threshold = -1;
+		for ( unsigned int k = 0; k < RECOGNITION_NB_FRR; ++ k )
+			far_at_frr[k] = 1;
+		for ( unsigned int i = 0; i < nb_exact; ++ i )
+		{
+			a = count_below( g_sorted, nb_g, a, t_exact[i] );
+			b = count_below( i_sorted, nb_i, b, t_exact[i] );
+			double 	frr = 1.0 - ( (double) a ) / g_norm,
+					far = ( (double) b ) / i_norm;
+			//Croisement FAR / FRR ( interpolation linéaire )
+			if ( eer < 0 && far >= frr )
 			{
-				if ( i_distances[j * t_n + k] < thresholds[i] )
-					++ nb_i;
+				if ( i == 0 )
+				{
+					eer = ( far + frr ) / 2;
+					eer_threshold = t_exact[i];
+				}
+				else
+				{
+					double w = ( prev_frr - prev_far ) / ( ( prev_frr - prev_far ) - ( frr - far ) );
+					eer = prev_far + w * ( far - prev_far );
+					eer_threshold = prev_t + w * ( t_exact[i] - prev_t );
+				}
 			}
+			while ( n_frr < RECOGNITION_NB_FRR && frr <= frr_targets[n_frr] )
+				far_at_frr[ n_frr ++ ] = far;
+			prev_far = far;
+			prev_frr = frr;
+			prev_t = t_exact[i];
 		}
-
-		v_p[i] = ( (double) nb_g) / nb_videos;
-		f_p[i] = ( (double) nb_i) / (t_n * nb_videos);
-		v_n[i] = 1.0 - v_p[i];
-		f_n[i] = 1.0 - f_p[i];
 	}
+
+	if ( exact_thresholds )
+		delete[] exact_thresholds;
+	delete[] g_sorted;
+	delete[] i_sorted;
 }
 
 void c_recognition :: get_top_rank()
@@ -0,0 +1,181 @@
+#include "c_stage_metrics.hpp"
+#include <cmath>
+#include <ctime>
+
+double monotonic_time( void )
+{
+	timespec t;
+	clock_gettime( CLOCK_MONOTONIC, &t );
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+c_metric_histogram :: c_metric_histogram ( void )
+{
+	reset();
+}
+
+void c_metric_histogram :: reset ( void )
+{
+	for ( unsigned int i = 0; i < METRIC_NB_BINS; ++ i )
+		_bins[i] = 0;
+	_count = 0;
+	_sum = 0;
+	_min = 0;
+	_max = 0;
+}
+
+void c_metric_histogram :: add ( double value )
+{
+	//Classe ( 0 : sous le minimum, METRIC_NB_BINS - 1 : au-dessus du maximum )
+	unsigned int k = 0;
+	if ( value >= METRIC_MIN_VALUE )
+	{
+		double l = log10( value / METRIC_MIN_VALUE ) * METRIC_BINS_PER_DECADE;
+		k = ( l >= METRIC_NB_BINS - 2 ) ? METRIC_NB_BINS - 1 : 1 + (unsigned int) l;
+	}
+	++ _bins[k];
+	if ( _count == 0 || value < _min )
+		_min = value;
+	if ( _count == 0 || value > _max )
+		_max = value;
+	++ _count;
+	_sum += value;
+}
+
+double c_metric_histogram :: quantile ( double p ) const
+{
+	if ( _count == 0 )
+		return 0;
+	unsigned long long rank = (unsigned long long) ceil( p * _count ),
+					   n = 0;
+	if ( rank == 0 )
+		rank = 1;
+	unsigned int k = 0;
+	for ( ; k < METRIC_NB_BINS; ++ k )
+	{
+		n += _bins[k];
+		if ( n >= rank )
+			break;
+	}
+	double v;
+	if ( k == 0 )
+		v = _min;
+	else if ( k == METRIC_NB_BINS - 1 )
+		v = _max;
+	else
+		v = METRIC_MIN_VALUE * pow( 10.0, ( k - 0.5 ) / METRIC_BINS_PER_DECADE );
+	if ( v < _min )
+		v = _min;
+	if ( v > _max )
+		v = _max;
+	return v;
+}
+
+c_stage_metrics :: c_stage_metrics ( void )
+{
+	pthread_mutex_init( &_mutex, NULL );
+}
+
+void c_stage_metrics :: add ( 	metric_id id,
+								double value )
+{
+	pthread_mutex_lock( &_mutex );
+	_histograms[id].add( value );
+	pthread_mutex_unlock( &_mutex );
+}
+
+void c_stage_metrics :: reset ( void )
+{
+	pthread_mutex_lock( &_mutex );
+	for ( unsigned int i = 0; i < METRIC_COUNT; ++ i )
+		_histograms[i].reset();
+	pthread_mutex_unlock( &_mutex );
+}
+
+void c_stage_metrics :: save ( 	ostream & out,
+								unsigned int video_id )
+{
+	for ( unsigned int i = 0; i < METRIC_COUNT; ++ i )
+		save( out, video_id, (metric_id) i );
+}
+
+void c_stage_metrics :: save ( 	ostream & out,
+								unsigned int video_id,
+								metric_id id )
+{
+	pthread_mutex_lock( &_mutex );
+	const c_metric_histogram & h = _histograms[id];
+	out << "metrics(" << video_id << ")." << name( id ) << " = [ "
+		<< h.count() << ", "
+		<< h.sum() << ", "
+		<< ( h.count() ? h.sum() / h.count() : 0 ) << ", "
+		<< h.quantile( 0.50 ) << ", "
+		<< h.quantile( 0.95 ) << ", "
+		<< h.quantile( 0.99 ) << ", "
+		<< h.max() << " ];" << endl;
+	pthread_mutex_unlock( &_mutex );
+}
+
+const char * c_stage_metrics :: name ( metric_id id )
+{
+	switch ( id )
+	{
+		case METRIC_DECODE:
+			return "decode";
+		case METRIC_DECODE_WAIT:
+			return "decode_wait";
+		case METRIC_PREPROCESSING:
+			return "preprocessing";
+		case METRIC_FOCUS_SCORE:
+			return "focus_score";
+		case METRIC_PUPIL_SEGMENTATION:
+			return "pupil_segmentation";
+		case METRIC_IRIS_SEGMENTATION:
+			return "iris_segmentation";
+		case METRIC_EYELIDS:
+			return "eyelids";
+		case METRIC_POLAR:
+			return "polar";
+		case METRIC_IRIS_CODE:
+			return "iris_code";
+		case METRIC_SAVE:
+			return "save";
+		case METRIC_IMAGE_PUSH_WAIT:
+			return "image_push_wait";
+		case METRIC_IMAGE_POP_WAIT:
+			return "image_pop_wait";
+		case METRIC_IMAGE_DEPTH:
+			return "image_depth";
+		case METRIC_PUPIL_PUSH_WAIT:
+			return "pupil_push_wait";
+		case METRIC_PUPIL_POP_WAIT:
+			return "pupil_pop_wait";
+		case METRIC_PUPIL_DEPTH:
+			return "pupil_depth";
+		case METRIC_IRIS_PUSH_WAIT:
+			return "iris_push_wait";
+		case METRIC_IRIS_DEPTH:
+			return "iris_depth";
+		default:
+			return "unknown";
+	}
+}
+
+c_stage_metrics :: ~c_stage_metrics()
+{
+	pthread_mutex_destroy( &_mutex );
+}
+
+c_scoped_timer :: c_scoped_timer ( 	c_stage_metrics * metrics,
+									metric_id id )
+{
+	_metrics = metrics;
+	_id = id;
+	_start = ( metrics ) ? monotonic_time() : 0;
+}
+
+c_scoped_timer :: ~c_scoped_timer()
+{
+	if ( _metrics )
+		_metrics->add( _id, monotonic_time() - _start );
+}
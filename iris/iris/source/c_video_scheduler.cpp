@@ -0,0 +1,168 @@
+#include "c_video_scheduler.hpp"
+
+void * video_scheduler_function ( void * params )
+{
+	c_video_scheduler::worker * w = (c_video_scheduler::worker *) params;
+	w->obj->process( w->id );
+	return NULL;
+}
+
+c_video_scheduler :: c_video_scheduler ( void )
+{
+	initialize();
+}
+
+int c_video_scheduler :: setup ( 	unsigned int argc,
+									char ** argv,
+									const char * save_dir,
+									ostream * stream )
+{
+	free();
+	initialize();
+	err_stream = stream;
+
+	api_parameters params;
+	for ( unsigned int i = 0; i < argc; ++ i )
+		params.load( argv[i] );
+
+	stringstream oss;
+	oss << BUFFER_NAMESPACE << "::" << SCHEDULER_NB_VIDEOS;
+	if ( api_get_positive_integer( 	params,
+									oss.str().c_str(),
+									&_nb_videos,
+									NULL ) || _nb_videos == 0 )
+		_nb_videos = 1;
+
+	pthread_mutex_init( &_mutex, NULL );
+	_pipelines = new c_get_iris_template_pthread*[_nb_videos];
+	_threads = new pthread_t[_nb_videos];
+	_workers = new worker[_nb_videos];
+	for ( unsigned int i = 0; i < _nb_videos; ++ i )
+	{
+		_workers[i].obj = this;
+		_workers[i].id = i;
+		_pipelines[i] = new c_get_iris_template_pthread;
+	}
+
+	//Un fichier de statistiques par pipeline
+	for ( unsigned int i = 0; i < _nb_videos; ++ i )
+	{
+		oss.str("");
+		oss << "fps_" << i + 1 << ".m";
+		if ( _pipelines[i]->setup( 	argc,
+									argv,
+									save_dir,
+									stream,
+									false,
+									oss.str().c_str() ) )
+			return 1;
+	}
+	return 0;
+}
+
+void c_video_scheduler :: add_job ( 	const char * filename,
+										const char * save_dir,
+										const char * log_filename )
+{
+	video_job job;
+	job.filename = filename;
+	job.save_dir = save_dir;
+	if ( log_filename )
+		job.log_filename = log_filename;
+	_jobs.push_back( job );
+}
+
+unsigned int c_video_scheduler :: run ( int & end )
+{
+	p_end = &end;
+	_next_job = 0;
+	_nb_done = 0;
+	_nb_failed = 0;
+	for ( unsigned int i = 0; i < _nb_videos; ++ i )
+		pthread_create( _threads + i,
+						NULL,
+						video_scheduler_function,
+						(void*) ( _workers + i ) );
+	for ( unsigned int i = 0; i < _nb_videos; ++ i )
+		pthread_join( _threads[i], NULL );
+	return _nb_failed;
+}
+
+void c_video_scheduler :: process ( unsigned int id )
+{
+	c_get_iris_template_pthread * obj = _pipelines[id];
+	while ( true )
+	{
+		//Vidéo suivante
+		pthread_mutex_lock( &_mutex );
+		if ( _next_job >= _jobs.size() || *p_end )
+		{
+			pthread_mutex_unlock( &_mutex );
+			break;
+		}
+		video_job job = _jobs[ _next_job ++ ];
+		pthread_mutex_unlock( &_mutex );
+
+		ofstream log_file;
+		if ( ! job.log_filename.empty() )
+		{
+			log_file.open( job.log_filename.c_str() );
+			if ( log_file )
+				obj->set_error_stream( log_file );
+		}
+
+		//Segmentation
+		obj->test();
+		int q = obj->run( job.filename.c_str(), *p_end );
+		if ( ! q )
+			q = obj->save( job.save_dir.c_str() );
+
+		//Le flux de log est fermé
+		obj->set_error_stream( err_stream ? *err_stream : cout );
+		if ( log_file.is_open() )
+			log_file.close();
+
+		pthread_mutex_lock( &_mutex );
+		++ _nb_done;
+		if ( q )
+			++ _nb_failed;
+		if ( err_stream )
+			*err_stream << "( " << _nb_done << " / " << _jobs.size() << " ) " << job.filename << endl;
+		pthread_mutex_unlock( &_mutex );
+	}
+}
+
+c_video_scheduler :: ~c_video_scheduler()
+{
+	free();
+	initialize();
+}
+
+void c_video_scheduler :: initialize()
+{
+	_nb_videos = 0;
+	_pipelines = NULL;
+	_threads = NULL;
+	_workers = NULL;
+	_next_job = 0;
+	_nb_done = 0;
+	_nb_failed = 0;
+	p_end = NULL;
+	err_stream = NULL;
+}
+
+void c_video_scheduler :: free()
+{
+	if ( _pipelines )
+	{
+		for ( unsigned int i = 0; i < _nb_videos; ++ i )
+			delete _pipelines[i];
+		delete[] _pipelines;
+		pthread_mutex_destroy( &_mutex );
+	}
+	if ( _threads )
+		delete[] _threads;
+	if ( _workers )
+		delete[] _workers;
+	_jobs.clear();
+}
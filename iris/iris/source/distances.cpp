@@ -1,5 +1,41 @@
 #include "distances.hpp"
 
+//Comptage des bits ( cas générique )
+template <class type> static void count_bits_opt(	distance::bit_counts & counts,
+													const type * x_1,
+													const type * x_2,
+													const type * v_1,
+													const type * v_2,
+													const type * s_1,
+													const type * s_2,
+													size_t size )
+{
+	counts.valid = 0;
+	counts.diff = 0;
+	counts.both = 0;
+	for ( size_t i = 0; i < size; ++ i )
+	{
+		type v = v_1[i] & v_2[i];
+		counts.valid += __builtin_popcountll( (unsigned long long) v );
+		counts.diff += __builtin_popcountll( (unsigned long long) ( ( x_1[i] ^ x_2[i] ) & v ) );
+		if ( s_1 && s_2 )
+			counts.both += __builtin_popcountll( (unsigned long long) ( s_1[i] & s_2[i] & v ) );
+	}
+}
+
+//Comptage des bits ( 64 bits : noyau sélectionné à l'exécution )
+static void count_bits_opt(	distance::bit_counts & counts,
+							const unsigned long long * x_1,
+							const unsigned long long * x_2,
+							const unsigned long long * v_1,
+							const unsigned long long * v_2,
+							const unsigned long long * s_1,
+							const unsigned long long * s_2,
+							size_t size )
+{
+	distance::count_bits( counts, x_1, x_2, v_1, v_2, s_1, s_2, size );
+}
+
 template <class type> int distance :: debug_convert( const type * code,
 													 const type * mask,
 													 const type * fb,
@@ -107,6 +143,7 @@ template <class type> int distance :: debug_convert( const type * code,
 	
 	
 	
+	return 0;
 }
 
 
@@ -191,6 +228,7 @@ template <class type> int distance :: convert( 	type * code_out,
 	}
 	
 	
+	return 0;
 }
 
 											
@@ -327,6 +365,404 @@ template <class type> int distance :: rotate( 	type * code_out,
 
 		}
 	}
+	return 0;
+}
+
+template <class type> int distance :: Hamming_aligned ( 	double & d,
+															const type * code_1_data,
+															const type * mask_1_data,
+															const type * fb_data_1,
+															const type * code_2_data,
+															const type * mask_2_data,
+															const type * fb_data_2,
+															unsigned int width,
+															unsigned int height,
+															unsigned int width_step,
+															const void * params )
+{
+	//pixels valides et pixel différents
+	distance::bit_counts counts;
+	count_bits_opt(	counts,
+					code_1_data,
+					code_2_data,
+					fb_data_1,
+					fb_data_2,
+					(const type *) NULL,
+					(const type *) NULL,
+					(size_t) width_step * height );
+	unsigned int n = counts.valid;
+	d = counts.diff;
+	if ( n == 0 )
+	{
+		d = 1;
+		return 1;
+	}
+	d /= n;
+	return 0;
+}
+
+template <class type> int distance :: fragile_bit_distance_aligned ( 	double & d,
+																		const type * code_1_data,
+																		const type * mask_1_data,
+																		const type * fb_data_1,
+																		const type * code_2_data,
+																		const type * mask_2_data,
+																		const type * fb_data_2,
+																		unsigned int width,
+																		unsigned int height,
+																		unsigned int width_step,
+																		const void * params )
+{
+	//pixels valides et bits fragiles communs
+	distance::bit_counts counts;
+	count_bits_opt(	counts,
+					code_1_data,
+					code_2_data,
+					mask_1_data,
+					mask_2_data,
+					fb_data_1,
+					fb_data_2,
+					(size_t) width_step * height );
+	unsigned int n = counts.valid;
+	d = counts.both;
+	if ( n == 0 )
+	{
+		d = 1;
+		return 1;
+	}
+	d /= n;
+	d = 1 - d;
+	return 0;
+}
+
+template <class type> int distance :: Hamming_FBD_aligned ( 	double & d,
+																const type * code_1_data,
+																const type * mask_1_data,
+																const type * fb_data_1,
+																const type * code_2_data,
+																const type * mask_2_data,
+																const type * fb_data_2,
+																unsigned int width,
+																unsigned int height,
+																unsigned int width_step,
+																const void * params )
+{
+	double alpha = *((double*) params);
+	double d1 = 0, d2 = 0;
+	
+	//pixels valides, bits fragiles communs et pixels différents
+	distance::bit_counts counts;
+	count_bits_opt(	counts,
+					code_1_data,
+					code_2_data,
+					mask_1_data,
+					mask_2_data,
+					fb_data_1,
+					fb_data_2,
+					(size_t) width_step * height );
+	unsigned int n = counts.valid;
+	d1 = counts.both;
+	d2 = counts.diff;
+	if ( n == 0 )
+	{
+		d = 1;
+		return 1;
+	}
+	d1 /= n;
+	d2 /= n;
+	
+	d = alpha * (1 - d1) + (1 - alpha) * d2;
+	return 0;
+}
+
+template <class type> void distance :: compute_row_counts ( 	unsigned int * row_counts,
+																const type * mask_data,
+																const type * fb_data,
+																unsigned int width_step,
+																unsigned int height )
+{
+	row_counts[height] = 0;
+	row_counts[2 * height + 1] = 0;
+	for ( unsigned int r = height; r-- > 0; )
+	{
+		distance::bit_counts counts;
+		count_bits_opt(	counts,
+						mask_data + r * width_step,
+						fb_data + r * width_step,
+						mask_data + r * width_step,
+						mask_data + r * width_step,
+						(const type *) NULL,
+						(const type *) NULL,
+						(size_t) width_step );
+		row_counts[r] = row_counts[r + 1] + counts.valid;
+		count_bits_opt(	counts,
+						fb_data + r * width_step,
+						fb_data + r * width_step,
+						fb_data + r * width_step,
+						fb_data + r * width_step,
+						(const type *) NULL,
+						(const type *) NULL,
+						(size_t) width_step );
+		row_counts[height + 1 + r] = row_counts[height + 2 + r] + counts.valid;
+	}
+}
+
+//Marge sur les minorants ( arrondis )
+#define DIST_BOUND_EPSILON 1e-9
+
+//Ligne r de l'iris code 2 ( tournée de theta dans _x_2, sauf si _x_2 est NULL : déjà recadré )
+template <class type> static inline unsigned int get_row( 	const type *& code_2_row,
+															const type *& mask_2_row,
+															const type *& fb_2_row,
+															const type * code_2_data,
+															const type * mask_2_data,
+															const type * fb_data_2,
+															unsigned int r,
+															unsigned int width,
+															unsigned int width_step,
+															int theta,
+															type * _code_2_data,
+															type * _mask_2_data,
+															type * _fb_data_2 )
+{
+	unsigned int o = r * width_step;
+	if ( ! _code_2_data )
+	{
+		code_2_row = code_2_data + o;
+		mask_2_row = mask_2_data + o;
+		fb_2_row = fb_data_2 + o;
+	}
+	else
+	{
+		distance::rotate(	_code_2_data + o,
+							_mask_2_data + o,
+							_fb_data_2 + o,
+							code_2_data + o,
+							mask_2_data + o,
+							fb_data_2 + o,
+							width,
+							1,
+							width_step,
+							theta );
+		code_2_row = _code_2_data + o;
+		mask_2_row = _mask_2_data + o;
+		fb_2_row = _fb_data_2 + o;
+	}
+	return o;
+}
+
+template <class type> int distance :: Hamming_bounded ( 	double & d,
+															const type * code_1_data,
+															const type * mask_1_data,
+															const type * fb_data_1,
+															const type * code_2_data,
+															const type * mask_2_data,
+															const type * fb_data_2,
+															unsigned int width,
+															unsigned int height,
+															unsigned int width_step,
+															int theta,
+															const void * params,
+															double d_max,
+															const unsigned int * row_counts_1,
+															const unsigned int * row_counts_2,
+															type * _code_2_data,
+															type * _mask_2_data,
+															type * _fb_data_2 )
+{
+	unsigned long long 	n_valid = 0,
+						n_diff = 0;
+	for ( unsigned int r = 0; r < height; ++ r )
+	{
+		const type 	* code_2_row,
+					* mask_2_row,
+					* fb_2_row;
+		unsigned int o = get_row( 	code_2_row, mask_2_row, fb_2_row,
+									code_2_data, mask_2_data, fb_data_2,
+									r, width, width_step, theta,
+									_code_2_data, _mask_2_data, _fb_data_2 );
+		
+		//pixels valides et pixel différents
+		distance::bit_counts counts;
+		count_bits_opt(	counts,
+						code_1_data + o,
+						code_2_row,
+						fb_data_1 + o,
+						fb_2_row,
+						(const type *) NULL,
+						(const type *) NULL,
+						(size_t) width_step );
+		n_valid += counts.valid;
+		n_diff += counts.diff;
+		
+		//Minorant : tous les bits fragiles restants sont valides et identiques
+		unsigned long long b = min( row_counts_1[height + 2 + r], row_counts_2[height + 2 + r] );
+		if ( 	r + 1 < height 														&&
+				n_valid + b 														&&
+				( (double) n_diff ) / ( n_valid + b ) > d_max + DIST_BOUND_EPSILON 	)
+		{
+			d = ( (double) n_diff ) / ( n_valid + b );
+			return 2;
+		}
+	}
+	unsigned int n = n_valid;
+	d = n_diff;
+	if ( n == 0 )
+	{
+		d = 1;
+		return 1;
+	}
+	d /= n;
+	return 0;
+}
+
+template <class type> int distance :: fragile_bit_distance_bounded ( 	double & d,
+																		const type * code_1_data,
+																		const type * mask_1_data,
+																		const type * fb_data_1,
+																		const type * code_2_data,
+																		const type * mask_2_data,
+																		const type * fb_data_2,
+																		unsigned int width,
+																		unsigned int height,
+																		unsigned int width_step,
+																		int theta,
+																		const void * params,
+																		double d_max,
+																		const unsigned int * row_counts_1,
+																		const unsigned int * row_counts_2,
+																		type * _code_2_data,
+																		type * _mask_2_data,
+																		type * _fb_data_2 )
+{
+	unsigned long long 	n_valid = 0,
+						n_both = 0;
+	for ( unsigned int r = 0; r < height; ++ r )
+	{
+		const type 	* code_2_row,
+					* mask_2_row,
+					* fb_2_row;
+		unsigned int o = get_row( 	code_2_row, mask_2_row, fb_2_row,
+									code_2_data, mask_2_data, fb_data_2,
+									r, width, width_step, theta,
+									_code_2_data, _mask_2_data, _fb_data_2 );
+		
+		//pixels valides et bits fragiles communs
+		distance::bit_counts counts;
+		count_bits_opt(	counts,
+						code_1_data + o,
+						code_2_row,
+						mask_1_data + o,
+						mask_2_row,
+						fb_data_1 + o,
+						fb_2_row,
+						(size_t) width_step );
+		n_valid += counts.valid;
+		n_both += counts.both;
+		
+		//Minorant : tous les bits fragiles restants sont communs
+		unsigned long long b = min( row_counts_1[height + 2 + r], row_counts_2[height + 2 + r] );
+		if ( 	r + 1 < height 																	&&
+				n_valid + b 																	&&
+				1 - ( (double) ( n_both + b ) ) / ( n_valid + b ) > d_max + DIST_BOUND_EPSILON 	)
+		{
+			d = 1 - ( (double) ( n_both + b ) ) / ( n_valid + b );
+			return 2;
+		}
+	}
+	unsigned int n = n_valid;
+	d = n_both;
+	if ( n == 0 )
+	{
+		d = 1;
+		return 1;
+	}
+	d /= n;
+	d = 1 - d;
+	return 0;
+}
+
+template <class type> int distance :: Hamming_FBD_bounded ( 	double & d,
+																const type * code_1_data,
+																const type * mask_1_data,
+																const type * fb_data_1,
+																const type * code_2_data,
+																const type * mask_2_data,
+																const type * fb_data_2,
+																unsigned int width,
+																unsigned int height,
+																unsigned int width_step,
+																int theta,
+																const void * params,
+																double d_max,
+																const unsigned int * row_counts_1,
+																const unsigned int * row_counts_2,
+																type * _code_2_data,
+																type * _mask_2_data,
+																type * _fb_data_2 )
+{
+	double alpha = *((double*) params);
+	double d1 = 0, d2 = 0;
+	bool bounded = ( alpha >= 0 && alpha <= 1 );
+	unsigned long long 	n_valid = 0,
+						n_both = 0,
+						n_diff = 0;
+	for ( unsigned int r = 0; r < height; ++ r )
+	{
+		const type 	* code_2_row,
+					* mask_2_row,
+					* fb_2_row;
+		unsigned int o = get_row( 	code_2_row, mask_2_row, fb_2_row,
+									code_2_data, mask_2_data, fb_data_2,
+									r, width, width_step, theta,
+									_code_2_data, _mask_2_data, _fb_data_2 );
+		
+		//pixels valides, bits fragiles communs et pixels différents
+		distance::bit_counts counts;
+		count_bits_opt(	counts,
+						code_1_data + o,
+						code_2_row,
+						mask_1_data + o,
+						mask_2_row,
+						fb_data_1 + o,
+						fb_2_row,
+						(size_t) width_step );
+		n_valid += counts.valid;
+		n_both += counts.both;
+		n_diff += counts.diff;
+		
+		//Minorant : v bits valides restants ( v <= V ), dont min( v, B ) fragiles communs et 0 différent.
+		//La distance est monotone en v sur [0, B] et [B, V] : le minimum est atteint en B ou en V.
+		if ( ! bounded || r + 1 == height )
+			continue;
+		unsigned long long 	v = min( row_counts_1[r + 1], row_counts_2[r + 1] ),
+							b = min( row_counts_1[height + 2 + r], row_counts_2[height + 2 + r] );
+		if ( b > v )
+			b = v;
+		if ( n_valid + b == 0 )
+			continue;
+		double 	num = alpha * ( n_valid - n_both ) + ( 1 - alpha ) * n_diff,
+				lb = min( 	num / ( n_valid + b ),
+							( num + alpha * ( v - b ) ) / ( n_valid + v ) );
+		if ( lb > d_max + DIST_BOUND_EPSILON )
+		{
+			d = lb;
+			return 2;
+		}
+	}
+	unsigned int n = n_valid;
+	d1 = n_both;
+	d2 = n_diff;
+	if ( n == 0 )
+	{
+		d = 1;
+		return 1;
+	}
+	d1 /= n;
+	d2 /= n;
+	
+	d = alpha * (1 - d1) + (1 - alpha) * d2;
+	return 0;
 }
 
 template <class type> int distance :: Hamming_opt ( double & d,
@@ -345,10 +781,6 @@ template <class type> int distance :: Hamming_opt ( double & d,
 													type * _mask_2_data,
 													type * _fb_data_2 )
 {
-
-
-	d = 0;
-
 	rotate( _code_2_data,
 			_mask_2_data,
 			_fb_data_2,
@@ -359,38 +791,19 @@ template <class type> int distance :: Hamming_opt ( double & d,
 			height,
 			width_step,
 			theta );
-	unsigned int n = 0;
-	for ( unsigned int i = 0; i < height; ++ i )
-	{
-		for ( unsigned int j = 0; j < width_step; ++ j )
-		{
-			unsigned int n_pixel = i * width_step + j;
-			//pixels valides et pixel différents
-			type n1 = ( fb_data_1[n_pixel] ) & ( _fb_data_2[n_pixel] ), 
-				 c1 = ( code_1_data[n_pixel] ^ _code_2_data[n_pixel] ) & n1;
-			
-			//Comptage des bits
-			for ( unsigned int k = 0; k < 8 * sizeof(type); ++ k )
-			{
-				n += (n1 >> k) & 1;
-				d += (c1 >> k) & 1;
-			}
-		}
-	}
-	if ( n == 0 )
-	{
-		d = 1;
-		return 1;
-	}
-	d /= n;
-	
-	
-	return 0;
-	
-	
+	return distance :: Hamming_aligned( 	d,
+									code_1_data,
+									mask_1_data,
+									fb_data_1,
+									(const type *) _code_2_data,
+									(const type *) _mask_2_data,
+									(const type *) _fb_data_2,
+									width,
+									height,
+									width_step,
+									params );
 }
 
-
 template <class type> int  distance :: fragile_bit_distance_opt ( 	double & d,
 																	const type * code_1_data,
 																	const type * mask_1_data,
@@ -407,8 +820,6 @@ template <class type> int  distance :: fragile_bit_distance_opt ( 	double & d,
 																	type * _mask_2_data,
 																	type * _fb_data_2 )
 {
-	d = 0;
-
 	rotate( _code_2_data,
 			_mask_2_data,
 			_fb_data_2,
@@ -419,37 +830,18 @@ template <class type> int  distance :: fragile_bit_distance_opt ( 	double & d,
 			height,
 			width_step,
 			theta );
-			
-	unsigned int n = 0;
-	for ( unsigned int i = 0; i < height; ++ i )
-	{
-		for ( unsigned int j = 0; j < width_step; ++ j )
-		{
-			unsigned int n_pixel = i * width_step + j;
-			//pixels valides et pixel différents
-			type n1 = mask_1_data[n_pixel] & _mask_2_data[n_pixel], 
-				 c1 = ( fb_data_1[n_pixel] & _fb_data_2[n_pixel] ) & n1;
-			
-			//Comptage des bits
-			for ( unsigned int k = 0; k < 8 * sizeof(type); ++ k )
-			{
-				n += (n1 >> k) & 1;
-				d += (c1 >> k) & 1;
-			}
-		}
-	}
-	if ( n == 0 )
-	{
-		d = 1;
-		return 1;
-	}
-	d /= n;
-	d = 1 - d;
-	
-	return 0;
-	
+	return distance :: fragile_bit_distance_aligned( 	d,
+									code_1_data,
+									mask_1_data,
+									fb_data_1,
+									(const type *) _code_2_data,
+									(const type *) _mask_2_data,
+									(const type *) _fb_data_2,
+									width,
+									height,
+									width_step,
+									params );
 }
-														
 
 template <class type> int  distance :: Hamming_FBD_opt ( 	double & d,
 															const type * code_1_data,
@@ -467,13 +859,6 @@ template <class type> int  distance :: Hamming_FBD_opt ( 	double & d,
 															type * _mask_2_data,
 															type * _fb_data_2 )
 {
-	double alpha = *((double*) params);
-	
-	
-	
-	
-	d = 0;
-	double d1 = 0,d2 = 0;
 	rotate( _code_2_data,
 			_mask_2_data,
 			_fb_data_2,
@@ -484,46 +869,21 @@ template <class type> int  distance :: Hamming_FBD_opt ( 	double & d,
 			height,
 			width_step,
 			theta );
-	
-	unsigned int n = 0;
-	for ( unsigned int i = 0; i < height; ++ i )
-	{
-		for ( unsigned int j = 0; j < width_step; ++ j )
-		{
-			unsigned int n_pixel = i * width_step + j;
-			//pixels valides et pixel différents
-			type n1 = mask_1_data[n_pixel] & _mask_2_data[n_pixel], 
-				 c1 = ( fb_data_1[n_pixel] & _fb_data_2[n_pixel] ) & n1,
-				 c2 = ( code_1_data[n_pixel] ^ _code_2_data[n_pixel] ) & n1;
-			//Comptage des bits
-			for ( unsigned int k = 0; k < 8 * sizeof(type); ++ k )
-			{
-				n += (n1 >> k) & 1;
-				d1 += (c1 >> k) & 1;
-				d2 += (c2 >> k) & 1;
-			}
-		}
-	}
-	if ( n == 0 )
-	{
-		d = 1;
-		return 1;
-	}
-	d1 /= n;
-	d2 /= n;
-	
-	d = alpha * (1 - d1) + (1 - alpha) * d2;
-	return 0;
-	
-	
+	return distance :: Hamming_FBD_aligned( 	d,
+									code_1_data,
+									mask_1_data,
+									fb_data_1,
+									(const type *) _code_2_data,
+									(const type *) _mask_2_data,
+									(const type *) _fb_data_2,
+									width,
+									height,
+									width_step,
+									params );
 }
 
 
 
-
-
-
-
 template <class type> int distance :: convert(	type * code_out,
 												type * mask_out,
 												type * fb_data_out,
@@ -0,0 +1,314 @@
+#include "expectation.hpp"
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define FUZZY_X86 1
+#endif
+
+//Nombre de pixels traités entre deux vidages des accumulateurs 16 / 32 bits des noyaux vectoriels
+#define FUZZY_BLOCK_SIZE 8192
+
+//Noyau scalaire
+static void count_fuzzy_scalar (	distance::fuzzy_counts & counts,
+									const short * code_1,
+									const short * code_2,
+									size_t size )
+{
+	long long dot = 0;
+	unsigned long long valid = 0;
+	for ( size_t i = 0; i < size; ++ i )
+	{
+		dot += code_1[i] * code_2[i];
+		valid += ( code_1[i] != 0 && code_2[i] != 0 );
+	}
+	counts.dot = dot;
+	counts.valid = valid;
+}
+
+#ifdef FUZZY_X86
+
+//Noyau SSE2 : pmaddwd ( produits 16 bits sommés par paires en 32 bits ), pixels masqués comptés en 16 bits
+__attribute__((target("sse2"))) static void count_fuzzy_sse2 (	distance::fuzzy_counts & counts,
+																const short * code_1,
+																const short * code_2,
+																size_t size )
+{
+	const __m128i 	zero = _mm_setzero_si128(),
+					one = _mm_set1_epi16( 1 );
+	long long dot = 0;
+	unsigned long long invalid = 0;
+	size_t i = 0;
+	while ( i + 8 <= size )
+	{
+		__m128i a_dot = _mm_setzero_si128(),
+				a_invalid = _mm_setzero_si128();
+		size_t end = i + FUZZY_BLOCK_SIZE;
+		if ( end > size )
+			end = size;
+		for ( ; i + 8 <= end; i += 8 )
+		{
+			__m128i a = _mm_loadu_si128( (const __m128i*) ( code_1 + i ) ),
+					b = _mm_loadu_si128( (const __m128i*) ( code_2 + i ) );
+			a_dot = _mm_add_epi32( a_dot, _mm_madd_epi16( a, b ) );
+			a_invalid = _mm_sub_epi16( 	a_invalid,
+										_mm_or_si128( 	_mm_cmpeq_epi16( a, zero ),
+														_mm_cmpeq_epi16( b, zero ) ) );
+		}
+		int tmp[4];
+		_mm_storeu_si128( (__m128i*) tmp, a_dot );
+		dot += (long long) tmp[0] + tmp[1] + tmp[2] + tmp[3];
+		_mm_storeu_si128( (__m128i*) tmp, _mm_madd_epi16( a_invalid, one ) );
+		invalid += (long long) tmp[0] + tmp[1] + tmp[2] + tmp[3];
+	}
+	counts.dot = dot;
+	counts.valid = i - invalid;
+
+	//Fin
+	distance::fuzzy_counts c;
+	count_fuzzy_scalar( c, code_1 + i, code_2 + i, size - i );
+	counts.dot += c.dot;
+	counts.valid += c.valid;
+}
+
+//Noyau AVX2 : même calcul sur 16 pixels
+__attribute__((target("avx2"))) static void count_fuzzy_avx2 (	distance::fuzzy_counts & counts,
+																const short * code_1,
+																const short * code_2,
+																size_t size )
+{
+	const __m256i 	zero = _mm256_setzero_si256(),
+					one = _mm256_set1_epi16( 1 );
+	long long dot = 0;
+	unsigned long long invalid = 0;
+	size_t i = 0;
+	while ( i + 16 <= size )
+	{
+		__m256i a_dot = _mm256_setzero_si256(),
+				a_invalid = _mm256_setzero_si256();
+		size_t end = i + FUZZY_BLOCK_SIZE;
+		if ( end > size )
+			end = size;
+		for ( ; i + 16 <= end; i += 16 )
+		{
+			__m256i a = _mm256_loadu_si256( (const __m256i*) ( code_1 + i ) ),
+					b = _mm256_loadu_si256( (const __m256i*) ( code_2 + i ) );
+			a_dot = _mm256_add_epi32( a_dot, _mm256_madd_epi16( a, b ) );
+			a_invalid = _mm256_sub_epi16( 	a_invalid,
+											_mm256_or_si256( 	_mm256_cmpeq_epi16( a, zero ),
+																_mm256_cmpeq_epi16( b, zero ) ) );
+		}
+		int tmp[8];
+		_mm256_storeu_si256( (__m256i*) tmp, a_dot );
+		for ( unsigned int k = 0; k < 8; ++ k )
+			dot += tmp[k];
+		_mm256_storeu_si256( (__m256i*) tmp, _mm256_madd_epi16( a_invalid, one ) );
+		for ( unsigned int k = 0; k < 8; ++ k )
+			invalid += tmp[k];
+	}
+	counts.dot = dot;
+	counts.valid = i - invalid;
+
+	//Fin
+	distance::fuzzy_counts c;
+	count_fuzzy_scalar( c, code_1 + i, code_2 + i, size - i );
+	counts.dot += c.dot;
+	counts.valid += c.valid;
+}
+
+#endif
+
+static distance::count_fuzzy_prototype 	_count_fuzzy = count_fuzzy_scalar;
+static distance::fuzzy_kernel 			_kernel = distance::FUZZY_SCALAR;
+
+//Sélection automatique au chargement de la bibliothèque
+static int _fuzzy_init = distance::set_fuzzy_kernel( distance::FUZZY_AUTO );
+
+void distance :: count_fuzzy (	fuzzy_counts & counts,
+								const short * code_1,
+								const short * code_2,
+								size_t size )
+{
+	_count_fuzzy( counts, code_1, code_2, size );
+}
+
+unsigned int distance :: fuzzy_code_width_step( unsigned int width )
+{
+	//Ligne doublée, arrondie à 16 entiers ( 32 octets )
+	return ( 2 * width + 15 ) & ~15U;
+}
+
+int distance :: quantize_fuzzy_code( 	short * code_out,
+										const IplImage * code,
+										const IplImage * fragility_map )
+{
+	if ( ! code || ! fragility_map )
+		return 1;
+	if ( 	code->depth != IPL_DEPTH_8U 				||
+			fragility_map->depth != IPL_DEPTH_8U 		||
+			code->width != fragility_map->width 		||
+			code->height > fragility_map->height 		)
+		return 1;
+	unsigned int 	width = code->width,
+					height = code->height,
+					width_step = fuzzy_code_width_step( width );
+	memset( code_out, 0, sizeof(short) * width_step * height );
+	for ( unsigned int i = 0; i < height; ++ i )
+	{
+		const unsigned char 	* c = (const unsigned char *) code->imageData + i * code->widthStep,
+								* fm = (const unsigned char *) fragility_map->imageData + i * fragility_map->widthStep;
+		short * row = code_out + i * width_step;
+		for ( unsigned int j = 0; j < width; ++ j )
+		{
+			row[j] = ( c[j] ) ? fm[j] : - fm[j];
+			row[j + width] = row[j];
+		}
+	}
+	return 0;
+}
+
+int distance :: Hamming_expectation_q ( 	double & d,
+											const short * code_1,
+											const short * code_2,
+											unsigned int width,
+											unsigned int height,
+											unsigned int width_step,
+											int theta )
+{
+	//Décalage circulaire
+	int shift = theta % (int) width;
+	if ( shift < 0 )
+		shift += width;
+	long long dot = 0;
+	unsigned long long n_pixel = 0;
+	for ( unsigned int i = 0; i < height; ++ i )
+	{
+		fuzzy_counts counts;
+		_count_fuzzy( 	counts,
+						code_1 + i * width_step,
+						code_2 + i * width_step + shift,
+						width );
+		dot += counts.dot;
+		n_pixel += counts.valid;
+	}
+	if ( n_pixel == 0 )
+	{
+		d = 1;
+		return 1;
+	}
+	d = 0.5 * ( 1.0 - dot / ( ( (double) FUZZY_CODE_MAX * FUZZY_CODE_MAX ) * n_pixel ) );
+	return 0;
+}
+
+int distance :: registering_q (	double & d,
+									int & theta,
+									const short * code_1,
+									const short * code_2,
+									unsigned int width,
+									unsigned int height,
+									unsigned int width_step,
+									int theta_min,
+									int theta_max )
+{
+	d = 2;
+	theta = theta_min;
+	for( int i = theta_min; i < theta_max; ++ i )
+	{
+		double v = 2;
+		if ( 	Hamming_expectation_q( 	v,
+										code_1,
+										code_2,
+										width,
+										height,
+										width_step,
+										i ) == 0 )
+		{
+			if ( v < d )
+			{
+				theta = i;
+				d = v;
+			}
+		}
+	}
+	if ( d == 2 )
+		return 1;
+	return 0;
+}
+
+bool distance :: fuzzy_kernel_supported( fuzzy_kernel kernel )
+{
+#ifdef FUZZY_X86
+	//Peut être appelée par un constructeur statique ( _fuzzy_init ) : ini. de __builtin_cpu_supports
+	__builtin_cpu_init();
+#endif
+	switch ( kernel )
+	{
+		case FUZZY_AUTO:
+		case FUZZY_SCALAR:
+			return true;
+#ifdef FUZZY_X86
+		case FUZZY_SSE2:
+			return __builtin_cpu_supports( "sse2" );
+		case FUZZY_AVX2:
+			return __builtin_cpu_supports( "avx2" );
+#endif
+		default:
+			return false;
+	}
+}
+
+int distance :: set_fuzzy_kernel( fuzzy_kernel kernel )
+{
+#ifdef FUZZY_X86
+	__builtin_cpu_init();
+#endif
+	if ( kernel == FUZZY_AUTO )
+	{
+		if ( fuzzy_kernel_supported( FUZZY_AVX2 ) )
+			kernel = FUZZY_AVX2;
+		else if ( fuzzy_kernel_supported( FUZZY_SSE2 ) )
+			kernel = FUZZY_SSE2;
+		else
+			kernel = FUZZY_SCALAR;
+	}
+	if ( ! fuzzy_kernel_supported( kernel ) )
+		return 1;
+
+	switch ( kernel )
+	{
+#ifdef FUZZY_X86
+		case FUZZY_SSE2:
+			_count_fuzzy = count_fuzzy_sse2;
+			break;
+		case FUZZY_AVX2:
+			_count_fuzzy = count_fuzzy_avx2;
+			break;
+#endif
+		default:
+			_count_fuzzy = count_fuzzy_scalar;
+			break;
+	}
+	_kernel = kernel;
+	return 0;
+}
+
+distance::fuzzy_kernel distance :: get_fuzzy_kernel( void )
+{
+	return _kernel;
+}
+
+const char * distance :: fuzzy_kernel_name( fuzzy_kernel kernel )
+{
+	switch ( kernel )
+	{
+		case FUZZY_AUTO:
+			return "auto";
+		case FUZZY_SCALAR:
+			return "scalar";
+		case FUZZY_SSE2:
+			return "sse2";
+		case FUZZY_AVX2:
+			return "avx2";
+		default:
+			return "unknown";
+	}
+}
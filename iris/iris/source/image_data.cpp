@@ -1,4 +1,5 @@
 #include "image_data.hpp"
+#include <algorithm>
 image_data :: image_data()
 {
 	initialize();
@@ -93,6 +94,8 @@ int image_data :: setup ( const image_data & data )
 
 image_data & image_data :: operator=( const image_data & data )
 {
+	if ( this == &data )
+		return *this;
 	if ( ! ( *this == data ) )
 		setup ( data );
 	else
@@ -115,6 +118,19 @@ image_data & image_data :: operator=( const image_data & data )
 	return *this;
 }
 
+void image_data :: swap( image_data & data )
+{
+	IplImage * tmp_image = image;
+	image = data.image;
+	data.image = tmp_image;
+	name.swap( data.name );
+	std::swap( width, data.width );
+	std::swap( height, data.height );
+	std::swap( frame_id, data.frame_id );
+	std::swap( score, data.score );
+	std::swap( img_ok, data.img_ok );
+}
+
 image_data :: ~image_data()
 {
 	free();
@@ -0,0 +1,283 @@
+#include "popcount.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define POPCOUNT_X86 1
+#endif
+
+//Noyau scalaire
+static inline __attribute__((always_inline)) void count_bits_generic (	distance::bit_counts & counts,
+																	const unsigned long long * x_1,
+																	const unsigned long long * x_2,
+																	const unsigned long long * v_1,
+																	const unsigned long long * v_2,
+																	const unsigned long long * s_1,
+																	const unsigned long long * s_2,
+																	size_t size )
+{
+	unsigned long long 	n_valid = 0,
+						n_diff = 0,
+						n_both = 0;
+	if ( s_1 && s_2 )
+	{
+		for ( size_t i = 0; i < size; ++ i )
+		{
+			unsigned long long v = v_1[i] & v_2[i];
+			n_valid += __builtin_popcountll( v );
+			n_diff += __builtin_popcountll( ( x_1[i] ^ x_2[i] ) & v );
+			n_both += __builtin_popcountll( s_1[i] & s_2[i] & v );
+		}
+	}
+	else
+	{
+		for ( size_t i = 0; i < size; ++ i )
+		{
+			unsigned long long v = v_1[i] & v_2[i];
+			n_valid += __builtin_popcountll( v );
+			n_diff += __builtin_popcountll( ( x_1[i] ^ x_2[i] ) & v );
+		}
+	}
+	counts.valid = n_valid;
+	counts.diff = n_diff;
+	counts.both = n_both;
+}
+
+static void count_bits_scalar (	distance::bit_counts & counts,
+								const unsigned long long * x_1,
+								const unsigned long long * x_2,
+								const unsigned long long * v_1,
+								const unsigned long long * v_2,
+								const unsigned long long * s_1,
+								const unsigned long long * s_2,
+								size_t size )
+{
+	count_bits_generic( counts, x_1, x_2, v_1, v_2, s_1, s_2, size );
+}
+
+#ifdef POPCOUNT_X86
+
+//Noyau scalaire avec l'instruction popcnt
+__attribute__((target("popcnt"))) static void count_bits_popcnt (	distance::bit_counts & counts,
+																	const unsigned long long * x_1,
+																	const unsigned long long * x_2,
+																	const unsigned long long * v_1,
+																	const unsigned long long * v_2,
+																	const unsigned long long * s_1,
+																	const unsigned long long * s_2,
+																	size_t size )
+{
+	count_bits_generic( counts, x_1, x_2, v_1, v_2, s_1, s_2, size );
+}
+
+//Noyau AVX2 : table de 16 entrées (vpshufb) puis somme horizontale par octets (vpsadbw)
+__attribute__((target("avx2"))) static inline __m256i popcount_avx2( __m256i v )
+{
+	const __m256i 	lookup = _mm256_setr_epi8( 	0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+												0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 ),
+					low_mask = _mm256_set1_epi8( 0x0f );
+	__m256i lo = _mm256_and_si256( v, low_mask ),
+			hi = _mm256_and_si256( _mm256_srli_epi16( v, 4 ), low_mask ),
+			c = _mm256_add_epi8( 	_mm256_shuffle_epi8( lookup, lo ),
+									_mm256_shuffle_epi8( lookup, hi ) );
+	return _mm256_sad_epu8( c, _mm256_setzero_si256() );
+}
+
+__attribute__((target("avx2"))) static inline unsigned long long hsum_avx2( __m256i v )
+{
+	return 	(unsigned long long) _mm256_extract_epi64( v, 0 ) +
+			(unsigned long long) _mm256_extract_epi64( v, 1 ) +
+			(unsigned long long) _mm256_extract_epi64( v, 2 ) +
+			(unsigned long long) _mm256_extract_epi64( v, 3 );
+}
+
+__attribute__((target("avx2"))) static void count_bits_avx2 (	distance::bit_counts & counts,
+																const unsigned long long * x_1,
+																const unsigned long long * x_2,
+																const unsigned long long * v_1,
+																const unsigned long long * v_2,
+																const unsigned long long * s_1,
+																const unsigned long long * s_2,
+																size_t size )
+{
+	__m256i a_valid = _mm256_setzero_si256(),
+			a_diff = _mm256_setzero_si256(),
+			a_both = _mm256_setzero_si256();
+	bool select = ( s_1 && s_2 );
+	size_t i = 0;
+	for ( ; i + 4 <= size; i += 4 )
+	{
+		__m256i v = _mm256_and_si256( 	_mm256_loadu_si256( (const __m256i*) ( v_1 + i ) ),
+										_mm256_loadu_si256( (const __m256i*) ( v_2 + i ) ) ),
+				x = _mm256_xor_si256(	_mm256_loadu_si256( (const __m256i*) ( x_1 + i ) ),
+										_mm256_loadu_si256( (const __m256i*) ( x_2 + i ) ) );
+		a_valid = _mm256_add_epi64( a_valid, popcount_avx2( v ) );
+		a_diff = _mm256_add_epi64( a_diff, popcount_avx2( _mm256_and_si256( x, v ) ) );
+		if ( select )
+		{
+			__m256i s = _mm256_and_si256(	_mm256_loadu_si256( (const __m256i*) ( s_1 + i ) ),
+											_mm256_loadu_si256( (const __m256i*) ( s_2 + i ) ) );
+			a_both = _mm256_add_epi64( a_both, popcount_avx2( _mm256_and_si256( s, v ) ) );
+		}
+	}
+	counts.valid = hsum_avx2( a_valid );
+	counts.diff = hsum_avx2( a_diff );
+	counts.both = hsum_avx2( a_both );
+
+	//Fin
+	for ( ; i < size; ++ i )
+	{
+		unsigned long long v = v_1[i] & v_2[i];
+		counts.valid += __builtin_popcountll( v );
+		counts.diff += __builtin_popcountll( ( x_1[i] ^ x_2[i] ) & v );
+		if ( select )
+			counts.both += __builtin_popcountll( s_1[i] & s_2[i] & v );
+	}
+}
+
+//Noyau AVX-512 (VPOPCNTDQ)
+__attribute__((target("avx512f,avx512vpopcntdq"))) static void count_bits_avx512 (	distance::bit_counts & counts,
+																					const unsigned long long * x_1,
+																					const unsigned long long * x_2,
+																					const unsigned long long * v_1,
+																					const unsigned long long * v_2,
+																					const unsigned long long * s_1,
+																					const unsigned long long * s_2,
+																					size_t size )
+{
+	__m512i a_valid = _mm512_setzero_si512(),
+			a_diff = _mm512_setzero_si512(),
+			a_both = _mm512_setzero_si512();
+	bool select = ( s_1 && s_2 );
+	size_t i = 0;
+	for ( ; i + 8 <= size; i += 8 )
+	{
+		__m512i v = _mm512_and_si512( 	_mm512_loadu_si512( v_1 + i ),
+										_mm512_loadu_si512( v_2 + i ) ),
+				x = _mm512_xor_si512(	_mm512_loadu_si512( x_1 + i ),
+										_mm512_loadu_si512( x_2 + i ) );
+		a_valid = _mm512_add_epi64( a_valid, _mm512_popcnt_epi64( v ) );
+		a_diff = _mm512_add_epi64( a_diff, _mm512_popcnt_epi64( _mm512_and_si512( x, v ) ) );
+		if ( select )
+		{
+			__m512i s = _mm512_and_si512(	_mm512_loadu_si512( s_1 + i ),
+											_mm512_loadu_si512( s_2 + i ) );
+			a_both = _mm512_add_epi64( a_both, _mm512_popcnt_epi64( _mm512_and_si512( s, v ) ) );
+		}
+	}
+	counts.valid = _mm512_reduce_add_epi64( a_valid );
+	counts.diff = _mm512_reduce_add_epi64( a_diff );
+	counts.both = _mm512_reduce_add_epi64( a_both );
+
+	//Fin
+	for ( ; i < size; ++ i )
+	{
+		unsigned long long v = v_1[i] & v_2[i];
+		counts.valid += __builtin_popcountll( v );
+		counts.diff += __builtin_popcountll( ( x_1[i] ^ x_2[i] ) & v );
+		if ( select )
+			counts.both += __builtin_popcountll( s_1[i] & s_2[i] & v );
+	}
+}
+
+#endif
+
+static distance::count_bits_prototype 	_count_bits = count_bits_scalar;
+static distance::popcount_kernel 		_kernel = distance::POPCOUNT_SCALAR;
+
+//Sélection automatique au chargement de la bibliothèque
+static int _popcount_init = distance::set_popcount_kernel( distance::POPCOUNT_AUTO );
+
+bool distance :: popcount_kernel_supported( popcount_kernel kernel )
+{
+#ifdef POPCOUNT_X86
+	//Peut être appelée par un constructeur statique ( _popcount_init ) : ini. de __builtin_cpu_supports
+	__builtin_cpu_init();
+#endif
+	switch ( kernel )
+	{
+		case POPCOUNT_AUTO:
+		case POPCOUNT_SCALAR:
+			return true;
+#ifdef POPCOUNT_X86
+		case POPCOUNT_AVX2:
+			return __builtin_cpu_supports( "avx2" );
+		case POPCOUNT_AVX512:
+			return 	__builtin_cpu_supports( "avx512f" ) &&
+					__builtin_cpu_supports( "avx512vpopcntdq" );
+#endif
+		default:
+			return false;
+	}
+}
+
+int distance :: set_popcount_kernel( popcount_kernel kernel )
+{
+#ifdef POPCOUNT_X86
+	__builtin_cpu_init();
+#endif
+	if ( kernel == POPCOUNT_AUTO )
+	{
+		if ( popcount_kernel_supported( POPCOUNT_AVX512 ) )
+			kernel = POPCOUNT_AVX512;
+		else if ( popcount_kernel_supported( POPCOUNT_AVX2 ) )
+			kernel = POPCOUNT_AVX2;
+		else
+			kernel = POPCOUNT_SCALAR;
+	}
+	if ( ! popcount_kernel_supported( kernel ) )
+		return 1;
+
+	switch ( kernel )
+	{
+#ifdef POPCOUNT_X86
+		case POPCOUNT_AVX2:
+			_count_bits = count_bits_avx2;
+			break;
+		case POPCOUNT_AVX512:
+			_count_bits = count_bits_avx512;
+			break;
+#endif
+		default:
+			_count_bits = count_bits_scalar;
+#ifdef POPCOUNT_X86
+			if ( __builtin_cpu_supports( "popcnt" ) )
+				_count_bits = count_bits_popcnt;
+#endif
+			break;
+	}
+	_kernel = kernel;
+	return 0;
+}
+
+distance::popcount_kernel distance :: get_popcount_kernel( void )
+{
+	return _kernel;
+}
+
+const char * distance :: popcount_kernel_name( popcount_kernel kernel )
+{
+	switch ( kernel )
+	{
+		case POPCOUNT_AUTO:
+			return "auto";
+		case POPCOUNT_SCALAR:
+			return "scalar";
+		case POPCOUNT_AVX2:
+			return "avx2";
+		case POPCOUNT_AVX512:
+			return "avx512";
+		default:
+			return "unknown";
+	}
+}
+
+void distance :: count_bits (	bit_counts & counts,
+								const unsigned long long * x_1,
+								const unsigned long long * x_2,
+								const unsigned long long * v_1,
+								const unsigned long long * v_2,
+								const unsigned long long * s_1,
+								const unsigned long long * s_2,
+								size_t size )
+{
+	_count_bits( counts, x_1, x_2, v_1, v_2, s_1, s_2, size );
+}
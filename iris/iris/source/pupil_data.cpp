@@ -1,4 +1,5 @@
 #include "pupil_data.hpp"
+#include <algorithm>
 pupil_data :: pupil_data()
 {
 	initialize();
@@ -143,6 +144,23 @@ pupil_data & pupil_data :: operator=( const pupil_data & _p_data )
 	return *this;
 }
 
+void pupil_data :: swap( pupil_data & data )
+{
+	_img_data.swap( data._img_data );
+	IplImage * tmp_image = smoothed_image;
+	smoothed_image = data.smoothed_image;
+	data.smoothed_image = tmp_image;
+	std::swap( x_pupil, data.x_pupil );
+	std::swap( y_pupil, data.y_pupil );
+	std::swap( a_pupil, data.a_pupil );
+	std::swap( b_pupil, data.b_pupil );
+	std::swap( theta_pupil, data.theta_pupil );
+	std::swap( pupil_threshold, data.pupil_threshold );
+	std::swap( score, data.score );
+	std::swap( seg_ok, data.seg_ok );
+	std::swap( roi, data.roi );
+}
+
 pupil_data :: ~pupil_data()
 {
 	free();